@@ -59,10 +59,13 @@
 #define STORAGE_TYPE int16_t
 #define STORAGE_BITSIZE 11 /**< round_up(log_2(2 * APP_MSG_MAX_TEMPERATURE)) */
 #define STORAGE_SIGNED 1
-#define STORAGE_EEPROM_FIRST_ROW 21
+#define STORAGE_EEPROM_FIRST_ROW 13
 #define STORAGE_EEPROM_LAST_ROW (EEPROM_NR_OF_RW_ROWS - 1)
 #define STORAGE_COMPRESS_CB App_CompressCb
 #define STORAGE_DECOMPRESS_CB App_DecompressCb
+#define STORAGE_FLASH_LAST_PAGE (EVENT_ARCHIVE_FLASH_FIRST_PAGE - 1) /**< The last 2 kB are used by the event module. */
+#define STORAGE_DEFER_MOVE_TO_FLASH 1 /**< Storage_Service is called while the NFC field is present. */
+#define STORAGE_DEFER_ERASE 1 /**< Erasing FLASH after a reset of the storage module is also left to Storage_Service. */
 #ifdef DEBUG
     #define STORAGE_FIRST_ALON_REGISTER 1
     #define STORAGE_WRITE_RECOVERY_EVERY_X_SAMPLES STORAGE_SAMPLE_ALON_CACHE_COUNT
@@ -73,13 +76,28 @@
     #define STORAGE_REDUCE_RECOVERY_WRITES 0
 #endif
 
+/* Diversities tweaking compress module for application-specific usage. */
+#define COMPRESS_WINDOW_BITS 7 /**< Only used for event archive blocks: no larger than EVENT_ARCHIVE_BLOCK_SIZE. */
+
 /* Diversities tweaking event module for application-specific usage. */
 #define EVENT_CB App_EventCb
 #define EVENT_CB_OPENING_CALL 1
 #define EVENT_CB_CLOSING_CALL 1
 #define EVENT_EEPROM_FIRST_ROW 2
-#define EVENT_EEPROM_LAST_ROW 20
+#define EVENT_EEPROM_LAST_ROW 12 /**< Older events are moved to FLASH, leaving more EEPROM for the storage module. */
 #define EVENT_OVERHEAD_CHOICE EVENT_OVERHEAD_CHOICE_B
+#define EVENT_TAG_INDEX_COUNT 7 /**< Up to EVENT_TAG_TEMPERATURE_TOO_LOW: looked up at each wake-up and excursion. */
+#define EVENT_CHECKPOINT_INTERVAL 16 /**< Event_GetByIndex is called for each NFC read-out page. */
+#define EVENT_ARCHIVE_FLASH_FIRST_PAGE ((FLASH_NR_OF_RW_SECTORS - 2) * FLASH_PAGES_PER_SECTOR)
+#define EVENT_ARCHIVE_BLOCK_SIZE 128
+/**
+ * The end time of an excursion is written in its event when the excursion ends: see validate.c. Meanwhile, at most
+ * each of the other 21 tags is stored once - 5 bytes each - and one excursion of the other kind - 9 bytes - after the
+ * event of the open excursion - 9 bytes as well: 123 bytes, rounded up.
+ */
+#define EVENT_ARCHIVE_KEEP_SIZE 128
+#define EVENT_ARCHIVE_COMPRESS_CB Compress_Encode
+#define EVENT_ARCHIVE_DECOMPRESS_CB Compress_Decode
 
 #ifdef DEBUG
     /* The diag module, if used, is compiled together with the chip library. It is also used at application level in
@@ -100,10 +118,20 @@
  * - Rows [STORAGE_EEPROM_FIRST_ROW .. STORAGE_EEPROM_LAST_ROW] in use by storage module.
  * .
  *
+ * FLASH SW Memory map
+ * - Pages [first free page after the .text and .data sections .. STORAGE_FLASH_LAST_PAGE] in use by storage module.
+ * - Pages [EVENT_ARCHIVE_FLASH_FIRST_PAGE .. last RW page] in use by event module.
+ * .
+ *
  * ALON register usage
  * - Words [0 .. ALON_WORD_SIZE[ in use by memory application file memory.c
  * - Words [STORAGE_FIRST_ALON_REGISTER .. 4] in use by module storage.
  * .
+ *
+ * Changing any of the maps above moves data stored by a previous firmware image. No migration is done: the first
+ * start of each new firmware image is detected in Memory_Init by comparing the build timestamp stored in EEPROM, after
+ * which the configuration, the storage module and the event module are reset. All data logged by the previous firmware
+ * image is lost. FLASH pages reassigned to the event module are erased by the event module before they are reused.
  */
 
 #endif
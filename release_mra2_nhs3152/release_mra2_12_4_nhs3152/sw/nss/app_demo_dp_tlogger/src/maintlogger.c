@@ -280,6 +280,11 @@ void App_MsgReadCb(void)
 
 /**
  * Connects the compress module with the storage module. Provides compression of data.
+ * The temperature drifts slowly: the differences between consecutive samples are compressed, not the packed bytes.
+ * @note This changes the format of the blocks in FLASH: earlier firmware images used #Compress_Encode instead, and
+ *  blocks written by them cannot be decompressed by #App_DecompressCb. The same holds after changing
+ *  #COMPRESS_DELTA_ORDER or #COMPRESS_DELTA_FRAME_SIZE. Such blocks are never read: on the first start of each new
+ *  firmware image, #Memory_Init resets the storage module.
  * @see STORAGE_COMPRESS_CB
  * @see pStorage_CompressCb_t
  */
@@ -289,8 +294,8 @@ int App_CompressCb(int eepromByteOffset, int bitCount, void * pOut)
     (void)bitCount; /* suppress [-Wunused-parameter]: its value is known to be STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS. */
     uint8_t data[STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BYTES];
     Chip_EEPROM_Read(NSS_EEPROM, eepromByteOffset, data, STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BYTES);
-    int length = Compress_Encode(data, STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BYTES, pOut, STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BYTES);
-    return length * 8;
+    return Compress_DeltaEncode(data, STORAGE_BLOCK_SIZE_IN_SAMPLES, STORAGE_BITSIZE, pOut,
+                                STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BYTES);
 }
 
 /**
@@ -300,8 +305,7 @@ int App_CompressCb(int eepromByteOffset, int bitCount, void * pOut)
  */
 int App_DecompressCb(const uint8_t * pData, int bitCount, void * pOut)
 {
-    int length = Compress_Decode(pData, STORAGE_IDIVUP(bitCount, 8), pOut, STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BYTES);
-    return (length == STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BYTES) ? STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS : 0;
+    return Compress_DeltaDecode(pData, bitCount, STORAGE_BITSIZE, pOut, STORAGE_BLOCK_SIZE_IN_SAMPLES);
 }
 
 /* ------------------------------------------------------------------------- */
@@ -692,6 +696,18 @@ static bool Execute(PMU_DPD_WAKEUPREASON_T wakeupReason)
         if (Timer_CheckMeasurementTimeout()) {
             DoPeriodicMeasurements(USEPLACEHOLDER);
         }
+
+        if ((!sMessageAvailable) && ((Chip_NFC_GetStatus(NSS_NFC) & NFC_STATUS_SEL) != 0)) {
+            /* The NFC field supplies power and no command is waiting: move samples from EEPROM to FLASH and erase FLASH
+             * now, one short step at a time, instead of during a periodic measurement. See STORAGE_DEFER_MOVE_TO_FLASH
+             * and STORAGE_DEFER_ERASE.
+             * Only when the storage module has nothing left to do, the oldest events are moved to FLASH as well, one
+             * block at a time, instead of in Event_Set. See EVENT_ARCHIVE_KEEP_SIZE.
+             */
+            if (!Storage_Service()) {
+                (void)Event_Service();
+            }
+        }
 #ifndef DEBUG
         if ((Chip_NFC_GetStatus(NSS_NFC) & NFC_STATUS_SEL) != 0) {
             /* Only feed when NFC is still detected. This to avoid a hang where the while loop, checking on
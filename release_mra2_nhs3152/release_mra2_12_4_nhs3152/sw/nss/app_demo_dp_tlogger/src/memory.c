@@ -109,6 +109,12 @@ static char sTestValuesOfEventT[((1 << EVENT_TAG_TILT_CONFIGURED) == APP_MSG_EVE
 static char sTestValuesOfEventQ[((int)EVENT_TAG_COUNT == APP_MSG_EVENT_COUNT) - 1] __attribute__((unused));
 /** @} */
 
+/**
+ * Dummy variable to test whether the tags looked up during each wake-up and each excursion are indexed by the event
+ * module - see #EVENT_TAG_INDEX_COUNT.
+ */
+static char sTestTagIndex[((EVENT_TAG_LOGGING < EVENT_TAG_INDEX_COUNT) && (EVENT_TAG_TEMPERATURE_TOO_HIGH < EVENT_TAG_INDEX_COUNT) && (EVENT_TAG_TEMPERATURE_TOO_LOW < EVENT_TAG_INDEX_COUNT)) - 1] __attribute__((unused));
+
 /* ------------------------------------------------------------------------- */
 
 /**
@@ -147,6 +153,10 @@ bool Memory_Init(void)
     uint32_t eepromBuildTimestamp;
     Chip_EEPROM_Read(NSS_EEPROM, EEPROM_OFFSET_BUILDTIMESTAMP, &eepromBuildTimestamp, sizeof(uint32_t));
     if (eepromBuildTimestamp != sArmBuildTimestamp) {
+        /* First start of a new firmware image. Its EEPROM, FLASH and ALON memory maps - see app_sel.h - and the
+         * format of the compressed blocks in FLASH - see App_CompressCb - may differ from the ones of the previous
+         * image: nothing stored before can be trusted. Start over.
+         */
         Chip_EEPROM_Write(NSS_EEPROM, EEPROM_OFFSET_BUILDTIMESTAMP, &sArmBuildTimestamp, sizeof(uint32_t));
         Chip_EEPROM_Memset(NSS_EEPROM, EEPROM_OFFSET_CONFIG, 0, sizeof(MEMORY_CONFIG_T));
         Storage_Init();
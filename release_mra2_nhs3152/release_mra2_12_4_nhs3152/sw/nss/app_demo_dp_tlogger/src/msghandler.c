@@ -150,8 +150,8 @@ static bool EventCb_GetEventsResponse(uint8_t tag, int offset, uint8_t len, unsi
         default:
             ASSERT(sData != NULL);
             ASSERT((sOffsetInResponse > 0) && (sOffsetInResponse <= (int)MAX_RECORD_PAYLOAD_SIZE));
-            if (offset < 0) {
-                len = 0;
+            if ((offset < 0) && (Event_GetData() == NULL)) {
+                len = 0; /* No data available. Archived events do provide their data via Event_GetData. */
             }
             if ((1U << tag) & pResponse->eventMask) {
                 sCallCount++;
@@ -193,7 +193,13 @@ static bool EventCb_GetEventsResponse(uint8_t tag, int offset, uint8_t len, unsi
                             sOffsetInResponse = (uint16_t)(sOffsetInResponse + 1);
                         }
                         if ((pResponse->info & EVENT_INFO_DATA) && (len)) {
-                            Chip_EEPROM_Read(NSS_EEPROM, offset, sData + sOffsetInResponse, len);
+                            const void * pEventData = Event_GetData();
+                            if (pEventData) {
+                                memcpy(sData + sOffsetInResponse, pEventData, len);
+                            }
+                            else {
+                                Chip_EEPROM_Read(NSS_EEPROM, offset, sData + sOffsetInResponse, len);
+                            }
                             sOffsetInResponse = (uint16_t)(sOffsetInResponse + len);
                         }
                     }
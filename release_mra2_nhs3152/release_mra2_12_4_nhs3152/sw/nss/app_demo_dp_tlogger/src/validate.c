@@ -100,7 +100,11 @@ void Validate_Temperature(int16_t temperature)
                     tag = EVENT_TAG_TEMPERATURE_TOO_HIGH;
                 }
                 if (tag < EVENT_TAG_COUNT) {
-                    /* The excursion ended. Fetch the previously created event, and update the extra data. */
+                    /* The excursion ended. Fetch the previously created event, and update the extra data.
+                     * The event is still stored in EEPROM: Event_Service never moves it to FLASH while the excursion
+                     * lasts, see EVENT_ARCHIVE_KEEP_SIZE. Only when Event_Set had to make room itself - the offset is
+                     * then negative - it can no longer be updated: its end time then stays 0.
+                     */
                     int offset = -1;
                     uint8_t len = 0;
                     Event_GetLastByTag(tag, &offset, &len, NULL, NULL);
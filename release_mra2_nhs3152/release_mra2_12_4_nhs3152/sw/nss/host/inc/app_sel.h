@@ -0,0 +1,76 @@
+/*
+ * Copyright 2020 NXP
+ * This software is owned or controlled by NXP and may only be used strictly
+ * in accordance with the applicable license terms.  By expressly accepting
+ * such terms or by downloading, installing, activating and/or otherwise using
+ * the software, you are agreeing that you have read, and that you agree to
+ * comply with and are bound by, such license terms.  If you do not agree to
+ * be bound by the applicable license terms, then you may not retain, install,
+ * activate or otherwise use the software.
+ */
+
+#ifndef __APP_SEL_H_
+#define __APP_SEL_H_
+
+/**
+ * @file
+ * Diversity settings for the host builds. Force-included, as in the firmware projects.
+ * By default, the storage and event modules are configured as in the tlogger demo application - see
+ * app_demo_dp_tlogger/mods/app_sel.h. The Makefile builds extra variants by defining some of the settings below on the
+ * command line. The other modules use their default settings, apart from what the Makefile defines.
+ */
+
+#include <stdint.h>
+
+#ifndef STORAGE_TYPE
+    #define STORAGE_TYPE int16_t
+    #define STORAGE_BITSIZE 11
+    #define STORAGE_SIGNED 1
+#endif
+#ifndef STORAGE_EEPROM_FIRST_ROW
+    #define STORAGE_EEPROM_FIRST_ROW 13
+#endif
+#ifndef STORAGE_EEPROM_LAST_ROW
+    #define STORAGE_EEPROM_LAST_ROW (EEPROM_NR_OF_RW_ROWS - 1)
+#endif
+#ifndef STORAGE_FLASH_FIRST_PAGE
+    #define STORAGE_FLASH_FIRST_PAGE (8 * FLASH_PAGES_PER_SECTOR) /**< Assumes 8 kB of code and data. */
+#endif
+#ifndef STORAGE_FLASH_LAST_PAGE
+    #define STORAGE_FLASH_LAST_PAGE ((FLASH_NR_OF_RW_SECTORS - 2) * FLASH_PAGES_PER_SECTOR - 1)
+#endif
+#ifndef HOST_NO_COMPRESS
+    #define STORAGE_COMPRESS_CB App_CompressCb
+    #define STORAGE_DECOMPRESS_CB App_DecompressCb
+#endif
+#ifndef STORAGE_DEFER_MOVE_TO_FLASH
+    #define STORAGE_DEFER_MOVE_TO_FLASH 1
+#endif
+#ifndef STORAGE_DEFER_ERASE
+    #define STORAGE_DEFER_ERASE 1
+#endif
+#ifndef STORAGE_FIRST_ALON_REGISTER
+    #define STORAGE_FIRST_ALON_REGISTER 3
+    #define STORAGE_WRITE_RECOVERY_EVERY_X_SAMPLES STORAGE_SAMPLE_ALON_CACHE_COUNT
+    #define STORAGE_REDUCE_RECOVERY_WRITES 0
+#endif
+
+/* The event callback is not set at compile time: the tests use Event_SetCb instead. */
+#ifndef EVENT_EEPROM_FIRST_ROW
+    #define EVENT_EEPROM_FIRST_ROW 2
+#endif
+#ifndef EVENT_EEPROM_LAST_ROW
+    #define EVENT_EEPROM_LAST_ROW 12
+#endif
+#define EVENT_CB_OPENING_CALL 1
+#define EVENT_CB_CLOSING_CALL 1
+#define EVENT_OVERHEAD_CHOICE EVENT_OVERHEAD_CHOICE_B
+#define EVENT_TAG_INDEX_COUNT 7
+#define EVENT_CHECKPOINT_INTERVAL 16
+#define EVENT_ARCHIVE_FLASH_FIRST_PAGE ((FLASH_NR_OF_RW_SECTORS - 2) * FLASH_PAGES_PER_SECTOR)
+#define EVENT_ARCHIVE_BLOCK_SIZE 128
+#define EVENT_ARCHIVE_KEEP_SIZE 128
+#define EVENT_ARCHIVE_COMPRESS_CB Compress_Encode
+#define EVENT_ARCHIVE_DECOMPRESS_CB Compress_Decode
+
+#endif
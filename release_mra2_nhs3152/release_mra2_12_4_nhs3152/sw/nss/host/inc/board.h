@@ -0,0 +1,22 @@
+/*
+ * Copyright 2020 NXP
+ * This software is owned or controlled by NXP and may only be used strictly
+ * in accordance with the applicable license terms.  By expressly accepting
+ * such terms or by downloading, installing, activating and/or otherwise using
+ * the software, you are agreeing that you have read, and that you agree to
+ * comply with and are bound by, such license terms.  If you do not agree to
+ * be bound by the applicable license terms, then you may not retain, install,
+ * activate or otherwise use the software.
+ */
+
+#ifndef __BOARD_H_
+#define __BOARD_H_
+
+/**
+ * @file
+ * Replaces lib_board_dp/inc/board.h when building for the host: there are no board peripherals to drive.
+ */
+
+#include "chip.h"
+
+#endif
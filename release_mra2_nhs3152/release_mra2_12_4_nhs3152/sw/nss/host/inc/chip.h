@@ -0,0 +1,114 @@
+/*
+ * Copyright 2020 NXP
+ * This software is owned or controlled by NXP and may only be used strictly
+ * in accordance with the applicable license terms.  By expressly accepting
+ * such terms or by downloading, installing, activating and/or otherwise using
+ * the software, you are agreeing that you have read, and that you agree to
+ * comply with and are bound by, such license terms.  If you do not agree to
+ * be bound by the applicable license terms, then you may not retain, install,
+ * activate or otherwise use the software.
+ */
+
+#ifndef __CHIP_H_
+#define __CHIP_H_
+
+/**
+ * @file
+ * Replaces lib_chip_nss/inc/chip.h when building for the host. The include guard is shared with the original: the
+ * driver headers of lib_chip_nss that are used as-is - eeprom_nss.h and iap_nss.h - include "chip.h" themselves, which
+ * then resolves to nothing.
+ * - The memories are backed by arrays in SRAM of the host: see host_nvm.h.
+ * - The RTC up counter and CT32B0 only advance when told to, and the NFC block is never selected: see host_chip.h.
+ * - The clock, reset and power control of the peripherals are no-ops.
+ * - #ASSERT is always active, and aborts the program.
+ * .
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define ASSERT(expr) do { if (expr) {} else { fprintf(stderr, "%s:%d: ASSERT(%s)\n", __FILE__, __LINE__, #expr); \
+                                               abort(); } } while (0)
+
+#define __IO volatile
+#define __I volatile const
+#define __O volatile
+
+#define SDK_VERSION 12_4_nhs3152
+
+extern uint8_t gHostNvm_Eeprom[];
+extern uint8_t gHostNvm_Flash[];
+
+#define EEPROM_START ((uintptr_t)gHostNvm_Eeprom)
+#define EEPROM_ROW_SIZE 64
+#define EEPROM_NR_OF_R_ROWS 64
+#define EEPROM_NR_OF_RW_ROWS 58
+
+#define FLASH_START ((uintptr_t)gHostNvm_Flash)
+#define FLASH_SECTOR_SIZE 1024
+#define FLASH_PAGE_SIZE 64
+#define FLASH_PAGES_PER_SECTOR (FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE)
+#define FLASH_NR_OF_R_SECTORS 32
+#define FLASH_NR_OF_RW_SECTORS 30
+
+#define __disable_irq() do { } while (0)
+#define __enable_irq() do { } while (0)
+#define __get_PRIMASK() 0u
+
+#define EEPROM_IRQn 28
+#define NVIC_ClearPendingIRQ(irq) ((void)(irq))
+#define NVIC_EnableIRQ(irq) ((void)(irq))
+#define NVIC_DisableIRQ(irq) ((void)(irq))
+
+#define Chip_Clock_Peripheral_EnableClock(peripheral) ((void)0)
+#define Chip_Clock_Peripheral_DisableClock(peripheral) ((void)0)
+#define Chip_SysCon_Peripheral_AssertReset(peripheral) ((void)0)
+#define Chip_SysCon_Peripheral_DeassertReset(peripheral) ((void)0)
+#define Chip_SysCon_Peripheral_EnablePower(peripheral) ((void)0)
+#define Chip_SysCon_Peripheral_DisablePower(peripheral) ((void)0)
+#define Chip_Clock_System_BusyWait_us(us) ((void)0)
+#define Chip_Clock_System_GetClockFreq() 8000000
+
+typedef struct NSS_RTC_S NSS_RTC_T;
+typedef struct NSS_TIMER_S NSS_TIMER_T;
+typedef struct NSS_NFC_S NSS_NFC_T;
+#define NSS_RTC ((NSS_RTC_T *)NULL)
+#define NSS_TIMER32_0 ((NSS_TIMER_T *)NULL)
+#define NSS_NFC ((NSS_NFC_T *)NULL)
+
+typedef enum NFC_INT {
+    NFC_INT_RFSELECT = (1 << 1),
+    NFC_INT_NFCOFF = (1 << 8)
+} NFC_INT_T;
+typedef enum NFC_STATUS {
+    NFC_STATUS_SEL = (1 << 4)
+} NFC_STATUS_T;
+
+#define Chip_TIMER32_0_Init() ((void)0)
+#define Chip_TIMER32_0_DeInit() ((void)0)
+#define Chip_TIMER_Reset(pTMR) ((void)(pTMR))
+#define Chip_TIMER_PrescaleSet(pTMR, prescale) ((void)(pTMR), (void)(prescale))
+#define Chip_TIMER_Enable(pTMR) ((void)(pTMR))
+#define Chip_TIMER_Disable(pTMR) ((void)(pTMR))
+
+int Chip_RTC_Time_GetValue(NSS_RTC_T *pRTC);
+uint32_t Chip_TIMER_ReadCount(NSS_TIMER_T *pTMR);
+NFC_INT_T Chip_NFC_Int_GetRawStatus(NSS_NFC_T *pNFC);
+NFC_STATUS_T Chip_NFC_GetStatus(NSS_NFC_T *pNFC);
+void NFC_IRQHandler(void);
+
+void Chip_PMU_PowerMode_EnterSleep(void);
+void Chip_PMU_SetRetainedData(uint32_t *pData, int offset, int size);
+void Chip_PMU_GetRetainedData(uint32_t *pData, int offset, int size);
+
+#include "diag/diag.h"
+#include "eeprom_nss.h"
+#include "iap_nss.h"
+
+NSS_EEPROM_T * HostNvm_GetEepromRegs(void);
+#define NSS_EEPROM (HostNvm_GetEepromRegs())
+
+#endif
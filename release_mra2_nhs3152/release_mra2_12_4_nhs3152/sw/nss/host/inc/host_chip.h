@@ -0,0 +1,40 @@
+/*
+ * Copyright 2020 NXP
+ * This software is owned or controlled by NXP and may only be used strictly
+ * in accordance with the applicable license terms.  By expressly accepting
+ * such terms or by downloading, installing, activating and/or otherwise using
+ * the software, you are agreeing that you have read, and that you agree to
+ * comply with and are bound by, such license terms.  If you do not agree to
+ * be bound by the applicable license terms, then you may not retain, install,
+ * activate or otherwise use the software.
+ */
+
+#ifndef __HOST_CHIP_H_
+#define __HOST_CHIP_H_
+
+/**
+ * @file
+ * Emulation of the peripherals other than the non-volatile memories - see host_nvm.h - as far as the SDK modules built
+ * for the host use them.
+ * - RTC: the up counter starts at @c 0 and only advances on a call to #HostChip_AdvanceTime.
+ * - CT32B0: counts system clock cycles - see #Chip_Clock_System_GetClockFreq - and advances together with the RTC up
+ *  counter. All memory operations thus take no time.
+ * - NFC: the block is never selected by a reader, and no interrupt is ever raised. #NFC_IRQHandler is not overridden.
+ * .
+ */
+
+#include "chip.h"
+
+/**
+ * Resets the RTC up counter and CT32B0 to @c 0, as after a power loss. The non-volatile memories are not touched: see
+ * #HostNvm_Init and #HostNvm_PowerLoss.
+ */
+void HostChip_Init(void);
+
+/**
+ * Lets time pass.
+ * @param seconds The number of seconds to advance the RTC up counter with. Must not be negative.
+ */
+void HostChip_AdvanceTime(int seconds);
+
+#endif
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2020 NXP
+ * This software is owned or controlled by NXP and may only be used strictly
+ * in accordance with the applicable license terms.  By expressly accepting
+ * such terms or by downloading, installing, activating and/or otherwise using
+ * the software, you are agreeing that you have read, and that you agree to
+ * comply with and are bound by, such license terms.  If you do not agree to
+ * be bound by the applicable license terms, then you may not retain, install,
+ * activate or otherwise use the software.
+ */
+
+#ifndef __HOST_NVM_H_
+#define __HOST_NVM_H_
+
+/**
+ * @file
+ * Emulation of the non-volatile memories of the NHS3152 on the host, in place of the HW blocks and the IAP ROM code.
+ * The EEPROM driver of lib_chip_nss is used as-is on top of it.
+ * - EEPROM: #EEPROM_START points to an array of #EEPROM_NR_OF_R_ROWS rows. A second array holds the contents that
+ *  survive a power loss: a row is only copied there when the EEPROM driver has started its erase & program operation
+ *  and accesses the EEPROM registers again - to wait for the completion, or before starting a next operation.
+ *  #NSS_EEPROM is a function call for this purpose. The operation completes at once.
+ * - FLASH: #FLASH_START points to an array of #FLASH_NR_OF_R_SECTORS sectors. The IAP calls erase and program it as
+ *  the HW does: a program operation can only clear bits, and a word can only be written once after an erase. Each
+ *  erase or program operation must be preceded by a call to #Chip_IAP_Flash_PrepareSector. As in the IAP driver, each
+ *  erase and program operation is reported to the @ref MODS_NSS_DIAG "diag module" when #DIAG_TRACK_WEAR is set.
+ * - PMU: the 5 words of retained data (the general purpose registers in the always-on domain).
+ * .
+ * Every erase & program operation of an EEPROM row, every FLASH program operation and every FLASH erase operation is a
+ * step. #HostNvm_SchedulePowerCut allows to lose power right before any step is executed.
+ */
+
+#include <setjmp.h>
+#include "chip.h"
+
+/** The number of words of retained data in the PMU. */
+#define HOST_NVM_RETAINED_DATA_COUNT 5
+
+/** The number of operations on the non-volatile memories, since the last call to #HostNvm_ResetCounters. */
+typedef struct HOST_NVM_COUNTERS_S {
+    int eepromProgramCount; /**< The number of EEPROM rows that were erased & programmed. */
+    int flashProgramCount; /**< The number of FLASH pages that were programmed. */
+    int flashEraseCount; /**< The number of FLASH pages that were erased. */
+    int sleepCount; /**< The number of times the CPU was put in Sleep mode, waiting for an EEPROM operation. */
+} HOST_NVM_COUNTERS_T;
+
+/**
+ * Applies power to a fresh IC: all EEPROM bytes are @c 0, all FLASH bytes are @c 0xFF and the retained data is @c 0.
+ * The step counter and the counters are reset. No power cut is scheduled.
+ */
+void HostNvm_Init(void);
+
+/**
+ * Loses power: everything written to the EEPROM that was not yet programmed is lost, and the retained data in the PMU
+ * is cleared. The contents of FLASH are kept.
+ * @note The state kept by the drivers and modules in SRAM is @b not touched: the caller must re-initialize them as
+ *  after a cold boot.
+ */
+void HostNvm_PowerLoss(void);
+
+/**
+ * Schedules a power loss.
+ * @param step The step before which power is lost, relative to the steps already taken. Use @c 0 to lose power right
+ *  before the next step. A negative value cancels a scheduled power loss.
+ * @param pEnv When the power loss occurs, #HostNvm_PowerLoss is called, after which @c longjmp is called with this
+ *  environment and @c 1 as value.
+ */
+void HostNvm_SchedulePowerCut(int step, jmp_buf * pEnv);
+
+/** @return The number of steps taken since the last call to #HostNvm_Init. */
+int HostNvm_GetStepCount(void);
+
+/** @return The counters, since the last call to #HostNvm_Init or #HostNvm_ResetCounters */
+const HOST_NVM_COUNTERS_T * HostNvm_GetCounters(void);
+
+/** Resets all counters to @c 0. */
+void HostNvm_ResetCounters(void);
+
+#endif
@@ -0,0 +1,30 @@
+/*
+ * Copyright 2020 NXP
+ * This software is owned or controlled by NXP and may only be used strictly
+ * in accordance with the applicable license terms.  By expressly accepting
+ * such terms or by downloading, installing, activating and/or otherwise using
+ * the software, you are agreeing that you have read, and that you agree to
+ * comply with and are bound by, such license terms.  If you do not agree to
+ * be bound by the applicable license terms, then you may not retain, install,
+ * activate or otherwise use the software.
+ */
+
+#ifndef __TRACE_H_
+#define __TRACE_H_
+
+#include <stdint.h>
+
+/**
+ * @file
+ * A reproducible synthetic temperature trace, as logged by the tlogger demo application with one sample every 15
+ * minutes: a daily cycle of +/- 4 degrees Celsius around 5 degrees Celsius, a slow weekly drift and a noise of
+ * +/- 0.2 degrees Celsius.
+ */
+
+/**
+ * @param n The sequence number of the sample. Any value can be given: samples can be generated in any order.
+ * @return The temperature, in 0.1 degrees Celsius. This always fits in 11 bits, sign bit included.
+ */
+int16_t Trace_GetTemperature(int n);
+
+#endif
@@ -0,0 +1,141 @@
+/*
+ * Copyright 2020 NXP
+ * This software is owned or controlled by NXP and may only be used strictly
+ * in accordance with the applicable license terms.  By expressly accepting
+ * such terms or by downloading, installing, activating and/or otherwise using
+ * the software, you are agreeing that you have read, and that you agree to
+ * comply with and are bound by, such license terms.  If you do not agree to
+ * be bound by the applicable license terms, then you may not retain, install,
+ * activate or otherwise use the software.
+ */
+
+#include <string.h>
+#include <time.h>
+#include "trace.h"
+#include "compress/compress.h"
+#include "storage/storage.h"
+
+/**
+ * @file
+ * Comparison of the two codecs of the compress module, on the blocks the storage module hands to the compression
+ * callback of the tlogger demo application: #STORAGE_BLOCK_SIZE_IN_SAMPLES samples of #STORAGE_BITSIZE bits of the
+ * synthetic temperature trace, packed without padding bits.
+ * - heatshrink: #Compress_Encode and #Compress_Decode on the packed bytes, as App_CompressCb did before.
+ * - delta: #Compress_DeltaEncode and #Compress_DeltaDecode on the packed samples, as App_CompressCb does now.
+ * .
+ * Per codec, the compressed size relative to the uncompressed size and the time to encode and decode one block are
+ * reported, averaged over all blocks. Each block is decoded and checked against the original. A block that does not
+ * compress is counted at its uncompressed size, as the storage module then stores it as-is.
+ *
+ * Usage: bench_compress [number of blocks]
+ * @note Timings are measured on the host and only allow to compare the codecs with each other.
+ */
+
+/** The number of times each block is encoded and decoded. The fastest time is kept. */
+#define REPEAT 20
+
+/* ------------------------------------------------------------------------- */
+
+static uint8_t sBlock[STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BYTES];
+static uint8_t sCompressed[STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BYTES];
+static uint8_t sDecompressed[STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BYTES];
+
+/* ------------------------------------------------------------------------- */
+
+static double Now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+/** Packs the samples of block @c n in #sBlock, as the storage module does: LSBit first, back to back. */
+static void FillBlock(int n)
+{
+    memset(sBlock, 0, sizeof(sBlock));
+    for (int i = 0; i < STORAGE_BLOCK_SIZE_IN_SAMPLES; i++) {
+        uint32_t value = (uint32_t)Trace_GetTemperature(n * STORAGE_BLOCK_SIZE_IN_SAMPLES + i);
+        for (int b = 0; b < STORAGE_BITSIZE; b++) {
+            int bit = i * STORAGE_BITSIZE + b;
+            sBlock[bit / 8] = (uint8_t)(sBlock[bit / 8] | (((value >> b) & 1) << (bit % 8)));
+        }
+    }
+}
+
+/** @return The size in bits of the compressed block, as the compression callback would return it. */
+static int HeatshrinkEncode(void)
+{
+    return 8 * Compress_Encode(sBlock, sizeof(sBlock), sCompressed, sizeof(sCompressed));
+}
+
+/** @return The size in bits of the decompressed block, as the decompression callback would return it. */
+static int HeatshrinkDecode(int bitCount)
+{
+    int length = Compress_Decode(sCompressed, STORAGE_IDIVUP(bitCount, 8), sDecompressed, sizeof(sDecompressed));
+    return (length == STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BYTES) ? STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS : 0;
+}
+
+static int DeltaEncode(void)
+{
+    return Compress_DeltaEncode(sBlock, STORAGE_BLOCK_SIZE_IN_SAMPLES, STORAGE_BITSIZE, sCompressed,
+                                sizeof(sCompressed));
+}
+
+static int DeltaDecode(int bitCount)
+{
+    return Compress_DeltaDecode(sCompressed, bitCount, STORAGE_BITSIZE, sDecompressed, STORAGE_BLOCK_SIZE_IN_SAMPLES);
+}
+
+static void Bench(const char * name, int (*pEncode)(void), int (*pDecode)(int), int blockCount)
+{
+    long totalBits = 0;
+    int failures = 0;
+    double encodeTime = 0;
+    double decodeTime = 0;
+    for (int n = 0; n < blockCount; n++) {
+        FillBlock(n);
+        double bestEncode = 1e9;
+        double bestDecode = 1e9;
+        bool compressed = false;
+        int bitCount = 0;
+        for (int r = 0; r < REPEAT; r++) {
+            double start = Now();
+            bitCount = pEncode();
+            double encoded = Now();
+            compressed = (bitCount > 0) && (bitCount < STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS);
+            if (compressed) {
+                memset(sDecompressed, 0, sizeof(sDecompressed));
+                ASSERT(pDecode(bitCount) == STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS);
+            }
+            double decoded = Now();
+            bestEncode = (encoded - start < bestEncode) ? encoded - start : bestEncode;
+            bestDecode = (decoded - encoded < bestDecode) ? decoded - encoded : bestDecode;
+        }
+        if (compressed) {
+            ASSERT(memcmp(sBlock, sDecompressed, sizeof(sBlock)) == 0);
+            totalBits += bitCount;
+        }
+        else {
+            failures++; /* Not smaller than the uncompressed size: the storage module then copies the block as-is. */
+            totalBits += STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS;
+        }
+        encodeTime += bestEncode;
+        decodeTime += bestDecode;
+    }
+    printf("%-12s %8.3f %8d %12.1f %12.1f\n", name,
+           (double)totalBits / ((double)blockCount * STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS), failures,
+           encodeTime * 1e6 / blockCount, decodeTime * 1e6 / blockCount);
+}
+
+int main(int argc, char ** argv)
+{
+    int blockCount = (argc > 1) ? atoi(argv[1]) : 50;
+    setvbuf(stdout, NULL, _IOLBF, 0); /* Keep all output when aborting. */
+
+    printf("%d blocks of %d samples of %d bits; delta: order %d, frame size %d\n", blockCount,
+           STORAGE_BLOCK_SIZE_IN_SAMPLES, STORAGE_BITSIZE, COMPRESS_DELTA_ORDER, COMPRESS_DELTA_FRAME_SIZE);
+    printf("%-12s %8s %8s %12s %12s\n", "codec", "ratio", "as-is", "encode [us]", "decode [us]");
+    Bench("heatshrink", HeatshrinkEncode, HeatshrinkDecode, blockCount);
+    Bench("delta", DeltaEncode, DeltaDecode, blockCount);
+    return 0;
+}
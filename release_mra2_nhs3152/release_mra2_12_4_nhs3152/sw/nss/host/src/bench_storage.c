@@ -0,0 +1,197 @@
+/*
+ * Copyright 2020 NXP
+ * This software is owned or controlled by NXP and may only be used strictly
+ * in accordance with the applicable license terms.  By expressly accepting
+ * such terms or by downloading, installing, activating and/or otherwise using
+ * the software, you are agreeing that you have read, and that you agree to
+ * comply with and are bound by, such license terms.  If you do not agree to
+ * be bound by the applicable license terms, then you may not retain, install,
+ * activate or otherwise use the software.
+ */
+
+#include <string.h>
+#include <time.h>
+#include "host_nvm.h"
+#include "trace.h"
+#include "storage/storage.h"
+
+/**
+ * @file
+ * Benchmark of the storage module, using the host emulation of the non-volatile memories.
+ * - Write: samples are written one by one, as the tlogger demo application does: each sample is written in its own
+ *  active period, with the EEPROM driver and the storage module initialized before and de-initialized after.
+ *  Every #TAP_INTERVAL samples, an NFC tap is emulated by calling #Storage_Service until no work is left.
+ *  The throughput and the number of EEPROM and FLASH operations are reported per #REPORT_INTERVAL samples.
+ * - Read-out: after a cold start, the oldest and the newest samples are read, for increasing log sizes.
+ * - Recovery: the time #Storage_Init takes after a power loss.
+ * .
+ * Usage: bench_storage [maximum number of samples to write]
+ * @note Timings are measured on the host and only allow to compare revisions and diversity settings. The operation
+ *  counts are what the target would execute.
+ */
+
+/** The number of samples written in between two NFC taps. */
+#define TAP_INTERVAL 96
+
+/** The number of samples written in between two reports. */
+#define REPORT_INTERVAL 2000
+
+/** The number of samples read per call to #Storage_Read, as done when responding to a read-out command. */
+#define READ_CHUNK 64
+
+/** The number of times each read-out measurement is repeated. The fastest one is reported. */
+#define READ_REPEAT 5
+
+/* ------------------------------------------------------------------------- */
+
+static STORAGE_TYPE sReadBuffer[READ_CHUNK];
+
+static double Now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+static void Wake(void)
+{
+    Chip_EEPROM_Init(NSS_EEPROM);
+    Storage_Init();
+}
+
+static void Sleep(void)
+{
+    Storage_DeInit();
+    Chip_EEPROM_DeInit(NSS_EEPROM);
+}
+
+/** @return The number of samples written, which may be less than @c max when the storage is full. */
+static int BenchWrite(int max)
+{
+    printf("write: 1 sample per active period, NFC tap every %d samples\n", TAP_INTERVAL);
+    printf("%8s %12s %12s %12s %12s %12s\n", "samples", "samples/s", "EEPROM/1k", "FLASH prg/1k", "FLASH ers/1k",
+           "sleeps/1k");
+    int n = 0;
+    bool full = false;
+    while (!full && (n < max)) {
+        HostNvm_ResetCounters();
+        double start = Now();
+        int count = 0;
+        while (!full && (count < REPORT_INTERVAL) && (n < max)) {
+            STORAGE_TYPE sample = (STORAGE_TYPE)Trace_GetTemperature(n);
+            Wake();
+            if (Storage_Write(&sample, 1) == 1) {
+                n++;
+                count++;
+            }
+            else {
+                full = true;
+            }
+            if (full || (n % TAP_INTERVAL == 0)) {
+                while (Storage_Service()) {
+                    ; /* Keep on working while the NFC field is present. */
+                }
+            }
+            Sleep();
+        }
+        double elapsed = Now() - start;
+        const HOST_NVM_COUNTERS_T * pCounters = HostNvm_GetCounters();
+        double perK = (count > 0) ? 1000.0 / count : 0;
+        printf("%8d %12.0f %12.1f %12.1f %12.1f %12.1f\n", n, (elapsed > 0) ? count / elapsed : 0,
+               pCounters->eepromProgramCount * perK, pCounters->flashProgramCount * perK,
+               pCounters->flashEraseCount * perK, pCounters->sleepCount * perK);
+    }
+    printf("%s after %d samples\n\n", full ? "storage full" : "stopped", n);
+    return n;
+}
+
+/** @return The fastest time, in seconds, to read @c count samples starting from @c first, after a cold start. */
+static double TimeRead(int first, int count, int * pMisses)
+{
+    double best = 1e9;
+    for (int r = 0; r < READ_REPEAT; r++) {
+        Wake();
+        double start = Now();
+        ASSERT(Storage_Seek(first));
+        int done = 0;
+        while (done < count) {
+            int chunk = (count - done < READ_CHUNK) ? count - done : READ_CHUNK;
+            ASSERT(Storage_Read(sReadBuffer, chunk) == chunk);
+            done += chunk;
+        }
+        double elapsed = Now() - start;
+        Storage_GetCacheStatistics(NULL, pMisses);
+        Sleep();
+        if (elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+static void BenchRead(int total)
+{
+    printf("read-out after a cold start, %d samples per Storage_Read call\n", READ_CHUNK);
+    printf("%8s %14s %14s %14s %14s\n", "samples", "oldest [us]", "decompressed", "newest [us]", "decompressed");
+    for (int count = 250; ; count *= 2) {
+        if (count > total) {
+            count = total;
+        }
+        int missesOldest;
+        int missesNewest;
+        double oldest = TimeRead(0, count, &missesOldest);
+        double newest = TimeRead(total - count, count, &missesNewest);
+        printf("%8d %14.1f %14d %14.1f %14d\n", count, oldest * 1e6, missesOldest, newest * 1e6, missesNewest);
+        if (count == total) {
+            break;
+        }
+    }
+    printf("\n");
+}
+
+static void BenchRecovery(void)
+{
+    /* Add a few samples after the last active period, then lose power: Storage_Init must search the EEPROM. */
+    Wake();
+    STORAGE_TYPE samples[3] = {0, 1, 2};
+    int written = Storage_Write(samples, 3);
+    Chip_EEPROM_Flush(NSS_EEPROM, true);
+    int expected = Storage_GetCount();
+    HostNvm_PowerLoss();
+    HostNvm_ResetCounters();
+    double start = Now();
+    Chip_EEPROM_Init(NSS_EEPROM);
+    Storage_Init();
+    double elapsed = Now() - start;
+    printf("recovery after a power loss: %.1f us, %d of %d samples recovered (%d written since the last active period)"
+           "\n", elapsed * 1e6, Storage_GetCount(), expected, written);
+    Sleep();
+}
+
+int main(int argc, char ** argv)
+{
+    int max = (argc > 1) ? atoi(argv[1]) : 1000000;
+    setvbuf(stdout, NULL, _IOLBF, 0); /* Keep all output when aborting. */
+
+    printf("STORAGE_BITSIZE %d, block size %d samples, EEPROM rows [%d, %d], FLASH pages [%d, %d], %s\n\n",
+           STORAGE_BITSIZE, STORAGE_BLOCK_SIZE_IN_SAMPLES, STORAGE_EEPROM_FIRST_ROW, STORAGE_EEPROM_LAST_ROW,
+           STORAGE_FLASH_FIRST_PAGE, STORAGE_FLASH_LAST_PAGE,
+#ifdef HOST_NO_COMPRESS
+           "no compression"
+#else
+           "delta compression"
+#endif
+           );
+
+    HostNvm_Init();
+    Wake();
+    Storage_Reset(true);
+    Sleep();
+
+    int total = BenchWrite(max);
+    if (total > 0) {
+        BenchRead(total);
+    }
+    BenchRecovery();
+    return 0;
+}
@@ -0,0 +1,258 @@
+/*
+ * Copyright 2020 NXP
+ * This software is owned or controlled by NXP and may only be used strictly
+ * in accordance with the applicable license terms.  By expressly accepting
+ * such terms or by downloading, installing, activating and/or otherwise using
+ * the software, you are agreeing that you have read, and that you agree to
+ * comply with and are bound by, such license terms.  If you do not agree to
+ * be bound by the applicable license terms, then you may not retain, install,
+ * activate or otherwise use the software.
+ */
+
+#include <string.h>
+#include "host_nvm.h"
+#include "trace.h"
+#include "storage/storage.h"
+
+/**
+ * @file
+ * Power-loss fuzzer of the storage module, using the host emulation of the non-volatile memories.
+ *
+ * A reproducible workload - a sequence of active periods in which samples are written, #Storage_Service is called now
+ * and then, and which end with #Storage_DeInit - is run once to count the number of steps: the EEPROM and FLASH
+ * operations. It is then replayed from scratch once per step, each time losing power right before that step. After
+ * each power loss, the guarantees documented in storage.h are checked:
+ * - Recovery: after a cold start, #Storage_Init recovers all samples that were stored before the last call to
+ *  #Storage_DeInit that completed, except for the last #STORAGE_MAX_LOSS_AFTER_CORRUPTION ones: a power loss also
+ *  clears the samples cached in the general purpose registers. Samples written afterwards may be lost. This also holds
+ *  when power is lost while a move to FLASH is in progress.
+ * - Integrity: the samples that are recovered are exactly the oldest samples that were written, in order. Nothing
+ *  else is returned.
+ * - Continuity: new samples can be added after the recovery, and all samples survive a following active period.
+ * .
+ * Usage: fuzz_storage [number of active periods in the workload] [seed]
+ * @return @c 0 when all guarantees held after each power loss; the program aborts otherwise.
+ */
+
+/** The maximum number of samples written in one active period. */
+#define MAX_BURST 40
+
+/** The maximum number of samples in the workload. */
+#define MAX_SAMPLES 100000
+
+/* ------------------------------------------------------------------------- */
+
+/** All samples that were given to the storage module, including the ones of an ongoing call to #Storage_Write. */
+static STORAGE_TYPE sWritten[MAX_SAMPLES];
+
+/** The number of samples that were stored when a call to #Storage_DeInit last completed. */
+static int sDurableCount;
+
+/** The number of samples for which a call to #Storage_Write returned. */
+static int sWrittenCount;
+
+/** The number of samples in the call to #Storage_Write that is ongoing, or @c 0. */
+static int sPendingCount;
+
+/**
+ * The number of FLASH pages programmed when the ongoing call to #Storage_Write or #Storage_Service started, or @c -1.
+ * A move is in progress when more pages were programmed since then.
+ */
+static int sMoveStartFlashProgramCount = -1;
+
+static uint32_t sRandomState;
+
+static jmp_buf sPowerCutEnv;
+
+static STORAGE_TYPE sReadBuffer[MAX_SAMPLES];
+
+/* ------------------------------------------------------------------------- */
+
+static int Random(int n)
+{
+    sRandomState = sRandomState * 1103515245u + 12345u;
+    return (int)((sRandomState >> 8) % (uint32_t)n);
+}
+
+/** @return The @c n-th sample, keeping only #STORAGE_BITSIZE bits as #Storage_Read returns them. */
+static STORAGE_TYPE Sample(int n)
+{
+    int value = Trace_GetTemperature(n);
+#if STORAGE_SIGNED
+    int shift = (int)(sizeof(int) * 8) - STORAGE_BITSIZE;
+    value = (int)((unsigned int)value << shift) >> shift;
+#else
+    value &= (int)((1u << STORAGE_BITSIZE) - 1);
+#endif
+    return (STORAGE_TYPE)value;
+}
+
+static void Wake(void)
+{
+    Chip_EEPROM_Init(NSS_EEPROM);
+    Storage_Init();
+}
+
+static void Sleep(void)
+{
+    Storage_DeInit();
+    Chip_EEPROM_DeInit(NSS_EEPROM);
+    sDurableCount = sWrittenCount;
+}
+
+/** @return @c false when the storage is full. */
+static bool ActivePeriod(void)
+{
+    Wake();
+    int n = (Random(8) == 0) ? 1 + Random(MAX_BURST) : 1 + Random(4);
+    if (sWrittenCount + n > MAX_SAMPLES) {
+        n = MAX_SAMPLES - sWrittenCount;
+    }
+    for (int i = 0; i < n; i++) {
+        sWritten[sWrittenCount + i] = Sample(sWrittenCount + i);
+    }
+    sPendingCount = n;
+    sMoveStartFlashProgramCount = HostNvm_GetCounters()->flashProgramCount;
+    int written = Storage_Write(sWritten + sWrittenCount, n);
+    sWrittenCount += written;
+    sPendingCount = 0;
+    if (Random(6) == 0) {
+        sMoveStartFlashProgramCount = HostNvm_GetCounters()->flashProgramCount;
+        while (Storage_Service()) {
+            ; /* Keep on working while the NFC field is present. */
+        }
+    }
+    sMoveStartFlashProgramCount = -1;
+    Sleep();
+    return written == n;
+}
+
+/**
+ * Runs the workload from scratch.
+ * @pre #HostNvm_Init was called.
+ * @return The number of samples written, when the workload completes. When power is lost, @c longjmp is called
+ *  instead.
+ */
+static int Workload(int periods, uint32_t seed)
+{
+    sRandomState = seed;
+    sDurableCount = 0;
+    sWrittenCount = 0;
+    sPendingCount = 0;
+    sMoveStartFlashProgramCount = -1;
+    Wake();
+    Storage_Reset(true);
+    Sleep();
+    for (int p = 0; (p < periods) && ActivePeriod(); p++) {
+        ; /* Keep on logging. */
+    }
+    return sWrittenCount;
+}
+
+/** Reads all samples that are still stored, and checks them against what was written. */
+static void CheckIntegrity(int step, int count)
+{
+    int first = Storage_GetFirst();
+    ASSERT((first >= 0) && (first <= count));
+#if !STORAGE_FLASH_CIRCULAR
+    ASSERT(first == 0);
+#endif
+    if (count > first) {
+        ASSERT(Storage_Seek(first));
+        int read = Storage_Read(sReadBuffer, count - first);
+        if (read != count - first) {
+            printf("step %d: read %d of the %d samples stored\n", step, read, count - first);
+            abort();
+        }
+        for (int i = 0; i < read; i++) {
+            if (sReadBuffer[i] != sWritten[first + i]) {
+                printf("step %d: sample %d reads %d instead of %d\n", step, first + i, sReadBuffer[i],
+                       sWritten[first + i]);
+                abort();
+            }
+        }
+    }
+    ASSERT(!Storage_Seek(count));
+}
+
+/**
+ * Checks the guarantees after a power loss at @c step.
+ * @return The number of samples lost: samples that were stored before the last call to #Storage_DeInit that
+ *  completed, but which are not recovered.
+ */
+static int Check(int step, bool moving)
+{
+    Wake();
+    int count = Storage_GetCount();
+    int minimum = sDurableCount - (STORAGE_MAX_LOSS_AFTER_CORRUPTION);
+    if ((count < minimum) || (count > sWrittenCount + sPendingCount)) {
+        printf("step %d: %d samples recovered, expected [%d, %d]%s\n", step, count, minimum,
+               sWrittenCount + sPendingCount, moving ? " while moving" : "");
+        abort();
+    }
+    CheckIntegrity(step, count);
+    int lost = (sDurableCount > count) ? sDurableCount - count : 0;
+
+    /* The samples that were not recovered are written again, as the application would do with new samples. */
+    int n = (sWrittenCount - count > MAX_BURST) ? sWrittenCount - count : MAX_BURST;
+    if (count + n > MAX_SAMPLES) {
+        n = MAX_SAMPLES - count;
+    }
+    for (int i = 0; i < n; i++) {
+        sWritten[count + i] = Sample(count + i + 1); /* Differs from the samples that were lost. */
+    }
+    sWrittenCount = count + Storage_Write(sWritten + count, n);
+    while (Storage_Service()) {
+        ; /* Keep on working while the NFC field is present. */
+    }
+    Sleep();
+    Wake();
+    if (Storage_GetCount() != sWrittenCount) {
+        printf("step %d: %d samples stored instead of %d\n", step, Storage_GetCount(), sWrittenCount);
+        abort();
+    }
+    CheckIntegrity(step, sWrittenCount);
+    Sleep();
+    return lost;
+}
+
+int main(int argc, char ** argv)
+{
+    int periods = (argc > 1) ? atoi(argv[1]) : 1500;
+    uint32_t seed = (argc > 2) ? (uint32_t)atoi(argv[2]) : 1;
+    setvbuf(stdout, NULL, _IOLBF, 0); /* Keep all output when aborting. */
+
+    HostNvm_Init();
+    int total = Workload(periods, seed);
+    int steps = HostNvm_GetStepCount();
+    const HOST_NVM_COUNTERS_T * pCounters = HostNvm_GetCounters();
+    printf("workload: %d active periods, %d samples, %d steps: %d EEPROM programs, %d FLASH page programs, "
+           "%d FLASH page erases\n", periods, total, steps, pCounters->eepromProgramCount,
+           pCounters->flashProgramCount, pCounters->flashEraseCount);
+
+    int maxLoss = 0;
+    int maxLossMoving = 0;
+    int movingCount = 0;
+    for (int step = 0; step < steps; step++) {
+        HostNvm_Init();
+        HostNvm_SchedulePowerCut(step, &sPowerCutEnv);
+        if (setjmp(sPowerCutEnv) == 0) {
+            Workload(periods, seed);
+            printf("step %d: no power loss\n", step);
+            abort();
+        }
+        bool moving = (sMoveStartFlashProgramCount >= 0)
+                && (HostNvm_GetCounters()->flashProgramCount > sMoveStartFlashProgramCount);
+        int loss = Check(step, moving);
+        if (moving) {
+            movingCount++;
+            maxLossMoving = (loss > maxLossMoving) ? loss : maxLossMoving;
+        }
+        else {
+            maxLoss = (loss > maxLoss) ? loss : maxLoss;
+        }
+    }
+    printf("OK: %d power losses, %d while moving to FLASH; at most %d samples lost (%d while moving)\n", steps,
+           movingCount, maxLoss, maxLossMoving);
+    return 0;
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2020 NXP
+ * This software is owned or controlled by NXP and may only be used strictly
+ * in accordance with the applicable license terms.  By expressly accepting
+ * such terms or by downloading, installing, activating and/or otherwise using
+ * the software, you are agreeing that you have read, and that you agree to
+ * comply with and are bound by, such license terms.  If you do not agree to
+ * be bound by the applicable license terms, then you may not retain, install,
+ * activate or otherwise use the software.
+ */
+
+#include "host_chip.h"
+
+/** The RTC up counter, in seconds. */
+static int sRtc;
+
+/** The value of the CT32B0 counter register. */
+static uint32_t sTimerCount;
+
+/**
+ * The interrupt vector table of the startup module, of which only the entry of the default interrupt handler is
+ * looked at: see #Diag_NFC_IRQHandler. As the application does not override #NFC_IRQHandler, both are the same.
+ */
+void (* const g_pfnVectors[40])(void) = {[39] = NFC_IRQHandler};
+
+/* ------------------------------------------------------------------------- */
+
+void HostChip_Init(void)
+{
+    sRtc = 0;
+    sTimerCount = 0;
+}
+
+void HostChip_AdvanceTime(int seconds)
+{
+    ASSERT(seconds >= 0);
+    sRtc += seconds;
+    sTimerCount += (uint32_t)seconds * (uint32_t)Chip_Clock_System_GetClockFreq();
+}
+
+/* ------------------------------------------------------------------------- */
+
+int Chip_RTC_Time_GetValue(NSS_RTC_T *pRTC)
+{
+    (void)pRTC; /* suppress [-Wunused-parameter]: there is only one RTC. */
+    return sRtc;
+}
+
+uint32_t Chip_TIMER_ReadCount(NSS_TIMER_T *pTMR)
+{
+    (void)pTMR; /* suppress [-Wunused-parameter]: only CT32B0 is used. */
+    return sTimerCount;
+}
+
+NFC_INT_T Chip_NFC_Int_GetRawStatus(NSS_NFC_T *pNFC)
+{
+    (void)pNFC; /* suppress [-Wunused-parameter]: there is only one NFC block. */
+    return (NFC_INT_T)0;
+}
+
+NFC_STATUS_T Chip_NFC_GetStatus(NSS_NFC_T *pNFC)
+{
+    (void)pNFC; /* suppress [-Wunused-parameter]: there is only one NFC block. */
+    return (NFC_STATUS_T)0;
+}
+
+void NFC_IRQHandler(void)
+{
+    /* Not overridden by the application: nothing to do. */
+}
@@ -0,0 +1,238 @@
+/*
+ * Copyright 2020 NXP
+ * This software is owned or controlled by NXP and may only be used strictly
+ * in accordance with the applicable license terms.  By expressly accepting
+ * such terms or by downloading, installing, activating and/or otherwise using
+ * the software, you are agreeing that you have read, and that you agree to
+ * comply with and are bound by, such license terms.  If you do not agree to
+ * be bound by the applicable license terms, then you may not retain, install,
+ * activate or otherwise use the software.
+ */
+
+#include <string.h>
+#include "host_nvm.h"
+
+/** The command written to #NSS_EEPROM_T.CMD by the EEPROM driver to start an erase & program operation. */
+#define EEPROM_START_ERASE_PROGRAM 6
+
+/** The memory-mapped EEPROM, as seen by the CPU. */
+uint8_t gHostNvm_Eeprom[EEPROM_NR_OF_R_ROWS * EEPROM_ROW_SIZE];
+
+/** The memory-mapped FLASH. Only changed via the IAP calls. */
+uint8_t gHostNvm_Flash[FLASH_NR_OF_R_SECTORS * FLASH_SECTOR_SIZE] __attribute__((aligned(4)));
+
+/**
+ * The EEPROM register block. Only #NSS_EEPROM_T.CMD is checked: all operations complete at once, hence
+ * #NSS_EEPROM_T.INT_STATUS always reports them as done.
+ */
+static NSS_EEPROM_T sEepromRegs = {.INT_STATUS = 0xFFFFFFFF};
+
+/** The EEPROM contents that survive a power loss. */
+static uint8_t sEepromNv[EEPROM_NR_OF_R_ROWS * EEPROM_ROW_SIZE];
+
+/** The retained data of the PMU. */
+static uint32_t sRetainedData[HOST_NVM_RETAINED_DATA_COUNT];
+
+/** The sectors unprotected by the last call to #Chip_IAP_Flash_PrepareSector. @c -1 when none are. */
+static int sPreparedFirst = -1;
+static int sPreparedLast = -1;
+
+static int sStep;
+static int sCutStep = -1;
+static jmp_buf * sCutEnv;
+static HOST_NVM_COUNTERS_T sCounters;
+
+/* ------------------------------------------------------------------------- */
+
+/** Takes a step, losing power instead when scheduled. */
+static void Step(void)
+{
+    if (sStep == sCutStep) {
+        sCutStep = -1;
+        HostNvm_PowerLoss();
+        longjmp(*sCutEnv, 1);
+    }
+    sStep++;
+}
+
+/** Checks the sectors holding the given pages are prepared, and consumes the preparation as the IAP ROM code does. */
+static void Unprotect(uint32_t firstPage, uint32_t lastPage)
+{
+    ASSERT(firstPage <= lastPage);
+    ASSERT(lastPage < FLASH_NR_OF_RW_SECTORS * FLASH_PAGES_PER_SECTOR);
+    ASSERT(sPreparedFirst >= 0);
+    ASSERT((int)(firstPage / FLASH_PAGES_PER_SECTOR) >= sPreparedFirst);
+    ASSERT((int)(lastPage / FLASH_PAGES_PER_SECTOR) <= sPreparedLast);
+    sPreparedFirst = -1;
+    sPreparedLast = -1;
+}
+
+/* ------------------------------------------------------------------------- */
+
+void HostNvm_Init(void)
+{
+    memset(gHostNvm_Eeprom, 0, sizeof(gHostNvm_Eeprom));
+    memset(sEepromNv, 0, sizeof(sEepromNv));
+    memset(gHostNvm_Flash, 0xFF, sizeof(gHostNvm_Flash));
+    memset(sRetainedData, 0, sizeof(sRetainedData));
+    sPreparedFirst = -1;
+    sPreparedLast = -1;
+    sStep = 0;
+    sCutStep = -1;
+    HostNvm_ResetCounters();
+}
+
+void HostNvm_PowerLoss(void)
+{
+    memcpy(gHostNvm_Eeprom, sEepromNv, sizeof(gHostNvm_Eeprom));
+    memset(sRetainedData, 0, sizeof(sRetainedData));
+    sPreparedFirst = -1;
+    sPreparedLast = -1;
+}
+
+void HostNvm_SchedulePowerCut(int step, jmp_buf * pEnv)
+{
+    sCutStep = (step < 0) ? -1 : sStep + step;
+    sCutEnv = pEnv;
+}
+
+int HostNvm_GetStepCount(void)
+{
+    return sStep;
+}
+
+const HOST_NVM_COUNTERS_T * HostNvm_GetCounters(void)
+{
+    return &sCounters;
+}
+
+void HostNvm_ResetCounters(void)
+{
+    memset(&sCounters, 0, sizeof(sCounters));
+}
+
+/* ------------------------------------------------------------------------- */
+
+NSS_EEPROM_T * HostNvm_GetEepromRegs(void)
+{
+    if (sEepromRegs.CMD == EEPROM_START_ERASE_PROGRAM) {
+        /* The driver only copies a row to the memory-mapped EEPROM right before programming it: that is the one row
+         * that differs from the contents that survive a power loss - unless it was written with the same data.
+         */
+        sEepromRegs.CMD = 0;
+        Step();
+        int count = 0;
+        for (int row = 0; row < EEPROM_NR_OF_R_ROWS; row++) {
+            uint8_t * p = gHostNvm_Eeprom + row * EEPROM_ROW_SIZE;
+            uint8_t * nv = sEepromNv + row * EEPROM_ROW_SIZE;
+            if (memcmp(p, nv, EEPROM_ROW_SIZE) != 0) {
+                ASSERT(row < EEPROM_NR_OF_RW_ROWS + 1); /* The last rows are locked. */
+                memcpy(nv, p, EEPROM_ROW_SIZE);
+                count++;
+            }
+        }
+        ASSERT(count <= 1);
+        sCounters.eepromProgramCount++;
+    }
+    return &sEepromRegs;
+}
+
+void Chip_PMU_PowerMode_EnterSleep(void)
+{
+    sCounters.sleepCount++;
+}
+
+void Chip_PMU_SetRetainedData(uint32_t *pData, int offset, int size)
+{
+    ASSERT((offset >= 0) && (size >= 0) && (offset + size <= HOST_NVM_RETAINED_DATA_COUNT));
+    memcpy(sRetainedData + offset, pData, (size_t)size * sizeof(uint32_t));
+}
+
+void Chip_PMU_GetRetainedData(uint32_t *pData, int offset, int size)
+{
+    ASSERT((offset >= 0) && (size >= 0) && (offset + size <= HOST_NVM_RETAINED_DATA_COUNT));
+    memcpy(pData, sRetainedData + offset, (size_t)size * sizeof(uint32_t));
+}
+
+IAP_STATUS_T Chip_IAP_Flash_PrepareSector(uint32_t sectorStart, uint32_t sectorEnd)
+{
+    ASSERT((sectorStart <= sectorEnd) && (sectorEnd < FLASH_NR_OF_RW_SECTORS));
+    sPreparedFirst = (int)sectorStart;
+    sPreparedLast = (int)sectorEnd;
+    return IAP_STATUS_CMD_SUCCESS;
+}
+
+IAP_STATUS_T Chip_IAP_Flash_EraseSector(uint32_t sectorStart, uint32_t sectorEnd, uint32_t kHzSysClk)
+{
+    return Chip_IAP_Flash_ErasePage(sectorStart * FLASH_PAGES_PER_SECTOR,
+                                    (sectorEnd + 1) * FLASH_PAGES_PER_SECTOR - 1, kHzSysClk);
+}
+
+IAP_STATUS_T Chip_IAP_Flash_ErasePage(uint32_t pageStart, uint32_t pageEnd, uint32_t kHzSysClk)
+{
+    (void)kHzSysClk; /* suppress [-Wunused-parameter]: the emulation takes no time. */
+    Unprotect(pageStart, pageEnd);
+    uint32_t start = Diag_TrackNvmStart();
+    Step();
+    memset(gHostNvm_Flash + pageStart * FLASH_PAGE_SIZE, 0xFF, (pageEnd + 1 - pageStart) * FLASH_PAGE_SIZE);
+    sCounters.flashEraseCount += (int)(pageEnd + 1 - pageStart);
+    Diag_TrackNvmEnd(DIAG_NVM_OPERATION_FLASH_ERASE, (int)pageStart, (int)(pageEnd - pageStart + 1), start);
+    return IAP_STATUS_CMD_SUCCESS;
+}
+
+IAP_STATUS_T Chip_IAP_Flash_Program(const void *pSrc, const void *pFlash, uint32_t size, uint32_t kHzSysClk)
+{
+    (void)kHzSysClk; /* suppress [-Wunused-parameter]: the emulation takes no time. */
+    uintptr_t offset = (uintptr_t)pFlash - FLASH_START;
+    ASSERT(((uintptr_t)pSrc & 3) == 0);
+    ASSERT((offset % FLASH_PAGE_SIZE == 0) && (size % FLASH_PAGE_SIZE == 0) && (size > 0));
+    Unprotect((uint32_t)(offset / FLASH_PAGE_SIZE), (uint32_t)((offset + size) / FLASH_PAGE_SIZE - 1));
+    uint32_t start = Diag_TrackNvmStart();
+    Step();
+    const uint32_t * src = pSrc;
+    uint32_t * dst = (uint32_t *)(void *)(gHostNvm_Flash + offset);
+    for (uint32_t i = 0; i < size / 4; i++) {
+        /* A word may only be written once after an erase: either it is left untouched, or it was still erased. */
+        ASSERT((src[i] == 0xFFFFFFFF) || (dst[i] == 0xFFFFFFFF) || (src[i] == dst[i]));
+        dst[i] &= src[i];
+    }
+    sCounters.flashProgramCount += (int)(size / FLASH_PAGE_SIZE);
+    Diag_TrackNvmEnd(DIAG_NVM_OPERATION_FLASH_PROGRAM, (int)(offset / FLASH_PAGE_SIZE), (int)(size / FLASH_PAGE_SIZE),
+                     start);
+    return IAP_STATUS_CMD_SUCCESS;
+}
+
+IAP_STATUS_T Chip_IAP_Flash_SectorBlankCheck(uint32_t sectorStart, uint32_t sectorEnd, uint32_t *pOffset,
+                                             uint32_t *pContent)
+{
+    ASSERT((sectorStart <= sectorEnd) && (sectorEnd < FLASH_NR_OF_R_SECTORS));
+    const uint32_t * p = (const uint32_t *)(void *)(gHostNvm_Flash + sectorStart * FLASH_SECTOR_SIZE);
+    for (uint32_t i = 0; i < (sectorEnd + 1 - sectorStart) * FLASH_SECTOR_SIZE / 4; i++) {
+        if (p[i] != 0xFFFFFFFF) {
+            if (pOffset) {
+                *pOffset = i;
+            }
+            if (pContent) {
+                *pContent = p[i];
+            }
+            return IAP_STATUS_SECTOR_NOT_BLANK;
+        }
+    }
+    return IAP_STATUS_CMD_SUCCESS;
+}
+
+IAP_STATUS_T Chip_IAP_Compare(const void *pAddress1, const void *pAddress2, uint32_t size, uint32_t *pOffset)
+{
+    ASSERT((((uintptr_t)pAddress1 & 3) == 0) && (((uintptr_t)pAddress2 & 3) == 0) && (size % 4 == 0));
+    const uint32_t * p1 = pAddress1;
+    const uint32_t * p2 = pAddress2;
+    for (uint32_t i = 0; i < size / 4; i++) {
+        if (p1[i] != p2[i]) {
+            if (pOffset) {
+                *pOffset = i;
+            }
+            return IAP_STATUS_COMPARE_ERROR;
+        }
+    }
+    return IAP_STATUS_CMD_SUCCESS;
+}
@@ -0,0 +1,39 @@
+/*
+ * Copyright 2020 NXP
+ * This software is owned or controlled by NXP and may only be used strictly
+ * in accordance with the applicable license terms.  By expressly accepting
+ * such terms or by downloading, installing, activating and/or otherwise using
+ * the software, you are agreeing that you have read, and that you agree to
+ * comply with and are bound by, such license terms.  If you do not agree to
+ * be bound by the applicable license terms, then you may not retain, install,
+ * activate or otherwise use the software.
+ */
+
+#include "board.h"
+#include "storage/storage.h"
+#include "compress/compress.h"
+
+/**
+ * @file
+ * The compression callbacks of the storage module, identical to the ones of the tlogger demo application - see
+ * app_demo_dp_tlogger/src/maintlogger.c.
+ */
+
+#ifndef HOST_NO_COMPRESS
+
+int App_CompressCb(int eepromByteOffset, int bitCount, void * pOut)
+{
+    ASSERT(bitCount == STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS);
+    (void)bitCount; /* suppress [-Wunused-parameter]: its value is known to be STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS. */
+    uint8_t data[STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BYTES];
+    Chip_EEPROM_Read(NSS_EEPROM, eepromByteOffset, data, STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BYTES);
+    return Compress_DeltaEncode(data, STORAGE_BLOCK_SIZE_IN_SAMPLES, STORAGE_BITSIZE, pOut,
+                                STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BYTES);
+}
+
+int App_DecompressCb(const uint8_t * pData, int bitCount, void * pOut)
+{
+    return Compress_DeltaDecode(pData, bitCount, STORAGE_BITSIZE, pOut, STORAGE_BLOCK_SIZE_IN_SAMPLES);
+}
+
+#endif
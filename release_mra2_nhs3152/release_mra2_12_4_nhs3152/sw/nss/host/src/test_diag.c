@@ -0,0 +1,111 @@
+/*
+ * Copyright 2020 NXP
+ * This software is owned or controlled by NXP and may only be used strictly
+ * in accordance with the applicable license terms.  By expressly accepting
+ * such terms or by downloading, installing, activating and/or otherwise using
+ * the software, you are agreeing that you have read, and that you agree to
+ * comply with and are bound by, such license terms.  If you do not agree to
+ * be bound by the applicable license terms, then you may not retain, install,
+ * activate or otherwise use the software.
+ */
+
+#include "host_chip.h"
+#include "host_nvm.h"
+#include "trace.h"
+#include "storage/storage.h"
+
+/**
+ * @file
+ * Smoke test of the @ref MODS_NSS_DIAG "diag module", with #DIAG_TRACK_WEAR set. The storage module logs samples of
+ * the synthetic temperature trace one per active period, with a Deep power down period in between, and restarts the log
+ * halfway. The statistics are then checked against the time that passed and against the operations counted by the
+ * emulation of the non-volatile memories; the wear counters per EEPROM row and per FLASH sector must add up to the same
+ * totals.
+ *
+ * Usage: test_diag
+ * @return @c 0 when all statistics are as expected; the program aborts otherwise.
+ */
+
+/** The number of active periods. */
+#define PERIOD_COUNT 2000
+
+/** The number of seconds spent in Active mode per active period. */
+#define ACTIVE_TIME 1
+
+/** The number of seconds spent in Deep power down mode between two active periods. */
+#define DEEP_POWER_DOWN_TIME 900
+
+/* ------------------------------------------------------------------------- */
+
+static void Wake(void)
+{
+    Diag_Init();
+    Chip_EEPROM_Init(NSS_EEPROM);
+    Storage_Init();
+}
+
+static void Sleep(void)
+{
+    Storage_DeInit();
+    Chip_EEPROM_DeInit(NSS_EEPROM);
+    Diag_DeInit();
+}
+
+int main(void)
+{
+    setvbuf(stdout, NULL, _IOLBF, 0); /* Keep all output when aborting. */
+    HostNvm_Init();
+    HostChip_Init();
+
+    for (int n = 0; n < PERIOD_COUNT; n++) {
+        Wake();
+        if (n % (PERIOD_COUNT / 2) == 0) {
+            Storage_Reset(false); /* The second time, the FLASH pages in use are erased by Storage_Service. */
+        }
+        STORAGE_TYPE sample = (STORAGE_TYPE)Trace_GetTemperature(n);
+        ASSERT(Storage_Write(&sample, 1) == 1);
+        if (n % 100 == 99) {
+            while (Storage_Service()) {
+                ; /* Keep on working while the NFC field is present. */
+            }
+        }
+        HostChip_AdvanceTime(ACTIVE_TIME);
+        Sleep();
+        HostChip_AdvanceTime(DEEP_POWER_DOWN_TIME);
+    }
+
+    Diag_Init();
+    const DIAG_DATA_T * pData = Diag_Get();
+    const HOST_NVM_COUNTERS_T * pCounters = HostNvm_GetCounters();
+    printf("%d active periods: %u EEPROM programs, %u FLASH page programs, %u FLASH page erases\n", PERIOD_COUNT,
+           pData->eepromProgramCount, pData->flashProgramCount, pData->flashEraseCount);
+    ASSERT(pData->coldBootCount == 1);
+    ASSERT(pData->wakeUpCount == PERIOD_COUNT);
+    ASSERT(pData->activeTime == PERIOD_COUNT * ACTIVE_TIME);
+    ASSERT(pData->deepPowerDownTime == PERIOD_COUNT * DEEP_POWER_DOWN_TIME);
+    ASSERT(pData->nfcTapCount == 0);
+    ASSERT(pData->eepromProgramCount == (uint32_t)pCounters->eepromProgramCount);
+    ASSERT(pData->flashProgramCount == (uint32_t)pCounters->flashProgramCount);
+    ASSERT(pData->flashEraseCount == (uint32_t)pCounters->flashEraseCount);
+    ASSERT((pData->flashProgramCount > 0) && (pData->flashEraseCount > 0));
+
+    /* The row holding the statistics themselves is not tracked individually. */
+    uint32_t eepromProgramCount = 0;
+    for (int row = 0; row < EEPROM_NR_OF_RW_ROWS; row++) {
+        eepromProgramCount += Diag_GetWearCount(DIAG_NVM_OPERATION_EEPROM_PROGRAM, row);
+    }
+    uint32_t flashProgramCount = 0;
+    uint32_t flashEraseCount = 0;
+    for (int sector = 0; sector < FLASH_NR_OF_RW_SECTORS; sector++) {
+        flashProgramCount += Diag_GetWearCount(DIAG_NVM_OPERATION_FLASH_PROGRAM, sector);
+        flashEraseCount += Diag_GetWearCount(DIAG_NVM_OPERATION_FLASH_ERASE, sector);
+    }
+    ASSERT((eepromProgramCount > 0) && (eepromProgramCount < pData->eepromProgramCount));
+    ASSERT(flashProgramCount == pData->flashProgramCount);
+    ASSERT(flashEraseCount == pData->flashEraseCount);
+    ASSERT(Diag_GetWearCount(DIAG_NVM_OPERATION_EEPROM_PROGRAM, STORAGE_EEPROM_FIRST_ROW) > 0);
+    Diag_DeInit();
+
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,175 @@
+/*
+ * Copyright 2020 NXP
+ * This software is owned or controlled by NXP and may only be used strictly
+ * in accordance with the applicable license terms.  By expressly accepting
+ * such terms or by downloading, installing, activating and/or otherwise using
+ * the software, you are agreeing that you have read, and that you agree to
+ * comply with and are bound by, such license terms.  If you do not agree to
+ * be bound by the applicable license terms, then you may not retain, install,
+ * activate or otherwise use the software.
+ */
+
+#include <string.h>
+#include "host_chip.h"
+#include "host_nvm.h"
+#include "event/event.h"
+
+/**
+ * @file
+ * Smoke test of the @ref MODS_NSS_EVENT "event module", configured as in the tlogger demo application: enough events
+ * are stored to move the oldest ones to FLASH, after which all events are retrieved by index, by time and by tag, before
+ * and after a power loss. Each event reported must carry the tag, timestamp and data it was stored with.
+ *
+ * Usage: test_event
+ * @return @c 0 when all events are reported as expected; the program aborts otherwise.
+ */
+
+/** The number of events stored before the power loss. */
+#define EVENT_COUNT 200
+
+/** The number of events stored after the power loss. */
+#define EXTRA_EVENT_COUNT 20
+
+/** The number of different tags used: the higher ones are not indexed, see #EVENT_TAG_INDEX_COUNT. */
+#define TAG_COUNT 10
+
+/** The number of seconds between two events. */
+#define EVENT_INTERVAL 60
+
+/* ------------------------------------------------------------------------- */
+
+/** The number of events reported since the last call to #Reset. */
+static unsigned int sReportedCount;
+
+/** The number of events reported from FLASH since the last call to #Reset. */
+static unsigned int sArchivedCount;
+
+/** The index of the last event reported, or @c -1. Events must be reported in order. */
+static int sLastIndex;
+
+/* ------------------------------------------------------------------------- */
+
+static uint8_t Tag(unsigned int index)
+{
+    return (uint8_t)(index % TAG_COUNT);
+}
+
+static uint32_t Timestamp(unsigned int index)
+{
+    return (index + 1) * EVENT_INTERVAL;
+}
+
+static uint32_t Value(unsigned int index)
+{
+    return 0x5A000000 | (index * 7);
+}
+
+static void Reset(void)
+{
+    sReportedCount = 0;
+    sArchivedCount = 0;
+    sLastIndex = -1;
+}
+
+/** Checks each event reported against what was stored. */
+static bool EventCb(uint8_t tag, int offset, uint8_t len, unsigned int index, uint32_t timestamp, uint32_t context)
+{
+    (void)context; /* suppress [-Wunused-parameter]: all retrievals are checked the same way. */
+    if ((index == EVENT_CB_OPENING_INDEX) || (index == EVENT_CB_CLOSING_INDEX)) {
+        return true;
+    }
+    ASSERT((int)index > sLastIndex);
+    ASSERT(tag == Tag(index));
+    ASSERT(timestamp == Timestamp(index));
+    ASSERT(len == sizeof(uint32_t));
+    uint32_t value;
+    if (offset >= 0) {
+        Chip_EEPROM_Read(NSS_EEPROM, offset, &value, len);
+    }
+    else {
+        const void * pData = Event_GetData();
+        ASSERT(pData != NULL);
+        memcpy(&value, pData, len);
+        sArchivedCount++;
+    }
+    ASSERT(value == Value(index));
+    sLastIndex = (int)index;
+    sReportedCount++;
+    return true;
+}
+
+/** Stores events, moving the oldest ones to FLASH as an application does while the NFC field is present. */
+static void SetEvents(unsigned int first, unsigned int count)
+{
+    for (unsigned int index = first; index < first + count; index++) {
+        HostChip_AdvanceTime((int)Timestamp(index) - Chip_RTC_Time_GetValue(NSS_RTC));
+        uint32_t value = Value(index);
+        ASSERT(Event_Set(Tag(index), &value, sizeof(value)));
+        while (Event_Service()) {
+            ; /* Keep on working. */
+        }
+    }
+}
+
+/** Retrieves the first @c count events in several ways. */
+static void Check(unsigned int count)
+{
+    Reset();
+    ASSERT(Event_GetByIndex(0, count - 1, 0) == count);
+    ASSERT((sReportedCount == count) && (sArchivedCount > 0));
+
+    Reset();
+    ASSERT(Event_GetByIndex(count / 2, count + 10, 0) == count - count / 2);
+    ASSERT(sLastIndex == (int)count - 1);
+
+    Reset();
+    ASSERT(Event_GetByTime(Timestamp(10), Timestamp(19), 0) == 10);
+    ASSERT(sLastIndex == 19);
+
+    for (uint8_t tag = 0; tag < TAG_COUNT; tag++) {
+        unsigned int expected = (count - tag + TAG_COUNT - 1) / TAG_COUNT;
+        Reset();
+        ASSERT(Event_GetByTag(tag, 0) == expected);
+        ASSERT(sReportedCount == expected);
+
+        unsigned int index;
+        uint32_t timestamp;
+        ASSERT(Event_GetFirstByTag(tag, NULL, NULL, &index, &timestamp));
+        ASSERT((index == tag) && (timestamp == Timestamp(tag)));
+        ASSERT(Event_GetLastByTag(tag, NULL, NULL, &index, &timestamp));
+        ASSERT((index == tag + (expected - 1) * TAG_COUNT) && (timestamp == Timestamp(index)));
+    }
+    ASSERT(!Event_GetFirstByTag(TAG_COUNT, NULL, NULL, NULL, NULL));
+}
+
+int main(void)
+{
+    setvbuf(stdout, NULL, _IOLBF, 0); /* Keep all output when aborting. */
+    HostNvm_Init();
+    HostChip_Init();
+
+    Chip_EEPROM_Init(NSS_EEPROM);
+    Event_SetCb(EventCb);
+    Event_Init(true);
+    SetEvents(0, EVENT_COUNT);
+    Check(EVENT_COUNT);
+    Event_DeInit();
+    Chip_EEPROM_DeInit(NSS_EEPROM);
+    const HOST_NVM_COUNTERS_T * pCounters = HostNvm_GetCounters();
+    printf("%d events: %d EEPROM programs, %d FLASH page programs\n", EVENT_COUNT, pCounters->eepromProgramCount,
+           pCounters->flashProgramCount);
+    ASSERT(pCounters->flashProgramCount > 0);
+
+    /* The RTC keeps running: as after a wake-up from Deep power down, the contents of SRAM are lost. */
+    HostNvm_PowerLoss();
+    Chip_EEPROM_Init(NSS_EEPROM);
+    Event_Init(false);
+    Check(EVENT_COUNT);
+    SetEvents(EVENT_COUNT, EXTRA_EVENT_COUNT);
+    Check(EVENT_COUNT + EXTRA_EVENT_COUNT);
+    Event_DeInit();
+    Chip_EEPROM_DeInit(NSS_EEPROM);
+
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,174 @@
+/*
+ * Copyright 2020 NXP
+ * This software is owned or controlled by NXP and may only be used strictly
+ * in accordance with the applicable license terms.  By expressly accepting
+ * such terms or by downloading, installing, activating and/or otherwise using
+ * the software, you are agreeing that you have read, and that you agree to
+ * comply with and are bound by, such license terms.  If you do not agree to
+ * be bound by the applicable license terms, then you may not retain, install,
+ * activate or otherwise use the software.
+ */
+
+#include <string.h>
+#include "host_nvm.h"
+#include "kvstore/kvstore.h"
+
+/**
+ * @file
+ * Smoke test of the @ref MODS_NSS_KVSTORE "key/value store module". A random sequence of changes - enough to compact
+ * the log several times - is applied and checked against a model in RAM, with a power loss after each sleep.
+ * The sequence is then replayed once per EEPROM operation, losing power right before that operation: after recovery,
+ * each key must hold the value it had before the change in progress, or the value it was changed to.
+ *
+ * Usage: test_kvstore
+ * @return @c 0 when all values read are as expected; the program aborts otherwise.
+ */
+
+/** The number of changes in the sequence. */
+#define CHANGE_COUNT 300
+
+/** The number of changes done in one active period, before going to sleep. */
+#define CHANGES_PER_PERIOD 10
+
+/* ------------------------------------------------------------------------- */
+
+/** A value as stored for one key. */
+typedef struct VALUE_S {
+    int size; /**< The size of @c data in bytes, or @c -1 when no value is stored. */
+    uint8_t data[KVSTORE_MAX_VALUE_SIZE]; /**< Only the first @c size bytes are valid. */
+} VALUE_T;
+
+/** The values that are retained, i.e. when the changes done so far are flushed. */
+static VALUE_T sModel[KVSTORE_KEY_COUNT];
+
+/** The key being changed, or @c -1. */
+static int sPendingKey;
+
+/** The value @c sPendingKey is being changed to. */
+static VALUE_T sPendingValue;
+
+static uint32_t sRandomState;
+
+static jmp_buf sPowerCutEnv;
+
+/* ------------------------------------------------------------------------- */
+
+static int Random(int n)
+{
+    sRandomState = sRandomState * 1103515245u + 12345u;
+    return (int)((sRandomState >> 8) % (uint32_t)n);
+}
+
+static bool Equals(const VALUE_T * pValue, int size, const uint8_t * data)
+{
+    return (size == pValue->size) && ((size < 0) || (memcmp(data, pValue->data, (size_t)size) == 0));
+}
+
+/** Checks the value of each key, allowing the key being changed to have either its old or its new value. */
+static void CheckAll(int step)
+{
+    for (int key = 0; key < KVSTORE_KEY_COUNT; key++) {
+        uint8_t data[KVSTORE_MAX_VALUE_SIZE];
+        int size = KvStore_Get(key, data, sizeof(data));
+        if (!Equals(sModel + key, size, data) && !((key == sPendingKey) && Equals(&sPendingValue, size, data))) {
+            printf("step %d: key %d holds %d bytes, expected %d\n", step, key, size, sModel[key].size);
+            abort();
+        }
+    }
+}
+
+static void Wake(void)
+{
+    Chip_EEPROM_Init(NSS_EEPROM);
+    KvStore_Init();
+}
+
+static void Sleep(void)
+{
+    Chip_EEPROM_DeInit(NSS_EEPROM);
+}
+
+/** Changes a random key, and makes sure the change is retained before returning. */
+static void Change(void)
+{
+    sPendingKey = Random(KVSTORE_KEY_COUNT);
+    if (Random(8) == 0) {
+        sPendingValue.size = -1;
+        ASSERT(KvStore_Delete(sPendingKey));
+    }
+    else {
+        /* Small values, often the same as before: KvStore_Set must skip writing those. */
+        sPendingValue.size = Random(KVSTORE_MAX_VALUE_SIZE + 1);
+        for (int i = 0; i < sPendingValue.size; i++) {
+            sPendingValue.data[i] = (uint8_t)Random(2);
+        }
+        ASSERT(KvStore_Set(sPendingKey, sPendingValue.data, sPendingValue.size));
+    }
+    Chip_EEPROM_Flush(NSS_EEPROM, true);
+    sModel[sPendingKey] = sPendingValue;
+    sPendingKey = -1;
+}
+
+/**
+ * Applies the sequence of changes from scratch.
+ * @pre #HostNvm_Init was called.
+ * @note When power is lost, @c longjmp is called instead of returning.
+ */
+static void Workload(void)
+{
+    sRandomState = 1;
+    sPendingKey = -1;
+    for (int key = 0; key < KVSTORE_KEY_COUNT; key++) {
+        sModel[key].size = -1;
+    }
+    Wake();
+    KvStore_Reset();
+    for (int n = 0; n < CHANGE_COUNT; n++) {
+        Change();
+        CheckAll(-1);
+        if (n % CHANGES_PER_PERIOD == CHANGES_PER_PERIOD - 1) {
+            Sleep();
+            HostNvm_PowerLoss();
+            Wake();
+            CheckAll(-1);
+        }
+    }
+    Sleep();
+}
+
+int main(void)
+{
+    setvbuf(stdout, NULL, _IOLBF, 0); /* Keep all output when aborting. */
+
+    HostNvm_Init();
+    Workload();
+    int steps = HostNvm_GetStepCount();
+    printf("workload: %d changes, %d EEPROM programs\n", CHANGE_COUNT, HostNvm_GetCounters()->eepromProgramCount);
+
+    Wake();
+    uint8_t data = 0;
+    ASSERT(KvStore_Get(KVSTORE_KEY_COUNT, NULL, 0) == -1);
+    ASSERT(!KvStore_Set(KVSTORE_KEY_COUNT, &data, 1));
+    ASSERT(!KvStore_Set(0, NULL, KVSTORE_MAX_VALUE_SIZE + 1));
+    ASSERT(!KvStore_Delete(-1));
+    CheckAll(-1);
+    Sleep();
+
+    for (int step = 0; step < steps; step++) {
+        HostNvm_Init();
+        HostNvm_SchedulePowerCut(step, &sPowerCutEnv);
+        if (setjmp(sPowerCutEnv) == 0) {
+            Workload();
+            printf("step %d: no power loss\n", step);
+            abort();
+        }
+        Wake();
+        CheckAll(step);
+        data = (uint8_t)step;
+        ASSERT(KvStore_Set(0, &data, 1));
+        ASSERT((KvStore_Get(0, &data, 1) == 1) && (data == (uint8_t)step));
+        Sleep();
+    }
+    printf("OK: %d power losses\n", steps);
+    return 0;
+}
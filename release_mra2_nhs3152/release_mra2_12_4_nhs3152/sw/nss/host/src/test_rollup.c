@@ -0,0 +1,158 @@
+/*
+ * Copyright 2020 NXP
+ * This software is owned or controlled by NXP and may only be used strictly
+ * in accordance with the applicable license terms.  By expressly accepting
+ * such terms or by downloading, installing, activating and/or otherwise using
+ * the software, you are agreeing that you have read, and that you agree to
+ * comply with and are bound by, such license terms.  If you do not agree to
+ * be bound by the applicable license terms, then you may not retain, install,
+ * activate or otherwise use the software.
+ */
+
+#include <string.h>
+#include "host_nvm.h"
+#include "trace.h"
+#include "rollup/rollup.h"
+
+/**
+ * @file
+ * Smoke test of the @ref MODS_NSS_ROLLUP "rollup module", on top of the storage module in the @c circular
+ * configuration. Samples of the synthetic temperature trace are written a few per active period, until the oldest raw
+ * samples have long been overwritten in FLASH. All records reported by #Rollup_Read must then tile the log without gaps,
+ * from coarse to fine tiers, and the records of complete windows must hold the minimum, maximum and average of the
+ * samples written. The records must be reported identically after a power loss.
+ *
+ * Usage: test_rollup
+ * @return @c 0 when all records are as expected; the program aborts otherwise.
+ */
+
+/** The number of samples written. */
+#define SAMPLE_COUNT 20000
+
+/** The number of samples written in one active period, before going to sleep. */
+#define SAMPLES_PER_PERIOD 4
+
+/** The number of records fetched per call to #Rollup_Read. */
+#define RECORDS_PER_READ 16
+
+/** The largest number of records reported. */
+#define MAX_RECORD_COUNT 4096
+
+/* ------------------------------------------------------------------------- */
+
+static Rollup_Record_t sRecords[MAX_RECORD_COUNT];
+static Rollup_Record_t sRecordsAfterPowerLoss[MAX_RECORD_COUNT];
+
+/* ------------------------------------------------------------------------- */
+
+static void Wake(void)
+{
+    Chip_EEPROM_Init(NSS_EEPROM);
+    Storage_Init();
+    Rollup_Init();
+}
+
+static void Sleep(void)
+{
+    Storage_DeInit();
+    Chip_EEPROM_DeInit(NSS_EEPROM);
+}
+
+/** @return The number of records reported for the whole log. */
+static int ReadAll(Rollup_Record_t * pRecords)
+{
+    int count = 0;
+    int first = 0;
+    int n;
+    do {
+        ASSERT(count + RECORDS_PER_READ <= MAX_RECORD_COUNT);
+        n = Rollup_Read(first, SAMPLE_COUNT - first, pRecords + count, RECORDS_PER_READ);
+        count += n;
+        if (n > 0) {
+            first = pRecords[count - 1].first + pRecords[count - 1].size;
+        }
+    } while ((n == RECORDS_PER_READ) && (first < SAMPLE_COUNT));
+    return count;
+}
+
+/** Checks the records tile the log from coarse to fine tiers, and hold the values of the samples they span. */
+static void Check(const Rollup_Record_t * pRecords, int count)
+{
+    static const int sizes[ROLLUP_TIER_COUNT] = {1, ROLLUP_FACTOR, ROLLUP_FACTOR * ROLLUP_FACTOR};
+    int tierCounts[ROLLUP_TIER_COUNT] = {0};
+    ASSERT(count > 0);
+    for (int i = 0; i < count; i++) {
+        const Rollup_Record_t * pRecord = pRecords + i;
+        ASSERT((pRecord->tier >= 0) && (pRecord->tier < ROLLUP_TIER_COUNT));
+        ASSERT(pRecord->size == sizes[pRecord->tier]);
+        ASSERT(pRecord->first % pRecord->size == 0);
+        ASSERT((pRecord->count >= 0) && (pRecord->count <= pRecord->size));
+        if (i > 0) {
+            ASSERT(pRecord->first == pRecords[i - 1].first + pRecords[i - 1].size);
+            ASSERT(pRecord->tier <= pRecords[i - 1].tier);
+        }
+        tierCounts[pRecord->tier]++;
+
+        if (pRecord->count == pRecord->size) {
+            int min = INT32_MAX;
+            int max = INT32_MIN;
+            int sum = 0;
+            for (int n = pRecord->first; n < pRecord->first + pRecord->size; n++) {
+                int value = Trace_GetTemperature(n);
+                min = (value < min) ? value : min;
+                max = (value > max) ? value : max;
+                sum += value;
+            }
+            /* A record of tier 2 averages the truncated averages of tier 1: it can be off by 1. */
+            int tolerance = (pRecord->tier == 2) ? 1 : 0;
+            for (int channel = 0; channel < STORAGE_CHANNEL_COUNT; channel++) {
+                ASSERT(pRecord->values[channel].min == min);
+                ASSERT(pRecord->values[channel].max == max);
+                ASSERT(abs(pRecord->values[channel].avg - sum / pRecord->size) <= tolerance);
+            }
+        }
+    }
+    ASSERT(pRecords[count - 1].first + pRecords[count - 1].size == SAMPLE_COUNT);
+    ASSERT((tierCounts[0] > 0) && (tierCounts[1] > 0) && (tierCounts[2] > 0));
+    printf("%d records: %d of tier 2, %d of tier 1, %d raw samples\n", count, tierCounts[2], tierCounts[1],
+           tierCounts[0]);
+}
+
+int main(void)
+{
+    setvbuf(stdout, NULL, _IOLBF, 0); /* Keep all output when aborting. */
+    HostNvm_Init();
+
+    Wake();
+    Rollup_Reset(false);
+    for (int n = 0; n < SAMPLE_COUNT; n += SAMPLES_PER_PERIOD) {
+        STORAGE_TYPE samples[SAMPLES_PER_PERIOD * STORAGE_CHANNEL_COUNT];
+        for (int i = 0; i < SAMPLES_PER_PERIOD; i++) {
+            for (int channel = 0; channel < STORAGE_CHANNEL_COUNT; channel++) {
+                samples[i * STORAGE_CHANNEL_COUNT + channel] = (STORAGE_TYPE)Trace_GetTemperature(n + i);
+            }
+        }
+        ASSERT(Rollup_Write(samples, SAMPLES_PER_PERIOD) == SAMPLES_PER_PERIOD);
+        while (Storage_Service()) {
+            ; /* Keep on working while the NFC field is present. */
+        }
+        Sleep();
+        Wake();
+    }
+    const HOST_NVM_COUNTERS_T * pCounters = HostNvm_GetCounters();
+    printf("%d samples: %d EEPROM programs, %d FLASH page programs, %d FLASH page erases\n", SAMPLE_COUNT,
+           pCounters->eepromProgramCount, pCounters->flashProgramCount, pCounters->flashEraseCount);
+
+    int count = ReadAll(sRecords);
+    Check(sRecords, count);
+    Sleep();
+
+    HostNvm_PowerLoss();
+    Wake();
+    ASSERT(ReadAll(sRecordsAfterPowerLoss) == count);
+    ASSERT(memcmp(sRecords, sRecordsAfterPowerLoss, (size_t)count * sizeof(Rollup_Record_t)) == 0);
+    Sleep();
+
+    printf("OK\n");
+    return 0;
+}
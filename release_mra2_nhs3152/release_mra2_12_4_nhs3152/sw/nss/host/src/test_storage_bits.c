@@ -0,0 +1,327 @@
+/*
+ * Copyright 2020 NXP
+ * This software is owned or controlled by NXP and may only be used strictly
+ * in accordance with the applicable license terms.  By expressly accepting
+ * such terms or by downloading, installing, activating and/or otherwise using
+ * the software, you are agreeing that you have read, and that you agree to
+ * comply with and are bound by, such license terms.  If you do not agree to
+ * be bound by the applicable license terms, then you may not retain, install,
+ * activate or otherwise use the software.
+ */
+
+#include <string.h>
+#include <time.h>
+#include "storage/storage.c" /* The bit copy functions under test are static. */
+
+/**
+ * @file
+ * Equivalence test and micro-benchmark of the bit copy functions of the storage module: #ShiftAlignedData,
+ * #ShiftUnalignedData, #ShiftAlignedSample and #ShiftUnalignedSample. They are checked against the byte-wise
+ * implementations they replaced, which are kept here as reference.
+ * - #ShiftAlignedData and #ShiftUnalignedData: for every bit alignment and every bit count up to #MAX_BIT_COUNT.
+ * - #ShiftAlignedSample and #ShiftUnalignedSample: for every bit alignment and - up to 16 bits - for every value of a
+ *  sample of #STORAGE_BITSIZE bits, or for #RANDOM_SAMPLE_COUNT random values otherwise.
+ * .
+ * Both the bytes written and the bytes around them must be identical. The source and destination buffers are allocated
+ * with the exact size the functions are documented to access: build with @c SANITIZE=1 to also check no more is read
+ * or written.
+ * The program is built once per value of #STORAGE_BITSIZE: see the Makefile.
+ *
+ * Usage: test_storage_bits [-b]
+ * - @c -b: also run the micro-benchmark, reporting the time per call of the reference and of the current functions.
+ * .
+ * @return @c 0 when all results are identical; the program aborts otherwise.
+ */
+
+/** The largest number of bits copied by #ShiftAlignedData and #ShiftUnalignedData. */
+#define MAX_BIT_COUNT 600
+
+/** The number of samples checked when #STORAGE_BITSIZE is too large to check all values. */
+#define RANDOM_SAMPLE_COUNT (1 << 18)
+
+/** The number of random buffer contents each combination of bit alignment and bit count is checked with. */
+#define PATTERN_COUNT 4
+
+/** The number of bytes before and after a packed sample which must remain untouched. */
+#define GUARD_SIZE 8
+
+/** The number of bits copied per call in the micro-benchmark of a data block: the uncompressed size of a block. */
+#define BENCH_BLOCK_BIT_COUNT STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS
+
+/** The number of calls per measurement in the micro-benchmark. */
+#define BENCH_CALL_COUNT 2000000
+
+/* ------------------------------------------------------------------------- */
+
+static uint32_t sRandomState = 1;
+
+/** Accumulates the results of the micro-benchmark, so that no call can be optimized away. */
+static volatile uint32_t sSink;
+
+/* ------------------------------------------------------------------------- */
+
+/* The byte-wise implementations, as they were before the word-wide rewrite. */
+
+/** Reference implementation of #ShiftAlignedData. */
+static void RefShiftAlignedData(uint8_t * pTo, const uint8_t * pFrom, const int bitAlignment, const int bitCount)
+{
+    const uint8_t mask = (uint8_t)(0xFF & ((1 << bitAlignment) - 1)); /* Covering the existing bits in the last byte. */
+
+    ASSERT((bitAlignment >= 0) && (bitAlignment < 8));
+    ASSERT(bitCount > 0);
+
+    int n = 0;
+    do {
+        /* Step 1: copy x lsbits of the current byte, with x = 8-bitAlignment so left shift bitAlignment places */
+        *pTo = (uint8_t)((pFrom[n] << bitAlignment) | ((*pTo) & mask));
+
+        if ((n * 8) + 8 - bitAlignment < bitCount) {
+            /* Advance to the next location to copy bits to. */
+            pTo++;
+
+            /* Step 2: copy x msbits of the new byte, with x = bitAlignment so right shift 8-bitAlignment places */
+            *pTo = (uint8_t)(pFrom[n] >> (8 - bitAlignment));
+        }
+
+        n++;
+    } while (n * 8 < bitCount);
+
+    /* Clear the bits that were copied in excess. */
+    uint8_t finalMask = (uint8_t)~(0xFF << ((bitCount + bitAlignment) % 8));
+    if (finalMask != 0) { /* finalMask equals zero when the last bit to retain is the MSBit of the last byte written. */
+        *pTo = *pTo & finalMask;
+    }
+}
+
+/** Reference implementation of #ShiftUnalignedData. */
+static void RefShiftUnalignedData(uint8_t * pTo, const uint8_t * pFrom, const int bitAlignment, const int bitCount)
+{
+    const uint8_t mask = 0xFF & (uint8_t)((1 << (8 - bitAlignment)) - 1); /* Covering the lsbits to retain. */
+
+    ASSERT((bitAlignment >= 0) && (bitAlignment < 8));
+    ASSERT(bitCount > 0);
+
+    int n = 0;
+    do {
+        /* Step 1: copy x msbits of the current byte, with x = 8-bitAlignment so right shift bitAlignment places. */
+        *pTo = (uint8_t)((pFrom[n]) >> bitAlignment);
+
+        /* Advance to the next location to copy bits from. */
+        n++;
+
+        if (((n - 1) * 8) + 8 - bitAlignment < bitCount) {
+
+            /* Step 2: copy x lsbits of the next byte, with x = bitAlignment so left shift 8-bitAlignment places. */
+            *pTo = (uint8_t)((pFrom[n] << (8 - bitAlignment)) | ((*pTo) & mask));
+
+            if (n * 8 < bitCount) {
+                pTo++; /* Do not increment @c to unconditionally: @c finalmask still may have to be applied. */
+            }
+        }
+    } while (n * 8 < bitCount);
+
+    /* Clear the bits that were copied in excess. */
+    uint8_t finalMask = (uint8_t)~(0xFF << (bitCount % 8));
+    if (finalMask != 0) { /* finalMask equals zero when the last bit to retain is the MSBit of the last byte written. */
+        *pTo = *pTo & finalMask;
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+
+static uint8_t RandomByte(void)
+{
+    sRandomState = sRandomState * 1103515245u + 12345u;
+    return (uint8_t)(sRandomState >> 16);
+}
+
+static void Randomize(uint8_t * pData, int size)
+{
+    for (int i = 0; i < size; i++) {
+        pData[i] = RandomByte();
+    }
+}
+
+/** Allocates a buffer of exactly @c size bytes, so that the sanitizers catch any access beyond it. */
+static uint8_t * Allocate(int size)
+{
+    uint8_t * p = malloc((size_t)size);
+    ASSERT(p);
+    return p;
+}
+
+/**
+ * Calls @c pFunction and @c pReference on copies of the same random destination and source, and checks the resulting
+ * destinations are identical.
+ * @param toSize The number of bytes the functions may write.
+ * @param fromSize The number of bytes the functions may read.
+ */
+static void Compare(const char * name, void (*pFunction)(uint8_t *, const uint8_t *, const int, const int),
+                    void (*pReference)(uint8_t *, const uint8_t *, const int, const int), int bitAlignment,
+                    int bitCount, int toSize, int fromSize)
+{
+    uint8_t * pFrom = Allocate(fromSize);
+    uint8_t * pTo = Allocate(toSize);
+    uint8_t * pExpected = Allocate(toSize);
+    for (int p = 0; p < PATTERN_COUNT; p++) {
+        Randomize(pFrom, fromSize);
+        Randomize(pTo, toSize);
+        memcpy(pExpected, pTo, (size_t)toSize);
+        pFunction(pTo, pFrom, bitAlignment, bitCount);
+        pReference(pExpected, pFrom, bitAlignment, bitCount);
+        if (memcmp(pTo, pExpected, (size_t)toSize) != 0) {
+            printf("%s: bit alignment %d, bit count %d: results differ\n", name, bitAlignment, bitCount);
+            abort();
+        }
+    }
+    free(pExpected);
+    free(pTo);
+    free(pFrom);
+}
+
+static void TestData(void)
+{
+    for (int bitCount = 1; bitCount <= MAX_BIT_COUNT; bitCount++) {
+        for (int bitAlignment = 0; bitAlignment < 8; bitAlignment++) {
+            Compare("ShiftAlignedData", ShiftAlignedData, RefShiftAlignedData, bitAlignment, bitCount,
+                    STORAGE_IDIVUP(bitCount + bitAlignment, 8), STORAGE_IDIVUP(bitCount, 8));
+            Compare("ShiftUnalignedData", ShiftUnalignedData, RefShiftUnalignedData, bitAlignment, bitCount,
+                    STORAGE_IDIVUP(bitCount, 8), STORAGE_IDIVUP(bitCount + bitAlignment, 8));
+        }
+    }
+    printf("ShiftAlignedData, ShiftUnalignedData: identical for bit counts [1, %d] and all bit alignments\n",
+           MAX_BIT_COUNT);
+}
+
+/**
+ * Checks #ShiftAlignedSample and #ShiftUnalignedSample for one sample value at one bit alignment.
+ * @param pSample The source of #ShiftAlignedSample: a complete #STORAGE_TYPE.
+ */
+static void TestSample(const STORAGE_TYPE * pSample, int bitAlignment)
+{
+    const int packedSize = STORAGE_IDIVUP(STORAGE_BITSIZE + bitAlignment, 8);
+    uint8_t packed[GUARD_SIZE + 4 + GUARD_SIZE];
+    uint8_t expected[GUARD_SIZE + 4 + GUARD_SIZE];
+
+    Randomize(packed, sizeof(packed));
+    memcpy(expected, packed, sizeof(packed));
+    ShiftAlignedSample(packed + GUARD_SIZE, (const uint8_t *)pSample, bitAlignment);
+    RefShiftAlignedData(expected + GUARD_SIZE, (const uint8_t *)pSample, bitAlignment, STORAGE_BITSIZE);
+    if (memcmp(packed, expected, sizeof(packed)) != 0) {
+        printf("ShiftAlignedSample: bit alignment %d, sample 0x%08X: results differ\n", bitAlignment,
+               (unsigned int)*pSample);
+        abort();
+    }
+
+    /* Read back from the packed data, of which the bits around the sample are random. */
+    STORAGE_TYPE sample;
+    STORAGE_TYPE expectedSample;
+    Randomize((uint8_t *)&sample, sizeof(sample));
+    memcpy(&expectedSample, &sample, sizeof(sample));
+    uint8_t * pFrom = Allocate(packedSize);
+    memcpy(pFrom, packed + GUARD_SIZE, (size_t)packedSize);
+    ShiftUnalignedSample((uint8_t *)&sample, pFrom, bitAlignment);
+    RefShiftUnalignedData((uint8_t *)&expectedSample, pFrom, bitAlignment, STORAGE_BITSIZE);
+    free(pFrom);
+    if (memcmp(&sample, &expectedSample, sizeof(sample)) != 0) {
+        printf("ShiftUnalignedSample: bit alignment %d, sample 0x%08X: results differ\n", bitAlignment,
+               (unsigned int)*pSample);
+        abort();
+    }
+}
+
+static void TestSamples(void)
+{
+    STORAGE_TYPE sample;
+#if STORAGE_BITSIZE <= 16
+    for (uint32_t value = 0; value < (1UL << STORAGE_BITSIZE); value++) {
+        Randomize((uint8_t *)&sample, sizeof(sample)); /* The bits beyond STORAGE_BITSIZE must be ignored. */
+        for (int i = 0; i < STORAGE_IDIVUP(STORAGE_BITSIZE, 8); i++) {
+            ((uint8_t *)&sample)[i] = (uint8_t)(value >> (8 * i));
+        }
+#else
+    for (int n = 0; n < RANDOM_SAMPLE_COUNT; n++) {
+        Randomize((uint8_t *)&sample, sizeof(sample));
+#endif
+        for (int bitAlignment = 0; bitAlignment < 8; bitAlignment++) {
+            TestSample(&sample, bitAlignment);
+        }
+    }
+    printf("ShiftAlignedSample, ShiftUnalignedSample: identical for %s %d-bit samples and all bit alignments\n",
+           (STORAGE_BITSIZE <= 16) ? "all" : "random", STORAGE_BITSIZE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static double Now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+/** @return The time per call, in nanoseconds, cycling through all bit alignments. */
+static double TimeData(void (*pFunction)(uint8_t *, const uint8_t *, const int, const int), int bitCount,
+                       int callCount)
+{
+    static uint8_t to[STORAGE_IDIVUP(BENCH_BLOCK_BIT_COUNT, 8) + 1];
+    static uint8_t from[STORAGE_IDIVUP(BENCH_BLOCK_BIT_COUNT, 8) + 1];
+    Randomize(from, sizeof(from));
+    double start = Now();
+    for (int i = 0; i < callCount; i++) {
+        pFunction(to, from, i & 7, bitCount);
+        from[0] = to[0]; /* Chain the calls. */
+    }
+    double elapsed = Now() - start;
+    sSink += to[0];
+    return elapsed * 1e9 / callCount;
+}
+
+static void AlignedSample(uint8_t * pTo, const uint8_t * pFrom, const int bitAlignment, const int bitCount)
+{
+    (void)bitCount; /* suppress [-Wunused-parameter]: always STORAGE_BITSIZE. */
+    ShiftAlignedSample(pTo, pFrom, bitAlignment);
+}
+
+static void UnalignedSample(uint8_t * pTo, const uint8_t * pFrom, const int bitAlignment, const int bitCount)
+{
+    (void)bitCount; /* suppress [-Wunused-parameter]: always STORAGE_BITSIZE. */
+    ShiftUnalignedSample(pTo, pFrom, bitAlignment);
+}
+
+static void Bench(void)
+{
+    const int blockCallCount = BENCH_CALL_COUNT / STORAGE_IDIVUP(BENCH_BLOCK_BIT_COUNT, 64);
+    printf("\nmicro-benchmark, time per call [ns]\n");
+    printf("%-22s %10s %10s %10s %8s\n", "function", "bits", "reference", "current", "speedup");
+    struct {
+        const char * name;
+        void (*pFunction)(uint8_t *, const uint8_t *, const int, const int);
+        void (*pReference)(uint8_t *, const uint8_t *, const int, const int);
+        int bitCount;
+        int callCount;
+    } cases[] = {
+        {"ShiftAlignedSample", AlignedSample, RefShiftAlignedData, STORAGE_BITSIZE, BENCH_CALL_COUNT},
+        {"ShiftUnalignedSample", UnalignedSample, RefShiftUnalignedData, STORAGE_BITSIZE, BENCH_CALL_COUNT},
+        {"ShiftAlignedData", ShiftAlignedData, RefShiftAlignedData, BENCH_BLOCK_BIT_COUNT, blockCallCount},
+        {"ShiftUnalignedData", ShiftUnalignedData, RefShiftUnalignedData, BENCH_BLOCK_BIT_COUNT, blockCallCount}
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        double reference = TimeData(cases[i].pReference, cases[i].bitCount, cases[i].callCount);
+        double current = TimeData(cases[i].pFunction, cases[i].bitCount, cases[i].callCount);
+        printf("%-22s %10d %10.1f %10.1f %8.2f\n", cases[i].name, cases[i].bitCount, reference, current,
+               reference / current);
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    setvbuf(stdout, NULL, _IOLBF, 0); /* Keep all output when aborting. */
+    printf("STORAGE_BITSIZE %d\n", STORAGE_BITSIZE);
+    TestData();
+    TestSamples();
+    if ((argc > 1) && (strcmp(argv[1], "-b") == 0)) {
+        Bench();
+    }
+    return 0;
+}
@@ -0,0 +1,37 @@
+/*
+ * Copyright 2020 NXP
+ * This software is owned or controlled by NXP and may only be used strictly
+ * in accordance with the applicable license terms.  By expressly accepting
+ * such terms or by downloading, installing, activating and/or otherwise using
+ * the software, you are agreeing that you have read, and that you agree to
+ * comply with and are bound by, such license terms.  If you do not agree to
+ * be bound by the applicable license terms, then you may not retain, install,
+ * activate or otherwise use the software.
+ */
+
+#include "trace.h"
+
+#define SAMPLES_PER_DAY 96
+#define SAMPLES_PER_WEEK (7 * SAMPLES_PER_DAY)
+
+/** A stateless hash, so that the noise of each sample only depends on its sequence number. */
+static uint32_t Hash(uint32_t x)
+{
+    x ^= x >> 16;
+    x *= 0x7FEB352Du;
+    x ^= x >> 15;
+    x *= 0x846CA68Bu;
+    x ^= x >> 16;
+    return x;
+}
+
+int16_t Trace_GetTemperature(int n)
+{
+    int phase = n % SAMPLES_PER_DAY;
+    int triangle = (phase < SAMPLES_PER_DAY / 2) ? phase : SAMPLES_PER_DAY - phase; /* [0, 48] */
+    int daily = (triangle * 80) / (SAMPLES_PER_DAY / 2) - 40;
+    int week = (n / SAMPLES_PER_WEEK) % 8;
+    int drift = (week < 4) ? week * 5 : (8 - week) * 5;
+    int noise = (int)(Hash((uint32_t)n) % 5) - 2;
+    return (int16_t)(50 + daily + drift + noise);
+}
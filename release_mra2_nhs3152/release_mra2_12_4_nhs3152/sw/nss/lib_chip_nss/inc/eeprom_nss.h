@@ -45,6 +45,18 @@
  *      #Chip_EEPROM_DeInit.
  *  .
  *
+ * @par Write-back cache
+ *  Written data is first copied in a cache of #EEPROM_CACHE_ROW_COUNT rows. A row is only committed and flushed - a
+ *  costly erase & program cycle - when its cache slot is needed for another row, or when #Chip_EEPROM_Flush or
+ *  #Chip_EEPROM_DeInit is called. When all slots are in use, the least recently written row is flushed first.
+ *  #Chip_EEPROM_Read always returns the cached data, whether flushed or not. #Chip_EEPROM_Map gives direct access to
+ *  the memory-mapped EEPROM, up to the first cached row.
+ *  @n A cached row whose contents were not changed by the writes - e.g. when rewriting configuration data with the
+ *  same values - is not flushed at all. #Chip_EEPROM_GetSkippedFlushCount reports how many flushes were avoided.
+ *  @n With more than one cached row, rows are no longer flushed in the order in which they were written to. Code that
+ *  relies on that order to recover from a power loss must call #Chip_EEPROM_Flush as a barrier in between.
+ *  #Chip_EEPROM_Flush itself flushes the cached rows in the order in which they were first written to.
+ *
  * @warning EEPROM requires a system clock of 500 kHz or higher. This is not checked for.
  *  For a full list of clock restrictions in effect, see @ref NSS_CLOCK_RESTRICTIONS.
  *
@@ -56,6 +68,36 @@
 
 #include "chip.h"
 
+#ifndef EEPROM_CACHE_ROW_COUNT
+    /**
+     * The number of EEPROM rows the driver caches before data is committed and flushed. Each cached row costs
+     * #EEPROM_ROW_SIZE bytes of RAM. Increase this - in chip_sel.h - when interleaved writes to different rows, e.g. by
+     * different modules, cause too many flushes.
+     */
+    #define EEPROM_CACHE_ROW_COUNT 1
+#endif
+#if (EEPROM_CACHE_ROW_COUNT < 1) || (EEPROM_CACHE_ROW_COUNT > 8)
+    #error EEPROM_CACHE_ROW_COUNT must be in the range [1, 8]
+#endif
+
+#ifndef EEPROM_ASYNC_PROGRAM
+    /**
+     * By default, each erase & program operation of an EEPROM row is waited for by busy looping until it has completed.
+     * Define this - in chip_sel.h - to @c 1 to have the driver start the operation and return immediately instead:
+     * - the driver then implements #EEPROM_IRQHandler to be notified when the operation has completed.
+     * - a read of the row being programmed is served from a copy in RAM.
+     * - any other access to the EEPROM memory - a read of another row, or the start of the next erase & program
+     *  operation - waits for the operation to complete, with the CPU in Sleep mode.
+     * .
+     * This costs an extra #EEPROM_ROW_SIZE bytes of RAM.
+     * @note #Chip_EEPROM_Flush then only waits for the last operation to complete when its argument @c wait is @c true.
+     */
+    #define EEPROM_ASYNC_PROGRAM 0
+#endif
+#if (EEPROM_ASYNC_PROGRAM != 0) && (EEPROM_ASYNC_PROGRAM != 1)
+    #error EEPROM_ASYNC_PROGRAM must be 0 or 1
+#endif
+
 /** NSS EEPROM register block structure */
 typedef struct NSS_EEPROM_S {
     __IO uint32_t CMD; /*!< EEPROM command register */
@@ -119,6 +161,22 @@ void Chip_EEPROM_DeInit(NSS_EEPROM_T *pEEPROM);
  */
 void Chip_EEPROM_Read(NSS_EEPROM_T *pEEPROM, int offset, void *pBuf, int size);
 
+/**
+ * Gives direct read access to the memory-mapped EEPROM, avoiding a copy when reading many small pieces of data.
+ * @param pEEPROM : ignored. Argument no longer used but kept for compatibility.
+ * @param offset : EEPROM Offset, in bytes, of the first byte to access. The offset is relative to #EEPROM_START
+ * @param size : The number of bytes the caller wants to access.
+ * @param [out] ppData : Set to the address of the byte at @c offset in the memory-mapped EEPROM.
+ * @return The number of bytes, starting at @c offset, that can be read directly via @c ppData. This is less than
+ *  @c size when the region overlaps with a cached row that has not been flushed yet: the contents of the cached row
+ *  and beyond must then be read using #Chip_EEPROM_Read.
+ * @note The returned size is only valid until the next call to #Chip_EEPROM_Write, #Chip_EEPROM_Memset,
+ *  #Chip_EEPROM_Flush or #Chip_EEPROM_DeInit.
+ * @pre @c offset an @c size denote a memory region. The caller must ensure this whole region lies inside the
+ *  EEPROM memory. This is not checked for.
+ */
+int Chip_EEPROM_Map(NSS_EEPROM_T *pEEPROM, int offset, int size, const void ** ppData);
+
 /**
  * Writes data from a user allocated buffer into the EEPROM memory
  * @param pEEPROM : ignored. Argument no longer used but kept for compatibility.
@@ -127,9 +185,9 @@ void Chip_EEPROM_Read(NSS_EEPROM_T *pEEPROM, int offset, void *pBuf, int size);
  * @param pBuf : Pointer to the data to be copied into EEPROM. There are no alignment requirements.
  * @param size : Number of bytes to copy
  * @c offset + @c size must not exceed #EEPROM_ROW_SIZE * #EEPROM_NR_OF_RW_ROWS
- * @note This function's timing is non deterministic. Possibly, a pending flush must be executed before data is written;
- *  and when the data to write is spread over multiple EEPROM rows, intermediate flushes are also required.
- * @note The portion written in the last row is not committed an flushed to EEPROM. To be sure written data is
+ * @note This function's timing is non deterministic. Possibly, cached rows must be flushed to make place for the rows
+ *  being written to: see #EEPROM_CACHE_ROW_COUNT.
+ * @note The portions written in the last rows are not committed an flushed to EEPROM. To be sure written data is
  *  effectively retained in the EEPROM memory, user needs to call #Chip_EEPROM_Flush or #Chip_EEPROM_DeInit
  * @pre @c offset an @c size denote a memory region. The caller must ensure this whole region lies inside the
  *  EEPROM memory. This is not checked for.
@@ -146,20 +204,29 @@ void Chip_EEPROM_Write(NSS_EEPROM_T *pEEPROM, int offset, const void *pBuf, int
  * @note The @c offset an @c size denote a memory region. If any part of this region lies outside the EEPROM memory,
  *  nothing is written, and the function call is a void operation.
  *  @c offset + @c size must not exceed #EEPROM_ROW_SIZE * #EEPROM_NR_OF_RW_ROWS
- * @note This function's timing is non deterministic. Possibly, a pending flush must be executed before data is written;
- *  and when the data to write is spread over multiple EEPROM rows, intermediate flushes are also required.
- * @note The portion written in the last row is not committed an flushed to EEPROM. To be sure written data is
+ * @note This function's timing is non deterministic. Possibly, cached rows must be flushed to make place for the rows
+ *  being written to: see #EEPROM_CACHE_ROW_COUNT.
+ * @note The portions written in the last rows are not committed an flushed to EEPROM. To be sure written data is
  *  effectively retained in the EEPROM memory, user needs to call #Chip_EEPROM_Flush or #Chip_EEPROM_DeInit
  */
 void Chip_EEPROM_Memset(NSS_EEPROM_T *pEEPROM, int offset, uint8_t pattern, int size);
 
 /**
- * If needed, this function flushes pending data into the EEPROM. When this function returns, the flush operation has
- * been completed. To be used only if the user wants to make sure written data is retained, for example before going to
- * sleep.
+ * If needed, this function flushes pending data of all cached rows into the EEPROM. When this function returns, the
+ * flush operations have been completed. To be used only if the user wants to make sure written data is retained, for
+ * example before going to sleep.
  * @param pEEPROM : ignored. Argument no longer used but kept for compatibility.
- * @param wait : ignored. Argument no longer used but kept for compatibility.
+ * @param wait : Only used when #EEPROM_ASYNC_PROGRAM is set. When @c false, the function returns as soon as the last
+ *  erase & program operation has started; the data is then only guaranteed to be retained after the next call to
+ *  #Chip_EEPROM_Flush with @c true as argument, or after the next call to #Chip_EEPROM_DeInit.
  */
 void Chip_EEPROM_Flush(NSS_EEPROM_T *pEEPROM, bool wait);
 
+/**
+ * Retrieves how many erase & program operations were skipped, because the data written to a cached row was equal to
+ * what was already stored in EEPROM.
+ * @return The number of skipped operations since the last call to #Chip_EEPROM_Init.
+ */
+int Chip_EEPROM_GetSkippedFlushCount(void);
+
 #endif /** @} */
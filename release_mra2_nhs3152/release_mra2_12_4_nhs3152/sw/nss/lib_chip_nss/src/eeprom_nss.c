@@ -34,37 +34,143 @@
 #define EEPROM_OFFSET_TO_ROW(x) ((x) / EEPROM_ROW_SIZE)
 
 /**
- * The offset in the EEPROM starting from where the contents are cashed, with @c 0 pointing to the start of the EEPROM
- * memory.
+ * Per cache slot, the offset in the EEPROM starting from where the contents are cached, with @c 0 pointing to the start
+ * of the EEPROM memory. A value of @c -1 indicates the slot is not in use.
  * Must always point to the first byte of a row.
  */
 __attribute__((section(".noinit")))
-static int sCachedOffset;
+static int sCachedOffset[EEPROM_CACHE_ROW_COUNT];
 
 /**
- * Buffer to hold the cached data.
+ * Per cache slot, the value of #sCacheClock when the slot was last written to. The slot with the lowest value is the
+ * least recently used one, and is the first to be committed and flushed when a new row must be cached.
+ */
+__attribute__((section(".noinit")))
+static uint32_t sLastUse[EEPROM_CACHE_ROW_COUNT];
+
+/**
+ * Per cache slot, the value of #sCacheClock when the slot was taken in use. #Chip_EEPROM_Flush commits and flushes the
+ * slots in this order, i.e. in the order in which the rows were first written to.
+ */
+__attribute__((section(".noinit")))
+static uint32_t sFirstUse[EEPROM_CACHE_ROW_COUNT];
+
+/**
+ * Per cache slot, whether the cached data differs from what was read from EEPROM when the slot was taken in use. A
+ * slot that is not dirty is freed without an erase & program operation.
+ */
+__attribute__((section(".noinit")))
+static bool sDirty[EEPROM_CACHE_ROW_COUNT];
+
+/** The number of erase & program operations that were skipped because the cached data was unchanged. */
+__attribute__((section(".noinit")))
+static int sSkippedFlushCount;
+
+/** Incremented on each write to a cache slot. Used to order the slots. */
+__attribute__((section(".noinit")))
+static uint32_t sCacheClock;
+
+/**
+ * Buffers to hold the cached data, one row per cache slot.
  */
 __attribute__ ((section(".noinit"))) __attribute__((aligned (2)))
-static uint8_t sCachedData[EEPROM_ROW_SIZE];
+static uint8_t sCachedData[EEPROM_CACHE_ROW_COUNT][EEPROM_ROW_SIZE];
+
+#if EEPROM_ASYNC_PROGRAM
+/**
+ * The offset in the EEPROM of the row that is being programmed, or @c -1 when no erase & program operation is ongoing.
+ * Reset to @c -1 in #CompleteProgram, which is called from #EEPROM_IRQHandler.
+ */
+__attribute__((section(".noinit")))
+static volatile int sInFlightOffset;
+
+/**
+ * A copy of the data of the row that is being programmed. While an erase & program operation is ongoing, reads of that
+ * row are served from this copy.
+ */
+__attribute__((section(".noinit")))
+static uint8_t sInFlightData[EEPROM_ROW_SIZE];
+
+/** The value returned by #Diag_TrackNvmStart when the ongoing erase & program operation was started. */
+__attribute__((section(".noinit")))
+static uint32_t sInFlightStart;
+#endif
 
 /* ------------------------------------------------------------------------- */
 
+#if EEPROM_ASYNC_PROGRAM
 /**
- * Copies the cached data - if any - from #sCachedData to EEPROM, then starts an erase & program operation a.k.a flush.
- * Returns when this is completed.
+ * Ends an erase & program operation: disables and clears the interrupt, and marks the EEPROM as ready.
+ * Called from #EEPROM_IRQHandler, or from #WaitForProgram when interrupts are disabled.
+ */
+static void CompleteProgram(void)
+{
+    NSS_EEPROM->INT_CLR_ENABLE = EEPROM_PROG_DONE_STATUS_BIT;
+    NSS_EEPROM->INT_CLR_STATUS = EEPROM_PROG_DONE_STATUS_BIT;
+    NVIC_ClearPendingIRQ(EEPROM_IRQn);
+    if (sInFlightOffset >= 0) {
+        Diag_TrackNvmEnd(DIAG_NVM_OPERATION_EEPROM_PROGRAM, sInFlightOffset / EEPROM_ROW_SIZE, 1, sInFlightStart);
+    }
+    sInFlightOffset = -1;
+}
+
+/**
+ * Returns when no erase & program operation is ongoing. While waiting, the CPU is put in Sleep mode.
+ * @note Interrupts are disabled while checking, to not miss the wake-up. The EEPROM interrupt still ends the Sleep
+ *  mode, after which the operation is completed here directly. This also makes it safe to call this function while
+ *  the caller has disabled interrupts.
+ */
+static void WaitForProgram(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    while (sInFlightOffset >= 0) {
+        if ((NSS_EEPROM->INT_STATUS & EEPROM_PROG_DONE_STATUS_BIT) != 0) {
+            CompleteProgram();
+        }
+        else {
+            Chip_PMU_PowerMode_EnterSleep();
+        }
+    }
+    if (primask == 0) {
+        __enable_irq();
+    }
+}
+
+void EEPROM_IRQHandler(void)
+{
+    CompleteProgram();
+}
+#endif
+
+/**
+ * Copies the cached data of one cache slot - if in use and dirty - from #sCachedData to EEPROM, then starts an erase &
+ * program operation a.k.a flush. Returns when this is completed - or, when #EEPROM_ASYNC_PROGRAM is set, as soon as it is
+ * started: the cache slot is then free for re-use, while the operation continues in the background.
  * When called redundantly, this function is a void operation.
+ * @param slot The cache slot to commit and flush.
  */
-static void CommitAndFlush(void)
+static void CommitAndFlush(int slot)
 {
-    if (sCachedOffset >= 0) {
+    if ((sCachedOffset[slot] >= 0) && !sDirty[slot]) {
+        sSkippedFlushCount++;
+        sCachedOffset[slot] = -1;
+    }
+    else if (sCachedOffset[slot] >= 0) {
         /* Assumptions of code below */
-        ASSERT(EEPROM_ROW_SIZE == sizeof(sCachedData)); /* The buffer size must be 1 EEPROM row. */
-        ASSERT(((int)sCachedData & 1) == 0); /* The buffer must be 16-bit aligned. */
-        ASSERT(sCachedOffset % EEPROM_ROW_SIZE == 0); /* Exactly 1 EEPROM row must have been cached. */
+        ASSERT(EEPROM_ROW_SIZE == sizeof(sCachedData[slot])); /* The buffer size must be 1 EEPROM row. */
+        ASSERT(((uintptr_t)sCachedData[slot] & 1) == 0); /* The buffer must be 16-bit aligned. */
+        ASSERT(sCachedOffset[slot] % EEPROM_ROW_SIZE == 0); /* Exactly 1 EEPROM row must have been cached. */
+
+#if EEPROM_ASYNC_PROGRAM
+        WaitForProgram(); /* Only one row can be committed at a time. */
+        memcpy(sInFlightData, sCachedData[slot], (uint32_t)sizeof(sInFlightData));
+        sInFlightOffset = sCachedOffset[slot];
+#endif
 
         /* Commit */
-        uint16_t * src = (uint16_t *)sCachedData;
-        uint16_t * dst = (uint16_t *)EEPROM_START + sCachedOffset / 2;
+        uint16_t * src = (uint16_t *)sCachedData[slot];
+        uint16_t * dst = (uint16_t *)EEPROM_START + sCachedOffset[slot] / 2;
         for (int i = 0; i < EEPROM_ROW_SIZE; i += 2) {
             *dst = *src;
             dst++;
@@ -73,22 +179,98 @@ static void CommitAndFlush(void)
 
         /* Flush */
         NSS_EEPROM->INT_CLR_STATUS = EEPROM_PROG_DONE_STATUS_BIT;
+#if EEPROM_ASYNC_PROGRAM
+        sInFlightStart = Diag_TrackNvmStart();
+        NSS_EEPROM->INT_SET_ENABLE = EEPROM_PROG_DONE_STATUS_BIT;
+        NSS_EEPROM->CMD = EEPROM_START_ERASE_PROGRAM;
+#else
+        uint32_t start = Diag_TrackNvmStart();
         NSS_EEPROM->CMD = EEPROM_START_ERASE_PROGRAM;
         while ((NSS_EEPROM->INT_STATUS & EEPROM_PROG_DONE_STATUS_BIT) == 0) {
             ; /* wait */
         }
+        Diag_TrackNvmEnd(DIAG_NVM_OPERATION_EEPROM_PROGRAM, sCachedOffset[slot] / EEPROM_ROW_SIZE, 1, start);
+#endif
+
+        sCachedOffset[slot] = -1;
+    }
+}
+
+/**
+ * Commits and flushes all cache slots in use, in the order in which their rows were first written to.
+ */
+static void CommitAndFlushAll(void)
+{
+    int slot;
+    do {
+        slot = -1;
+        for (int i = 0; i < EEPROM_CACHE_ROW_COUNT; i++) {
+            if ((sCachedOffset[i] >= 0) && ((slot < 0) || ((int32_t)(sFirstUse[i] - sFirstUse[slot]) < 0))) {
+                slot = i;
+            }
+        }
+        if (slot >= 0) {
+            CommitAndFlush(slot);
+        }
+    } while (slot >= 0);
+}
 
-        sCachedOffset = -1;
+/**
+ * Copies the contents of one EEPROM row, as currently stored or being programmed.
+ * @param rowOffset The offset of the first byte of an EEPROM row.
+ * @param pBuf Where to copy the #EEPROM_ROW_SIZE bytes to.
+ */
+static void ReadRow(int rowOffset, uint8_t * pBuf)
+{
+#if EEPROM_ASYNC_PROGRAM
+    if (rowOffset == sInFlightOffset) {
+        memcpy(pBuf, sInFlightData, EEPROM_ROW_SIZE);
+        return;
     }
+    WaitForProgram();
+#endif
+    memcpy(pBuf, (uint8_t *)(EEPROM_START + rowOffset), EEPROM_ROW_SIZE);
+}
+
+/**
+ * Finds the cache slot holding the row starting at @c rowOffset. When not yet cached, a cache slot is taken in use for
+ * it: a free slot when available, else the least recently used slot after committing and flushing it.
+ * @note The row is read before a slot is flushed: when #EEPROM_ASYNC_PROGRAM is set, the caller can then continue
+ *  writing in the cache while that slot is being programmed.
+ * @param rowOffset The offset of the first byte of an EEPROM row.
+ * @return The cache slot that holds the row.
+ */
+static int GetCacheSlot(int rowOffset)
+{
+    int slot = -1;
+    for (int i = 0; i < EEPROM_CACHE_ROW_COUNT; i++) {
+        if (sCachedOffset[i] == rowOffset) {
+            return i;
+        }
+        if ((slot < 0) || (sCachedOffset[i] < 0)
+                || ((sCachedOffset[slot] >= 0) && ((int32_t)(sLastUse[i] - sLastUse[slot]) < 0))) {
+            slot = i;
+        }
+    }
+
+    uint8_t row[EEPROM_ROW_SIZE];
+    ReadRow(rowOffset, row);
+    CommitAndFlush(slot);
+    sCachedOffset[slot] = rowOffset;
+    sDirty[slot] = false;
+    sFirstUse[slot] = sCacheClock;
+    memcpy(sCachedData[slot], row, (uint32_t)sizeof(sCachedData[slot]));
+    return slot;
 }
 
 /**
  * Loops over these actions:
- * - Initialize #sCachedData if necessary
- * - Find the portion of @c pBuf that can be copied to #sCachedData
- * - Copies that portion to #sCachedData
- * - If not all data is copied, commits and flushed #sCachedData to EEPROM memory
+ * - Find - or take in use - the cache slot holding the row of the first byte to write
+ * - Copies the portion of @c pBuf that falls within that row to the cache slot
  * - repeat until all data is copied
+ * .
+ * When a new row must be cached and all cache slots are in use, the least recently used cache slot is committed and
+ * flushed to EEPROM memory first.
  * @param offset See #Chip_EEPROM_Write and #Chip_EEPROM_Memset
  * @param pBuf See #Chip_EEPROM_Write and #Chip_EEPROM_Memset
  * @param size See #Chip_EEPROM_Write and #Chip_EEPROM_Memset
@@ -105,37 +287,29 @@ static void Write(int offset, const void * pBuf, int size, bool singleValue)
 #endif
     /* All bytes must be written to a valid EEPROM region */
     ASSERT(offset >= 0);
-    ASSERT(offset + size < EEPROM_ROW_SIZE * (EEPROM_NR_OF_RW_ROWS + 1));
+    ASSERT(offset + size <= EEPROM_ROW_SIZE * (EEPROM_NR_OF_RW_ROWS + 1));
 
     while (size > 0) {
-        if (sCachedOffset < 0) { /* If nothing is cached */
-            sCachedOffset = (offset / EEPROM_ROW_SIZE) * EEPROM_ROW_SIZE;
-            memcpy(sCachedData, (uint8_t *)(EEPROM_START + sCachedOffset), (uint32_t)sizeof(sCachedData));
+        int rowOffset = (offset / EEPROM_ROW_SIZE) * EEPROM_ROW_SIZE;
+        int slot = GetCacheSlot(rowOffset);
+        int relativeOffset = offset - rowOffset;
+        int partialSize = EEPROM_ROW_SIZE - relativeOffset; /* the maximum value that can be copied */
+        if (size <= partialSize) {
+            partialSize = size;
         }
-        int relativeOffset = offset - sCachedOffset;
-
-        /* Find the overlap with what's already cached.
-         *   EEPROM: eeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeee
-         *   cached:               cccccccc
-         * to write:                              wwwww     --> relativeOffset > sizeof(sCachedData)
-         *      OR:                      wwwww
-         *      OR:                  wwwww
-         *      OR:              wwwww                                        --> relativeOffset < 0
-         *      OR:     wwwww                                                 --> relativeOffset < 0
-         */
-        int partialSize = 0;
-        if ((0 <= relativeOffset) && (relativeOffset < (int)sizeof(sCachedData))) {
-            partialSize = (int)sizeof(sCachedData) - relativeOffset; /* the maximum value that can be copied */
-            if (size <= partialSize) {
-                partialSize = size;
-            }
-            if (singleValue) {
-                memset(sCachedData + relativeOffset, *(uint8_t *)pBuf, (uint32_t)partialSize);
+        if (singleValue) {
+            for (int i = 0; (i < partialSize) && !sDirty[slot]; i++) {
+                sDirty[slot] = (sCachedData[slot][relativeOffset + i] != *(uint8_t *)pBuf);
             }
-            else {
-                memcpy(sCachedData + relativeOffset, pBuf, (uint32_t)partialSize);
+            memset(sCachedData[slot] + relativeOffset, *(uint8_t *)pBuf, (uint32_t)partialSize);
+        }
+        else {
+            if (!sDirty[slot]) {
+                sDirty[slot] = (memcmp(sCachedData[slot] + relativeOffset, pBuf, (uint32_t)partialSize) != 0);
             }
+            memcpy(sCachedData[slot] + relativeOffset, pBuf, (uint32_t)partialSize);
         }
+        sLastUse[slot] = sCacheClock++;
 
         /* Prepare the next iteration. */
         offset += partialSize;
@@ -143,10 +317,6 @@ static void Write(int offset, const void * pBuf, int size, bool singleValue)
             pBuf = (uint8_t *)pBuf + partialSize;
         }
         size -= partialSize;
-        /* commit and flush only if necessary */
-        if (size > 0) {
-            CommitAndFlush();
-        }
     }
 }
 
@@ -156,6 +326,16 @@ void Chip_EEPROM_Init(NSS_EEPROM_T *pEEPROM)
 {
     (void)pEEPROM; /* suppress [-Wunused-parameter]: argument no longer used but kept for compatibility. */
 
+#if EEPROM_ASYNC_PROGRAM
+    /* When initialized again without a call to Chip_EEPROM_DeInit in between - e.g. by the diag module - an erase &
+     * program operation may still be ongoing: the reset below would abort it. The EEPROM interrupt is only enabled in
+     * between both calls, and is disabled after a reset of the CPU. Only then can sInFlightOffset be trusted.
+     */
+    if ((NVIC->ISER[0] & (1u << ((uint32_t)EEPROM_IRQn & 0x1F))) != 0) {
+        WaitForProgram();
+    }
+#endif
+
     Chip_Clock_Peripheral_EnableClock(CLOCK_PERIPHERAL_EEPROM);
     Chip_SysCon_Peripheral_AssertReset(SYSCON_PERIPHERAL_RESET_EEPROM);
     Chip_SysCon_Peripheral_EnablePower(SYSCON_PERIPHERAL_POWER_EEPROM);
@@ -174,13 +354,26 @@ void Chip_EEPROM_Init(NSS_EEPROM_T *pEEPROM)
     }
     NSS_EEPROM->CLKDIV = (uint32_t)div;
 
-    sCachedOffset = -1;
+    for (int i = 0; i < EEPROM_CACHE_ROW_COUNT; i++) {
+        sCachedOffset[i] = -1;
+    }
+    sCacheClock = 0;
+    sSkippedFlushCount = 0;
+#if EEPROM_ASYNC_PROGRAM
+    sInFlightOffset = -1; /* No operation is ongoing after the reset above; sInFlightOffset may be uninitialized. */
+    CompleteProgram();
+    NVIC_EnableIRQ(EEPROM_IRQn);
+#endif
 }
 
 void Chip_EEPROM_DeInit(NSS_EEPROM_T *pEEPROM)
 {
     (void)pEEPROM; /* suppress [-Wunused-parameter]: argument no longer used but kept for compatibility. */
-    CommitAndFlush();
+    CommitAndFlushAll();
+#if EEPROM_ASYNC_PROGRAM
+    WaitForProgram();
+    NVIC_DisableIRQ(EEPROM_IRQn);
+#endif
     Chip_SysCon_Peripheral_AssertReset(SYSCON_PERIPHERAL_RESET_EEPROM);
     Chip_SysCon_Peripheral_DisablePower(SYSCON_PERIPHERAL_POWER_EEPROM);
     Chip_Clock_Peripheral_DisableClock(CLOCK_PERIPHERAL_EEPROM);
@@ -189,8 +382,14 @@ void Chip_EEPROM_DeInit(NSS_EEPROM_T *pEEPROM)
 void Chip_EEPROM_Flush(NSS_EEPROM_T *pEEPROM, bool wait)
 {
     (void)pEEPROM; /* suppress [-Wunused-parameter]: argument no longer used but kept for compatibility. */
-    (void)wait; /* suppress [-Wunused-parameter]: argument no longer used but kept for compatibility. */
-    CommitAndFlush();
+    CommitAndFlushAll();
+#if EEPROM_ASYNC_PROGRAM
+    if (wait) {
+        WaitForProgram();
+    }
+#else
+    (void)wait; /* suppress [-Wunused-parameter]: argument only used when EEPROM_ASYNC_PROGRAM is set. */
+#endif
 }
 
 void Chip_EEPROM_Read(NSS_EEPROM_T *pEEPROM, int offset, void * pBuf, int size)
@@ -202,56 +401,64 @@ void Chip_EEPROM_Read(NSS_EEPROM_T *pEEPROM, int offset, void * pBuf, int size)
     ASSERT(size > 0);
     ASSERT(offset + size <= EEPROM_ROW_SIZE * EEPROM_NR_OF_R_ROWS);
 
+#if EEPROM_ASYNC_PROGRAM
+    int inFlightOffset = sInFlightOffset; /* Read once: the EEPROM interrupt may reset it. */
+    if ((inFlightOffset >= 0) && (inFlightOffset <= offset) && (offset + size <= inFlightOffset + EEPROM_ROW_SIZE)) {
+        /* Fully inside the row being programmed: no need to wait. */
+        memcpy(pBuf, sInFlightData + (offset - inFlightOffset), (uint32_t)size);
+    }
+    else {
+        WaitForProgram();
+        memcpy(pBuf, (uint8_t *)(EEPROM_START + offset), (uint32_t)size);
+    }
+#else
     memcpy(pBuf, (uint8_t *)(EEPROM_START + offset), (uint32_t)size);
+#endif
 
-    if (sCachedOffset >= 0) {
-        /* Check if address ranges overlap */
-        uint8_t * src;
-        uint8_t * dst;
-        if (sCachedOffset < offset) {
-            /*  EEPROM: eeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeee
-             * to read:                              rrrrr
-             *  cached:               cccccccc
-             *      OR:                        cccccccc
-             *      OR:                             cccccccc
-             */
-            src = sCachedData + (offset - sCachedOffset); /* S below */
-            dst = pBuf; /* D below */
+    /* Overwrite the overlapping parts with the data of all cached rows. */
+    for (int i = 0; i < EEPROM_CACHE_ROW_COUNT; i++) {
+        if (sCachedOffset[i] >= 0) {
             /*  EEPROM: eeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeee
-             * to read:                              Drrrr
-             *  cached:               cccccccc       S                                 --> out of bound
-             *      OR:                        ccccccSc
-             *      OR:                             cScccccc
+             * to read:                              rrrrrrrrrr
+             *  cached:                         cccccccc
+             *      OR:                                 cccccccc
+             *      OR:                                        cccccccc
+             * The overlap starts at the highest of both first offsets and ends at the lowest of both end offsets.
              */
-        }
-        else {
-            /*  EEPROM: eeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeee
-             * to read:                              rrrrr
-             *  cached:                              cccccccc
-             *      OR:                                cccccccc
-             *      OR:                                            cccccccc
-             */
-            src = sCachedData; /* S below */
-            dst = (uint8_t *)pBuf + (sCachedOffset - offset); /* D below */
-            /*  EEPROM: eeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeee
-             * to read:                              Drrrr
-             *  cached:                              Sccccccc
-             * to read:                              rrDrr
-             *  cached:                                Sccccccc
-             * to read:                              rrrrr         D                   --> out of bound
-             *  cached:                                            Sccccccc
-             */
-        }
-        if ((src < sCachedData + sizeof(sCachedData)) && (dst < (uint8_t *)pBuf + size)) { /* Excluding out of bounds */
-            int partialSize = (uint8_t *)pBuf + size - dst; /* Limit the size so it fits in the destination */
-            if (partialSize > (int)sizeof(sCachedData)) {
-                partialSize = (int)sizeof(sCachedData); /* Limit the size so it fits in the source */
+            int first = (sCachedOffset[i] < offset) ? offset : sCachedOffset[i];
+            int end = (sCachedOffset[i] + EEPROM_ROW_SIZE < offset + size) ? sCachedOffset[i] + EEPROM_ROW_SIZE
+                                                                             : offset + size;
+            if (first < end) {
+                memcpy((uint8_t *)pBuf + (first - offset), sCachedData[i] + (first - sCachedOffset[i]),
+                       (uint32_t)(end - first));
             }
-            memcpy(dst, src, (uint32_t)partialSize); /* Overwrite with cached data */
         }
     }
 }
 
+int Chip_EEPROM_Map(NSS_EEPROM_T *pEEPROM, int offset, int size, const void ** ppData)
+{
+    (void)pEEPROM; /* suppress [-Wunused-parameter]: argument no longer used but kept for compatibility. */
+
+    /* All bytes must lie in a valid EEPROM region */
+    ASSERT(offset >= 0);
+    ASSERT(size >= 0);
+    ASSERT(offset + size <= EEPROM_ROW_SIZE * EEPROM_NR_OF_R_ROWS);
+
+#if EEPROM_ASYNC_PROGRAM
+    WaitForProgram(); /* The memory core can not be read while an erase & program operation is ongoing. */
+#endif
+    /* Stop at the first cached row: its contents in the memory core may be outdated. */
+    for (int i = 0; i < EEPROM_CACHE_ROW_COUNT; i++) {
+        if ((sCachedOffset[i] >= 0) && (sCachedOffset[i] < offset + size)
+                && (sCachedOffset[i] + EEPROM_ROW_SIZE > offset)) {
+            size = (sCachedOffset[i] > offset) ? sCachedOffset[i] - offset : 0;
+        }
+    }
+    *ppData = (const uint8_t *)(EEPROM_START + offset);
+    return size;
+}
+
 void Chip_EEPROM_Write(NSS_EEPROM_T *pEEPROM, int offset, const void * pBuf, int size)
 {
     (void)pEEPROM; /* suppress [-Wunused-parameter]: argument no longer used but kept for compatibility. */
@@ -263,3 +470,8 @@ void Chip_EEPROM_Memset(NSS_EEPROM_T *pEEPROM, int offset, uint8_t pattern, int
     (void)pEEPROM; /* suppress [-Wunused-parameter]: argument no longer used but kept for compatibility. */
     Write(offset, &pattern, size, true);
 }
+
+int Chip_EEPROM_GetSkippedFlushCount(void)
+{
+    return sSkippedFlushCount;
+}
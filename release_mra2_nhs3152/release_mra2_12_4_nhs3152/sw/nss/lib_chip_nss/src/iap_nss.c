@@ -164,7 +164,12 @@ IAP_STATUS_T Chip_IAP_Flash_EraseSector(uint32_t sectorStart, uint32_t sectorEnd
     cmd[2] = sectorEnd;
     cmd[3] = kHzSysClk;
 
+    uint32_t start = Diag_TrackNvmStart();
     IAP_EXECUTECOMMAND(cmd, status);
+    if (status[0] == IAP_STATUS_CMD_SUCCESS) {
+        Diag_TrackNvmEnd(DIAG_NVM_OPERATION_FLASH_ERASE, (int)(sectorStart * FLASH_PAGES_PER_SECTOR),
+                         (int)((sectorEnd - sectorStart + 1) * FLASH_PAGES_PER_SECTOR), start);
+    }
 
     // Ensure the IAP command is executed
     ASSERT(0xFF != status[0]); // Should never fail except memory corruption like stack overflow.
@@ -183,7 +188,11 @@ IAP_STATUS_T Chip_IAP_Flash_ErasePage(uint32_t pageStart, uint32_t pageEnd, uint
     cmd[2] = pageEnd;
     cmd[3] = kHzSysClk;
 
+    uint32_t start = Diag_TrackNvmStart();
     IAP_EXECUTECOMMAND(cmd, status);
+    if (status[0] == IAP_STATUS_CMD_SUCCESS) {
+        Diag_TrackNvmEnd(DIAG_NVM_OPERATION_FLASH_ERASE, (int)pageStart, (int)(pageEnd - pageStart + 1), start);
+    }
 
     // Ensure the IAP command is executed
     ASSERT(0xFF != status[0]); // Should never fail except memory corruption like stack overflow.
@@ -203,7 +212,12 @@ IAP_STATUS_T Chip_IAP_Flash_Program(const void *pSrc, const void *pFlash, uint32
     cmd[3] = size;
     cmd[4] = kHzSysClk;
 
+    uint32_t start = Diag_TrackNvmStart();
     IAP_EXECUTECOMMAND(cmd, status);
+    if (status[0] == IAP_STATUS_CMD_SUCCESS) {
+        Diag_TrackNvmEnd(DIAG_NVM_OPERATION_FLASH_PROGRAM, (int)(((uintptr_t)pFlash - FLASH_START) / FLASH_PAGE_SIZE),
+                         (int)((size + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE), start);
+    }
 
     // Ensure the IAP command is executed
     ASSERT(0xFF != status[0]); // Should never fail except memory corruption like stack overflow.
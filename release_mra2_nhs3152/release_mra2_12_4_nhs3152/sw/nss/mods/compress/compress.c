@@ -23,22 +23,22 @@ int Compress_Encode(const uint8_t * input, int inputLength, uint8_t * output, in
     heatshrink_encoder_reset(&encoder);
     while (success && (inputLength > 0)) {
         /* Add uncompressed data */
-        int sunk = 0;
-        success &= heatshrink_encoder_sink(&encoder, input, (size_t)inputLength, (size_t *)&sunk) == HSER_SINK_OK;
+        size_t sunk = 0;
+        success &= heatshrink_encoder_sink(&encoder, input, (size_t)inputLength, &sunk) == HSER_SINK_OK;
         input += sunk;
-        inputLength -= sunk;
+        inputLength -= (int)sunk;
         if (inputLength == 0) {
             success &= heatshrink_encoder_finish(&encoder) == HSER_FINISH_MORE;
         }
         /* Retrieve compressed data */
         HSE_poll_res pollResult;
-        int polled;
+        size_t polled;
         do {
             polled = 0;
-            pollResult = heatshrink_encoder_poll(&encoder, output, (size_t)outputLength, (size_t *)&polled);
+            pollResult = heatshrink_encoder_poll(&encoder, output, (size_t)outputLength, &polled);
             output += polled;
-            outputLength -= polled;
-            compressedSize += polled;
+            outputLength -= (int)polled;
+            compressedSize += (int)polled;
         } while ((pollResult == HSER_POLL_MORE) && (polled > 0));
         success &= pollResult == HSER_POLL_EMPTY;
     }
@@ -55,22 +55,22 @@ int Compress_Decode(const uint8_t * input, int inputLength, uint8_t * output, in
     heatshrink_decoder_reset(&decoder);
     while (success && (inputLength > 0)) {
         /* Add compressed data */
-        int sunk = 0;
-        success &= heatshrink_decoder_sink(&decoder, input, (size_t)inputLength, (size_t *)&sunk) == HSDR_SINK_OK;
+        size_t sunk = 0;
+        success &= heatshrink_decoder_sink(&decoder, input, (size_t)inputLength, &sunk) == HSDR_SINK_OK;
         input += sunk;
-        inputLength -= sunk;
+        inputLength -= (int)sunk;
         if (inputLength == 0) {
             success &= heatshrink_decoder_finish(&decoder) == HSDR_FINISH_MORE;
         }
         /* Retrieve uncompressed data */
         HSD_poll_res pollResult;
-        int polled;
+        size_t polled;
         do {
             polled = 0;
-            pollResult = heatshrink_decoder_poll(&decoder, output, (size_t)outputLength, (size_t *)&polled);
+            pollResult = heatshrink_decoder_poll(&decoder, output, (size_t)outputLength, &polled);
             output += polled;
-            outputLength -= polled;
-            uncompressedSize += polled;
+            outputLength -= (int)polled;
+            uncompressedSize += (int)polled;
         } while ((pollResult == HSDR_POLL_MORE) && (polled > 0));
         /* If the decoding fully fills the available buffer, polled equaled outputLength when heatshrink_decoder_poll
          * returned the last but one time; and both polled and outputLength are now 0 after heatshrink_decoder_poll a
@@ -83,3 +83,267 @@ int Compress_Decode(const uint8_t * input, int inputLength, uint8_t * output, in
 
     return success ? uncompressedSize : 0;
 }
+
+/* ------------------------------------------------------------------------- */
+
+/**
+ * Reads a number of bits from a bit stream, packed LSBit first.
+ * @param pData The start of the bit stream.
+ * @param bitCursor The position of the first bit to read.
+ * @param bitCount The number of bits to read. Must be in the range [1, 32].
+ * @return The bits read; all MSBits above @c bitCount are @c 0.
+ */
+static uint32_t ReadBits(const uint8_t * pData, int bitCursor, int bitCount)
+{
+    const int bitAlignment = bitCursor % 8;
+    pData += bitCursor / 8;
+    uint32_t value = (uint32_t)(*pData++ >> bitAlignment);
+    int shift = 8 - bitAlignment;
+    while (shift < bitCount) {
+        value |= (uint32_t)*pData++ << shift;
+        shift += 8;
+    }
+    return (bitCount < 32) ? (value & ((1U << bitCount) - 1)) : value;
+}
+
+/**
+ * Appends a number of bits to a bit stream, packed LSBit first.
+ * @param pData The start of the bit stream.
+ * @param bitCursor The position where to write the first bit. The bits before this position in the same byte are
+ *  not touched.
+ * @param bitCount The number of bits to write. Must be in the range [0, 32].
+ * @param value The bits to write. All MSBits above @c bitCount must be @c 0.
+ * @post The remainder MSBits of the last byte written to are set to @c 0.
+ */
+static void WriteBits(uint8_t * pData, int bitCursor, int bitCount, uint32_t value)
+{
+    if (bitCount > 0) {
+        const int bitAlignment = bitCursor % 8;
+        pData += bitCursor / 8;
+        *pData = (uint8_t)((*pData & ((1U << bitAlignment) - 1)) | (value << bitAlignment));
+        pData++;
+        int shift = 8 - bitAlignment;
+        while (shift < bitCount) {
+            *pData++ = (uint8_t)(value >> shift);
+            shift += 8;
+        }
+    }
+}
+
+/** @return The number of bits required to represent @c value. */
+static int BitWidth(uint32_t value)
+{
+    int width = 0;
+    while (value) {
+        value >>= 1;
+        width++;
+    }
+    return width;
+}
+
+/**
+ * Predicts the next sample, based on the previous two.
+ * @param previous The previous sample.
+ * @param beforePrevious The sample before @c previous.
+ * @return The predicted value. Only the LSBits - as many as a sample has - are meaningful.
+ */
+static inline uint32_t Predict(uint32_t previous, uint32_t beforePrevious)
+{
+#if COMPRESS_DELTA_ORDER == 1
+    (void)beforePrevious; /* suppress [-Wunused-parameter]: a first order prediction only uses the previous sample. */
+    return previous;
+#else
+    return (2 * previous) - beforePrevious;
+#endif
+}
+
+/**
+ * Inserts a number of bits in a bit stream, packed LSBit first, leaving all other bits untouched.
+ * @param pData The start of the bit stream.
+ * @param bitCursor The position where to write the first bit.
+ * @param bitCount The number of bits to write. Must be in the range [1, 32].
+ * @param value The bits to write. All MSBits above @c bitCount must be @c 0.
+ */
+static void InsertBits(uint8_t * pData, int bitCursor, int bitCount, uint32_t value)
+{
+    const int bitAlignment = bitCursor % 8;
+    pData += bitCursor / 8;
+    uint32_t mask = (bitCount < 32) ? ((1U << bitCount) - 1) : 0xFFFFFFFF;
+    *pData = (uint8_t)((*pData & ~(mask << bitAlignment)) | (value << bitAlignment));
+    pData++;
+    int shift = 8 - bitAlignment;
+    while (shift < bitCount) {
+        *pData = (uint8_t)((*pData & ~(mask >> shift)) | (value >> shift));
+        pData++;
+        shift += 8;
+    }
+}
+
+/**
+ * Encodes one column of samples: see #Compress_DeltaEncodeChannels.
+ * @param input The start of the packed records.
+ * @param count The number of records.
+ * @param recordSize The distance in bits between two consecutive samples of this column.
+ * @param inCursor The position of the first sample of this column.
+ * @param bitSize The number of bits of each sample of this column. Must be in the range [1, 32].
+ * @param output The start of the encoded bit stream.
+ * @param pOutCursor Points to the position where to write the first encoded bit. Is updated on return.
+ * @param outputBitCount The size of @c output in bits.
+ * @return @c true when the encoded column fitted in @c output.
+ */
+static bool EncodeColumn(const uint8_t * input, int count, int recordSize, int inCursor, int bitSize, uint8_t * output,
+                         int * pOutCursor, int outputBitCount)
+{
+    uint32_t residues[COMPRESS_DELTA_FRAME_SIZE];
+    const uint32_t mask = (bitSize < 32) ? ((1U << bitSize) - 1) : 0xFFFFFFFF;
+    const int widthSize = BitWidth((uint32_t)bitSize); /* The number of bits required to store a width. */
+    int outCursor = *pOutCursor;
+    bool success = outCursor + bitSize <= outputBitCount;
+
+    if (success) {
+        /* The first sample is stored as-is. It also serves as the initial history for the prediction. */
+        uint32_t previous = ReadBits(input, inCursor, bitSize);
+        uint32_t beforePrevious = previous;
+        WriteBits(output, outCursor, bitSize, previous);
+        inCursor += recordSize;
+        outCursor += bitSize;
+
+        for (int i = 1; success && (i < count); i += COMPRESS_DELTA_FRAME_SIZE) {
+            const int n = ((count - i) < COMPRESS_DELTA_FRAME_SIZE) ? (count - i) : COMPRESS_DELTA_FRAME_SIZE;
+            uint32_t all = 0;
+            for (int k = 0; k < n; k++) {
+                const uint32_t sample = ReadBits(input, inCursor, bitSize);
+                /* The difference wraps around: it always fits in bitSize bits, and is sign-extended from there. */
+                int32_t delta = (int32_t)(((sample - Predict(previous, beforePrevious)) & mask) << (32 - bitSize));
+                delta >>= 32 - bitSize;
+                /* Zig-zag: 0, -1, 1, -2, 2, ... becomes 0, 1, 2, 3, 4, ... */
+                residues[k] = (((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31)) & mask;
+                all |= residues[k];
+                beforePrevious = previous;
+                previous = sample;
+                inCursor += recordSize;
+            }
+
+            const int width = BitWidth(all);
+            success = outCursor + widthSize + (n * width) <= outputBitCount;
+            if (success) {
+                WriteBits(output, outCursor, widthSize, (uint32_t)width);
+                outCursor += widthSize;
+                for (int k = 0; k < n; k++) {
+                    WriteBits(output, outCursor, width, residues[k]);
+                    outCursor += width;
+                }
+            }
+        }
+    }
+    *pOutCursor = outCursor;
+    return success;
+}
+
+/**
+ * Decodes one column of samples: see #Compress_DeltaDecodeChannels.
+ * @param input The start of the encoded bit stream.
+ * @param pInCursor Points to the position of the first encoded bit of this column. Is updated on return.
+ * @param inputBitCount The size of @c input in bits.
+ * @param bitSize The number of bits of each sample of this column. Must be in the range [1, 32].
+ * @param output The start of the packed records.
+ * @param recordSize The distance in bits between two consecutive samples of this column.
+ * @param outCursor The position of the first sample of this column.
+ * @param count The number of records.
+ * @return @c true when the column could be decoded without running out of @c input.
+ * @note Only the bits of this column are written to in @c output.
+ */
+static bool DecodeColumn(const uint8_t * input, int * pInCursor, int inputBitCount, int bitSize, uint8_t * output,
+                         int recordSize, int outCursor, int count)
+{
+    const uint32_t mask = (bitSize < 32) ? ((1U << bitSize) - 1) : 0xFFFFFFFF;
+    const int widthSize = BitWidth((uint32_t)bitSize); /* The number of bits required to store a width. */
+    int inCursor = *pInCursor;
+    bool success = inCursor + bitSize <= inputBitCount;
+
+    if (success) {
+        uint32_t previous = ReadBits(input, inCursor, bitSize);
+        uint32_t beforePrevious = previous;
+        InsertBits(output, outCursor, bitSize, previous);
+        inCursor += bitSize;
+        outCursor += recordSize;
+
+        for (int i = 1; success && (i < count); i += COMPRESS_DELTA_FRAME_SIZE) {
+            const int n = ((count - i) < COMPRESS_DELTA_FRAME_SIZE) ? (count - i) : COMPRESS_DELTA_FRAME_SIZE;
+            int width = 0;
+            success = inCursor + widthSize <= inputBitCount;
+            if (success) {
+                width = (int)ReadBits(input, inCursor, widthSize);
+                inCursor += widthSize;
+                success = (width <= bitSize) && (inCursor + (n * width) <= inputBitCount);
+            }
+            for (int k = 0; success && (k < n); k++) {
+                uint32_t residue = 0;
+                if (width > 0) {
+                    residue = ReadBits(input, inCursor, width);
+                    inCursor += width;
+                }
+                /* Undo the zig-zag encoding, then add the prediction. */
+                const uint32_t delta = (residue >> 1) ^ (0 - (residue & 1));
+                const uint32_t sample = (Predict(previous, beforePrevious) + delta) & mask;
+                InsertBits(output, outCursor, bitSize, sample);
+                outCursor += recordSize;
+                beforePrevious = previous;
+                previous = sample;
+            }
+        }
+    }
+    *pInCursor = inCursor;
+    return success;
+}
+
+int Compress_DeltaEncode(const uint8_t * input, int count, int bitSize, uint8_t * output, int outputLength)
+{
+    return Compress_DeltaEncodeChannels(input, count, &bitSize, 1, output, outputLength);
+}
+
+int Compress_DeltaDecode(const uint8_t * input, int inputBitCount, int bitSize, uint8_t * output, int count)
+{
+    return Compress_DeltaDecodeChannels(input, inputBitCount, &bitSize, 1, output, count);
+}
+
+int Compress_DeltaEncodeChannels(const uint8_t * input, int count, const int * pBitSizes, int channelCount,
+                                 uint8_t * output, int outputLength)
+{
+    bool success = (count > 0) && (channelCount > 0);
+    int recordSize = 0;
+    int outCursor = 0;
+
+    for (int c = 0; success && (c < channelCount); c++) {
+        success = (pBitSizes[c] > 0) && (pBitSizes[c] <= 32);
+        recordSize += pBitSizes[c];
+    }
+    /* Each channel is encoded as a column on its own, one after the other: the prediction then only sees samples of
+     * the same channel.
+     */
+    for (int c = 0, offset = 0; success && (c < channelCount); offset += pBitSizes[c], c++) {
+        success = EncodeColumn(input, count, recordSize, offset, pBitSizes[c], output, &outCursor, outputLength * 8);
+    }
+    return success ? outCursor : 0;
+}
+
+int Compress_DeltaDecodeChannels(const uint8_t * input, int inputBitCount, const int * pBitSizes, int channelCount,
+                                 uint8_t * output, int count)
+{
+    bool success = (count > 0) && (channelCount > 0);
+    int recordSize = 0;
+    int inCursor = 0;
+
+    for (int c = 0; success && (c < channelCount); c++) {
+        success = (pBitSizes[c] > 0) && (pBitSizes[c] <= 32);
+        recordSize += pBitSizes[c];
+    }
+    for (int c = 0, offset = 0; success && (c < channelCount); offset += pBitSizes[c], c++) {
+        success = DecodeColumn(input, &inCursor, inputBitCount, pBitSizes[c], output, recordSize, offset, count);
+    }
+    success &= inCursor == inputBitCount;
+    if (success && ((count * recordSize) % 8)) {
+        output[(count * recordSize) / 8] &= (uint8_t)((1U << ((count * recordSize) % 8)) - 1);
+    }
+    return success ? count * recordSize : 0;
+}
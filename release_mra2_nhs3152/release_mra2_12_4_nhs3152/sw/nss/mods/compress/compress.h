@@ -36,12 +36,17 @@
  *  Check @ref MODS_NSS_COMPRESS_DFT for all diversity parameters.
  *
  * @par Memory Requirements
- *  The memory requirements are defined by the diversity settings. Check #COMPRESS_WINDOW_BITS and #COMPRESS_USE_INDEX.
+ *  The memory requirements are defined by the diversity settings. Check #COMPRESS_WINDOW_BITS, #COMPRESS_USE_INDEX
+ *  and #COMPRESS_DELTA_FRAME_SIZE.
  *
  * @par How to use the module
  *  -# To compress, simply call Compress_Encode. No preparation or initialization is necessary.
  *  -# To uncompress, call Compress_Decod. No preparation or initialization is necessary.
  *  -# Compress_Decode o Compress_Encode is an identity function.
+ *  -# For sensor samples that are packed without padding bits, use Compress_DeltaEncode and Compress_DeltaDecode
+ *      instead: these exploit that consecutive samples differ only little, which Compress_Encode can not detect.
+ *      When each sample holds several measured values, use Compress_DeltaEncodeChannels and
+ *      Compress_DeltaDecodeChannels to predict each value from its own history.
  *  .
  *
  * @par Example
@@ -82,5 +87,80 @@ int Compress_Encode(const uint8_t * input, int inputLength, uint8_t * output, in
  */
 int Compress_Decode(const uint8_t * input, int inputLength, uint8_t * output, int outputLength);
 
+/**
+ * Compresses a contiguous array of samples, each @c bitSize bits wide and packed without padding bits: the first
+ * sample occupies the @c bitSize LSBits of the first byte(s); the next sample starts at the next bit, and so on. This
+ * is the format in which the storage module offers samples for compression, see @c pStorage_CompressCb_t.
+ * Each sample is predicted from the previous sample(s) - see #COMPRESS_DELTA_ORDER - and only the difference is kept,
+ * using zig-zag encoding to map small negative and positive differences to small positive numbers. Per frame of
+ * #COMPRESS_DELTA_FRAME_SIZE samples, these are then packed using as few bits as the largest of them requires.
+ * @param input pointer to the array where all packed samples to encode can be found. No alignment is enforced.
+ * @param count The number of samples to encode, starting from @c input. Must be strict positive.
+ * @param bitSize The number of bits of each sample. Must be in the range [1, 32]. Whether the samples are signed or
+ *  not is of no importance.
+ * @param output pointer to the array where the encoded end result will be written to. No alignment is enforced.
+ * @param outputLength Size in bytes of the available @c output array.
+ * @return Size in @b bits of the used @c output bytes. An output size of @c 0 indicates an error: the @c output buffer
+ *  may or may not have been written to, but none of the bytes may be used for further processing.
+ * @note This is well suited for slowly changing sensor values. It does not look for repeating patterns: use
+ *  #Compress_Encode for that.
+ */
+int Compress_DeltaEncode(const uint8_t * input, int count, int bitSize, uint8_t * output, int outputLength);
+
+/**
+ * Uncompresses an array of samples which was compressed using #Compress_DeltaEncode.
+ * @param input pointer to the array where the encoded bits to uncompress can be found. No alignment is enforced.
+ * @param inputBitCount The number of bits to decode, starting from @c input. This value must be equal to the
+ *  returnvalue of a previous call to #Compress_DeltaEncode.
+ * @param bitSize The number of bits of each sample. This value must be equal to the value used when encoding.
+ * @param output pointer to the array where the decoded samples will be written to, packed without padding bits.
+ *  No alignment is enforced. @code (count * bitSize + 7) / 8 @endcode bytes must be available.
+ * @param count The number of samples to decode. This value must be equal to the value used when encoding.
+ * @return Size in @b bits of the decoded samples: @code count * bitSize @endcode. An output size of @c 0 indicates an
+ *  error: the @c output buffer may or may not have been written to, but none of the bytes may be used for further
+ *  processing.
+ * @note The remainder MSBits of the last byte written to are set to @c 0.
+ */
+int Compress_DeltaDecode(const uint8_t * input, int inputBitCount, int bitSize, uint8_t * output, int count);
+
+/**
+ * Compresses a contiguous array of records, each consisting of @c channelCount samples of different bit sizes and
+ * packed without padding bits: the first record occupies the @code pBitSizes[0] + ... + pBitSizes[channelCount - 1]
+ * @endcode LSBits of the first byte(s), with the sample of channel @c 0 in the LSBits; the next record starts at the
+ * next bit, and so on.
+ * Each channel is encoded as done by #Compress_DeltaEncode, as if the samples of that channel alone were given: the
+ * prediction only uses samples of the same channel, and each channel uses its own widths per frame. This keeps a noisy
+ * channel from inflating the residues of a quiet one.
+ * @param input pointer to the array where all packed records to encode can be found. No alignment is enforced.
+ * @param count The number of records to encode, starting from @c input. Must be strict positive.
+ * @param pBitSizes The number of bits of each sample, per channel. Each must be in the range [1, 32].
+ * @param channelCount The number of samples in each record. Must be strict positive.
+ * @param output pointer to the array where the encoded end result will be written to. No alignment is enforced.
+ * @param outputLength Size in bytes of the available @c output array.
+ * @return Size in @b bits of the used @c output bytes. An output size of @c 0 indicates an error: the @c output buffer
+ *  may or may not have been written to, but none of the bytes may be used for further processing.
+ * @note With @c channelCount equal to @c 1, the result is identical to that of #Compress_DeltaEncode.
+ */
+int Compress_DeltaEncodeChannels(const uint8_t * input, int count, const int * pBitSizes, int channelCount,
+                                 uint8_t * output, int outputLength);
+
+/**
+ * Uncompresses an array of records which was compressed using #Compress_DeltaEncodeChannels.
+ * @param input pointer to the array where the encoded bits to uncompress can be found. No alignment is enforced.
+ * @param inputBitCount The number of bits to decode, starting from @c input. This value must be equal to the
+ *  returnvalue of a previous call to #Compress_DeltaEncodeChannels.
+ * @param pBitSizes The number of bits of each sample, per channel. These must be equal to the values used when
+ *  encoding.
+ * @param channelCount The number of samples in each record. This value must be equal to the value used when encoding.
+ * @param output pointer to the array where the decoded records will be written to, packed without padding bits.
+ *  No alignment is enforced.
+ * @param count The number of records to decode. This value must be equal to the value used when encoding.
+ * @return Size in @b bits of the decoded records. An output size of @c 0 indicates an error: the @c output buffer
+ *  may or may not have been written to, but none of the bytes may be used for further processing.
+ * @note The remainder MSBits of the last byte written to are set to @c 0.
+ */
+int Compress_DeltaDecodeChannels(const uint8_t * input, int inputBitCount, const int * pBitSizes, int channelCount,
+                                 uint8_t * output, int count);
+
 /** @} */
 #endif
@@ -63,6 +63,36 @@
     #define COMPRESS_USE_INDEX 0
 #endif
 
+/**
+ * The order of the prediction used by #Compress_DeltaEncode and #Compress_DeltaDecode:
+ * - @c 1: each sample is predicted to equal the previous one. Best suited for slowly drifting series.
+ * - @c 2: each sample is predicted to continue the slope of the previous two. Best suited for series with long
+ *  stretches of steady rise or fall.
+ * .
+ * @note Data must be decoded using the same setting as was used to encode it.
+ */
+#ifndef COMPRESS_DELTA_ORDER
+    #define COMPRESS_DELTA_ORDER 1
+#endif
+#if (COMPRESS_DELTA_ORDER < 1) || (COMPRESS_DELTA_ORDER > 2)
+    #error COMPRESS_DELTA_ORDER must be 1 or 2
+#endif
+
+/**
+ * The number of samples in a frame, as used by #Compress_DeltaEncode and #Compress_DeltaDecode. All the residues
+ * in a frame are stored using the same number of bits, which is stored in front of the frame.
+ * A smaller frame adapts quicker to a varying signal, but adds more overhead.
+ * - required stack size for compression: 4 bytes per sample in a frame.
+ * .
+ * @note Data must be decoded using the same setting as was used to encode it.
+ */
+#ifndef COMPRESS_DELTA_FRAME_SIZE
+    #define COMPRESS_DELTA_FRAME_SIZE 16
+#endif
+#if (COMPRESS_DELTA_FRAME_SIZE < 1) || (COMPRESS_DELTA_FRAME_SIZE > 256)
+    #error COMPRESS_DELTA_FRAME_SIZE must be in the range [1, 256]
+#endif
+
 /* Dynamic allocation is explicitly disabled for compression. This is non-configurable. */
 #undef HEATSHRINK_DYNAMIC_ALLOC
 
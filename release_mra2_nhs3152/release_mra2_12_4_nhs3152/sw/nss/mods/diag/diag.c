@@ -50,12 +50,77 @@ typedef struct WORKSPACE_S {
      */
     int lastTapTime;
 
+#if DIAG_TRACK_WEAR
+    /**
+     * The number of CT32B0 ticks per millisecond. Initialized in #Diag_Init.
+     * @note Does not require to be stored in EEPROM - doesn't hurt either.
+     */
+    uint32_t ticksPerMs;
+
+    /** The part of the EEPROM busy time, in CT32B0 ticks, not yet accounted for in @c data.eepromBusyTime. */
+    uint32_t eepromBusyTicks;
+
+    /** The part of the FLASH busy time, in CT32B0 ticks, not yet accounted for in @c data.flashBusyTime. */
+    uint32_t flashBusyTicks;
+#endif
+
     DIAG_DATA_T data; /**< Statistics exposed via #Diag_Get */
 } WORKSPACE_T;
+int checkWorkspaceSize[(sizeof(WORKSPACE_T) <= EEPROM_ROW_SIZE) ? 1 : -1]; /* Dummy variable since we can't use sizeof during precompilation. */
 
 __attribute__ ((section(".noinit")))
 static WORKSPACE_T sWorkspace; /**< Copy in SRAM of EEPROM diagnostics data. */
 
+#if DIAG_TRACK_WEAR
+#define DIAG_WEAR_EEPROM_START_OFFSET (EEPROM_ROW_SIZE * DIAG_WEAR_EEPROM_FIRST_ROW)
+#define DIAG_WEAR_EEPROM_SIZE 512
+#define DIAG_WEAR_EEPROM_LAST_ROW (DIAG_WEAR_EEPROM_FIRST_ROW + (DIAG_WEAR_EEPROM_SIZE / EEPROM_ROW_SIZE) - 1)
+#if (DIAG_WEAR_EEPROM_FIRST_ROW < 0) || (DIAG_WEAR_EEPROM_LAST_ROW >= EEPROM_NR_OF_RW_ROWS)
+    #error Invalid value for DIAG_WEAR_EEPROM_FIRST_ROW
+#endif
+
+/* Check the regions of the other modules - as far as they are configured by the application - for overlap. */
+#define DIAG_WEAR_OVERLAPS(first, last) (((first) <= DIAG_WEAR_EEPROM_LAST_ROW) && ((last) >= DIAG_WEAR_EEPROM_FIRST_ROW))
+#if defined(EVENT_EEPROM_FIRST_ROW) && defined(EVENT_EEPROM_LAST_ROW)
+    #if DIAG_WEAR_OVERLAPS(EVENT_EEPROM_FIRST_ROW, EVENT_EEPROM_LAST_ROW)
+        #error DIAG_WEAR_EEPROM_FIRST_ROW: the wear counters overlap with the EEPROM region of the event module
+    #endif
+#endif
+#if defined(STORAGE_EEPROM_FIRST_ROW) && defined(STORAGE_EEPROM_LAST_ROW)
+    #if DIAG_WEAR_OVERLAPS(STORAGE_EEPROM_FIRST_ROW, STORAGE_EEPROM_LAST_ROW)
+        #error DIAG_WEAR_EEPROM_FIRST_ROW: the wear counters overlap with the EEPROM region of the storage module
+    #endif
+#endif
+#if defined(KVSTORE_EEPROM_FIRST_ROW) && defined(KVSTORE_EEPROM_LAST_ROW)
+    #if DIAG_WEAR_OVERLAPS(KVSTORE_EEPROM_FIRST_ROW, KVSTORE_EEPROM_LAST_ROW)
+        #error DIAG_WEAR_EEPROM_FIRST_ROW: the wear counters overlap with the EEPROM region of the kvstore module
+    #endif
+#endif
+#if defined(ROLLUP_EEPROM_FIRST_ROW) && defined(ROLLUP_EEPROM_LAST_ROW)
+    #if DIAG_WEAR_OVERLAPS(ROLLUP_EEPROM_FIRST_ROW, ROLLUP_EEPROM_LAST_ROW)
+        #error DIAG_WEAR_EEPROM_FIRST_ROW: the wear counters overlap with the EEPROM region of the rollup module
+    #endif
+#endif
+
+/** All wear counters stored in EEPROM, starting at #DIAG_WEAR_EEPROM_FIRST_ROW. */
+typedef struct WEAR_S {
+    uint32_t header; /**< Must equal #DIAG_HEADER, or the other fields below are not valid. */
+    uint32_t eepromProgramCount[EEPROM_NR_OF_RW_ROWS]; /**< The number of erase & program operations per EEPROM row. */
+    uint32_t flashProgramCount[FLASH_NR_OF_RW_SECTORS]; /**< The number of pages programmed per FLASH sector. */
+    uint32_t flashEraseCount[FLASH_NR_OF_RW_SECTORS]; /**< The number of pages erased per FLASH sector. */
+} WEAR_T;
+int checkWearSize[(sizeof(WEAR_T) <= DIAG_WEAR_EEPROM_SIZE) ? 1 : -1]; /* Dummy variable since we can't use sizeof during precompilation. */
+
+__attribute__ ((section(".noinit")))
+static WEAR_T sWear; /**< Copy in SRAM of the EEPROM wear counters. */
+
+/**
+ * Set while #Diag_DeInit flushes the diagnostics data. The EEPROM row programs of that flush are already accounted for
+ * by #AccountFinalFlush, and are not to be counted a second time.
+ */
+static bool sFinalFlush;
+#endif
+
 /* ------------------------------------------------------------------------- */
 
 /* NFC IRQ hook. */
@@ -95,6 +160,54 @@ void Diag_NFC_IRQHandler(void)
     }
 }
 
+#if DIAG_TRACK_WEAR
+/**
+ * Checks whether writing data would change the contents of the EEPROM.
+ * @param offset The offset in the EEPROM where the data is to be written to.
+ * @param pData The data to compare with.
+ * @param size The size of @c pData in bytes. Must not exceed #EEPROM_ROW_SIZE.
+ * @return @c true when at least one byte differs.
+ */
+static bool Differs(int offset, const void * pData, int size)
+{
+    uint8_t buf[EEPROM_ROW_SIZE];
+    Chip_EEPROM_Read(NSS_EEPROM, offset, buf, size);
+    return memcmp(buf, pData, (size_t)size) != 0;
+}
+
+/**
+ * Adds the EEPROM row programs of the final flush in #Diag_DeInit to the wear counters, before these are written: that
+ * flush stores the wear counters themselves. Only the rows of which the contents change are programmed. Counting a row
+ * changes the contents of other rows as well, so this is repeated until no more rows need to be counted.
+ * @note The time spent waiting for these programs to complete is not accounted for.
+ */
+static void AccountFinalFlush(void)
+{
+    bool workspaceCounted = false;
+    bool wearCounted[DIAG_WEAR_EEPROM_SIZE / EEPROM_ROW_SIZE] = {false};
+    bool counted;
+    do {
+        counted = false;
+        if (!workspaceCounted && Differs(DIAG_EEPROM_START_OFFSET, &sWorkspace, sizeof(WORKSPACE_T))) {
+            /* The row used by this module to store its own workspace is not tracked individually. */
+            sWorkspace.data.eepromProgramCount++;
+            workspaceCounted = true;
+            counted = true;
+        }
+        for (int i = 0; i * EEPROM_ROW_SIZE < (int)sizeof(WEAR_T); i++) {
+            int offset = i * EEPROM_ROW_SIZE;
+            int size = ((int)sizeof(WEAR_T) - offset < EEPROM_ROW_SIZE) ? (int)sizeof(WEAR_T) - offset : EEPROM_ROW_SIZE;
+            if (!wearCounted[i] && Differs(DIAG_WEAR_EEPROM_START_OFFSET + offset, (uint8_t *)&sWear + offset, size)) {
+                sWorkspace.data.eepromProgramCount++;
+                sWear.eepromProgramCount[DIAG_WEAR_EEPROM_FIRST_ROW + i]++;
+                wearCounted[i] = true;
+                counted = true;
+            }
+        }
+    } while (counted);
+}
+#endif
+
 /* ------------------------------------------------------------------------- */
 
 void Diag_Init(void)
@@ -111,6 +224,22 @@ void Diag_Init(void)
         memset(&sWorkspace, 0, sizeof(WORKSPACE_T));
         sWorkspace.header = DIAG_HEADER;
     }
+#if DIAG_TRACK_WEAR
+    Chip_EEPROM_Read(NSS_EEPROM, DIAG_WEAR_EEPROM_START_OFFSET, &sWear, sizeof(WEAR_T));
+    if (sWear.header != DIAG_HEADER) {
+        memset(&sWear, 0, sizeof(WEAR_T));
+        sWear.header = DIAG_HEADER;
+    }
+
+    /* Let CT32B0 count system clock cycles. The prescaler is left at 0: this keeps the resolution when running at the
+     * lowest system clock frequencies.
+     */
+    sWorkspace.ticksPerMs = (uint32_t)Chip_Clock_System_GetClockFreq() / 1000;
+    Chip_TIMER32_0_Init();
+    Chip_TIMER_Reset(NSS_TIMER32_0);
+    Chip_TIMER_PrescaleSet(NSS_TIMER32_0, 0);
+    Chip_TIMER_Enable(NSS_TIMER32_0);
+#endif
 
     int now = Chip_RTC_Time_GetValue(NSS_RTC);
     int diff = now - sWorkspace.lastStoredRtc;
@@ -134,9 +263,23 @@ void Diag_DeInit(void)
         sWorkspace.lastStoredRtc = now;
 
         Chip_EEPROM_Init(NSS_EEPROM); /* Ensure EEPROM is available. */
+#if DIAG_TRACK_WEAR
+        AccountFinalFlush();
+        sFinalFlush = true;
+#endif
         Chip_EEPROM_Write(NSS_EEPROM, DIAG_EEPROM_START_OFFSET, &sWorkspace, sizeof(WORKSPACE_T));
+#if DIAG_TRACK_WEAR
+        Chip_EEPROM_Write(NSS_EEPROM, DIAG_WEAR_EEPROM_START_OFFSET, &sWear, sizeof(WEAR_T));
+#endif
         Chip_EEPROM_Flush(NSS_EEPROM, true);
+#if DIAG_TRACK_WEAR
+        sFinalFlush = false;
+#endif
     }
+#if DIAG_TRACK_WEAR
+    Chip_TIMER_Disable(NSS_TIMER32_0);
+    Chip_TIMER32_0_DeInit();
+#endif
 }
 
 void Diag_TrackRtcUpdate(int new)
@@ -151,4 +294,84 @@ const DIAG_DATA_T * Diag_Get(void)
     return &sWorkspace.data;
 }
 
+#if DIAG_TRACK_WEAR
+/**
+ * Adds a duration to a busy time.
+ * @param pTime The busy time in milliseconds to update.
+ * @param pTicks The part of the busy time not yet accounted for in @c pTime, in CT32B0 ticks.
+ * @param ticks The duration in CT32B0 ticks to add.
+ */
+static void AddBusyTime(uint32_t * pTime, uint32_t * pTicks, uint32_t ticks)
+{
+    *pTicks += ticks;
+    if (sWorkspace.ticksPerMs > 0) {
+        *pTime += *pTicks / sWorkspace.ticksPerMs;
+        *pTicks %= sWorkspace.ticksPerMs;
+    }
+}
+
+uint32_t Diag_TrackNvmStart(void)
+{
+    return Chip_TIMER_ReadCount(NSS_TIMER32_0);
+}
+
+void Diag_TrackNvmEnd(DIAG_NVM_OPERATION_T operation, int first, int count, uint32_t start)
+{
+    if (sFinalFlush) {
+        return; /* Already accounted for in AccountFinalFlush. */
+    }
+    uint32_t ticks = Chip_TIMER_ReadCount(NSS_TIMER32_0) - start;
+
+    /* Both the EEPROM interrupt handler and the application may report an operation. */
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (operation == DIAG_NVM_OPERATION_EEPROM_PROGRAM) {
+        sWorkspace.data.eepromProgramCount += (uint32_t)count;
+        AddBusyTime(&sWorkspace.data.eepromBusyTime, &sWorkspace.eepromBusyTicks, ticks);
+        for (int row = first; row < first + count; row++) {
+            /* The row used by this module to store its own workspace is not tracked individually. */
+            if ((row >= 0) && (row < EEPROM_NR_OF_RW_ROWS)) {
+                sWear.eepromProgramCount[row]++;
+            }
+        }
+    }
+    else {
+        uint32_t * pCounts;
+        if (operation == DIAG_NVM_OPERATION_FLASH_PROGRAM) {
+            sWorkspace.data.flashProgramCount += (uint32_t)count;
+            pCounts = sWear.flashProgramCount;
+        }
+        else {
+            sWorkspace.data.flashEraseCount += (uint32_t)count;
+            pCounts = sWear.flashEraseCount;
+        }
+        AddBusyTime(&sWorkspace.data.flashBusyTime, &sWorkspace.flashBusyTicks, ticks);
+        for (int page = first; page < first + count; page++) {
+            int sector = page / FLASH_PAGES_PER_SECTOR;
+            if ((sector >= 0) && (sector < FLASH_NR_OF_RW_SECTORS)) {
+                pCounts[sector]++;
+            }
+        }
+    }
+    if (primask == 0) {
+        __enable_irq();
+    }
+}
+
+uint32_t Diag_GetWearCount(DIAG_NVM_OPERATION_T operation, int index)
+{
+    uint32_t count = 0;
+    if (operation == DIAG_NVM_OPERATION_EEPROM_PROGRAM) {
+        if ((index >= 0) && (index < EEPROM_NR_OF_RW_ROWS)) {
+            count = sWear.eepromProgramCount[index];
+        }
+    }
+    else if ((index >= 0) && (index < FLASH_NR_OF_RW_SECTORS)) {
+        count = (operation == DIAG_NVM_OPERATION_FLASH_PROGRAM) ? sWear.flashProgramCount[index]
+                                                                 : sWear.flashEraseCount[index];
+    }
+    return count;
+}
+#endif
+
 #endif
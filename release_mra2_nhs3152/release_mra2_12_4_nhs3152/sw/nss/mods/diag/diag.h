@@ -27,6 +27,7 @@
  *  - Active time
  *  - Number of NFC taps
  *  .
+ * Optionally, the wear of the non-volatile memories is tracked as well.
  *
  * @par Number of cold boots
  *  The number of times a cold boot was detected is counted. A cold boot is generated when leaving the Power-off mode,
@@ -65,8 +66,24 @@
  *      NFC field detections are only counted when the RTC up counter value has changed.
  *  .
  *
+ * @par Wear of the non-volatile memories
+ *  When #DIAG_TRACK_WEAR is set, the EEPROM driver and the IAP driver report each EEPROM row program, FLASH page
+ *  program and FLASH page erase they perform.
+ *  - Totals and the accumulated busy time are added to the statistics returned by #Diag_Get, and thus also to the
+ *      response of @c MSG_ID_GETDIAGDATA.
+ *  - The count per EEPROM row and per FLASH sector is available via #Diag_GetWearCount. These counters are stored in
+ *      EEPROM starting at #DIAG_WEAR_EEPROM_FIRST_ROW, which also allows a tag reader to fetch them using
+ *      @c MSG_ID_READMEMORY.
+ *  - The busy time is the time spent from the start of an operation until its completion, in milliseconds. It is
+ *      measured using CT32B0, which counts system clock cycles while the IC is not in Deep power down or Power-off
+ *      mode.
+ *      Changing the system clock frequency after #Diag_Init renders the measurement inaccurate.
+ *  .
+ *  All FLASH programs and erases performed via the IAP driver are tracked, including those done by the storage module.
+ *  Operations done by the boot loader or over SWD are not.
+ *
  * @par Diversity
- *  This module supports a single diversity #ENABLE_DIAG_MODULE.
+ *  This module supports the diversity settings #ENABLE_DIAG_MODULE, #DIAG_TRACK_WEAR and #DIAG_WEAR_EEPROM_FIRST_ROW.
  *  See @ref MODS_NSS_DIAG_DFT.
  *
  * @par Implementation
@@ -107,9 +124,23 @@ typedef struct DIAG_DATA_S {
     int32_t activeTime; /**< Accumulated Active, Sleep and Deep Sleep time in seconds. */
     int32_t deepPowerDownTime; /**< Accumulated Deep power down time in seconds. */
     uint32_t nfcTapCount; /**< Total number of NFC select states. */
+#if DIAG_TRACK_WEAR
+    uint32_t eepromProgramCount; /**< Total number of EEPROM row erase & program operations. */
+    uint32_t flashProgramCount; /**< Total number of FLASH pages programmed. */
+    uint32_t flashEraseCount; /**< Total number of FLASH pages erased. */
+    uint32_t eepromBusyTime; /**< Accumulated time in milliseconds spent in EEPROM erase & program operations. */
+    uint32_t flashBusyTime; /**< Accumulated time in milliseconds spent in FLASH program and erase operations. */
+#endif
 } DIAG_DATA_T;
 #pragma pack(pop)
 
+/** The non-volatile memory operations tracked when #DIAG_TRACK_WEAR is set. */
+typedef enum DIAG_NVM_OPERATION {
+    DIAG_NVM_OPERATION_EEPROM_PROGRAM, /**< An erase & program operation of one EEPROM row. */
+    DIAG_NVM_OPERATION_FLASH_PROGRAM, /**< A program operation of one or more consecutive FLASH pages. */
+    DIAG_NVM_OPERATION_FLASH_ERASE /**< An erase operation of one or more consecutive FLASH pages. */
+} DIAG_NVM_OPERATION_T;
+
 /* ------------------------------------------------------------------------- */
 
 #if ENABLE_DIAG_MODULE
@@ -150,6 +181,32 @@ void Diag_TrackRtcUpdate(int new);
 /** @return a pointer to the latest statistics in SRAM. */
 const DIAG_DATA_T* Diag_Get(void);
 
+#if DIAG_TRACK_WEAR
+/**
+ * Must be called by the EEPROM and IAP drivers just before starting an operation on a non-volatile memory.
+ * @return A timestamp to be passed to #Diag_TrackNvmEnd.
+ */
+uint32_t Diag_TrackNvmStart(void);
+
+/**
+ * Must be called by the EEPROM and IAP drivers when an operation on a non-volatile memory has completed.
+ * @param operation The operation that was performed.
+ * @param first The first EEPROM row or FLASH page operated upon.
+ * @param count The number of EEPROM rows or FLASH pages operated upon.
+ * @param start The value returned by #Diag_TrackNvmStart when the operation was started.
+ */
+void Diag_TrackNvmEnd(DIAG_NVM_OPERATION_T operation, int first, int count, uint32_t start);
+
+/**
+ * Retrieves the wear of one EEPROM row or one FLASH sector.
+ * @param operation Determines which counter to retrieve.
+ * @param index The EEPROM row when @c operation equals #DIAG_NVM_OPERATION_EEPROM_PROGRAM, the FLASH sector otherwise.
+ * @return The total number of times the EEPROM row was programmed, or the total number of pages in the FLASH sector
+ *  that were programmed or erased.
+ */
+uint32_t Diag_GetWearCount(DIAG_NVM_OPERATION_T operation, int index);
+#endif
+
 /* ------------------------------------------------------------------------- */
 
 /**
@@ -167,5 +224,10 @@ void Diag_NFC_IRQHandler(void);
     #define Diag_Get(x) NULL
     #define Diag_NFC_IRQHandler NFC_IRQHandler
 #endif
+#if !ENABLE_DIAG_MODULE || !DIAG_TRACK_WEAR
+    #define Diag_TrackNvmStart(x) 0
+    #define Diag_TrackNvmEnd(operation, first, count, start) (void)(start)
+    #define Diag_GetWearCount(operation, index) 0
+#endif
 
 #endif /** @} */
@@ -29,4 +29,29 @@
     #define ENABLE_DIAG_MODULE 1
 #endif
 
+/**
+ * Set to a non-zero value to also track the wear of the non-volatile memories: the number of EEPROM row programs, FLASH
+ * page programs and FLASH page erases - in total and per EEPROM row and FLASH sector - and the time spent waiting for
+ * these operations to complete.
+ * @note When enabled, the 32-bit timer CT32B0 is claimed by the diag module while the IC is not in Deep power down or
+ *  Power-off mode: the application may not use it.
+ * @see DIAG_WEAR_EEPROM_FIRST_ROW
+ */
+#ifndef DIAG_TRACK_WEAR
+    #define DIAG_TRACK_WEAR 0
+#endif
+
+/**
+ * The first EEPROM row of the region where the per row and per sector wear counters are stored when #DIAG_TRACK_WEAR
+ * is set. The region spans 512 bytes and must lie outside the EEPROM regions used by the application and by other
+ * modules.
+ * @note By default, the 512 bytes just below the default EEPROM region of the event module will be chosen.
+ * @note The regions of the event, storage, kvstore and rollup modules are checked for overlap at compile time, as far as
+ *  both their first and last row are defined by the application. E.g. the temperature logger demo application uses all
+ *  EEPROM rows: enabling #DIAG_TRACK_WEAR there requires shrinking one of its regions first.
+ */
+#ifndef DIAG_WEAR_EEPROM_FIRST_ROW
+    #define DIAG_WEAR_EEPROM_FIRST_ROW (512 / EEPROM_ROW_SIZE)
+#endif
+
 #endif /** @} */
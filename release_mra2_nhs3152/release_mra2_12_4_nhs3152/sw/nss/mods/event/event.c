@@ -9,6 +9,8 @@
  * activate or otherwise use the software.
  */
 
+#include <limits.h>
+#include <string.h>
 #include "chip.h"
 #include "event.h"
 
@@ -22,11 +24,40 @@
  *          event must be stored: a value of @c 0x0000 indicates no events are stored. See also #sMeta.nextFreeOffset.
  *      - The 4 bytes before that are used to store the full timestamp when #Event_Init was first called.
  *          All other timestamps are delta values. See also #sBaseTimestamp.
+ *      - When #EVENT_TAG_INDEX_COUNT is set, the meta information also holds a #TAG_ENTRY_T instance per indexed tag.
+ *      - When #EVENT_CHECKPOINT_INTERVAL is set, an array of #CHECKPOINT_T instances is stored just before the meta
+ *          information. Events are stored up to the start of that array.
+ *      - When #EVENT_CIRCULAR is set, the events are stored in a ring buffer. An event is never split: when it does
+ *          not fit in the remaining space, #META_T.wrapOffset marks the end of the stored events and the event is
+ *          stored at the start of the region instead, after dropping as many of the oldest events as needed.
+ *          #META_T.firstOffset then points to the oldest event. #META_T.baseTimestamp is advanced with the delta time
+ *          of each dropped event, keeping the timestamps of the remaining events unchanged.
+ *      - When #EVENT_ARCHIVE_FLASH_FIRST_PAGE is set, the events are stored in the same ring buffer. Instead of being
+ *          dropped, the oldest events are first copied - possibly compressed - to a new block in FLASH: see
+ *          #ArchiveOldestEvents. This is done in #Event_Service, ahead of time: #Event_Set only does so itself when
+ *          the region is full. Each block starts at a page boundary with an #ARCHIVE_HEADER_T instance; the blocks
+ *          are stored one after the other, the oldest first. #META_T.archivePageCount tells how many pages are in use.
+ *          A block programmed in FLASH without a corresponding update of the meta information in EEPROM - due to a
+ *          power loss before #Event_DeInit - lies beyond these pages: it is ignored, and erased when overwritten.
  *
  *  @par Searching events
  *      Events can only be searched by traversing them in sequence, from the oldest event to the newest event.
  *      The size of one event equals the size of the structure #EVENT_T plus #EVENT_T.len. Searching stops when the
- *      iterator reaches the value of #sMeta.nextFreeOffset.
+ *      iterator reaches the value of #sMeta.nextFreeOffset. When the events are stored in a ring buffer, the iterator
+ *      continues at the start of the region when it reaches #META_T.wrapOffset.
+ *      The events are decoded using a #CURSOR_T instance, directly from the memory-mapped EEPROM. Only events stored in
+ *      a row that is still cached by the EEPROM driver are read using #Chip_EEPROM_Read.
+ *      The first and the last event of the tags indexed in #META_T.tags are found without searching. Because all
+ *      timestamps but the first are delta values, the table stores the full timestamp - as it would be calculated when
+ *      traversing - of both events.
+ *      Every #EVENT_CHECKPOINT_INTERVAL th event is referenced by a #CHECKPOINT_T instance: the traversal can start
+ *      there instead. The first event is never referenced: the traversal starts there by default. Because the
+ *      timestamps never decrease, the checkpoints are sorted by time as well as by index.
+ *      The events moved to FLASH are traversed first, using an #ITERATOR_T instance: per block, the events are
+ *      decompressed in #sArchiveBuffer - unless stored uncompressed - and decoded using a #CURSOR_T instance as well.
+ *      The block headers act as checkpoints.
+ *      The traversal then continues seamlessly in EEPROM: #META_T.baseTimestamp and #META_T.firstIndex equal the full
+ *      timestamp and the sequential number of the last archived event, plus one for the latter.
  */
 
 /**
@@ -45,6 +76,94 @@
  */
 #define EEPROM_META_OFFSET (EEPROM_ABSOLUTE_LAST_BYTE_OFFSET + 1 - sizeof(META_T))
 
+#if EVENT_CHECKPOINT_INTERVAL
+/**
+ * The number of checkpoints that can be stored. Checkpoint @c n - starting from @c 1 - references the event with index
+ * @c n * #EVENT_CHECKPOINT_INTERVAL. When the events are stored in a ring buffer, the checkpoints are as well:
+ * the extra checkpoint ensures the checkpoints of all stored events fit.
+ */
+#define CHECKPOINT_COUNT ((EVENT_EEPROM_SIZE / EVENT_OVERHEAD / EVENT_CHECKPOINT_INTERVAL) + 1)
+
+/**
+ * The absolute offset to where the checkpoints are stored. The location is written in #Event_Set, each time an event
+ * is stored that must be referenced by a checkpoint.
+ */
+#define EEPROM_CHECKPOINT_OFFSET (EEPROM_META_OFFSET - CHECKPOINT_COUNT * sizeof(CHECKPOINT_T))
+
+/** The absolute offset to where checkpoint @c n is stored. */
+#define CHECKPOINT_OFFSET(n) ((int)(EEPROM_CHECKPOINT_OFFSET + (((n) - 1U) % CHECKPOINT_COUNT) * sizeof(CHECKPOINT_T)))
+
+/** The absolute offset to the first byte following the space available for events. */
+#define EEPROM_EVENTS_END_OFFSET EEPROM_CHECKPOINT_OFFSET
+#else
+#define EEPROM_EVENTS_END_OFFSET EEPROM_META_OFFSET
+#endif
+
+/** The number of bytes available for events. */
+#define EVENTS_SIZE ((int)(EEPROM_EVENTS_END_OFFSET - EEPROM_ABSOLUTE_FIRST_BYTE_OFFSET))
+
+/**
+ * Whether the events are stored in a ring buffer. This is the case when the oldest events are dropped - see
+ * #EVENT_CIRCULAR - or moved to FLASH - see #EVENT_ARCHIVE_FLASH_FIRST_PAGE - to make room for new events.
+ */
+#define RING_BUFFER (EVENT_CIRCULAR || EVENT_ARCHIVE_FLASH_FIRST_PAGE)
+
+#if RING_BUFFER
+    #define FIRST_EVENT_OFFSET ((int)sMeta.firstOffset)
+    #define FIRST_EVENT_INDEX sMeta.firstIndex
+#else
+    /** The absolute offset to the oldest event. */
+    #define FIRST_EVENT_OFFSET EEPROM_ABSOLUTE_FIRST_BYTE_OFFSET
+    /** The sequential number of the oldest event. */
+    #define FIRST_EVENT_INDEX 0U
+#endif
+
+/**
+ * Restores the full sequential number of a stored event from its 16 least significant bits. This is possible as
+ * less than @c 0x10000 events are stored at any time.
+ */
+#define RESTORE_INDEX(index16) (FIRST_EVENT_INDEX + (uint16_t)((index16) - (uint16_t)FIRST_EVENT_INDEX))
+
+#if EVENT_ARCHIVE_FLASH_FIRST_PAGE
+/** The number of FLASH pages assigned for archiving events. */
+#define ARCHIVE_PAGE_COUNT (EVENT_ARCHIVE_FLASH_LAST_PAGE + 1 - EVENT_ARCHIVE_FLASH_FIRST_PAGE)
+
+/** The address of a FLASH page assigned for archiving events, given its number relative to the first one. */
+#define ARCHIVE_PAGE_TO_ADDRESS(page) \
+    ((const uint8_t *)(FLASH_START + ((EVENT_ARCHIVE_FLASH_FIRST_PAGE + (page)) * FLASH_PAGE_SIZE)))
+
+/** The number of FLASH pages occupied by an archive block holding @c size bytes of (compressed) events. */
+#define ARCHIVE_BLOCK_PAGES(size) \
+    ((int)((sizeof(ARCHIVE_HEADER_T) + (size_t)(size) + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE))
+
+/** The number of bytes needed to hold the largest archive block: whole FLASH pages. */
+#define ARCHIVE_BLOCK_BUFFER_SIZE (ARCHIVE_BLOCK_PAGES(EVENT_ARCHIVE_BLOCK_SIZE) * FLASH_PAGE_SIZE)
+
+/** The offset in #sArchiveBuffer where #ArchiveOldestEvents gathers the events to archive. */
+#define ARCHIVE_RAW_OFFSET ARCHIVE_BLOCK_BUFFER_SIZE
+
+/**
+ * #Event_Service moves events to FLASH until this many bytes are free in EEPROM. Then #Event_Set can always store
+ * a new event without moving events itself: even when the new event does not fit at the end of the region, which then
+ * remains unused, #EVENT_ARCHIVE_BLOCK_SIZE bytes are still free at the start of the region.
+ */
+#define ARCHIVE_FREE_SIZE (2 * EVENT_ARCHIVE_BLOCK_SIZE)
+
+/**
+ * Set in #TAG_ENTRY_T.firstOffset or #TAG_ENTRY_T.lastOffset when the referenced event is moved to FLASH. The 8 LSBits
+ * then hold #EVENT_T.len of that event.
+ */
+#define TAG_ARCHIVED 0x8000
+
+/**
+ * Restores the full sequential number of the first or last event with an indexed tag. The sequential number of an
+ * archived event is always below @c 0x10000.
+ */
+#define RESTORE_TAG_INDEX(offset, index16) (((offset) & TAG_ARCHIVED) ? (index16) : RESTORE_INDEX(index16))
+#else
+#define RESTORE_TAG_INDEX(offset, index16) RESTORE_INDEX(index16)
+#endif
+
 #if (EVENT_OVERHEAD_CHOICE == EVENT_OVERHEAD_CHOICE_C) | (EVENT_OVERHEAD_CHOICE == EVENT_OVERHEAD_CHOICE_D)
     #define REDUCE_TIMESTAMP(full) ((full) / 64U)
     #define RESTORE_TIMESTAMP(reduced) ((reduced) * 64U)
@@ -68,12 +187,66 @@
 
 #pragma pack(push, 1)
 
+#if EVENT_TAG_INDEX_COUNT
+/** Keeps track of the first and the last event stored with a specific tag. */
+typedef struct TAG_ENTRY_S {
+    /**
+     * The absolute offset to the first event with this tag, or @c 0xFFFF if there is none. When
+     * #EVENT_ARCHIVE_FLASH_FIRST_PAGE is set, #TAG_ARCHIVED is set instead when the event was moved to FLASH.
+     */
+    uint16_t firstOffset;
+    uint16_t lastOffset; /**< The absolute offset to the last event with this tag, or #TAG_ARCHIVED as above. */
+    uint16_t firstIndex; /**< The 16 LSBits of the sequential number of the first event with this tag. */
+    uint16_t lastIndex; /**< The 16 LSBits of the sequential number of the last event with this tag. */
+    uint32_t firstTimestamp; /**< Time in seconds. The timestamp of the first event with this tag. */
+    uint32_t lastTimestamp; /**< Time in seconds. The timestamp of the last event with this tag. */
+} TAG_ENTRY_T;
+#endif
+
+#if EVENT_CHECKPOINT_INTERVAL
+/** References an event from where the traversal of the events can start. */
+typedef struct CHECKPOINT_S {
+    uint16_t offset; /**< The absolute offset to the referenced event. */
+    /**
+     * Time in seconds. The full timestamp of the event stored just before the referenced event, as it would be
+     * calculated when traversing.
+     */
+    uint32_t previousTimestamp;
+} CHECKPOINT_T;
+#endif
+
 /** Data stored at the end of the assigned EEPROM memory. Required for proper working of the event module. */
 typedef struct META_S {
-    uint32_t baseTimestamp; /**< Time in seconds. The full timestamp when #Event_Init was first called. */
+    /**
+     * Time in seconds. The full timestamp when #Event_Init was first called. When the events are stored in a ring
+     * buffer, this is advanced with the delta time of each dropped - or archived - event.
+     */
+    uint32_t baseTimestamp;
     uint32_t lastTimestamp; /**< Time in seconds. The full timestamp when #Event_Set was last called. */
     uint16_t lastTimeError; /**< Delta time in seconds. The error made when storing the delta time in #EVENT_T.timestamp. */
     uint16_t nextFreeOffset; /**< The absolute offset to where the next event must be stored. */
+#if EVENT_TAG_INDEX_COUNT || EVENT_CHECKPOINT_INTERVAL
+    uint16_t count; /**< The number of events stored. */
+#endif
+#if RING_BUFFER
+    uint16_t firstOffset; /**< The absolute offset to the oldest event. */
+    /**
+     * The absolute offset to the first byte following the event stored last before wrapping, or @c 0 if the stored
+     * events did not wrap.
+     */
+    uint16_t wrapOffset;
+    /**
+     * The sequential number of the oldest event in EEPROM: the number of events dropped - or moved to FLASH - to make
+     * room for newer events.
+     */
+    uint32_t firstIndex;
+#endif
+#if EVENT_ARCHIVE_FLASH_FIRST_PAGE
+    uint16_t archivePageCount; /**< The number of FLASH pages occupied by the archive blocks. */
+#endif
+#if EVENT_TAG_INDEX_COUNT
+    TAG_ENTRY_T tags[EVENT_TAG_INDEX_COUNT]; /**< The first and last event of each indexed tag. */
+#endif
 } META_T;
 
 /** Data stored for each event. */
@@ -107,8 +280,66 @@ typedef struct EVENT_S { /* ANY change must be reflected in EVENT_OVERHEAD. */
 #endif
 } EVENT_T;
 
+#if EVENT_ARCHIVE_FLASH_FIRST_PAGE
+/** Stored in FLASH in front of each block of archived events. */
+typedef struct ARCHIVE_HEADER_S {
+    /**
+     * Time in seconds. The full timestamp of the event archived just before the first event in this block, as it would
+     * be calculated when traversing.
+     */
+    uint32_t previousTimestamp;
+    uint16_t size; /**< The number of bytes of (compressed) events following this header. */
+    /**
+     * The number of bytes of the events, uncompressed: each event is stored as in EEPROM. When equal to @c size, the
+     * events are stored uncompressed.
+     */
+    uint16_t rawSize;
+    uint16_t count; /**< The number of events in this block. */
+} ARCHIVE_HEADER_T;
+#endif
+
 #pragma pack(pop)
 
+/** Decodes the stored events one after the other. See #InitCursor and #DecodeNextEvent. */
+typedef struct CURSOR_S {
+    int offset; /**< The absolute offset to the next event to decode. */
+    int remaining; /**< The number of bytes still to decode. */
+    const uint8_t * pMapped; /**< Points to the next event to decode, in the memory-mapped EEPROM. */
+    int mappedSize; /**< The number of bytes that can be read directly via @c pMapped. */
+    int eventOffset; /**< The absolute offset to the event decoded last. */
+    EVENT_T event; /**< A copy of the event decoded last. */
+    const uint8_t * pData; /**< Points to the data of the event decoded last, or @c NULL if not directly accessible. */
+#if EVENT_ARCHIVE_FLASH_FIRST_PAGE
+    bool archived; /**< Whether the events are decoded from an archive block, in SRAM or in FLASH, instead of EEPROM. */
+#endif
+} CURSOR_T;
+
+#if EVENT_ARCHIVE_FLASH_FIRST_PAGE
+    #define IS_ARCHIVED(pCursor) ((pCursor)->archived)
+#else
+    /** Whether the cursor decodes archived events. */
+    #define IS_ARCHIVED(pCursor) false
+#endif
+
+/**
+ * Decodes all events one after the other: first the events moved to FLASH, if any, followed by the events in EEPROM.
+ * See #StartIterator and #NextEvent.
+ */
+typedef struct ITERATOR_S {
+    CURSOR_T cursor; /**< Decodes the events in EEPROM, or those in the current archive block. */
+    unsigned int nextIndex; /**< The sequential number of the event to decode next. */
+    unsigned int index; /**< The sequential number of the event decoded last. */
+    uint32_t timestamp; /**< Time in seconds. The full timestamp of the event decoded last. */
+#if EVENT_ARCHIVE_FLASH_FIRST_PAGE
+    /**
+     * The page - relative to #EVENT_ARCHIVE_FLASH_FIRST_PAGE - of the archive block to decode next, or @c -1 when the
+     * events in EEPROM are being decoded.
+     */
+    int page;
+    unsigned int blockIndex; /**< The sequential number of the first event in the archive block to decode next. */
+#endif
+} ITERATOR_T;
+
 /**
  * Dummy variable to test the value of #MEMORY_FIRSTUNUSEDEEPROMOFFSET.
  * If the macro is not correct, the dummy variable will have a negative array size and the compiler will raise an error
@@ -117,16 +348,103 @@ typedef struct EVENT_S { /* ANY change must be reflected in EVENT_OVERHEAD. */
  */
 static char sTestEventoverhead[(EVENT_OVERHEAD == sizeof(EVENT_T)) - 1] __attribute__((unused));
 
+#if EVENT_TAG_INDEX_COUNT
+/** If this construct doesn't compile, the cost per tag documented for #EVENT_TAG_INDEX_COUNT is no longer correct. */
+static char sTestTagEntrySize[(sizeof(TAG_ENTRY_T) == 16) - 1] __attribute__((unused));
+
+/** If this construct doesn't compile, #EVENT_TAG_INDEX_COUNT is too large for the assigned EEPROM region. */
+static char sTestMetaSize[(sizeof(META_T) < EVENT_EEPROM_SIZE) - 1] __attribute__((unused));
+#endif
+
+#if EVENT_CHECKPOINT_INTERVAL
+/** If this construct doesn't compile, the cost per checkpoint documented for #EVENT_CHECKPOINT_INTERVAL is no longer correct. */
+static char sTestCheckpointSize[(sizeof(CHECKPOINT_T) == 6) - 1] __attribute__((unused));
+
+/** If this construct doesn't compile, the checkpoints and the meta information leave no space for events. */
+static char sTestCheckpointCount[(EEPROM_EVENTS_END_OFFSET > EEPROM_ABSOLUTE_FIRST_BYTE_OFFSET) - 1] __attribute__((unused));
+#endif
+
+#if EVENT_ARCHIVE_FLASH_FIRST_PAGE
+/** If this construct doesn't compile, the assigned FLASH region can not hold a single uncompressed archive block. */
+static char sTestArchivePageCount[(ARCHIVE_BLOCK_PAGES(EVENT_ARCHIVE_BLOCK_SIZE) <= ARCHIVE_PAGE_COUNT) - 1] __attribute__((unused));
+
+/** If this construct doesn't compile, an EEPROM offset in #TAG_ENTRY_T can not be distinguished from #TAG_ARCHIVED. */
+static char sTestTagArchived[(EEPROM_ABSOLUTE_LAST_BYTE_OFFSET < TAG_ARCHIVED) - 1] __attribute__((unused));
+
+/**
+ * If this construct doesn't compile, the EEPROM region is too small to keep #EVENT_ARCHIVE_KEEP_SIZE bytes of events
+ * and still have the room #Event_Service aims for: see #ARCHIVE_FREE_SIZE.
+ */
+static char sTestArchiveKeepSize[(EVENTS_SIZE >= ARCHIVE_FREE_SIZE + EVENT_ARCHIVE_BLOCK_SIZE + EVENT_ARCHIVE_KEEP_SIZE) - 1] __attribute__((unused));
+#endif
+
 /* ------------------------------------------------------------------------- */
 
-/** A copy of the information stored at #EEPROM_META_OFFSET. Updated in EEPROM in #Event_DeInit. */
+/**
+ * A copy of the information stored at #EEPROM_META_OFFSET. Updated in EEPROM in #Event_DeInit, and - when the events
+ * are stored in a ring buffer - each time events are dropped: see #MakeRoom.
+ */
 static META_T sMeta;
 
 extern bool EVENT_CB(uint8_t tag, int offset, uint8_t len, unsigned int index, uint32_t timestamp, uint32_t context);
 static pEvent_Cb_t sEventCb = EVENT_CB;
 
+#if EVENT_ARCHIVE_FLASH_FIRST_PAGE
+extern int EVENT_ARCHIVE_COMPRESS_CB(const uint8_t * pIn, int inSize, uint8_t * pOut, int outSize);
+extern int EVENT_ARCHIVE_DECOMPRESS_CB(const uint8_t * pIn, int inSize, uint8_t * pOut, int outSize);
+#endif
+
+/** Points to the data of the event being reported, as returned by #Event_GetData. */
+static const uint8_t * sData;
+
+#if EVENT_ARCHIVE_FLASH_FIRST_PAGE
+/**
+ * The working memory for archive blocks, shared by all functions: only one of them uses it at any time. Word aligned,
+ * as required by IAP.
+ * - #ArchiveOldestEvents gathers the oldest events at #ARCHIVE_RAW_OFFSET, and prepares the archive block to program
+ *  in the first #ARCHIVE_BLOCK_BUFFER_SIZE bytes.
+ * - #LoadArchiveBlock decompresses the events of an archive block in the first #EVENT_ARCHIVE_BLOCK_SIZE bytes. These
+ *  are reported from there, until the iterator moves on to the next archive block.
+ * .
+ */
+static uint32_t sArchiveBuffer[(ARCHIVE_RAW_OFFSET + EVENT_ARCHIVE_BLOCK_SIZE + 3) / sizeof(uint32_t)];
+
+/**
+ * Set when moving events to FLASH failed - the archive is full, or programming failed. #Event_Service then no longer
+ * tries until the next call to #Event_Init.
+ */
+static bool sArchiveFailed;
+#endif
+
 static bool GetFirstOrLastByTag(bool first, uint8_t tag, int * pOffset, uint8_t * pLen, unsigned int * pIndex,
                                 uint32_t * pTimestamp);
+static void InitCursor(CURSOR_T * pCursor, int offset, int size);
+static bool DecodeNextEvent(CURSOR_T * pCursor);
+static int GetDataOffset(const CURSOR_T * pCursor);
+static bool Report(const CURSOR_T * pCursor, unsigned int index, uint32_t timestamp, uint32_t context);
+static void StartInEeprom(ITERATOR_T * pIterator, int offset, int size, unsigned int index, uint32_t timestamp);
+static void StartIterator(ITERATOR_T * pIterator, bool byTime, uint32_t value);
+static bool NextEvent(ITERATOR_T * pIterator);
+static int GetDistance(int offset);
+static int GetUsedSize(void);
+#if EVENT_TAG_INDEX_COUNT
+static void ResetTagIndex(void);
+#endif
+static void StoreMeta(void);
+#if RING_BUFFER
+static void DropOldestEvent(void);
+static bool MakeRoom(int size);
+#endif
+#if EVENT_CHECKPOINT_INTERVAL
+static void Seek(bool byTime, uint32_t value, int * pOffset, unsigned int * pIndex, uint32_t * pTimestamp);
+#endif
+#if EVENT_ARCHIVE_FLASH_FIRST_PAGE
+static void SeekArchive(ITERATOR_T * pIterator, bool byTime, uint32_t value);
+static bool LoadArchiveBlock(ITERATOR_T * pIterator);
+static bool IsArchivePending(void);
+static int ArchiveOldestEvents(int maxSize);
+static bool ProgramArchive(int page, const uint32_t * pData, int pageCount);
+#endif
 
 #if EVENT_CB_SELF_DEFINED == 1
 #pragma GCC diagnostic push
@@ -150,41 +468,712 @@ bool DummyEventCb(uint8_t tag, int offset, uint8_t len, unsigned int index, uint
 #pragma GCC diagnostic pop
 #endif
 
+#if EVENT_ARCHIVE_FLASH_FIRST_PAGE && (EVENT_ARCHIVE_COMPRESS_CB_SELF_DEFINED == 1)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+/**
+ * This is a dummy implementation to provoke fallback behavior: the events are archived uncompressed.
+ * It is only used when #EVENT_ARCHIVE_COMPRESS_CB is not overridden in an application specific @c app_sel.h header file
+ * @see pEvent_CompressCb_t
+ * @param pIn unused
+ * @param inSize unused
+ * @param pOut unused
+ * @param outSize unused
+ * @return @c 0
+ */
+int Event_DummyCompressCb(const uint8_t * pIn, int inSize, uint8_t * pOut, int outSize)
+{
+    return 0;
+}
+#pragma GCC diagnostic pop
+#endif
+
+#if EVENT_ARCHIVE_FLASH_FIRST_PAGE && (EVENT_ARCHIVE_DECOMPRESS_CB_SELF_DEFINED == 1)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+/**
+ * This is a dummy implementation to provoke fallback behavior: compressed blocks are skipped.
+ * It is only used when #EVENT_ARCHIVE_DECOMPRESS_CB is not overridden in an application specific @c app_sel.h header
+ * file
+ * @see pEvent_DecompressCb_t
+ * @param pIn unused
+ * @param inSize unused
+ * @param pOut unused
+ * @param outSize unused
+ * @return @c 0
+ */
+int Event_DummyDecompressCb(const uint8_t * pIn, int inSize, uint8_t * pOut, int outSize)
+{
+    return 0;
+}
+#pragma GCC diagnostic pop
+#endif
+
 static bool GetFirstOrLastByTag(bool first, uint8_t tag, int * pOffset, uint8_t * pLen, unsigned int * pIndex,
                                 uint32_t * pTimestamp)
 {
     bool found = false;
-    int eepromOffset = EEPROM_ABSOLUTE_FIRST_BYTE_OFFSET;
+    ITERATOR_T iterator;
+    int foundOffset = -1;
+    uint8_t foundLen = 0;
+    unsigned int foundIndex = 0;
+    uint32_t foundTimestamp = 0;
+
+    StartIterator(&iterator, false, 0);
+#if EVENT_TAG_INDEX_COUNT
+    if (tag < EVENT_TAG_INDEX_COUNT) {
+        const TAG_ENTRY_T * pEntry = &sMeta.tags[tag];
+        found = (pEntry->firstOffset != 0xFFFF);
+        if (found) {
+            uint16_t offset = first ? pEntry->firstOffset : pEntry->lastOffset;
+#if EVENT_ARCHIVE_FLASH_FIRST_PAGE
+            if (offset & TAG_ARCHIVED) {
+                foundLen = (uint8_t)offset;
+            }
+            else
+#endif
+            {
+                EVENT_T event;
+                Chip_EEPROM_Read(NSS_EEPROM, offset, &event, EVENT_OVERHEAD);
+                foundLen = event.len;
+                if (foundLen) {
+                    foundOffset = offset + EVENT_OVERHEAD;
+                }
+            }
+            foundIndex = RESTORE_TAG_INDEX(offset, first ? pEntry->firstIndex : pEntry->lastIndex);
+            foundTimestamp = first ? pEntry->firstTimestamp : pEntry->lastTimestamp;
+        }
+        StartInEeprom(&iterator, FIRST_EVENT_OFFSET, 0, 0, 0); /* No need to search. */
+    }
+#endif
+    while (NextEvent(&iterator)) {
+        if (tag == iterator.cursor.event.tag) {
+            found = true;
+            foundOffset = GetDataOffset(&iterator.cursor);
+            foundLen = iterator.cursor.event.len;
+            foundIndex = iterator.index;
+            foundTimestamp = iterator.timestamp;
+            if (first) {
+                break;
+            }
+        }
+    }
+
+    if (found) {
+        if (pOffset) {
+            *pOffset = foundOffset;
+        }
+        if (pLen) {
+            *pLen = foundLen;
+        }
+        if (pIndex) {
+            *pIndex = foundIndex;
+        }
+        if (pTimestamp) {
+            *pTimestamp = foundTimestamp;
+        }
+    }
+    return found;
+}
+
+/**
+ * Prepares decoding the events stored in the given range.
+ * @param pCursor The cursor to initialize.
+ * @param offset The absolute offset to the first event to decode.
+ * @param size The number of bytes to decode. The last event decoded is the one that contains the last byte.
+ */
+static void InitCursor(CURSOR_T * pCursor, int offset, int size)
+{
+    pCursor->offset = offset;
+    pCursor->remaining = size;
+    pCursor->mappedSize = 0;
+#if EVENT_ARCHIVE_FLASH_FIRST_PAGE
+    pCursor->archived = false;
+#endif
+}
+
+/**
+ * Decodes the next event. The memory-mapped EEPROM is read directly, up to the first row that is still cached by the
+ * EEPROM driver: only an event overlapping with such a row is read using #Chip_EEPROM_Read.
+ * @param pCursor The cursor, as initialized by #InitCursor.
+ * @return @c false when all events in the range have been decoded. Otherwise, @c true, and the fields @c eventOffset,
+ *  @c event and @c pData of @c pCursor describe the decoded event.
+ * @note When decoding an archive block, the whole block is mapped from the start: see #LoadArchiveBlock.
+ */
+static bool DecodeNextEvent(CURSOR_T * pCursor)
+{
+    bool available = pCursor->remaining > 0;
+#if EVENT_ARCHIVE_FLASH_FIRST_PAGE
+    if (pCursor->archived) {
+        /* Guard against a corrupt block: never map EEPROM instead. */
+        available = (pCursor->mappedSize >= EVENT_OVERHEAD);
+    }
+#endif
+    if (available) {
+#if RING_BUFFER
+        if (!IS_ARCHIVED(pCursor) && (sMeta.wrapOffset != 0) && (pCursor->offset == sMeta.wrapOffset)) {
+            pCursor->offset = EEPROM_ABSOLUTE_FIRST_BYTE_OFFSET;
+            pCursor->mappedSize = 0;
+        }
+#endif
+        if (pCursor->mappedSize < EVENT_OVERHEAD) {
+            const void * pMapped;
+            pCursor->mappedSize = Chip_EEPROM_Map(NSS_EEPROM, pCursor->offset,
+                                                  (int)EEPROM_EVENTS_END_OFFSET - pCursor->offset, &pMapped);
+            pCursor->pMapped = pMapped;
+        }
+        if (pCursor->mappedSize >= EVENT_OVERHEAD) {
+            memcpy(&pCursor->event, pCursor->pMapped, EVENT_OVERHEAD);
+        }
+        else {
+            Chip_EEPROM_Read(NSS_EEPROM, pCursor->offset, &pCursor->event, EVENT_OVERHEAD);
+        }
+        int size = EVENT_OVERHEAD + pCursor->event.len;
+        if (pCursor->event.len && (pCursor->mappedSize >= size)) {
+            pCursor->pData = pCursor->pMapped + EVENT_OVERHEAD;
+        }
+        else {
+            pCursor->pData = NULL;
+        }
+        pCursor->eventOffset = pCursor->offset;
+        pCursor->offset += size;
+        pCursor->remaining -= size;
+        pCursor->pMapped += size;
+        pCursor->mappedSize -= size; /* When negative, the next call maps again. */
+    }
+    return available;
+}
+
+/**
+ * Determines the offset to the data of the event decoded last, as given to the callback.
+ * @param pCursor The cursor that decoded the event.
+ * @return The absolute offset to the data in EEPROM, or @c -1 when the event has no data or is archived.
+ */
+static int GetDataOffset(const CURSOR_T * pCursor)
+{
+    return (pCursor->event.len && !IS_ARCHIVED(pCursor)) ? (pCursor->eventOffset + EVENT_OVERHEAD) : -1;
+}
+
+/**
+ * Reports the event decoded last to the callback. While the callback runs, #Event_GetData returns the data pointer
+ * provided by the cursor.
+ * @param pCursor The cursor that decoded the event.
+ * @param index The sequential number of the event.
+ * @param timestamp The full timestamp of the event.
+ * @param context Passed on to the callback.
+ * @return The value returned by the callback.
+ */
+static bool Report(const CURSOR_T * pCursor, unsigned int index, uint32_t timestamp, uint32_t context)
+{
+    sData = pCursor->pData;
+    bool searching = sEventCb(pCursor->event.tag, GetDataOffset(pCursor), pCursor->event.len, index, timestamp,
+                              context);
+    sData = NULL;
+    return searching;
+}
+
+/**
+ * Prepares traversing the events in EEPROM, skipping the archived events.
+ * @param pIterator The iterator to initialize.
+ * @param offset The absolute offset to the first event to decode.
+ * @param size The number of bytes to decode. The last event decoded is the one that contains the last byte.
+ * @param index The sequential number of the first event to decode.
+ * @param timestamp The full timestamp of the event stored just before the first event to decode, as it would be
+ *  calculated when traversing.
+ */
+static void StartInEeprom(ITERATOR_T * pIterator, int offset, int size, unsigned int index, uint32_t timestamp)
+{
+    InitCursor(&pIterator->cursor, offset, size);
+    pIterator->nextIndex = index;
+    pIterator->timestamp = timestamp;
+#if EVENT_ARCHIVE_FLASH_FIRST_PAGE
+    pIterator->page = -1;
+#endif
+}
+
+/**
+ * Prepares traversing all events, skipping as many events as possible - archived or not - using the archive block
+ * headers and the checkpoints. Without checkpoints, a traversal by time always starts with the oldest event.
+ * @param pIterator The iterator to initialize.
+ * @param byTime Whether @c value is a timestamp or an index.
+ * @param value The traversal starts at an event before the first event with an index equal to or larger than
+ *  @c value, or before the first event with a timestamp equal to or later than @c value.
+ */
+static void StartIterator(ITERATOR_T * pIterator, bool byTime, uint32_t value)
+{
+    int offset = FIRST_EVENT_OFFSET;
+    unsigned int index = FIRST_EVENT_INDEX;
     uint32_t timestamp = sMeta.baseTimestamp;
-    unsigned int index = 0;
+#if EVENT_CHECKPOINT_INTERVAL
+    Seek(byTime, value, &offset, &index, &timestamp);
+#elif !EVENT_ARCHIVE_FLASH_FIRST_PAGE
+    (void)byTime; /* suppress [-Wunused-parameter]: without checkpoints or archive, always start at the oldest event. */
+    (void)value; /* suppress [-Wunused-parameter]: without checkpoints or archive, always start at the oldest event. */
+#endif
+    StartInEeprom(pIterator, offset, GetUsedSize() - GetDistance(offset), index, timestamp);
+#if EVENT_ARCHIVE_FLASH_FIRST_PAGE
+    SeekArchive(pIterator, byTime, value);
+#endif
+}
+
+/**
+ * Decodes the next event: the archived events are decoded first, followed by the events in EEPROM.
+ * @param pIterator The iterator, as initialized by #StartIterator or #StartInEeprom.
+ * @return @c false when all events have been decoded. Otherwise, @c true, and the fields @c cursor, @c index and
+ *  @c timestamp of @c pIterator describe the decoded event.
+ */
+static bool NextEvent(ITERATOR_T * pIterator)
+{
+    bool available = DecodeNextEvent(&pIterator->cursor);
+#if EVENT_ARCHIVE_FLASH_FIRST_PAGE
+    while (!available && (pIterator->page >= 0)) {
+        if (!LoadArchiveBlock(pIterator)) {
+            StartInEeprom(pIterator, FIRST_EVENT_OFFSET, GetUsedSize(), FIRST_EVENT_INDEX, sMeta.baseTimestamp);
+        }
+        available = DecodeNextEvent(&pIterator->cursor);
+    }
+#endif
+    if (available) {
+        pIterator->timestamp += RESTORE_TIMESTAMP(pIterator->cursor.event.deltaTimestamp);
+        pIterator->index = pIterator->nextIndex;
+        pIterator->nextIndex++;
+    }
+    return available;
+}
+
+/**
+ * Determines the position of a stored event, relative to the oldest event.
+ * @param offset The absolute offset to a stored event.
+ * @return The number of bytes occupied by the events stored before the given event.
+ */
+static int GetDistance(int offset)
+{
+    int distance = offset - FIRST_EVENT_OFFSET;
+#if RING_BUFFER
+    if (distance < 0) { /* Stored after wrapping. */
+        distance += sMeta.wrapOffset - EEPROM_ABSOLUTE_FIRST_BYTE_OFFSET;
+    }
+#endif
+    return distance;
+}
+
+/** @return The number of bytes occupied by all stored events. */
+static int GetUsedSize(void)
+{
+#if RING_BUFFER
+    if (sMeta.wrapOffset != 0) {
+        return (sMeta.wrapOffset - sMeta.firstOffset) + (sMeta.nextFreeOffset - EEPROM_ABSOLUTE_FIRST_BYTE_OFFSET);
+    }
+#endif
+    return sMeta.nextFreeOffset - FIRST_EVENT_OFFSET;
+}
+
+#if EVENT_TAG_INDEX_COUNT
+/** Marks all indexed tags as not used by any event. */
+static void ResetTagIndex(void)
+{
+    for (int tag = 0; tag < EVENT_TAG_INDEX_COUNT; tag++) {
+        sMeta.tags[tag].firstOffset = 0xFFFF;
+    }
+}
+#endif
+
+/** Writes #sMeta to EEPROM, unless it is stored already. A flush is still required afterwards. */
+static void StoreMeta(void)
+{
+    META_T storedMeta;
+    Chip_EEPROM_Read(NSS_EEPROM, EEPROM_META_OFFSET, &storedMeta, sizeof(META_T));
+    if (memcmp(&sMeta, &storedMeta, sizeof(META_T)) != 0) {
+        Chip_EEPROM_Write(NSS_EEPROM, EEPROM_META_OFFSET, &sMeta, sizeof(META_T));
+    }
+}
+
+#if RING_BUFFER
+/**
+ * Drops the oldest event. The meta information is updated accordingly - including the tag index: when the dropped
+ * event was the first event with an indexed tag, the next event with that tag is searched for. When
+ * #EVENT_ARCHIVE_FLASH_FIRST_PAGE is set, the event has been archived instead: the entry is marked with #TAG_ARCHIVED.
+ * @pre At least one event is stored.
+ */
+static void DropOldestEvent(void)
+{
+    int offset = sMeta.firstOffset;
     EVENT_T event;
+    Chip_EEPROM_Read(NSS_EEPROM, offset, &event, EVENT_OVERHEAD);
 
-    while (eepromOffset < sMeta.nextFreeOffset) {
-        Chip_EEPROM_Read(NSS_EEPROM, eepromOffset, &event, EVENT_OVERHEAD);
-        timestamp += RESTORE_TIMESTAMP(event.deltaTimestamp);
-        if (tag == event.tag) {
-            found = true;
-            if (pOffset) {
-                *pOffset = event.len ? (eepromOffset + EVENT_OVERHEAD) : -1;
+    sMeta.baseTimestamp += RESTORE_TIMESTAMP(event.deltaTimestamp);
+    sMeta.firstOffset = (uint16_t)(sMeta.firstOffset + EVENT_OVERHEAD + event.len);
+    if (sMeta.firstOffset == sMeta.wrapOffset) {
+        sMeta.firstOffset = EEPROM_ABSOLUTE_FIRST_BYTE_OFFSET;
+        sMeta.wrapOffset = 0;
+    }
+    sMeta.firstIndex++;
+#if EVENT_TAG_INDEX_COUNT || EVENT_CHECKPOINT_INTERVAL
+    sMeta.count--;
+#endif
+
+#if EVENT_TAG_INDEX_COUNT
+    if (event.tag < EVENT_TAG_INDEX_COUNT) {
+        TAG_ENTRY_T * pEntry = &sMeta.tags[event.tag];
+#if EVENT_ARCHIVE_FLASH_FIRST_PAGE
+        if (pEntry->firstOffset == offset) {
+            pEntry->firstOffset = (uint16_t)(TAG_ARCHIVED | event.len);
+        }
+        if (pEntry->lastOffset == offset) {
+            pEntry->lastOffset = (uint16_t)(TAG_ARCHIVED | event.len);
+        }
+#else
+        if (pEntry->lastOffset == offset) {
+            pEntry->firstOffset = 0xFFFF;
+        }
+        else {
+            /* Search up to and including the last event with this tag: it is found at the latest there. */
+            uint32_t timestamp = sMeta.baseTimestamp;
+            unsigned int index = FIRST_EVENT_INDEX;
+            CURSOR_T cursor;
+            InitCursor(&cursor, FIRST_EVENT_OFFSET, GetDistance(pEntry->lastOffset) + 1);
+            while (DecodeNextEvent(&cursor)) {
+                timestamp += RESTORE_TIMESTAMP(cursor.event.deltaTimestamp);
+                if (cursor.event.tag == event.tag) {
+                    pEntry->firstOffset = (uint16_t)cursor.eventOffset;
+                    pEntry->firstIndex = (uint16_t)index;
+                    pEntry->firstTimestamp = timestamp;
+                    break;
+                }
+                index++;
             }
-            if (pLen) {
-                *pLen = event.len;
+        }
+#endif
+    }
+#endif
+}
+
+/**
+ * Drops - or archives - the oldest events until a new event can be stored at #META_T.nextFreeOffset. When the new
+ * event does not fit anymore at the end of the region, the stored events are wrapped first.
+ * When events were dropped, the meta information is stored and flushed before returning: the new event is about to
+ * overwrite them. Otherwise, after a reset without a call to #Event_DeInit, the meta information in EEPROM would still
+ * refer to the overwritten events - undetectable by the sanity check in #Event_Init.
+ * @param size The size of the new event, including #EVENT_OVERHEAD.
+ * @return @c true when the new event can be stored; @c false when the archive is full.
+ * @pre @c size is smaller than the space available for events.
+ */
+static bool MakeRoom(int size)
+{
+    const uint32_t firstIndex = sMeta.firstIndex;
+    bool done = false;
+    bool possible = true;
+    while (possible && !done) {
+        if (sMeta.wrapOffset == 0) {
+            done = (sMeta.nextFreeOffset + size < (int)EEPROM_EVENTS_END_OFFSET);
+            if (!done) {
+                if (sMeta.firstOffset == sMeta.nextFreeOffset) {
+                    /* All events have been moved to FLASH: start over instead of wrapping. */
+                    sMeta.firstOffset = EEPROM_ABSOLUTE_FIRST_BYTE_OFFSET;
+                }
+                else {
+                    sMeta.wrapOffset = sMeta.nextFreeOffset;
+                }
+                sMeta.nextFreeOffset = EEPROM_ABSOLUTE_FIRST_BYTE_OFFSET;
             }
-            if (pIndex) {
-                *pIndex = index;
+        }
+        else {
+            done = (sMeta.nextFreeOffset + size <= sMeta.firstOffset);
+            if (!done) {
+#if EVENT_ARCHIVE_FLASH_FIRST_PAGE
+                possible = (ArchiveOldestEvents(INT_MAX) > 0);
+#else
+                DropOldestEvent();
+#endif
             }
-            if (pTimestamp) {
-                *pTimestamp = timestamp;
+        }
+    }
+    if (sMeta.firstIndex != firstIndex) {
+        StoreMeta();
+        Chip_EEPROM_Flush(NSS_EEPROM, true);
+    }
+    return done;
+}
+#endif
+
+#if EVENT_CHECKPOINT_INTERVAL
+/**
+ * Determines where to start traversing the events, using the checkpoints.
+ * @param byTime Whether @c value is a timestamp or an index.
+ * @param value
+ *  - When @c byTime is @c true: the traversal starts at the last checkpoint for which all preceding events have a
+ *      timestamp earlier than @c value.
+ *  - When @c byTime is @c false: the traversal starts at the last checkpoint referencing an event with an index equal
+ *      to or smaller than @c value.
+ *  .
+ * @param [out] pOffset : The absolute offset to the event to start traversing from.
+ * @param [out] pIndex : The sequential number of that event.
+ * @param [out] pTimestamp : The full timestamp of the event stored just before that event, as it would be calculated
+ *  when traversing.
+ */
+static void Seek(bool byTime, uint32_t value, int * pOffset, unsigned int * pIndex, uint32_t * pTimestamp)
+{
+    CHECKPOINT_T checkpoint;
+    /* The checkpoints in use are in ]low, high[. Instead of checkpoint low - if it was ever stored - the oldest event
+     * is used.
+     */
+    unsigned int low = FIRST_EVENT_INDEX / EVENT_CHECKPOINT_INTERVAL;
+    unsigned int high = (FIRST_EVENT_INDEX + sMeta.count + EVENT_CHECKPOINT_INTERVAL - 1U) / EVENT_CHECKPOINT_INTERVAL;
+    unsigned int n = low;
+
+    if (high <= low) {
+        high = low + 1;
+    }
+    if (byTime) {
+        /* Binary search for the last checkpoint with a timestamp before value. */
+        while (high - n > 1) {
+            unsigned int middle = (n + high) / 2;
+            Chip_EEPROM_Read(NSS_EEPROM, CHECKPOINT_OFFSET(middle), &checkpoint, sizeof(CHECKPOINT_T));
+            if (checkpoint.previousTimestamp < value) {
+                n = middle;
             }
-            if (first) {
-                break;
+            else {
+                high = middle;
             }
         }
-        eepromOffset += EVENT_OVERHEAD + event.len;
-        index++;
     }
-    return found;
+    else {
+        n = value / EVENT_CHECKPOINT_INTERVAL;
+        if (n < low) {
+            n = low;
+        }
+        else if (n >= high) {
+            n = high - 1;
+        }
+    }
+    if (n > low) {
+        Chip_EEPROM_Read(NSS_EEPROM, CHECKPOINT_OFFSET(n), &checkpoint, sizeof(CHECKPOINT_T));
+        *pOffset = checkpoint.offset;
+        *pIndex = n * EVENT_CHECKPOINT_INTERVAL;
+        *pTimestamp = checkpoint.previousTimestamp;
+    }
+    else {
+        *pOffset = FIRST_EVENT_OFFSET;
+        *pIndex = FIRST_EVENT_INDEX;
+        *pTimestamp = sMeta.baseTimestamp;
+    }
+}
+#endif
+
+#if EVENT_ARCHIVE_FLASH_FIRST_PAGE
+/**
+ * Determines whether the traversal must start in the archive, using the block headers. If so, the iterator is
+ * adapted to load the block found first.
+ * @param pIterator The iterator, as initialized by #StartInEeprom.
+ * @param byTime Whether @c value is a timestamp or an index.
+ * @param value
+ *  - When @c byTime is @c true: the traversal starts at the first block with an event with a timestamp equal to or
+ *      later than @c value. Without checkpoints, the timestamps may decrease: the traversal then starts at the first
+ *      block.
+ *  - When @c byTime is @c false: the traversal starts at the block containing the event with index @c value.
+ *  .
+ */
+static void SeekArchive(ITERATOR_T * pIterator, bool byTime, uint32_t value)
+{
+    int page = 0;
+    unsigned int index = 0;
+    bool found = false;
+    while (!found && (page < sMeta.archivePageCount)) {
+        const ARCHIVE_HEADER_T * pHeader = (const ARCHIVE_HEADER_T *)ARCHIVE_PAGE_TO_ADDRESS(page);
+        int nextPage = page + ARCHIVE_BLOCK_PAGES(pHeader->size);
+        if (byTime) {
+#if EVENT_CHECKPOINT_INTERVAL
+            /* The timestamp of the last event in a block is where the next block - or the EEPROM - continues from. */
+            uint32_t lastTimestamp = sMeta.baseTimestamp;
+            if (nextPage < sMeta.archivePageCount) {
+                lastTimestamp = ((const ARCHIVE_HEADER_T *)ARCHIVE_PAGE_TO_ADDRESS(nextPage))->previousTimestamp;
+            }
+            found = (value <= lastTimestamp);
+#else
+            found = true;
+#endif
+        }
+        else {
+            found = (value < index + pHeader->count);
+        }
+        if (!found) {
+            index += pHeader->count;
+            page = nextPage;
+        }
+    }
+    if (found) {
+        InitCursor(&pIterator->cursor, 0, 0);
+        pIterator->page = page;
+        pIterator->blockIndex = index;
+        pIterator->nextIndex = index;
+    }
+}
+
+/**
+ * Prepares decoding the events in the next archive block. Uncompressed blocks are decoded directly from FLASH; the
+ * others are first decompressed in #sArchiveBuffer using #EVENT_ARCHIVE_DECOMPRESS_CB. The events in a block that
+ * can not be decompressed are skipped.
+ * @param pIterator The iterator. @c pIterator->page and @c pIterator->blockIndex describe the block to load.
+ * @return @c false when all archive blocks have been decoded.
+ */
+static bool LoadArchiveBlock(ITERATOR_T * pIterator)
+{
+    bool loaded = false;
+    while (!loaded && (pIterator->page < sMeta.archivePageCount)) {
+        const ARCHIVE_HEADER_T * pHeader = (const ARCHIVE_HEADER_T *)ARCHIVE_PAGE_TO_ADDRESS(pIterator->page);
+        const uint8_t * pData = (const uint8_t *)(pHeader + 1);
+        if (pHeader->size == pHeader->rawSize) {
+            loaded = true;
+        }
+        else {
+            uint8_t * pBuffer = (uint8_t *)sArchiveBuffer;
+            int size = EVENT_ARCHIVE_DECOMPRESS_CB(pData, pHeader->size, pBuffer, EVENT_ARCHIVE_BLOCK_SIZE);
+            loaded = (size == pHeader->rawSize);
+            pData = pBuffer;
+        }
+        if (loaded) {
+            InitCursor(&pIterator->cursor, 0, pHeader->rawSize);
+            pIterator->cursor.archived = true;
+            pIterator->cursor.pMapped = pData;
+            pIterator->cursor.mappedSize = pHeader->rawSize;
+            pIterator->timestamp = pHeader->previousTimestamp;
+            pIterator->nextIndex = pIterator->blockIndex;
+        }
+        pIterator->page += ARCHIVE_BLOCK_PAGES(pHeader->size);
+        pIterator->blockIndex += pHeader->count;
+    }
+    return loaded;
+}
+
+/**
+ * Determines whether #Event_Service has to move events to FLASH: less than #ARCHIVE_FREE_SIZE bytes are free in
+ * EEPROM, and more than #EVENT_ARCHIVE_KEEP_SIZE bytes are used.
+ * @return @c false as well when moving events failed before.
+ */
+static bool IsArchivePending(void)
+{
+    int usedSize = GetUsedSize();
+    return !sArchiveFailed && (EVENTS_SIZE - usedSize < ARCHIVE_FREE_SIZE) && (usedSize > EVENT_ARCHIVE_KEEP_SIZE);
+}
+
+/**
+ * Moves the oldest events to a new archive block in FLASH, to make room in EEPROM. As many events as fit in
+ * #EVENT_ARCHIVE_BLOCK_SIZE bytes are gathered, compressed using #EVENT_ARCHIVE_COMPRESS_CB, and programmed after the
+ * blocks already archived. The archived events are then dropped using #DropOldestEvent.
+ * @param maxSize The maximum number of bytes - including #EVENT_OVERHEAD - of the oldest events that may be moved.
+ * @return
+ *  - The number of events archived.
+ *  - @c 0 when the oldest event is larger than @c maxSize.
+ *  - @c -1 when the archive is full, or when programming the FLASH failed.
+ *  .
+ * @warning This function will take 100+ milliseconds to complete.
+ * @pre At least one event is stored.
+ */
+static int ArchiveOldestEvents(int maxSize)
+{
+    uint8_t * pBlock = (uint8_t *)sArchiveBuffer;
+    uint8_t * pRaw = pBlock + ARCHIVE_RAW_OFFSET;
+    ARCHIVE_HEADER_T header = {.previousTimestamp = sMeta.baseTimestamp, .size = 0, .rawSize = 0, .count = 0};
+    CURSOR_T cursor;
+
+    if (maxSize > EVENT_ARCHIVE_BLOCK_SIZE) {
+        maxSize = EVENT_ARCHIVE_BLOCK_SIZE;
+    }
+    if (sMeta.archivePageCount >= ARCHIVE_PAGE_COUNT) {
+        return -1;
+    }
+
+    /* Gather the events as stored in EEPROM. Sequential numbers of archived events are kept below 0x10000, so that
+     * they fit in a TAG_ENTRY_T instance.
+     */
+    InitCursor(&cursor, FIRST_EVENT_OFFSET, GetUsedSize());
+    while ((FIRST_EVENT_INDEX + header.count < 0x10000) && DecodeNextEvent(&cursor)
+            && (header.rawSize + EVENT_OVERHEAD + cursor.event.len <= maxSize)) {
+        memcpy(pRaw + header.rawSize, &cursor.event, EVENT_OVERHEAD);
+        if (cursor.pData) {
+            memcpy(pRaw + header.rawSize + EVENT_OVERHEAD, cursor.pData, cursor.event.len);
+        }
+        else if (cursor.event.len) {
+            Chip_EEPROM_Read(NSS_EEPROM, cursor.eventOffset + EVENT_OVERHEAD, pRaw + header.rawSize + EVENT_OVERHEAD,
+                             cursor.event.len);
+        }
+        header.rawSize = (uint16_t)(header.rawSize + EVENT_OVERHEAD + cursor.event.len);
+        header.count++;
+    }
+
+    if (header.count == 0) {
+        return 0;
+    }
+
+    int size = EVENT_ARCHIVE_COMPRESS_CB(pRaw, header.rawSize, pBlock + sizeof(ARCHIVE_HEADER_T), header.rawSize);
+    if ((size <= 0) || (size >= header.rawSize)) {
+        size = header.rawSize;
+        memcpy(pBlock + sizeof(ARCHIVE_HEADER_T), pRaw, (size_t)size);
+    }
+    header.size = (uint16_t)size;
+    memcpy(pBlock, &header, sizeof(ARCHIVE_HEADER_T));
+    int pageCount = ARCHIVE_BLOCK_PAGES(size);
+    memset(pBlock + sizeof(ARCHIVE_HEADER_T) + size, 0xFF,
+           (size_t)pageCount * FLASH_PAGE_SIZE - sizeof(ARCHIVE_HEADER_T) - (size_t)size);
+
+    bool success = (sMeta.archivePageCount + pageCount <= ARCHIVE_PAGE_COUNT)
+            && ProgramArchive(sMeta.archivePageCount, sArchiveBuffer, pageCount);
+    if (!success) {
+        return -1;
+    }
+    sMeta.archivePageCount = (uint16_t)(sMeta.archivePageCount + pageCount);
+    for (int n = 0; n < header.count; n++) {
+        DropOldestEvent();
+    }
+    return header.count;
+}
+
+/**
+ * Programs an archive block in FLASH. Pages that are not blank - left behind by a block for which the meta information
+ * was never updated in EEPROM - are erased first.
+ * @param page The first page to program, relative to #EVENT_ARCHIVE_FLASH_FIRST_PAGE.
+ * @param pData May not be @c NULL. Must be word (32 bits) aligned.
+ * @param pageCount The number of pages to program. @c pData must provide this multiple of #FLASH_PAGE_SIZE bytes.
+ * @return the result of the FLASH program action: @c true for success.
+ */
+static bool ProgramArchive(int page, const uint32_t * pData, int pageCount)
+{
+    const uint32_t firstPage = (uint32_t)(EVENT_ARCHIVE_FLASH_FIRST_PAGE + page);
+    const uint32_t lastPage = (uint32_t)(firstPage + (uint32_t)pageCount - 1);
+    const uint32_t sectorStart = firstPage / FLASH_PAGES_PER_SECTOR;
+    const uint32_t sectorEnd = lastPage / FLASH_PAGES_PER_SECTOR;
+    uint8_t * pDest = (uint8_t *)ARCHIVE_PAGE_TO_ADDRESS(page);
+    uint32_t size = (uint32_t)pageCount * FLASH_PAGE_SIZE;
+    IAP_STATUS_T status = IAP_STATUS_CMD_SUCCESS;
+
+    const uint32_t * cursor = (const uint32_t *)pDest;
+    while ((cursor < (const uint32_t *)(pDest + size)) && (*cursor == 0xFFFFFFFF)) {
+        cursor++;
+    }
+    if (cursor < (const uint32_t *)(pDest + size)) { /* Not blank. */
+        status = Chip_IAP_Flash_PrepareSector(sectorStart, sectorEnd);
+        if (status == IAP_STATUS_CMD_SUCCESS) {
+            __disable_irq();
+            status = Chip_IAP_Flash_ErasePage(firstPage, lastPage, 0);
+            __enable_irq();
+        }
+    }
+    if (status == IAP_STATUS_CMD_SUCCESS) {
+        status = Chip_IAP_Flash_PrepareSector(sectorStart, sectorEnd);
+    }
+    if (status == IAP_STATUS_CMD_SUCCESS) {
+        __disable_irq();
+        status = Chip_IAP_Flash_Program(pData, pDest, size, 0);
+        __enable_irq();
+    }
+    if (status == IAP_STATUS_CMD_SUCCESS) {
+        __disable_irq();
+        status = Chip_IAP_Compare(pData, pDest, size, NULL);
+        __enable_irq();
+    }
+    return status == IAP_STATUS_CMD_SUCCESS;
 }
+#endif
 
 /* ------------------------------------------------------------------------- */
 
@@ -200,25 +1189,96 @@ void Event_Init(bool reset)
         sMeta.lastTimestamp = sMeta.baseTimestamp;
         sMeta.lastTimeError = 0;
         sMeta.nextFreeOffset = EEPROM_ABSOLUTE_FIRST_BYTE_OFFSET;
+#if EVENT_TAG_INDEX_COUNT || EVENT_CHECKPOINT_INTERVAL
+        sMeta.count = 0;
+#endif
+#if RING_BUFFER
+        sMeta.firstOffset = EEPROM_ABSOLUTE_FIRST_BYTE_OFFSET;
+        sMeta.wrapOffset = 0;
+        sMeta.firstIndex = 0;
+#endif
+#if EVENT_ARCHIVE_FLASH_FIRST_PAGE
+        sMeta.archivePageCount = 0;
+#endif
+#if EVENT_TAG_INDEX_COUNT
+        ResetTagIndex();
+#endif
     }
     /* Sanity check. */
-    if ((sMeta.nextFreeOffset < EEPROM_ABSOLUTE_FIRST_BYTE_OFFSET) || (sMeta.nextFreeOffset >= EEPROM_META_OFFSET)) {
+    bool valid = (sMeta.nextFreeOffset >= EEPROM_ABSOLUTE_FIRST_BYTE_OFFSET)
+            && (sMeta.nextFreeOffset < EEPROM_EVENTS_END_OFFSET);
+#if RING_BUFFER
+    if (sMeta.wrapOffset == 0) {
+        /* Moving a block of events to FLASH may continue past the wrap point. */
+        valid = valid && (sMeta.firstOffset >= EEPROM_ABSOLUTE_FIRST_BYTE_OFFSET)
+                && (sMeta.firstOffset <= sMeta.nextFreeOffset);
+    }
+    else {
+        valid = valid && (sMeta.nextFreeOffset <= sMeta.firstOffset) && (sMeta.firstOffset < sMeta.wrapOffset)
+                && (sMeta.wrapOffset < EEPROM_EVENTS_END_OFFSET);
+    }
+#endif
+#if EVENT_ARCHIVE_FLASH_FIRST_PAGE
+    /* The block headers must add up to the meta information. */
+    int page = 0;
+    unsigned int index = 0;
+    while (valid && (page < sMeta.archivePageCount)) {
+        const ARCHIVE_HEADER_T * pHeader = (const ARCHIVE_HEADER_T *)ARCHIVE_PAGE_TO_ADDRESS(page);
+        valid = (pHeader->count > 0) && (pHeader->size <= pHeader->rawSize)
+                && (pHeader->rawSize <= EVENT_ARCHIVE_BLOCK_SIZE);
+        page += ARCHIVE_BLOCK_PAGES(pHeader->size);
+        index += pHeader->count;
+    }
+    valid = valid && (page == sMeta.archivePageCount) && (index == FIRST_EVENT_INDEX);
+#endif
+    if (!valid) {
         sMeta.nextFreeOffset = EEPROM_ABSOLUTE_FIRST_BYTE_OFFSET;
+#if RING_BUFFER
+        sMeta.firstOffset = EEPROM_ABSOLUTE_FIRST_BYTE_OFFSET;
+        sMeta.wrapOffset = 0;
+#endif
+#if EVENT_ARCHIVE_FLASH_FIRST_PAGE
+        sMeta.firstIndex = 0;
+        sMeta.archivePageCount = 0;
+#endif
+#if EVENT_TAG_INDEX_COUNT || EVENT_CHECKPOINT_INTERVAL
+        sMeta.count = 0;
+#endif
+#if EVENT_TAG_INDEX_COUNT
+        ResetTagIndex();
+#endif
     }
+#if EVENT_ARCHIVE_FLASH_FIRST_PAGE
+    sArchiveFailed = false;
+#endif
 }
 
 void Event_DeInit(void)
 {
-    META_T storedMeta;
-    Chip_EEPROM_Read(NSS_EEPROM, EEPROM_META_OFFSET, &storedMeta, sizeof(META_T));
-    if ((sMeta.baseTimestamp != storedMeta.baseTimestamp)
-            || (sMeta.lastTimestamp != storedMeta.lastTimestamp)
-            || (sMeta.nextFreeOffset != storedMeta.nextFreeOffset)) {
-        Chip_EEPROM_Write(NSS_EEPROM, EEPROM_META_OFFSET, &sMeta, sizeof(META_T));
-    }
+    StoreMeta();
     Chip_EEPROM_Flush(NSS_EEPROM, true);
 }
 
+bool Event_Service(void)
+{
+    bool pending = false;
+#if EVENT_ARCHIVE_FLASH_FIRST_PAGE
+    if (IsArchivePending()) {
+        int count = ArchiveOldestEvents(GetUsedSize() - EVENT_ARCHIVE_KEEP_SIZE);
+        if (count > 0) {
+            /* Same as in MakeRoom: the next events stored will overwrite the events just moved. */
+            StoreMeta();
+            Chip_EEPROM_Flush(NSS_EEPROM, true);
+            pending = IsArchivePending();
+        }
+        else if (count < 0) {
+            sArchiveFailed = true;
+        }
+    }
+#endif
+    return pending;
+}
+
 pEvent_Cb_t Event_SetCb(pEvent_Cb_t cb)
 {
     pEvent_Cb_t previousCb = sEventCb;
@@ -242,12 +1302,54 @@ bool Event_Set(uint8_t tag, void * data, uint8_t len)
     if (data == NULL) {
         len = 0;
     }
-    bool success = (sMeta.nextFreeOffset + EVENT_OVERHEAD + len < (int)EEPROM_META_OFFSET);
+#if RING_BUFFER
+    bool success = (EVENT_OVERHEAD + len < EVENTS_SIZE);
+#else
+    bool success = (sMeta.nextFreeOffset + EVENT_OVERHEAD + len < (int)EEPROM_EVENTS_END_OFFSET);
+#endif
+#if EVENT_ARCHIVE_FLASH_FIRST_PAGE
+    success = success && (EVENT_OVERHEAD + len <= EVENT_ARCHIVE_BLOCK_SIZE);
+#endif
+#if RING_BUFFER
+    success = success && MakeRoom(EVENT_OVERHEAD + len);
+#endif
     if (success) {
+        /* Only read now: archiving takes time. */
         uint32_t now = (uint32_t)Chip_RTC_Time_GetValue(NSS_RTC);
+#if EVENT_CHECKPOINT_INTERVAL
+        /* The checkpoints must remain sorted by time: never go back in time. */
+        if (now < sMeta.lastTimestamp) {
+            now = sMeta.lastTimestamp;
+        }
+        unsigned int index = FIRST_EVENT_INDEX + sMeta.count;
+        if ((index > 0) && (index % EVENT_CHECKPOINT_INTERVAL == 0)) {
+            CHECKPOINT_T checkpoint = {.offset = sMeta.nextFreeOffset,
+                                       .previousTimestamp = sMeta.lastTimestamp - sMeta.lastTimeError};
+            Chip_EEPROM_Write(NSS_EEPROM, CHECKPOINT_OFFSET(index / EVENT_CHECKPOINT_INTERVAL), &checkpoint,
+                              sizeof(CHECKPOINT_T));
+        }
+#endif
         EVENT_T event = {.tag = tag, .len = len};
         event.deltaTimestamp = REDUCE_TIMESTAMP(now - sMeta.lastTimestamp + sMeta.lastTimeError)
                 & DELTATIMESTAMP_BITMASK;
+#if EVENT_TAG_INDEX_COUNT
+        if (tag < EVENT_TAG_INDEX_COUNT) {
+            /* The timestamp as it will be calculated when traversing, i.e. including the error made. */
+            uint32_t timestamp = sMeta.lastTimestamp - sMeta.lastTimeError + RESTORE_TIMESTAMP(event.deltaTimestamp);
+            TAG_ENTRY_T * pEntry = &sMeta.tags[tag];
+            if (pEntry->firstOffset == 0xFFFF) {
+                pEntry->firstOffset = sMeta.nextFreeOffset;
+                pEntry->firstIndex = (uint16_t)(FIRST_EVENT_INDEX + sMeta.count);
+                pEntry->firstTimestamp = timestamp;
+            }
+            pEntry->lastOffset = sMeta.nextFreeOffset;
+            pEntry->lastIndex = (uint16_t)(FIRST_EVENT_INDEX + sMeta.count);
+            pEntry->lastTimestamp = timestamp;
+        }
+#endif
+#if EVENT_TAG_INDEX_COUNT || EVENT_CHECKPOINT_INTERVAL
+        sMeta.count++;
+#endif
         sMeta.lastTimeError = (uint16_t)(now - sMeta.lastTimestamp + sMeta.lastTimeError
                 - RESTORE_TIMESTAMP(event.deltaTimestamp));
         Chip_EEPROM_Write(NSS_EEPROM, sMeta.nextFreeOffset, &event, EVENT_OVERHEAD);
@@ -266,26 +1368,15 @@ unsigned int Event_GetByIndex(unsigned int first, unsigned int last, uint32_t co
 #if EVENT_CB_OPENING_CALL
     searching = sEventCb(0, -1, 0, EVENT_CB_OPENING_INDEX, 0, context);
 #endif
-    int eepromOffset = EEPROM_ABSOLUTE_FIRST_BYTE_OFFSET;
-    uint32_t timestamp = sMeta.baseTimestamp;
-    unsigned int index = 0;
     unsigned int count = 0;
-    EVENT_T event;
+    ITERATOR_T iterator;
 
-    while (searching && (eepromOffset < sMeta.nextFreeOffset)) {
-        Chip_EEPROM_Read(NSS_EEPROM, eepromOffset, &event, EVENT_OVERHEAD);
-        timestamp += RESTORE_TIMESTAMP(event.deltaTimestamp);
-        if ((first <= index) && (index <= last)) {
-        searching = sEventCb(event.tag,
-                             event.len ? eepromOffset + EVENT_OVERHEAD : -1,
-                             event.len,
-                             index,
-                             timestamp,
-                             context);
+    StartIterator(&iterator, false, first);
+    while (searching && (iterator.nextIndex <= last) && NextEvent(&iterator)) {
+        if ((first <= iterator.index) && (iterator.index <= last)) {
+            searching = Report(&iterator.cursor, iterator.index, iterator.timestamp, context);
             count++;
         }
-        eepromOffset += EVENT_OVERHEAD + event.len;
-        index++;
     }
 #if EVENT_CB_CLOSING_CALL
     (void)sEventCb(0, -1, 0, EVENT_CB_CLOSING_INDEX, 0, context);
@@ -299,23 +1390,20 @@ unsigned int Event_GetByTime(unsigned int begin, unsigned int end, uint32_t cont
 #if EVENT_CB_OPENING_CALL
     searching = sEventCb(0, -1, 0, EVENT_CB_OPENING_INDEX, 0, context);
 #endif
-    int eepromOffset = EEPROM_ABSOLUTE_FIRST_BYTE_OFFSET;
-    uint32_t timestamp = sMeta.baseTimestamp;
-    unsigned int index = 0;
     unsigned int count = 0;
-    EVENT_T event;
+    ITERATOR_T iterator;
 
-    begin = REDUCE_TIMESTAMP(begin);
-    end = REDUCE_TIMESTAMP(end);
-    while (searching && (eepromOffset < sMeta.nextFreeOffset)) {
-        Chip_EEPROM_Read(NSS_EEPROM, eepromOffset, &event, EVENT_OVERHEAD);
-        timestamp += RESTORE_TIMESTAMP(event.deltaTimestamp);
-        if ((begin <= event.deltaTimestamp) && (event.deltaTimestamp <= end)) {
-            searching = sEventCb(event.tag, eepromOffset, event.len, index, timestamp, context);
+    StartIterator(&iterator, true, begin);
+    while (searching && NextEvent(&iterator)) {
+#if EVENT_CHECKPOINT_INTERVAL
+        if (iterator.timestamp > end) {
+            break; /* Timestamps never decrease: no more events can match. */
+        }
+#endif
+        if ((begin <= iterator.timestamp) && (iterator.timestamp <= end)) {
+            searching = Report(&iterator.cursor, iterator.index, iterator.timestamp, context);
             count++;
         }
-        eepromOffset += EVENT_OVERHEAD + event.len;
-        index++;
     }
 #if EVENT_CB_CLOSING_CALL
     (void)sEventCb(0, -1, 0, EVENT_CB_CLOSING_INDEX, 0, context);
@@ -329,22 +1417,39 @@ unsigned int Event_GetByTag(uint8_t tag, uint32_t context)
 #if EVENT_CB_OPENING_CALL
     searching = sEventCb(0, -1, 0, EVENT_CB_OPENING_INDEX, 0, context);
 #endif
-    int eepromOffset = EEPROM_ABSOLUTE_FIRST_BYTE_OFFSET;
-    uint32_t timestamp = sMeta.baseTimestamp;
-    unsigned int index = 0;
+    unsigned int lastIndex = UINT_MAX;
     unsigned int count = 0;
-    EVENT_T event;
+    ITERATOR_T iterator;
 
-    while (searching && (eepromOffset < sMeta.nextFreeOffset)) {
-        Chip_EEPROM_Read(NSS_EEPROM, eepromOffset, &event, EVENT_OVERHEAD);
-        timestamp += RESTORE_TIMESTAMP(event.deltaTimestamp);
-        if (tag == event.tag) {
-            int offset = event.len ? (eepromOffset + EVENT_OVERHEAD) : -1;
-            searching = sEventCb(event.tag, offset, event.len, index, timestamp, context);
+    StartIterator(&iterator, false, 0);
+#if EVENT_TAG_INDEX_COUNT
+    if (tag < EVENT_TAG_INDEX_COUNT) {
+        /* Only traverse the events from the first up to the last one with this tag. */
+        const TAG_ENTRY_T * pEntry = &sMeta.tags[tag];
+        if (pEntry->firstOffset == 0xFFFF) {
+            StartInEeprom(&iterator, FIRST_EVENT_OFFSET, 0, 0, 0);
+        }
+#if EVENT_ARCHIVE_FLASH_FIRST_PAGE
+        else if (pEntry->firstOffset & TAG_ARCHIVED) {
+            StartIterator(&iterator, false, pEntry->firstIndex);
+        }
+#endif
+        else {
+            EVENT_T event;
+            Chip_EEPROM_Read(NSS_EEPROM, pEntry->firstOffset, &event, EVENT_OVERHEAD);
+            StartInEeprom(&iterator, pEntry->firstOffset,
+                          GetDistance(pEntry->lastOffset) + 1 - GetDistance(pEntry->firstOffset),
+                          RESTORE_INDEX(pEntry->firstIndex),
+                          pEntry->firstTimestamp - RESTORE_TIMESTAMP(event.deltaTimestamp));
+        }
+        lastIndex = RESTORE_TAG_INDEX(pEntry->lastOffset, pEntry->lastIndex);
+    }
+#endif
+    while (searching && (iterator.nextIndex <= lastIndex) && NextEvent(&iterator)) {
+        if (tag == iterator.cursor.event.tag) {
+            searching = Report(&iterator.cursor, iterator.index, iterator.timestamp, context);
             count++;
         }
-        eepromOffset += EVENT_OVERHEAD + event.len;
-        index++;
     }
 #if EVENT_CB_CLOSING_CALL
     (void)sEventCb(0, -1, 0, EVENT_CB_CLOSING_INDEX, 0, context);
@@ -361,3 +1466,17 @@ bool Event_GetLastByTag(uint8_t tag, int * pOffset, uint8_t * pLen, unsigned int
 {
     return GetFirstOrLastByTag(false, tag, pOffset, pLen, pIndex, pTimestamp);
 }
+
+const void * Event_GetData(void)
+{
+    return sData;
+}
+
+unsigned int Event_GetDroppedCount(void)
+{
+#if EVENT_CIRCULAR
+    return sMeta.firstIndex;
+#else
+    return 0;
+#endif
+}
@@ -31,8 +31,10 @@
  *
  * The event bookkeeping module main purpose is to store sparse but noteworthy events. Only EEPROM is used, and only a
  * limited portion thereof. Events also take considerable space; once the assigned memory is full, no new events can be
- * stored. Typically, only a handful events of each 'type' - each is then given a different tag value is expected to
- * be stored.
+ * stored - unless #EVENT_CIRCULAR is set: the oldest events are then dropped instead; or unless a FLASH region is
+ * assigned using #EVENT_ARCHIVE_FLASH_FIRST_PAGE: the oldest events are then compressed and moved to FLASH instead.
+ * Typically, only a handful events of each 'type' - each is then given a different tag value - is expected to be
+ * stored.
  *
  * Examples are:
  * - Storing configuration, start and stop times.
@@ -57,6 +59,8 @@
  * @par How to use the module
  *  -# First call #Event_Init to prepare the module.
  *  -# After that, at any time, call #Event_Set to append a new event.
+ *  -# When #EVENT_ARCHIVE_FLASH_FIRST_PAGE is set, call #Event_Service regularly - e.g. when an NFC field is present -
+ *      to move the oldest events to FLASH ahead of time.
  *  -# To retrieve data, use one of the #Event_GetByIndex, #Event_GetByTime, or #Event_GetByTag.
  *      The configured callback will be called for each event that matches the given constraints until all memory has
  *      been searched.
@@ -88,8 +92,9 @@
  * @param offset Absolute EEPROM Offset, in bytes, from where to start reading the associated data.
  *  The offset is relative to #EEPROM_START and can be given unmodified as @c offset argument in a call to
  *  #Chip_EEPROM_Read
- *  If this value equals @c -1, it signifies no data was associated with the tag value. The callback still reports
- *  a valid event in that case.
+ *  If this value equals @c -1, it signifies no data was associated with the tag value - or that the event was moved to
+ *  FLASH, see #EVENT_ARCHIVE_FLASH_FIRST_PAGE. The callback still reports a valid event in that case.
+ *  From within the callback, #Event_GetData may provide direct access to the data instead.
  * @param len The size of the associated data pointed at, in bytes.
  * @param index The sequential number of the event. The very first event stored will have index @c 0.
  *  There are two special values, #EVENT_CB_OPENING_INDEX and #EVENT_CB_CLOSING_INDEX, whose usage can be controlled via
@@ -99,6 +104,9 @@
  * @param context The value as given in the call to #Event_GetByIndex, #Event_GetByTime or #Event_GetByTag that
  *  triggered this callback.
  * @note Events are @b always reported ordered by time: the oldest events are always reported first.
+ * @warning When #EVENT_ARCHIVE_FLASH_FIRST_PAGE is set, the events moved to FLASH are reported from a buffer shared
+ *  within this module. It is then @b not allowed to call #Event_Set, #Event_Service or any of the functions retrieving
+ *  events during the lifetime of the callback.
  * @return
  *  - @c true to indicate searching must continue;
  *  - @c false to stop searching and end the call to #Event_GetByIndex, #Event_GetByTag or #Event_GetByTime immediately.
@@ -106,6 +114,35 @@
  */
 typedef bool (*pEvent_Cb_t)(uint8_t tag, int offset, uint8_t len, unsigned int index, uint32_t timestamp, uint32_t context);
 
+/**
+ * Whenever events are about to be moved from EEPROM to FLASH, the application is notified via a callback of this
+ * prototype. It then has a chance to compress the events before they are written to FLASH.
+ * @param pIn Points to the events to compress, in SRAM.
+ * @param inSize The number of bytes to compress. At most #EVENT_ARCHIVE_BLOCK_SIZE.
+ * @param pOut Points to SRAM where the compressed events must be stored. No alignment is guaranteed.
+ * @param outSize The size of the buffer pointed to by @c pOut: equal to @c inSize.
+ * @return The size in bytes of the compressed events. When @c 0 is returned, or a value bigger than or equal to
+ *  @c inSize, the events are stored uncompressed instead, and the decompression callback of type
+ *  #pEvent_DecompressCb_t will not be called when retrieving these events later.
+ * @warning It is @b not allowed to call any function of this module during the lifetime of the callback.
+ * @see EVENT_ARCHIVE_COMPRESS_CB
+ */
+typedef int (*pEvent_CompressCb_t)(const uint8_t * pIn, int inSize, uint8_t * pOut, int outSize);
+
+/**
+ * Whenever compressed events are retrieved from FLASH, the application is notified via a callback of this prototype.
+ * It must then decompress them.
+ * @param pIn Points to the compressed events, directly in FLASH.
+ * @param inSize The number of bytes to decompress: the value returned by the callback of type #pEvent_CompressCb_t.
+ * @param pOut Points to SRAM where the decompressed events must be stored. No alignment is guaranteed.
+ * @param outSize The size of the buffer pointed to by @c pOut: #EVENT_ARCHIVE_BLOCK_SIZE.
+ * @return The size in bytes of the decompressed events. Any value different from the @c inSize argument given to the
+ *  compression callback indicates a failure: the events in the block can then @b not be retrieved any more.
+ * @warning It is @b not allowed to call any function of this module during the lifetime of the callback.
+ * @see EVENT_ARCHIVE_DECOMPRESS_CB
+ */
+typedef int (*pEvent_DecompressCb_t)(const uint8_t * pIn, int inSize, uint8_t * pOut, int outSize);
+
 /* ------------------------------------------------------------------------- */
 
 /**
@@ -155,9 +192,31 @@ pEvent_Cb_t Event_SetCb(pEvent_Cb_t cb);
  *  - @c true when the data is stored - possibly not yet flushed - in EEPROM.
  *  - @c false when not enough space was available to store the data.
  *  .
+ * @note When #EVENT_CIRCULAR is set, the oldest events are dropped until enough space is available. @c false is then
+ *  only returned when the data does not fit in the assigned EEPROM region at all.
+ * @note When #EVENT_ARCHIVE_FLASH_FIRST_PAGE is set, the oldest events are moved to FLASH until enough space is
+ *  available. @c false is then only returned when the assigned FLASH region is full as well, or when the event is
+ *  larger than #EVENT_ARCHIVE_BLOCK_SIZE.
+ * @warning When #EVENT_ARCHIVE_FLASH_FIRST_PAGE is set and #Event_Service was not called often enough, this function
+ *  may have to move events to FLASH itself, and then take 100+ milliseconds to complete. #EVENT_ARCHIVE_KEEP_SIZE is
+ *  not honored in that case.
  */
 bool Event_Set(uint8_t tag, void * data, uint8_t len);
 
+/**
+ * Moves the oldest events to FLASH ahead of time, one archive block per call, so that #Event_Set does not have to.
+ * Events are moved while less than twice #EVENT_ARCHIVE_BLOCK_SIZE bytes are free in the assigned EEPROM region; the
+ * newest #EVENT_ARCHIVE_KEEP_SIZE bytes of events are never moved. Events are kept in EEPROM as long as possible: they
+ * can then still be changed - see the @c offset argument of #pEvent_Cb_t.
+ * @pre EEPROM is initialized
+ * @return @c true when more events are to be moved: call this function again.
+ * @note When #EVENT_ARCHIVE_FLASH_FIRST_PAGE is not set, this function does nothing and returns @c false.
+ * @note When moving events fails - the assigned FLASH region is full - this function does not try again until
+ *  #Event_Init is called.
+ * @warning When events are moved, this function will take 100+ milliseconds to complete.
+ */
+bool Event_Service(void);
+
 /**
  * Retrieves events previously stored with a call to #Event_Set.
  * Events are returned one at a time by calling #EVENT_CB repetitively, until no more events match the constraints.
@@ -169,7 +228,8 @@ bool Event_Set(uint8_t tag, void * data, uint8_t len);
  * This is a synchronous function: it only returns after all calls to that callback have finished.
  * @pre EEPROM is initialized
  * @param first : the sequence number of the event to retrieve first.
- *  A value of @c 0 will retrieve the very first event stored.
+ *  A value of @c 0 will retrieve the very first event stored - or the oldest event still stored, when events have
+ *  been dropped: see #EVENT_CIRCULAR.
  * @param last : the sequence number of the event to retrieve last.
  *  - If this value equals @c first, precisely one event will be returned. In this case, the callback will be called
  *      twice: the first time reporting the single matched event, the second time with empty data.
@@ -177,6 +237,8 @@ bool Event_Set(uint8_t tag, void * data, uint8_t len);
  *      called once with empty data.
  * @param context May be any number. Is not stored or looked at, only passed on as last argument in every call to
  *  #EVENT_CB. Use for your own housekeeping, as a means to provide contextual information to the callback.
+ * @note When #EVENT_CHECKPOINT_INTERVAL is set, this function starts scanning at the nearest checkpoint before
+ *  @c first. Scanning always stops after the event with sequence number @c last.
  * @return The number of events reported, not including the possible opening and closing calls.
  * @see pEvent_Cb_t
  */
@@ -201,6 +263,8 @@ unsigned int Event_GetByIndex(unsigned int first, unsigned int last, uint32_t co
  * @note Since the RTC value is used as timestamp, it is possible that events that are stored at a later time have a
  *  timestamp that is smaller than an earlier event. This function will scan @b all events and report @b all those that
  *  have a timestamp between (and including) @c begin and @c end.
+ * @note When #EVENT_CHECKPOINT_INTERVAL is set, timestamps never decrease. This function then starts scanning at the
+ *  nearest checkpoint before @c begin, and stops scanning at the first event with a timestamp later than @c end.
  * @return The number of events reported, not including the possible opening and closing calls.
  * @see pEvent_Cb_t
  */
@@ -220,6 +284,8 @@ unsigned int Event_GetByTime(unsigned int begin, unsigned int end, uint32_t cont
  * @param context May be any number. Is not stored or looked at, only passed on as last argument in every call to
  *  #EVENT_CB. Use for your own housekeeping, as a means to provide contextual information to the callback.
  * @return The number of events reported, not including the possible opening and closing calls.
+ * @note When @c tag is below #EVENT_TAG_INDEX_COUNT, only the events from the first up to the last event with this tag
+ *  are traversed.
  */
 unsigned int Event_GetByTag(uint8_t tag, uint32_t context);
 
@@ -232,6 +298,7 @@ unsigned int Event_GetByTag(uint8_t tag, uint32_t context);
  * @param pIndex : May be @c NULL. Only touched when a matching event is found. See #pEvent_Cb_t
  * @param pTimestamp : May be @c NULL. Only touched when a matching event is found. See #pEvent_Cb_t
  * @return @c true if a matching event was found. If @c false, the arguments have not been written to.
+ * @note When @c tag is below #EVENT_TAG_INDEX_COUNT, the event is found without traversing the stored events.
  */
 bool Event_GetFirstByTag(uint8_t tag, int * pOffset, uint8_t * pLen, unsigned int * pIndex, uint32_t * pTimestamp);
 
@@ -244,7 +311,28 @@ bool Event_GetFirstByTag(uint8_t tag, int * pOffset, uint8_t * pLen, unsigned in
  * @param pIndex : May be @c NULL. Only touched when a matching event is found. See #pEvent_Cb_t
  * @param pTimestamp : May be @c NULL. Only touched when a matching event is found. See #pEvent_Cb_t
  * @return @c true if a matching event was found. If @c false, the arguments have not been written to.
+ * @note When @c tag is below #EVENT_TAG_INDEX_COUNT, the event is found without traversing the stored events.
  */
 bool Event_GetLastByTag(uint8_t tag, int * pOffset, uint8_t * pLen, unsigned int * pIndex, uint32_t * pTimestamp);
 
+/**
+ * Gives direct access to the data associated with the event being reported, avoiding a call to #Chip_EEPROM_Read.
+ * @return A pointer to the @c len bytes of data of the event, in the memory-mapped EEPROM; or @c NULL when the event
+ *  has no associated data, or when it is stored in an EEPROM row that has not been flushed yet - the data must then be
+ *  read using the @c offset argument of the callback. For an event moved to FLASH - see
+ *  #EVENT_ARCHIVE_FLASH_FIRST_PAGE - the pointer is never @c NULL when the event has associated data: this is the only
+ *  way to access it.
+ * @note May only be called from within the callback of type #pEvent_Cb_t, while it reports an event. At any other time,
+ *  @c NULL is returned.
+ * @note The pointer is only valid until the callback returns, and as long as the callback does not write to EEPROM.
+ */
+const void * Event_GetData(void);
+
+/**
+ * Retrieves how many events have been dropped to make room for newer events. This is also the index of the oldest
+ * event that can still be retrieved.
+ * @return Always @c 0, unless #EVENT_CIRCULAR is set and the oldest events have been dropped.
+ */
+unsigned int Event_GetDroppedCount(void);
+
 #endif /** @} */
@@ -23,6 +23,9 @@
  * Additional notes regarding some flags:
  * - By default, the assigned EEPROM region takes up 1KB and is located just below the RO EEPROM rows. This storage
  *  space can be moved and resized by adapting #EVENT_EEPROM_FIRST_ROW and #EVENT_EEPROM_LAST_ROW.
+ * - By default, no FLASH is used. Assigning a FLASH region using #EVENT_ARCHIVE_FLASH_FIRST_PAGE and
+ *  #EVENT_ARCHIVE_FLASH_LAST_PAGE allows the EEPROM region to be much smaller: the oldest events are then moved to
+ *  FLASH when the EEPROM region is full.
  * .
  *
  * These flags may be overridden/set:
@@ -32,6 +35,15 @@
  * - #EVENT_CB_OPENING_CALL
  * - #EVENT_CB_CLOSING_CALL
  * - #EVENT_OVERHEAD_CHOICE
+ * - #EVENT_TAG_INDEX_COUNT
+ * - #EVENT_CHECKPOINT_INTERVAL
+ * - #EVENT_CIRCULAR
+ * - #EVENT_ARCHIVE_FLASH_FIRST_PAGE
+ * - #EVENT_ARCHIVE_FLASH_LAST_PAGE
+ * - #EVENT_ARCHIVE_BLOCK_SIZE
+ * - #EVENT_ARCHIVE_KEEP_SIZE
+ * - #EVENT_ARCHIVE_COMPRESS_CB
+ * - #EVENT_ARCHIVE_DECOMPRESS_CB
  * .
  *
  * These defines are fixed or derived from the above flags and may not be defined or redefined in an application:
@@ -222,4 +234,171 @@
     #define EVENT_OVERHEAD 6
 #endif
 
+#ifndef EVENT_TAG_INDEX_COUNT
+    /**
+     * By default, finding the first or last event with a given tag requires a walk over all stored events.
+     * Define this to a value @c N to keep track of the first and the last event of each of the tags in the range
+     * [0, N[: #Event_GetFirstByTag and #Event_GetLastByTag then no longer walk over the events for these tags, and
+     * #Event_GetByTag only walks from the first to the last event with the given tag.
+     * @note This costs 16 bytes of EEPROM - taken from the region assigned to this module - and 16 bytes of SRAM per
+     *  tag, plus 2 extra bytes of each.
+     * @note The table is kept up to date in SRAM and only written to EEPROM in #Event_DeInit, together with the other
+     *  meta information.
+     */
+    #define EVENT_TAG_INDEX_COUNT 0
+#endif
+#if (EVENT_TAG_INDEX_COUNT < 0) || (EVENT_TAG_INDEX_COUNT > 255)
+    #error EVENT_TAG_INDEX_COUNT must be in the range [0, 255]
+#endif
+
+#ifndef EVENT_CHECKPOINT_INTERVAL
+    /**
+     * By default, #Event_GetByIndex and #Event_GetByTime walk over the stored events starting from the very first one.
+     * Define this to a value @c N to store a checkpoint - the location and the full timestamp - for every @c N th
+     * event: both functions then look up the nearest checkpoint - #Event_GetByTime using a binary search - and only walk
+     * over the events from there on.
+     * @note This costs 6 bytes of EEPROM per checkpoint - taken from the region assigned to this module - for the
+     *  maximum number of events that fit in the assigned EEPROM region, divided by @c N.
+     * @note Checkpoints are written to EEPROM in #Event_Set.
+     * @note When the RTC value is found to be earlier than the timestamp of the previous event, #Event_Set stores the
+     *  new event with the timestamp of the previous event instead. This guarantees that timestamps never decrease.
+     */
+    #define EVENT_CHECKPOINT_INTERVAL 0
+#endif
+#if (EVENT_CHECKPOINT_INTERVAL < 0) || (EVENT_CHECKPOINT_INTERVAL == 1) || (EVENT_CHECKPOINT_INTERVAL > 255)
+    #error EVENT_CHECKPOINT_INTERVAL must be 0 or in the range [2, 255]
+#endif
+
+#ifndef EVENT_CIRCULAR
+    /**
+     * - If not defined, or defined to zero, no more events can be stored once the assigned EEPROM region is full:
+     *  #Event_Set then returns @c false.
+     * - If defined to a non-zero value, the assigned EEPROM region is used as a ring buffer: the oldest events are
+     *  dropped to make room for new ones, and storing never stops. The newest events are kept.
+     * .
+     * Events keep their index: the event stored first has index @c 0, also after it has been dropped. Use
+     * #Event_GetDroppedCount to know the index of the oldest event that can still be retrieved.
+     * @note This costs 8 bytes of EEPROM - taken from the region assigned to this module - and 8 bytes of SRAM.
+     * @note When the first event with a tag indexed by #EVENT_TAG_INDEX_COUNT is dropped, #Event_Set searches for the
+     *  next event with that tag.
+     * @note Each time #Event_Set drops events, it also stores the meta information and flushes the EEPROM before
+     *  overwriting them. This keeps the stored events consistent when a reset occurs before #Event_DeInit is called, at
+     *  the cost of an extra EEPROM row program per call once the ring buffer is full.
+     */
+    #define EVENT_CIRCULAR 0
+#endif
+
+#ifndef EVENT_ARCHIVE_FLASH_FIRST_PAGE
+    /**
+     * The first FLASH page assigned for archiving events. Starting from the first byte in this page, until the last
+     * byte in #EVENT_ARCHIVE_FLASH_LAST_PAGE, the event bookkeeping module has full control: no other code may touch
+     * this FLASH region.
+     * - If not defined, or defined to zero, no events are archived.
+     * - Otherwise, when the assigned EEPROM region is nearly full, the oldest events are compressed - see
+     *  #EVENT_ARCHIVE_COMPRESS_CB - and moved to FLASH in blocks, making room for new events. #Event_Set then only
+     *  returns @c false when the assigned FLASH region is full as well.
+     * .
+     * Archived events are retrieved transparently: #Event_GetByIndex, #Event_GetByTime, #Event_GetByTag,
+     * #Event_GetFirstByTag and #Event_GetLastByTag report them exactly as the events still stored in EEPROM - except
+     * for the @c offset, which is then @c -1: use #Event_GetData to access their data.
+     * @note This costs 10 bytes of EEPROM - taken from the region assigned to this module - and 10 bytes of SRAM, plus
+     *  the buffer described at #EVENT_ARCHIVE_BLOCK_SIZE.
+     * @note Archived events can no longer be changed. At most @c 65536 events are archived.
+     * @note Moving events to FLASH is done in #Event_Service, which then takes 100+ milliseconds. Only when that
+     *  function is not called often enough, #Event_Set does so itself.
+     * @warning It is the responsibility of the application programmer to ensure the FLASH region points to outside the
+     *  @c .text and @c .data sections, and does not overlap with the FLASH region of the storage module, if used.
+     */
+    #define EVENT_ARCHIVE_FLASH_FIRST_PAGE 0
+#endif
+#if !(EVENT_ARCHIVE_FLASH_FIRST_PAGE >= 0) \
+        || (EVENT_ARCHIVE_FLASH_FIRST_PAGE >= FLASH_NR_OF_RW_SECTORS * FLASH_PAGES_PER_SECTOR)
+    #error Invalid value for EVENT_ARCHIVE_FLASH_FIRST_PAGE
+#endif
+
+#ifndef EVENT_ARCHIVE_FLASH_LAST_PAGE
+    /**
+     * The last FLASH page assigned for archiving events. Starting from the first byte in
+     * #EVENT_ARCHIVE_FLASH_FIRST_PAGE, until the last byte in this page, the event bookkeeping module has full control:
+     * no other code may touch this FLASH region.
+     * @note By default, the region ends at the last FLASH page that can be written.
+     */
+    #define EVENT_ARCHIVE_FLASH_LAST_PAGE (FLASH_NR_OF_RW_SECTORS * FLASH_PAGES_PER_SECTOR - 1)
+#endif
+#if (EVENT_ARCHIVE_FLASH_LAST_PAGE < EVENT_ARCHIVE_FLASH_FIRST_PAGE) \
+        || (EVENT_ARCHIVE_FLASH_LAST_PAGE >= FLASH_NR_OF_RW_SECTORS * FLASH_PAGES_PER_SECTOR)
+    #error Invalid value for EVENT_ARCHIVE_FLASH_LAST_PAGE
+#endif
+
+#if EVENT_ARCHIVE_FLASH_FIRST_PAGE && EVENT_CIRCULAR
+    #error EVENT_CIRCULAR can not be combined with EVENT_ARCHIVE_FLASH_FIRST_PAGE
+#endif
+
+#ifndef EVENT_ARCHIVE_BLOCK_SIZE
+    /**
+     * The maximum number of bytes of events - each including #EVENT_OVERHEAD - that are compressed together and
+     * stored as one block in FLASH. Each time a block is moved, the oldest events are gathered until this size is
+     * reached. Larger blocks compress better and leave less unused space in their last FLASH page.
+     * @note Only used when #EVENT_ARCHIVE_FLASH_FIRST_PAGE is set.
+     * @note #Event_Set returns @c false for an event larger than this size.
+     * @note A single buffer of about twice this value is statically allocated in SRAM. It is used both to move events
+     *  to FLASH and to decompress archived events while retrieving them.
+     * @note Since #Event_Service moves events while less than twice this value is free, the assigned EEPROM region must
+     *  be able to hold at least three times this value of events, plus #EVENT_ARCHIVE_KEEP_SIZE. This is verified at
+     *  compile time.
+     */
+    #define EVENT_ARCHIVE_BLOCK_SIZE 256
+#endif
+#if (EVENT_ARCHIVE_BLOCK_SIZE < 64) || (EVENT_ARCHIVE_BLOCK_SIZE > 1024)
+    #error EVENT_ARCHIVE_BLOCK_SIZE must be in the range [64, 1024]
+#endif
+
+#ifndef EVENT_ARCHIVE_KEEP_SIZE
+    /**
+     * The number of bytes of the newest events - each including #EVENT_OVERHEAD - that #Event_Service never moves to
+     * FLASH. Events still stored in EEPROM can be changed - see the @c offset argument of #pEvent_Cb_t: set this to the
+     * size of the events an application may store while it still has to change an earlier event.
+     * @note Only used when #EVENT_ARCHIVE_FLASH_FIRST_PAGE is set.
+     * @note When #Event_Set has to move events to FLASH itself, because the assigned EEPROM region is full, this value
+     *  is not honored.
+     */
+    #define EVENT_ARCHIVE_KEEP_SIZE 0
+#endif
+#if EVENT_ARCHIVE_KEEP_SIZE < 0
+    #error EVENT_ARCHIVE_KEEP_SIZE can not be negative
+#endif
+
+#ifdef EVENT_ARCHIVE_COMPRESS_CB
+    #undef EVENT_ARCHIVE_COMPRESS_CB_SELF_DEFINED
+#else
+    /**
+     * Used internally to know when to use a dummy callback for this.
+     * @internal
+     */
+    #define EVENT_ARCHIVE_COMPRESS_CB_SELF_DEFINED 1
+    /**
+     * The name of the function - @b not a function pointer - of type #pEvent_CompressCb_t that is able to compress a
+     * block of events before it is moved to FLASH.
+     * @note When not overridden, the default behavior is to store the events uncompressed.
+     * @note Only used when #EVENT_ARCHIVE_FLASH_FIRST_PAGE is set.
+     */
+    #define EVENT_ARCHIVE_COMPRESS_CB Event_DummyCompressCb
+#endif
+
+#ifdef EVENT_ARCHIVE_DECOMPRESS_CB
+    #undef EVENT_ARCHIVE_DECOMPRESS_CB_SELF_DEFINED
+#else
+    /**
+     * Used internally to know when to use a dummy callback for this.
+     * @internal
+     */
+    #define EVENT_ARCHIVE_DECOMPRESS_CB_SELF_DEFINED 1
+    /**
+     * The name of the function - @b not a function pointer - of type #pEvent_DecompressCb_t that is able to
+     * decompress a block of events compressed by #EVENT_ARCHIVE_COMPRESS_CB.
+     * @note Only used when #EVENT_ARCHIVE_FLASH_FIRST_PAGE is set.
+     */
+    #define EVENT_ARCHIVE_DECOMPRESS_CB Event_DummyDecompressCb
+#endif
+
 #endif /** @} */
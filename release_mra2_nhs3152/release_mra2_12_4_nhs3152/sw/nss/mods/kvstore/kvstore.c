@@ -0,0 +1,345 @@
+/*
+ * Copyright 2020 NXP
+ * This software is owned or controlled by NXP and may only be used strictly
+ * in accordance with the applicable license terms.  By expressly accepting
+ * such terms or by downloading, installing, activating and/or otherwise using
+ * the software, you are agreeing that you have read, and that you agree to
+ * comply with and are bound by, such license terms.  If you do not agree to
+ * be bound by the applicable license terms, then you may not retain, install,
+ * activate or otherwise use the software.
+ */
+
+#include <string.h>
+#include "chip.h"
+#include "kvstore.h"
+
+/**
+ * @file
+ *
+ *  @par Storage model
+ *      The assigned EEPROM region is split in two halves of equal size. One half is active: it starts with a
+ *      #Header_t instance, followed by a log of records. Each record consists of:
+ *      - 1 byte: the key.
+ *      - 1 byte: the size of the value in bytes, or #TOMBSTONE when the value was removed.
+ *      - the value, if any.
+ *      - 2 bytes: a CRC-16 over the epoch of the half, the key, the size and the value.
+ *      .
+ *      The newest record of a key holds its value. The log ends just before the first record that is not valid.
+ *
+ *  @par Compaction
+ *      When a record does not fit anymore, the newest record of each key is copied to the other half, using an epoch
+ *      one higher than the epoch of the active half. The record that did not fit is written there as part of the copy.
+ *      Only when all records are copied and flushed, the header of the other half is written: from then on, it is the
+ *      active half. #KvStore_Init selects the half with the highest epoch as the active one. Because the epoch is
+ *      taken into the CRC, records that are left in a half from before its last compaction are never mistaken for
+ *      valid ones.
+ */
+
+/* Check the regions of the other modules - as far as they are configured by the application - for overlap. */
+#define KVSTORE_OVERLAPS(first, last) (((first) <= KVSTORE_EEPROM_LAST_ROW) && ((last) >= KVSTORE_EEPROM_FIRST_ROW))
+#if defined(EVENT_EEPROM_FIRST_ROW) && defined(EVENT_EEPROM_LAST_ROW)
+    #if KVSTORE_OVERLAPS(EVENT_EEPROM_FIRST_ROW, EVENT_EEPROM_LAST_ROW)
+        #error KVSTORE_EEPROM_FIRST_ROW: the key/value store overlaps with the EEPROM region of the event module
+    #endif
+#endif
+#if defined(STORAGE_EEPROM_FIRST_ROW) && defined(STORAGE_EEPROM_LAST_ROW)
+    #if KVSTORE_OVERLAPS(STORAGE_EEPROM_FIRST_ROW, STORAGE_EEPROM_LAST_ROW)
+        #error KVSTORE_EEPROM_FIRST_ROW: the key/value store overlaps with the EEPROM region of the storage module
+    #endif
+#endif
+#if defined(ROLLUP_EEPROM_FIRST_ROW) && defined(ROLLUP_EEPROM_LAST_ROW)
+    #if KVSTORE_OVERLAPS(ROLLUP_EEPROM_FIRST_ROW, ROLLUP_EEPROM_LAST_ROW)
+        #error KVSTORE_EEPROM_FIRST_ROW: the key/value store overlaps with the EEPROM region of the rollup module
+    #endif
+#endif
+#if ENABLE_DIAG_MODULE && DIAG_TRACK_WEAR
+    #if KVSTORE_OVERLAPS(DIAG_WEAR_EEPROM_FIRST_ROW, DIAG_WEAR_EEPROM_FIRST_ROW + (512 / EEPROM_ROW_SIZE) - 1)
+        #error KVSTORE_EEPROM_FIRST_ROW: the key/value store overlaps with the wear counters of the diag module
+    #endif
+#endif
+
+/** The size in bytes of one half of the assigned EEPROM region. */
+#define HALF_SIZE ((KVSTORE_EEPROM_ROW_COUNT / 2) * EEPROM_ROW_SIZE)
+
+/** The absolute offset to the very first byte of half @c half, which is either @c 0 or @c 1. */
+#define HALF_ABSOLUTE_BYTE_OFFSET(half) ((KVSTORE_EEPROM_FIRST_ROW * EEPROM_ROW_SIZE) + ((half) * HALF_SIZE))
+
+/** The number of bytes stored in each record on top of the value: the key, the size and the CRC. */
+#define RECORD_OVERHEAD 4
+
+/** The special size value indicating the value of the key has been removed. Such a record carries no value. */
+#define TOMBSTONE 0xFF
+
+/* ------------------------------------------------------------------------- */
+
+/** Stored at the start of each half. */
+typedef struct Header_s {
+    /** Incremented with each compaction. The valid header with the highest epoch indicates the active half. */
+    uint16_t epoch;
+
+    /** The bitwise inverse of @c epoch. Used to validate this structure. */
+    uint16_t inverseEpoch;
+} Header_t;
+
+/** Describes where the value of a key is stored. */
+typedef struct Entry_s {
+    /** The absolute offset in EEPROM to the first byte of the value, or @c 0 when no value is stored for the key. */
+    uint16_t offset;
+
+    /** The size of the value in bytes. */
+    uint8_t size;
+} Entry_t;
+
+/* ------------------------------------------------------------------------- */
+
+/** The half holding the log in use: @c 0 or @c 1. */
+__attribute__ ((section(".noinit")))
+static int sHalf;
+
+/** The epoch of the active half. @see Header_t */
+__attribute__ ((section(".noinit")))
+static uint16_t sEpoch;
+
+/** The absolute offset in EEPROM where the next record is to be written. */
+__attribute__ ((section(".noinit")))
+static int sNextFreeOffset;
+
+/** For each key, where its value can be found in EEPROM. */
+__attribute__ ((section(".noinit")))
+static Entry_t sIndex[KVSTORE_KEY_COUNT];
+
+/* ------------------------------------------------------------------------- */
+
+static uint16_t CalculateCrc(uint16_t crc, const uint8_t * pData, int length);
+static bool ReadHeader(int half, uint16_t * pEpoch);
+static int WriteRecord(int offset, uint16_t epoch, int key, const void * pValue, int size);
+static void ReadLog(void);
+static void Compact(int replaceKey, const void * pValue, int size);
+
+/* ------------------------------------------------------------------------- */
+
+/**
+ * Calculates a CRC-16 using the CCITT polynomial @c 0x1021.
+ * @param crc The initial value: @c 0xFFFF to start a new calculation, or the value returned by a previous call to
+ *  continue it.
+ * @param pData May not be @c NULL. The bytes to calculate the CRC over.
+ * @param length The number of bytes in @c pData.
+ * @return The calculated CRC.
+ */
+static uint16_t CalculateCrc(uint16_t crc, const uint8_t * pData, int length)
+{
+    for (int i = 0; i < length; i++) {
+        crc = (uint16_t)(crc ^ (pData[i] << 8));
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (uint16_t)((crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1));
+        }
+    }
+    return crc;
+}
+
+/**
+ * Reads the header of a half.
+ * @param half @c 0 or @c 1.
+ * @param [out] pEpoch : May not be @c NULL. The epoch of the half is written here.
+ * @return @c true when the header is valid.
+ */
+static bool ReadHeader(int half, uint16_t * pEpoch)
+{
+    Header_t header;
+    Chip_EEPROM_Read(NSS_EEPROM, HALF_ABSOLUTE_BYTE_OFFSET(half), &header, sizeof(Header_t));
+    *pEpoch = header.epoch;
+    return (header.epoch ^ header.inverseEpoch) == 0xFFFF;
+}
+
+/**
+ * Writes a record to EEPROM.
+ * @param offset The absolute offset in EEPROM where to write the record.
+ * @param epoch The epoch of the half the record is written in.
+ * @param key The key.
+ * @param pValue : May be @c NULL when @c size is @c 0 or #TOMBSTONE.
+ * @param size The size of the value in bytes, or #TOMBSTONE.
+ * @return The number of bytes written.
+ */
+static int WriteRecord(int offset, uint16_t epoch, int key, const void * pValue, int size)
+{
+    uint8_t record[RECORD_OVERHEAD + KVSTORE_MAX_VALUE_SIZE];
+    const int valueSize = (size == TOMBSTONE) ? 0 : size;
+    const uint8_t epochBytes[2] = {(uint8_t)(epoch & 0xFF), (uint8_t)((epoch >> 8) & 0xFF)};
+
+    record[0] = (uint8_t)key;
+    record[1] = (uint8_t)size;
+    if (valueSize > 0) {
+        memcpy(record + 2, pValue, (size_t)valueSize);
+    }
+    uint16_t crc = CalculateCrc(CalculateCrc(0xFFFF, epochBytes, 2), record, 2 + valueSize);
+    record[2 + valueSize] = (uint8_t)(crc & 0xFF);
+    record[3 + valueSize] = (uint8_t)((crc >> 8) & 0xFF);
+    Chip_EEPROM_Write(NSS_EEPROM, offset, record, RECORD_OVERHEAD + valueSize);
+    return RECORD_OVERHEAD + valueSize;
+}
+
+/**
+ * Builds the index by walking over the log of the active half, up to the first record that is not valid.
+ * @post #sIndex and #sNextFreeOffset are fully updated.
+ */
+static void ReadLog(void)
+{
+    const uint8_t epochBytes[2] = {(uint8_t)(sEpoch & 0xFF), (uint8_t)((sEpoch >> 8) & 0xFF)};
+    const uint16_t epochCrc = CalculateCrc(0xFFFF, epochBytes, 2);
+    const int end = HALF_ABSOLUTE_BYTE_OFFSET(sHalf) + HALF_SIZE;
+    int offset = HALF_ABSOLUTE_BYTE_OFFSET(sHalf) + (int)sizeof(Header_t);
+    bool valid = true;
+
+    memset(sIndex, 0, sizeof(sIndex));
+    while (valid && (offset + RECORD_OVERHEAD <= end)) {
+        uint8_t record[RECORD_OVERHEAD + KVSTORE_MAX_VALUE_SIZE];
+        Chip_EEPROM_Read(NSS_EEPROM, offset, record, 2);
+        const int key = record[0];
+        const int valueSize = (record[1] == TOMBSTONE) ? 0 : record[1];
+        valid = (key < KVSTORE_KEY_COUNT) && (valueSize <= KVSTORE_MAX_VALUE_SIZE)
+                && (offset + RECORD_OVERHEAD + valueSize <= end);
+        if (valid) {
+            Chip_EEPROM_Read(NSS_EEPROM, offset + 2, record + 2, valueSize + 2);
+            uint16_t crc = (uint16_t)(record[2 + valueSize] | (record[3 + valueSize] << 8));
+            valid = (crc == CalculateCrc(epochCrc, record, 2 + valueSize));
+        }
+        if (valid) {
+            sIndex[key].offset = (uint16_t)((record[1] == TOMBSTONE) ? 0 : offset + 2);
+            sIndex[key].size = (uint8_t)valueSize;
+            offset += RECORD_OVERHEAD + valueSize;
+        }
+    }
+    sNextFreeOffset = offset;
+}
+
+/**
+ * Copies the newest value of each key to the other half, and makes that half the active one.
+ * @param replaceKey The value of this key is not copied: @c pValue is written instead, as part of the same compaction.
+ *  Use @c -1 to copy all.
+ * @param pValue : May be @c NULL when @c size is @c 0 or #TOMBSTONE. The new value for @c replaceKey.
+ * @param size The size of @c pValue in bytes, or #TOMBSTONE to remove the value of @c replaceKey.
+ * @post Either all values as they were before, or all values including the new value of @c replaceKey are retained,
+ *  even when the compaction is interrupted by a power loss.
+ * @post #sIndex, #sHalf, #sEpoch and #sNextFreeOffset are fully updated.
+ */
+static void Compact(int replaceKey, const void * pValue, int size)
+{
+    const int half = 1 - sHalf;
+    const uint16_t epoch = (uint16_t)(sEpoch + 1);
+    int offset = HALF_ABSOLUTE_BYTE_OFFSET(half) + (int)sizeof(Header_t);
+
+    for (int key = 0; key < KVSTORE_KEY_COUNT; key++) {
+        if ((key == replaceKey) && (size != TOMBSTONE)) {
+            sIndex[key].offset = (uint16_t)(offset + 2);
+            sIndex[key].size = (uint8_t)size;
+            offset += WriteRecord(offset, epoch, key, pValue, size);
+        }
+        else if ((key != replaceKey) && (sIndex[key].offset != 0)) {
+            uint8_t value[KVSTORE_MAX_VALUE_SIZE];
+            if (sIndex[key].size > 0) {
+                Chip_EEPROM_Read(NSS_EEPROM, sIndex[key].offset, value, sIndex[key].size);
+            }
+            sIndex[key].offset = (uint16_t)(offset + 2);
+            offset += WriteRecord(offset, epoch, key, value, sIndex[key].size);
+        }
+        else {
+            sIndex[key].offset = 0;
+        }
+    }
+
+    /* Only activate the new half when all records - including the new value - have been retained. */
+    Chip_EEPROM_Flush(NSS_EEPROM, true);
+    Header_t header = {.epoch = epoch, .inverseEpoch = (uint16_t)~epoch};
+    Chip_EEPROM_Write(NSS_EEPROM, HALF_ABSOLUTE_BYTE_OFFSET(half), &header, sizeof(Header_t));
+    Chip_EEPROM_Flush(NSS_EEPROM, true);
+
+    sHalf = half;
+    sEpoch = epoch;
+    sNextFreeOffset = offset;
+}
+
+/* ------------------------------------------------------------------------- */
+
+void KvStore_Init(void)
+{
+    uint16_t epoch0;
+    uint16_t epoch1;
+    bool valid0 = ReadHeader(0, &epoch0);
+    bool valid1 = ReadHeader(1, &epoch1);
+
+    if (!valid0 && !valid1) {
+        /* Nothing stored yet. Make sure the header of half 1 stays invalid, then start using half 0. */
+        Header_t header = {.epoch = 0, .inverseEpoch = 0};
+        Chip_EEPROM_Write(NSS_EEPROM, HALF_ABSOLUTE_BYTE_OFFSET(1), &header, sizeof(Header_t));
+        sHalf = 1;
+        sEpoch = 0xFFFF;
+        KvStore_Reset();
+    }
+    else {
+        sHalf = (valid1 && (!valid0 || ((int16_t)(epoch1 - epoch0) > 0))) ? 1 : 0;
+        sEpoch = sHalf ? epoch1 : epoch0;
+        ReadLog();
+    }
+}
+
+void KvStore_Reset(void)
+{
+    memset(sIndex, 0, sizeof(sIndex));
+    Compact(-1, NULL, 0);
+}
+
+int KvStore_Get(int key, void * pValue, int size)
+{
+    int storedSize = -1;
+    if ((key >= 0) && (key < KVSTORE_KEY_COUNT) && (sIndex[key].offset != 0)) {
+        storedSize = sIndex[key].size;
+        if ((size > 0) && (storedSize > 0)) {
+            Chip_EEPROM_Read(NSS_EEPROM, sIndex[key].offset, pValue, (size < storedSize) ? size : storedSize);
+        }
+    }
+    return storedSize;
+}
+
+bool KvStore_Set(int key, const void * pValue, int size)
+{
+    bool success = (key >= 0) && (key < KVSTORE_KEY_COUNT) && (size >= 0) && (size <= KVSTORE_MAX_VALUE_SIZE);
+    bool unchanged = false;
+    if (success && (sIndex[key].offset != 0) && (sIndex[key].size == size)) {
+        /* Avoid wearing out the EEPROM when the value is not changed. */
+        unchanged = true;
+        if (size > 0) {
+            uint8_t value[KVSTORE_MAX_VALUE_SIZE];
+            Chip_EEPROM_Read(NSS_EEPROM, sIndex[key].offset, value, size);
+            unchanged = (memcmp(value, pValue, (size_t)size) == 0);
+        }
+    }
+    if (success && !unchanged) {
+        if (sNextFreeOffset + RECORD_OVERHEAD + size > HALF_ABSOLUTE_BYTE_OFFSET(sHalf) + HALF_SIZE) {
+            /* Written before the new half is activated: a power loss can not lose the value stored before.
+             * Guaranteed to fit: see the checks in kvstore_dft.h.
+             */
+            Compact(key, pValue, size);
+        }
+        else {
+            sIndex[key].offset = (uint16_t)(sNextFreeOffset + 2);
+            sIndex[key].size = (uint8_t)size;
+            sNextFreeOffset += WriteRecord(sNextFreeOffset, sEpoch, key, pValue, size);
+        }
+    }
+    return success;
+}
+
+bool KvStore_Delete(int key)
+{
+    bool success = (key >= 0) && (key < KVSTORE_KEY_COUNT);
+    if (success && (sIndex[key].offset != 0)) {
+        if (sNextFreeOffset + RECORD_OVERHEAD > HALF_ABSOLUTE_BYTE_OFFSET(sHalf) + HALF_SIZE) {
+            Compact(key, NULL, TOMBSTONE); /* The value is not copied: no need to write a tombstone anymore. */
+        }
+        else {
+            sIndex[key].offset = 0;
+            sNextFreeOffset += WriteRecord(sNextFreeOffset, sEpoch, key, NULL, TOMBSTONE);
+        }
+    }
+    return success;
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2020 NXP
+ * This software is owned or controlled by NXP and may only be used strictly
+ * in accordance with the applicable license terms.  By expressly accepting
+ * such terms or by downloading, installing, activating and/or otherwise using
+ * the software, you are agreeing that you have read, and that you agree to
+ * comply with and are bound by, such license terms.  If you do not agree to
+ * be bound by the applicable license terms, then you may not retain, install,
+ * activate or otherwise use the software.
+ */
+
+#ifndef __KVSTORE_H_
+#define __KVSTORE_H_
+
+/**
+ * @defgroup MODS_NSS_KVSTORE kvstore: log-structured key/value store in EEPROM
+ * @ingroup MODS_NSS
+ * The key/value store module allows an application to persist small configuration values - settings, calibration
+ * data, counters that change rarely - without having to define and maintain its own EEPROM layout.
+ *
+ * It will:
+ * - identify each value by a small integer key, in the range [0, #KVSTORE_KEY_COUNT[.
+ * - never overwrite a value in place: each change appends a small record - key, size, value and CRC - to a log in the
+ *  assigned EEPROM region. Successive changes thus spread over all rows of the region, instead of wearing out the
+ *  same row over and over again.
+ * - keep an index in RAM, which is rebuilt in #KvStore_Init using a single linear pass over the log: a value is
+ *  looked up without searching.
+ * - compact the log when it is full: the newest value of each key is copied to the other half of the region, after
+ *  which that half becomes the active one.
+ * - skip writing a value when it is equal to the value already stored.
+ * .
+ *
+ * A record that was only partially written, due to a power loss, fails its CRC check: it is ignored in
+ * #KvStore_Init, together with everything that follows it. A compaction only takes effect once the copy has completed:
+ * a power loss during a compaction leaves the values as they were before.
+ *
+ * @par Diversity
+ *  This module supports diversity settings: the EEPROM region placed under control of this module, the number of keys
+ *  and the maximum size of a value. Check @ref MODS_NSS_KVSTORE_DFT for all diversity parameters.
+ *
+ * @par How to use the module
+ *  -# First call #KvStore_Init to prepare the module.
+ *  -# Use #KvStore_Get, #KvStore_Set and #KvStore_Delete to access the values.
+ *  -# Call #KvStore_Reset to remove all values.
+ *  -# Call #Chip_EEPROM_Flush or #Chip_EEPROM_DeInit before going to Deep power down or Power-off mode, to ensure the
+ *      written values are retained.
+ *  .
+ *
+ * @{
+ */
+
+#include "board.h"
+#include "kvstore_dft.h"
+
+/* ------------------------------------------------------------------------- */
+
+/**
+ * This function must be the first function to call in this module after going to deep power down or power-off power
+ * save mode. Reads the log in EEPROM and builds the index in RAM. When no valid log is found - e.g. the very first time
+ * - the module starts with no values stored.
+ * @pre EEPROM is initialized and is ready to be used.
+ */
+void KvStore_Init(void);
+
+/**
+ * Removes all values.
+ * @pre EEPROM is initialized and is ready to be used.
+ */
+void KvStore_Reset(void);
+
+/**
+ * Retrieves the value stored for a key.
+ * @param key The key to look up.
+ * @param [out] pValue : May be @c NULL when @c size is @c 0. Up to @c size bytes of the value are copied here.
+ * @param size The size of the buffer pointed to by @c pValue.
+ * @return The size of the stored value - which may be larger than @c size - or @c -1 when no value is stored for
+ *  @c key, or when @c key is not valid.
+ */
+int KvStore_Get(int key, void * pValue, int size);
+
+/**
+ * Stores a value for a key, replacing the value stored before. When the log is full, it is compacted first.
+ * @param key The key to store a value for. Must be in the range [0, #KVSTORE_KEY_COUNT[.
+ * @param pValue : May be @c NULL when @c size is @c 0. Points to the value to store.
+ * @param size The size of the value in bytes. Must be in the range [0, #KVSTORE_MAX_VALUE_SIZE].
+ * @return @c true when the value is stored - or was already stored; @c false when @c key or @c size is not valid.
+ * @note A later call to #Chip_EEPROM_Flush or #Chip_EEPROM_DeInit is necessary to ensure the value is retained.
+ */
+bool KvStore_Set(int key, const void * pValue, int size);
+
+/**
+ * Removes the value stored for a key.
+ * @param key The key to remove the value for.
+ * @return @c true when no value is stored for @c key anymore; @c false when @c key is not valid.
+ * @note A later call to #Chip_EEPROM_Flush or #Chip_EEPROM_DeInit is necessary to ensure the removal is retained.
+ */
+bool KvStore_Delete(int key);
+
+#endif /** @} */
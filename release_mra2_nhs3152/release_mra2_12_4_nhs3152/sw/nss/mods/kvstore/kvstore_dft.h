@@ -0,0 +1,105 @@
+/*
+ * Copyright 2020 NXP
+ * This software is owned or controlled by NXP and may only be used strictly
+ * in accordance with the applicable license terms.  By expressly accepting
+ * such terms or by downloading, installing, activating and/or otherwise using
+ * the software, you are agreeing that you have read, and that you agree to
+ * comply with and are bound by, such license terms.  If you do not agree to
+ * be bound by the applicable license terms, then you may not retain, install,
+ * activate or otherwise use the software.
+ */
+
+#ifndef __KVSTORE_DFT_H_
+#define __KVSTORE_DFT_H_
+
+/** @defgroup MODS_NSS_KVSTORE_DFT Diversity Settings
+ *  @ingroup MODS_NSS_KVSTORE
+ *
+ * The application can adapt the key/value store module to better fit the different application scenarios through the
+ * use of diversity flags in the form of defines below. Sensible defaults are chosen; to override the default settings,
+ * place the defines with their desired values in the application app_sel.h header file: the compiler will pick up
+ * your defines before parsing this file.
+ *
+ * Additional notes regarding some flags:
+ * - By default, the assigned EEPROM region takes up 384 bytes, starting at byte offset 128. This space can be moved and
+ *  resized by adapting #KVSTORE_EEPROM_FIRST_ROW and #KVSTORE_EEPROM_LAST_ROW.
+ * - The assigned EEPROM region is split in two halves. One half must be able to hold a value of the maximum size for
+ *  each key: this is checked at compile time.
+ * .
+ *
+ * These flags may be overridden/set:
+ * - #KVSTORE_EEPROM_FIRST_ROW
+ * - #KVSTORE_EEPROM_LAST_ROW
+ * - #KVSTORE_KEY_COUNT
+ * - #KVSTORE_MAX_VALUE_SIZE
+ * .
+ *
+ * These defines are fixed or derived from the above flags and may not be defined or redefined in an application:
+ * - #KVSTORE_EEPROM_ROW_COUNT
+ * .
+ *
+ * @{
+ */
+
+#ifndef KVSTORE_EEPROM_FIRST_ROW
+    /**
+     * The first EEPROM row assigned for storing the key/value pairs. Starting from the first byte in this row, until the
+     * last byte in #KVSTORE_EEPROM_LAST_ROW, the key/value store module has full control: no other code may touch this
+     * EEPROM region.
+     * @note The regions of the event, storage and rollup modules and the wear counters of the diag module are checked
+     *  for overlap at compile time, as far as both their first and last row are defined by the application. E.g. the
+     *  default region overlaps with the EEPROM region of the event module in the temperature logger demo application:
+     *  using this module there requires moving or shrinking one of its regions first.
+     */
+    #define KVSTORE_EEPROM_FIRST_ROW (128 / EEPROM_ROW_SIZE)
+#endif
+#if !(KVSTORE_EEPROM_FIRST_ROW >= 0) || !(KVSTORE_EEPROM_FIRST_ROW < EEPROM_NR_OF_RW_ROWS)
+    #error Invalid value for KVSTORE_EEPROM_FIRST_ROW
+#endif
+
+#ifndef KVSTORE_EEPROM_LAST_ROW
+    /**
+     * The last EEPROM row assigned for storing the key/value pairs. Starting from the first byte in
+     * #KVSTORE_EEPROM_FIRST_ROW, until the last byte in this row, the key/value store module has full control: no other
+     * code may touch this EEPROM region.
+     * @note By default, the region ends just before byte offset 512.
+     */
+    #define KVSTORE_EEPROM_LAST_ROW ((512 / EEPROM_ROW_SIZE) - 1)
+#endif
+#if !(KVSTORE_EEPROM_LAST_ROW > KVSTORE_EEPROM_FIRST_ROW) || !(KVSTORE_EEPROM_LAST_ROW < EEPROM_NR_OF_RW_ROWS)
+    #error Invalid value for KVSTORE_EEPROM_LAST_ROW
+#endif
+
+/** The number of EEPROM rows assigned for storing the key/value pairs. */
+#define KVSTORE_EEPROM_ROW_COUNT (KVSTORE_EEPROM_LAST_ROW - KVSTORE_EEPROM_FIRST_ROW + 1)
+#if (KVSTORE_EEPROM_ROW_COUNT % 2) != 0
+    #error The number of EEPROM rows assigned to the key/value store module must be even
+#endif
+
+#ifndef KVSTORE_KEY_COUNT
+    /**
+     * The number of different keys that can be used. Valid keys are in the range [0, #KVSTORE_KEY_COUNT[.
+     * @note Each key costs 4 bytes of RAM for the index, regardless whether a value is stored for it.
+     */
+    #define KVSTORE_KEY_COUNT 8
+#endif
+#if (KVSTORE_KEY_COUNT < 1) || (KVSTORE_KEY_COUNT > 255)
+    #error KVSTORE_KEY_COUNT must be in the range [1, 255]
+#endif
+
+#ifndef KVSTORE_MAX_VALUE_SIZE
+    /**
+     * The maximum size in bytes of a single value. Each value is stored in EEPROM together with 4 bytes of overhead.
+     * @note The stack usage of #KvStore_Set scales with this value.
+     */
+    #define KVSTORE_MAX_VALUE_SIZE 16
+#endif
+#if (KVSTORE_MAX_VALUE_SIZE < 1) || (KVSTORE_MAX_VALUE_SIZE > 254)
+    #error KVSTORE_MAX_VALUE_SIZE must be in the range [1, 254]
+#endif
+
+#if (4 + KVSTORE_KEY_COUNT * (4 + KVSTORE_MAX_VALUE_SIZE)) > (KVSTORE_EEPROM_ROW_COUNT / 2 * EEPROM_ROW_SIZE)
+    #error The assigned EEPROM region is too small for KVSTORE_KEY_COUNT values of KVSTORE_MAX_VALUE_SIZE bytes
+#endif
+
+#endif /** @} */
@@ -719,6 +719,7 @@ typedef enum MSG_ID {
      * @return MSG_RESPONSE_GETDIAGDATA_T
      * @note synchronous command
      * @note For this command to become available, define @c ENABLE_DIAG_MODULE.
+     * @note When @c DIAG_TRACK_WEAR is set, the response also holds the non-volatile memory wear totals.
      */
     MSG_ID_GETDIAGDATA = 0x3E,
 
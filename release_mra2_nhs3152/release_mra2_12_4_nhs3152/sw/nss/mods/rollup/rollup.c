@@ -0,0 +1,286 @@
+/*
+ * Copyright 2020 NXP
+ * This software is owned or controlled by NXP and may only be used strictly
+ * in accordance with the applicable license terms.  By expressly accepting
+ * such terms or by downloading, installing, activating and/or otherwise using
+ * the software, you are agreeing that you have read, and that you agree to
+ * comply with and are bound by, such license terms.  If you do not agree to
+ * be bound by the applicable license terms, then you may not retain, install,
+ * activate or otherwise use the software.
+ */
+
+#include <string.h>
+#include "chip.h"
+#include "rollup.h"
+
+/**
+ * @file
+ *
+ *  @par Storage model
+ *      The assigned EEPROM region is split in two ring buffers of #Record_t instances: the first
+ *      #ROLLUP_TIER1_ROW_COUNT rows hold the records of tier 1, the remaining rows hold the records of tier 2.
+ *      The record for window @c w of a tier is stored at slot @code w % capacity @endcode of its ring buffer.
+ *      - The number of complete windows of tier 1 equals @code Storage_GetCount() / ROLLUP_FACTOR @endcode; the number
+ *          of complete windows of tier 2 equals that number divided by #ROLLUP_FACTOR.
+ *      - Each record stores the 16 LSBits of the index of its window. A record is only used when this matches the
+ *          window that is sought for: this rejects stale records, and records that were not written due to a reset.
+ *      - A record of tier 2 is calculated from the #ROLLUP_FACTOR records of tier 1 covering the same samples.
+ *
+ *  @par Reading
+ *      Records are read from EEPROM when present and valid. Otherwise, they are calculated on the fly from the raw
+ *      samples that are still stored. This is always the case for the newest, incomplete window of each tier.
+ */
+
+/** The number of raw samples a window of tier @c tier spans. */
+#define WINDOW_SIZE(tier) (((tier) == 0) ? 1 : (((tier) == 1) ? ROLLUP_FACTOR : ROLLUP_FACTOR * ROLLUP_FACTOR))
+
+/** The absolute offset to the very first byte of the ring buffer of tier 1. */
+#define TIER1_ABSOLUTE_BYTE_OFFSET (ROLLUP_EEPROM_FIRST_ROW * EEPROM_ROW_SIZE)
+
+/** The absolute offset to the very first byte of the ring buffer of tier 2. */
+#define TIER2_ABSOLUTE_BYTE_OFFSET ((ROLLUP_EEPROM_FIRST_ROW + ROLLUP_TIER1_ROW_COUNT) * EEPROM_ROW_SIZE)
+
+/** The number of records the ring buffer of tier 1 can hold. */
+#define TIER1_CAPACITY ((int)((ROLLUP_TIER1_ROW_COUNT * EEPROM_ROW_SIZE) / sizeof(Record_t)))
+
+/** The number of records the ring buffer of tier 2 can hold. */
+#define TIER2_CAPACITY ((int)(((ROLLUP_EEPROM_ROW_COUNT - ROLLUP_TIER1_ROW_COUNT) * EEPROM_ROW_SIZE) / sizeof(Record_t)))
+
+/* ------------------------------------------------------------------------- */
+
+/** The data stored in EEPROM for each window of tier 1 and tier 2. */
+typedef struct Record_s {
+    uint16_t window; /**< The 16 LSBits of the index of the window. */
+    uint16_t count; /**< The number of samples that were available to calculate @c values. */
+    Rollup_Value_t values[STORAGE_CHANNEL_COUNT]; /**< The summary of each channel over the window. */
+} Record_t;
+
+int checkTier1Capacity[(TIER1_CAPACITY >= ROLLUP_FACTOR) ? 1 : -1]; /* Dummy variable since we can't use sizeof during precompilation. */
+int checkTier2Capacity[(TIER2_CAPACITY >= 1) ? 1 : -1]; /* Dummy variable since we can't use sizeof during precompilation. */
+
+/* ------------------------------------------------------------------------- */
+
+/**
+ * The number of windows of tier 1 for which a record has been written - or was found to be present - since the last
+ * call to #Rollup_Init or #Rollup_Reset. The number of windows of tier 2 follows from this value.
+ */
+__attribute__ ((section(".noinit")))
+static int sWindowCount;
+
+/* ------------------------------------------------------------------------- */
+
+static int GetCapacity(int tier);
+static int GetRecordOffset(int tier, int window);
+static bool ReadRecord(int tier, int window, Record_t * pRecord);
+static void WriteRecord(int tier, int window, Record_t * pRecord);
+static void SummarizeStoredSamples(int first, int size, Record_t * pRecord);
+static void SummarizeTier1Records(int window, Record_t * pRecord);
+static void WriteCompletedWindows(void);
+static int GetFirstAvailable(int tier);
+
+/* ------------------------------------------------------------------------- */
+
+static int GetCapacity(int tier)
+{
+    return (tier == 1) ? TIER1_CAPACITY : TIER2_CAPACITY;
+}
+
+static int GetRecordOffset(int tier, int window)
+{
+    int base = (tier == 1) ? TIER1_ABSOLUTE_BYTE_OFFSET : TIER2_ABSOLUTE_BYTE_OFFSET;
+    return base + (window % GetCapacity(tier)) * (int)sizeof(Record_t);
+}
+
+/**
+ * Reads the record of a window of tier 1 or tier 2 from EEPROM.
+ * @return @c true when the record stored in the slot of the window belongs to that window.
+ */
+static bool ReadRecord(int tier, int window, Record_t * pRecord)
+{
+    Chip_EEPROM_Read(NSS_EEPROM, GetRecordOffset(tier, window), pRecord, sizeof(Record_t));
+    return pRecord->window == (uint16_t)window;
+}
+
+static void WriteRecord(int tier, int window, Record_t * pRecord)
+{
+    pRecord->window = (uint16_t)window;
+    Chip_EEPROM_Write(NSS_EEPROM, GetRecordOffset(tier, window), pRecord, sizeof(Record_t));
+}
+
+/**
+ * Summarizes the raw samples in the range [@c first, @c first + @c size[ that are still stored.
+ * @param first The index of the first sample of the window.
+ * @param size The number of samples the window spans.
+ * @param [out] pRecord : The summary is written here. @c window is not touched.
+ */
+static void SummarizeStoredSamples(int first, int size, Record_t * pRecord)
+{
+    Storage_Summary_t summaries[STORAGE_CHANNEL_COUNT];
+    int oldest = Storage_GetFirst();
+    int count = 0;
+
+    if (first < oldest) {
+        size -= oldest - first;
+        first = oldest;
+    }
+    if (size > 0) {
+        count = Storage_GetSummary(first, size, summaries);
+    }
+    pRecord->count = (uint16_t)count;
+    for (int c = 0; (count > 0) && (c < STORAGE_CHANNEL_COUNT); c++) {
+        pRecord->values[c].min = (ROLLUP_VALUE_TYPE)summaries[c].min;
+        pRecord->values[c].max = (ROLLUP_VALUE_TYPE)summaries[c].max;
+        pRecord->values[c].avg = (ROLLUP_VALUE_TYPE)(summaries[c].sum / count);
+    }
+}
+
+/**
+ * Calculates the record of a window of tier 2 from the records of tier 1 covering the same samples. Records of tier 1
+ * that are no longer - or not - present do not contribute.
+ * @param window The index of the window of tier 2.
+ * @param [out] pRecord : The summary is written here. @c window is not touched.
+ */
+static void SummarizeTier1Records(int window, Record_t * pRecord)
+{
+    int64_t sums[STORAGE_CHANNEL_COUNT] = {0};
+    int count = 0;
+
+    for (int w = window * ROLLUP_FACTOR; w < (window + 1) * ROLLUP_FACTOR; w++) {
+        Record_t record;
+        if (ReadRecord(1, w, &record) && (record.count > 0)) {
+            for (int c = 0; c < STORAGE_CHANNEL_COUNT; c++) {
+                if ((count == 0) || (record.values[c].min < pRecord->values[c].min)) {
+                    pRecord->values[c].min = record.values[c].min;
+                }
+                if ((count == 0) || (record.values[c].max > pRecord->values[c].max)) {
+                    pRecord->values[c].max = record.values[c].max;
+                }
+                sums[c] += (int64_t)record.values[c].avg * record.count;
+            }
+            count += record.count;
+        }
+    }
+    pRecord->count = (uint16_t)count;
+    for (int c = 0; (count > 0) && (c < STORAGE_CHANNEL_COUNT); c++) {
+        pRecord->values[c].avg = (ROLLUP_VALUE_TYPE)(sums[c] / count);
+    }
+}
+
+/** Writes the records of all windows of tier 1 - and thus tier 2 - that are complete, but not yet written. */
+static void WriteCompletedWindows(void)
+{
+    int completed = Storage_GetCount() / ROLLUP_FACTOR;
+    while (sWindowCount < completed) {
+        Record_t record;
+        SummarizeStoredSamples(sWindowCount * ROLLUP_FACTOR, ROLLUP_FACTOR, &record);
+        WriteRecord(1, sWindowCount, &record);
+        sWindowCount++;
+        if ((sWindowCount % ROLLUP_FACTOR) == 0) {
+            SummarizeTier1Records(sWindowCount / ROLLUP_FACTOR - 1, &record);
+            WriteRecord(2, sWindowCount / ROLLUP_FACTOR - 1, &record);
+        }
+    }
+}
+
+/**
+ * @return The index of the oldest sample that can be reported using tier @c tier. For tier 1 and tier 2, this is the
+ *  first sample of the oldest window whose record is still held in the ring buffer.
+ */
+static int GetFirstAvailable(int tier)
+{
+    int first;
+    if (tier == 0) {
+        first = Storage_GetFirst();
+        if ((ROLLUP_RAW_HORIZON > 0) && (first < Storage_GetCount() - ROLLUP_RAW_HORIZON)) {
+            first = Storage_GetCount() - ROLLUP_RAW_HORIZON;
+        }
+    }
+    else {
+        int windowCount = (tier == 1) ? sWindowCount : sWindowCount / ROLLUP_FACTOR;
+        first = (windowCount > GetCapacity(tier)) ? (windowCount - GetCapacity(tier)) * WINDOW_SIZE(tier) : 0;
+    }
+    return first;
+}
+
+/* ------------------------------------------------------------------------- */
+
+void Rollup_Init(void)
+{
+    /* Search backwards for the newest record of tier 1 that was written. Records that were lost due to a reset are
+     * written anew - as far as the raw samples are still stored.
+     */
+    int completed = Storage_GetCount() / ROLLUP_FACTOR;
+    int oldest = (completed > TIER1_CAPACITY) ? completed - TIER1_CAPACITY : 0;
+    Record_t record;
+
+    sWindowCount = completed;
+    while ((sWindowCount > oldest) && !ReadRecord(1, sWindowCount - 1, &record)) {
+        sWindowCount--;
+    }
+    WriteCompletedWindows();
+}
+
+void Rollup_Reset(bool checkFlash)
+{
+    Storage_Reset(checkFlash);
+
+    /* A window index of 0xFFFF can never match: its slot is overwritten before that window is complete. */
+    Chip_EEPROM_Memset(NSS_EEPROM, TIER1_ABSOLUTE_BYTE_OFFSET, 0xFF, ROLLUP_EEPROM_ROW_COUNT * EEPROM_ROW_SIZE);
+    sWindowCount = 0;
+}
+
+int Rollup_Write(STORAGE_TYPE * pSamples, int n)
+{
+    int written = Storage_Write(pSamples, n);
+    WriteCompletedWindows();
+    return written;
+}
+
+int Rollup_Read(int first, int count, Rollup_Record_t * pRecords, int n)
+{
+    int end = first + count;
+    int written = 0;
+
+    ASSERT(pRecords != NULL);
+    if (end > Storage_GetCount()) {
+        end = Storage_GetCount();
+    }
+
+    while ((written < n) && (first < end)) {
+        /* Pick the finest tier still holding the sample with index first. When none holds it, skip ahead to the oldest
+         * sample that is still available.
+         */
+        int tier = 0;
+        while ((tier < ROLLUP_TIER_COUNT) && (first < GetFirstAvailable(tier))) {
+            tier++;
+        }
+        if (tier == ROLLUP_TIER_COUNT) {
+            int oldest = GetFirstAvailable(0);
+            for (tier = 1; tier < ROLLUP_TIER_COUNT; tier++) {
+                if (GetFirstAvailable(tier) < oldest) {
+                    oldest = GetFirstAvailable(tier);
+                }
+            }
+            first = oldest;
+            continue;
+        }
+
+        int window = first / WINDOW_SIZE(tier);
+        Record_t record;
+        if ((tier == 0) || (window >= ((tier == 1) ? sWindowCount : sWindowCount / ROLLUP_FACTOR))
+                || !ReadRecord(tier, window, &record)) {
+            /* Not yet complete, or not present: calculate it from the raw samples, as far as still stored. */
+            SummarizeStoredSamples(window * WINDOW_SIZE(tier), WINDOW_SIZE(tier), &record);
+        }
+
+        Rollup_Record_t * pRecord = &pRecords[written];
+        pRecord->first = window * WINDOW_SIZE(tier);
+        pRecord->size = WINDOW_SIZE(tier);
+        pRecord->count = record.count;
+        pRecord->tier = tier;
+        memcpy(pRecord->values, record.values, sizeof(pRecord->values));
+        written++;
+        first = pRecord->first + pRecord->size;
+    }
+    return written;
+}
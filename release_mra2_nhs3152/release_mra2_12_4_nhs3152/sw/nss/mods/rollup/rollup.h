@@ -0,0 +1,144 @@
+/*
+ * Copyright 2020 NXP
+ * This software is owned or controlled by NXP and may only be used strictly
+ * in accordance with the applicable license terms.  By expressly accepting
+ * such terms or by downloading, installing, activating and/or otherwise using
+ * the software, you are agreeing that you have read, and that you agree to
+ * comply with and are bound by, such license terms.  If you do not agree to
+ * be bound by the applicable license terms, then you may not retain, install,
+ * activate or otherwise use the software.
+ */
+
+#ifndef __ROLLUP_H_
+#define __ROLLUP_H_
+
+/**
+ * @defgroup MODS_NSS_ROLLUP rollup: tiered downsampling on top of the storage module
+ * @ingroup MODS_NSS
+ * The rollup module allows an application to log samples for a much longer time than the FLASH memory assigned to the
+ * storage module can hold, while keeping the full resolution of the most recent samples.
+ *
+ * It will:
+ * - store all samples using the storage module: these raw samples are referred to as tier @c 0.
+ * - maintain two secondary streams, stored in a dedicated EEPROM region:
+ *  - tier @c 1 holds one record per window of #ROLLUP_FACTOR raw samples.
+ *  - tier @c 2 holds one record per window of #ROLLUP_FACTOR records of tier 1.
+ *  .
+ *  Each record holds the minimum, maximum and average value of each channel over its window.
+ * - rely on the storage module - configured with #STORAGE_FLASH_CIRCULAR - to reclaim the FLASH space of the oldest raw
+ *  samples. Raw samples older than #ROLLUP_RAW_HORIZON are no longer reported, even when still stored.
+ * - when reading, pick the finest tier that is still available for each part of the requested range.
+ * .
+ *
+ * Both tiers are stored in a ring buffer: the oldest records of a tier are overwritten by the newest. The record
+ * for a window is only written once the window is complete, and is calculated from the stored data using
+ * #Storage_GetSummary. Nothing has to be kept in RAM or in the general purpose registers between two sessions: the
+ * number of complete windows follows from #Storage_GetCount, and each record carries the index of its window, which
+ * allows #Rollup_Init to detect - and then write - the records that were lost due to a reset.
+ *
+ * @par Diversity
+ *  This module supports diversity settings: the EEPROM region placed under control of this module, the downsampling
+ *  factor and the raw horizon. Check @ref MODS_NSS_ROLLUP_DFT for all diversity parameters.
+ *
+ * @par How to use the module
+ *  -# First call #Storage_Init and then #Rollup_Init to prepare both modules.
+ *  -# Call #Rollup_Reset instead of #Storage_Reset to start a new logging session.
+ *  -# Call #Rollup_Write instead of #Storage_Write to add new samples.
+ *  -# To retrieve data, use #Rollup_Read. #Storage_Seek, #Storage_Read and the other functions of the storage module
+ *      can still be used to retrieve the raw samples that are still stored.
+ *  -# Call #Storage_DeInit as the last call between two sessions: this also flushes the records of the tiers to
+ *      EEPROM.
+ *  .
+ *
+ * @{
+ */
+
+#include "board.h"
+#include "storage/storage.h"
+#include "rollup_dft.h"
+
+/* ------------------------------------------------------------------------- */
+
+/** The minimum, maximum and average value of one channel over a window of samples. */
+typedef struct Rollup_Value_s {
+    ROLLUP_VALUE_TYPE min; /**< The lowest value. */
+    ROLLUP_VALUE_TYPE max; /**< The highest value. */
+    ROLLUP_VALUE_TYPE avg; /**< The mean value, rounded towards zero. */
+} Rollup_Value_t;
+
+/** Describes a window of samples, as reported by #Rollup_Read. */
+typedef struct Rollup_Record_s {
+    /** The index of the first sample of the window. For tier @c 0, the window is exactly one sample large. */
+    int first;
+
+    /**
+     * The number of samples the window spans: @c 1 for tier 0, #ROLLUP_FACTOR for tier 1, #ROLLUP_FACTOR squared for
+     * tier 2.
+     */
+    int size;
+
+    /**
+     * The number of samples that were available to calculate @c values. This is less than @c size when some of the
+     * samples were already overwritten, or - for the newest window - not yet written.
+     * When @c 0, @c values is not valid.
+     */
+    int count;
+
+    /** The tier the record was taken from, in the range [0, #ROLLUP_TIER_COUNT[. */
+    int tier;
+
+    /** The minimum, maximum and average value of each channel over the window. */
+    Rollup_Value_t values[STORAGE_CHANNEL_COUNT];
+} Rollup_Record_t;
+
+/* ------------------------------------------------------------------------- */
+
+/**
+ * This function must be the first function to call in this module after going to deep power down or power-off power
+ * save mode. Records for complete windows that were not written before a reset are calculated and written here.
+ * @pre #Storage_Init has been called.
+ * @pre EEPROM is initialized and is ready to be used.
+ * @post The read position of the storage module is undefined: a call to #Storage_Seek is required before calling
+ *  #Storage_Read.
+ */
+void Rollup_Init(void);
+
+/**
+ * Resets both the rollup module and the storage module to a pristine state.
+ * @param checkFlash Passed on unmodified to #Storage_Reset.
+ * @pre EEPROM is initialized and is ready to be used.
+ */
+void Rollup_Reset(bool checkFlash);
+
+/**
+ * Stores @c n samples using #Storage_Write and writes the records of all windows that are completed by doing so.
+ * @param pSamples Passed on unmodified to #Storage_Write.
+ * @param n Passed on unmodified to #Storage_Write.
+ * @return The value returned by #Storage_Write.
+ * @post The read position of the storage module is undefined: a call to #Storage_Seek is required before calling
+ *  #Storage_Read.
+ * @post A later call to #Storage_DeInit is necessary to ensure the data can survive Deep power down state.
+ */
+int Rollup_Write(STORAGE_TYPE * pSamples, int n);
+
+/**
+ * Reports the samples in the range [@c first, @c first + @c count[ using the finest tier still available for each part
+ * of the range. Typically, the oldest part of the range is reported using records of tier 2, followed by records of
+ * tier 1, followed by the raw samples.
+ * - When the sample with index @c first is no longer available in any tier, reporting starts with the oldest record
+ *  that is still available.
+ * - Each record covers a whole window of its tier: the first record reported may start before @c first, the last
+ *  record reported may extend beyond the end of the range.
+ * .
+ * @param first The index of the first sample to report. A value of @c 0 indicates the oldest sample ever written.
+ * @param count The number of samples to report.
+ * @param [out] pRecords : May not be @c NULL. Points to an array of @c n elements, where the records are written to.
+ * @param n The maximum number of records to write.
+ * @return The number of records written to @c pRecords. When equal to @c n, call this function again using
+ *  @code pRecords[n - 1].first + pRecords[n - 1].size @endcode as new value for @c first to continue.
+ * @post The read position of the storage module is undefined: a call to #Storage_Seek is required before calling
+ *  #Storage_Read.
+ */
+int Rollup_Read(int first, int count, Rollup_Record_t * pRecords, int n);
+
+#endif /** @} */
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2020 NXP
+ * This software is owned or controlled by NXP and may only be used strictly
+ * in accordance with the applicable license terms.  By expressly accepting
+ * such terms or by downloading, installing, activating and/or otherwise using
+ * the software, you are agreeing that you have read, and that you agree to
+ * comply with and are bound by, such license terms.  If you do not agree to
+ * be bound by the applicable license terms, then you may not retain, install,
+ * activate or otherwise use the software.
+ */
+
+#ifndef __ROLLUP_DFT_H_
+#define __ROLLUP_DFT_H_
+
+/** @defgroup MODS_NSS_ROLLUP_DFT Diversity Settings
+ *  @ingroup MODS_NSS_ROLLUP
+ *
+ * The application can adapt the rollup module to better fit the different application scenarios through the use of
+ * diversity flags in the form of defines below. Sensible defaults are chosen; to override the default settings, place
+ * the defines with their desired values in the application app_sel.h header file: the compiler will pick up your
+ * defines before parsing this file.
+ *
+ * Additional notes regarding some flags:
+ * - By default, the assigned EEPROM region takes up 512 bytes and is located just below the EEPROM region of the
+ *  storage module. This space can be moved and resized by adapting #ROLLUP_EEPROM_FIRST_ROW and
+ *  #ROLLUP_EEPROM_LAST_ROW.
+ * - The storage module must be configured with #STORAGE_FLASH_CIRCULAR and #STORAGE_BLOCK_SUMMARY both set.
+ * .
+ *
+ * These flags may be overridden/set:
+ * - #ROLLUP_EEPROM_FIRST_ROW
+ * - #ROLLUP_EEPROM_LAST_ROW
+ * - #ROLLUP_TIER1_ROW_COUNT
+ * - #ROLLUP_FACTOR
+ * - #ROLLUP_RAW_HORIZON
+ * - #ROLLUP_VALUE_TYPE
+ * .
+ *
+ * These defines are fixed or derived from the above flags and may not be defined or redefined in an application:
+ * - #ROLLUP_EEPROM_ROW_COUNT
+ * - #ROLLUP_TIER_COUNT
+ * .
+ *
+ * @{
+ */
+
+#if !STORAGE_FLASH_CIRCULAR || !STORAGE_BLOCK_SUMMARY
+    #error The rollup module requires STORAGE_FLASH_CIRCULAR and STORAGE_BLOCK_SUMMARY to be set to 1
+#endif
+
+#ifndef ROLLUP_EEPROM_FIRST_ROW
+    /**
+     * The first EEPROM row assigned for storing the rollup tiers. Starting from the first byte in this row, until the
+     * last byte in #ROLLUP_EEPROM_LAST_ROW, the rollup module has full control: no other code may touch this EEPROM
+     * region.
+     * @note By default, the EEPROM row 512 bytes below #STORAGE_EEPROM_FIRST_ROW will be chosen.
+     */
+    #define ROLLUP_EEPROM_FIRST_ROW (STORAGE_EEPROM_FIRST_ROW - (512 / EEPROM_ROW_SIZE))
+#endif
+#if !(ROLLUP_EEPROM_FIRST_ROW >= 0) || !(ROLLUP_EEPROM_FIRST_ROW < EEPROM_NR_OF_RW_ROWS)
+    #error Invalid value for ROLLUP_EEPROM_FIRST_ROW
+#endif
+
+#ifndef ROLLUP_EEPROM_LAST_ROW
+    /**
+     * The last EEPROM row assigned for storing the rollup tiers. Starting from the first byte in
+     * #ROLLUP_EEPROM_FIRST_ROW, until the last byte in this row, the rollup module has full control: no other code may
+     * touch this EEPROM region.
+     * @note By default, the total assigned size will occupy 512 bytes.
+     */
+    #define ROLLUP_EEPROM_LAST_ROW (ROLLUP_EEPROM_FIRST_ROW + (512 / EEPROM_ROW_SIZE) - 1)
+#endif
+#if !(ROLLUP_EEPROM_LAST_ROW > ROLLUP_EEPROM_FIRST_ROW) || !(ROLLUP_EEPROM_LAST_ROW < EEPROM_NR_OF_RW_ROWS)
+    #error Invalid value for ROLLUP_EEPROM_LAST_ROW
+#endif
+
+/** The number of EEPROM rows assigned for storing the rollup tiers. */
+#define ROLLUP_EEPROM_ROW_COUNT (ROLLUP_EEPROM_LAST_ROW - ROLLUP_EEPROM_FIRST_ROW + 1)
+
+#ifndef ROLLUP_TIER1_ROW_COUNT
+    /**
+     * The number of EEPROM rows, starting at #ROLLUP_EEPROM_FIRST_ROW, used to store the records of tier 1. The
+     * remaining rows are used to store the records of tier 2.
+     * Tier 1 only has to bridge the gap between the oldest raw sample still available and the resolution of tier 2;
+     * the rows assigned to tier 2 determine how far back in time the rollup reaches.
+     * @note The records of tier 2 are calculated from the records of tier 1: tier 1 must be able to hold at least
+     *  #ROLLUP_FACTOR records.
+     */
+    #define ROLLUP_TIER1_ROW_COUNT (ROLLUP_EEPROM_ROW_COUNT / 2)
+#endif
+#if !(ROLLUP_TIER1_ROW_COUNT > 0) || !(ROLLUP_TIER1_ROW_COUNT < ROLLUP_EEPROM_ROW_COUNT)
+    #error Invalid value for ROLLUP_TIER1_ROW_COUNT
+#endif
+
+#ifndef ROLLUP_FACTOR
+    /**
+     * The downsampling factor N between two consecutive tiers. Each record of tier 1 summarizes a window of @c N raw
+     * samples; each record of tier 2 summarizes a window of @c N records of tier 1, i.e. @c N*N raw samples.
+     */
+    #define ROLLUP_FACTOR 16
+#endif
+#if (ROLLUP_FACTOR < 2) || (ROLLUP_FACTOR > 255)
+    #error ROLLUP_FACTOR must be in the range [2, 255]
+#endif
+
+#ifndef ROLLUP_RAW_HORIZON
+    /**
+     * The number of newest samples for which raw samples are handed out by #Rollup_Read. Older samples are only
+     * reported via the tiers, even when the storage module still holds them. A value of @c 0 disables the horizon: raw
+     * samples are then reported as long as the storage module holds them, i.e. until they are overwritten in FLASH.
+     * @note The FLASH space occupied by raw samples beyond the horizon is reclaimed by the storage module when it needs
+     *  the space for new samples - see #STORAGE_FLASH_CIRCULAR. The size of the FLASH region assigned to the storage
+     *  module thus determines the upper limit of the horizon.
+     */
+    #define ROLLUP_RAW_HORIZON 0
+#endif
+#if ROLLUP_RAW_HORIZON < 0
+    #error ROLLUP_RAW_HORIZON must be positive
+#endif
+
+#ifndef ROLLUP_VALUE_TYPE
+    /**
+     * The type used to store the minimum, maximum and average value of one channel in one record. Each value in a
+     * record must be representable using this type. Defining this to @c int16_t halves the EEPROM footprint of each
+     * record, which is sufficient for signed values of up to 16 bits.
+     */
+    #define ROLLUP_VALUE_TYPE int32_t
+#endif
+
+/** The number of tiers, including the tier holding the raw samples, which is referred to as tier @c 0. */
+#define ROLLUP_TIER_COUNT 3
+
+#endif /** @} */
@@ -258,6 +258,7 @@ WEAK void FLASH_IRQHandler(void);
 /**
  * Handler for (Peripheral) EEPROM memory Interrupt.
  * This handler has a default (#WEAK) implementation
+ * @note The EEPROM driver overrides this handler when #EEPROM_ASYNC_PROGRAM is set.
  * @see #WEAK for documentation on overriding this handler's functionality
  */
 WEAK void EEPROM_IRQHandler(void);
@@ -9,6 +9,8 @@
  * activate or otherwise use the software.
  */
 
+#include <limits.h>
+#include <stddef.h>
 #include <string.h>
 #include "storage.h"
 
@@ -23,6 +25,8 @@
  *      - #RecoverInfo_t - stored in the general purpose registers
  *      - #Hint_t - stored on a fixed location in EEPROM
  *      - #Marker_t - stored on a variable location, immediately after the last written sample in EEPROM
+ *      - #Checkpoint_t - only when #STORAGE_CHECKPOINT is set: stored in two alternating slots on a fixed location in
+ *          EEPROM
  *      .
  *      After recovery, state is maintained in SRAM using the structure #Storage_Instance_t, and in #Storage_DeInit at
  *      least two of the three recovery structures are updated.
@@ -41,12 +45,20 @@
  *           - whether samples are stored or not
  *           - how much flash is occupied by data storage
  *           .
- *           It also provides a possible location to #Marker_t, which may be outdated.
+ *           It also provides a possible location to #Marker_t, which may be outdated. Since the hint is updated at
+ *           least every #STORAGE_WRITE_RECOVERY_EVERY_X_SAMPLES samples, the marker is then found within that many
+ *           samples after it.
+ *      - #Checkpoint_t
+ *           When enabled, this data is updated together with the hint, and points to the same location. It is tried
+ *           after #RecoverInfo_t. Two slots are used in turn and each is protected by a CRC, so a corruption while
+ *           writing one leaves the other - one update older - intact, where a corrupted hint forces a slow search. The
+ *           marker is found within #STORAGE_WRITE_RECOVERY_EVERY_X_SAMPLES samples after the location of the newest
+ *           valid slot, or - when that slot is one update older - within twice that many samples.
  *      - #Marker_t
  *           This data is always stored just after the last sample written in EEPROM. Its precise location is not known,
  *           as it is progressing together with the data. #RecoverInfo_t points to the start of this structure in the
- *           assigned EEPROM region; #Hint_t may point to it; if both are failing a full slow search is performed in the
- *           assigned EEPROM region.
+ *           assigned EEPROM region; #Checkpoint_t and #Hint_t may point to it; if all are failing a full slow search
+ *           is performed in the assigned EEPROM region.
  *      .
  *
  *      When a full backward search is performed during data recovery, we rely on the length of the marker to eliminate
@@ -339,7 +351,8 @@
  * The size in bytes of the meta data stored just in front of the (compressed) data block in FLASH. The LSBit of the
  * first byte after these header size contains the start of the (compressed) data block.
  * This header is used to give the decompress callback the correct arguments, and to deduce where to find the next
- * block.
+ * block. Its first two bytes hold the size in bits of the block; when #STORAGE_BLOCK_SUMMARY is set, these are followed
+ * by one #BlockSummary_t instance per channel.
  * @note Either this size is a value greater than 0 but less than #STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS, which
  *  indicates the contents have been compressed; either this size is equal to #STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS
  *  which indicates no compression/decompression algorithm was set or compression yielded bad results on this block and
@@ -348,13 +361,21 @@
  */
 #define FLASH_DATA_HEADER_SIZE STORAGE_BLOCK_HEADER_SIZE
 
+/**
+ * The size in bytes of the meta data stored just after the (compressed) data block in FLASH, at the end of the last
+ * word of the block. When non-zero, it holds a #Trailer_t instance.
+ * @see FLASH_BLOCK_SIZE
+ */
+#define FLASH_DATA_TRAILER_SIZE STORAGE_BLOCK_TRAILER_SIZE
+
 /**
  *  Given the header value of a (compressed) data block in FLASH, calculates the size in bytes of the complete block,
  *  @b including #FLASH_DATA_HEADER_SIZE.
  *  The start of a new block @b must @c always be stored on a 32-bit word boundary: this allows to continue writing the
  *  same page without erasing. As a consequence, up to 31 padding bits after the end of previous (compressed) data
  *  block are lost.
- *  @param bitCount The size in bits of the (compressed) data block, @b excluding #FLASH_DATA_HEADER_SIZE.
+ *  @param bitCount The size in bits of the (compressed) data block, @b excluding #FLASH_DATA_HEADER_SIZE and
+ *      #FLASH_DATA_TRAILER_SIZE.
  *  @note
  *  - From the FLASH specification:
  *      <em>It is possible to write only a sub-set of the page (Y words), but the maximum number of
@@ -370,7 +391,28 @@
  *      missing bit corrections, or spurious error conditions. [C-NODPG]</em>
  *  .
  */
-#define FLASH_BLOCK_SIZE(bitCount) (4 * STORAGE_IDIVUP((bitCount) + FLASH_DATA_HEADER_SIZE * 8, 32))
+#define FLASH_BLOCK_SIZE(bitCount) \
+    ((4 * STORAGE_IDIVUP((bitCount) + FLASH_DATA_HEADER_SIZE * 8, 32)) + FLASH_DATA_TRAILER_SIZE)
+
+/** The size in bytes of the assigned FLASH region. */
+#define FLASH_REGION_SIZE ((STORAGE_FLASH_LAST_PAGE + 1 - STORAGE_FLASH_FIRST_PAGE) * FLASH_PAGE_SIZE)
+
+#if STORAGE_BLOCK_CRC
+/**
+ * The maximum number of bytes of a newly written block in FLASH the CRC is recalculated over during one step of
+ * #MOVE_PHASE_VERIFY.
+ */
+#define VERIFY_CHUNK_SIZE (4 * FLASH_PAGE_SIZE)
+#endif
+
+#if STORAGE_FLASH_CIRCULAR
+
+/**
+ * The largest possible size of a data block in FLASH: that of an uncompressed block. This many bytes are kept erased
+ * after the last block written, so the next block can be written without having to erase first.
+ */
+#define FLASH_MAX_BLOCK_SIZE FLASH_BLOCK_SIZE(STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS)
+#endif
 
 /**
  * The first of two special values that are used in #Marker_t to be able to reconstruct the EEPROM and FLASH bit cursor
@@ -398,6 +440,19 @@ static int sStorageFlashFirstPage; /* Initialized in #Storage_Init, RO afterward
 
 /* ------------------------------------------------------------------------- */
 
+#if STORAGE_BLOCK_SUMMARY
+/**
+ * Summary of the values of one channel over all samples in a (compressed) data block. #STORAGE_CHANNEL_COUNT
+ * instances are stored in the header of each block in FLASH, just after its size.
+ * @see FLASH_DATA_HEADER_SIZE
+ */
+typedef struct BlockSummary_s {
+    int32_t min; /**< The lowest value. */
+    int32_t max; /**< The highest value. */
+    int64_t sum; /**< The sum of all values. */
+} BlockSummary_t;
+#endif
+
 /** @see Storage_Instance_t.readLocation */
 typedef enum LOCATION {
     LOCATION_UNKNOWN, /**< A successful call to #Storage_Seek is required. */
@@ -408,6 +463,24 @@ typedef enum LOCATION {
     LOCATION_FLASH /**< Memory in the assigned FLASH region is targeted. */
 } LOCATION_T;
 
+/**
+ * The phases a move of samples from EEPROM to FLASH goes through. Each call to #StepMoveSamplesFromEepromToFlash
+ * executes one phase - or, for #MOVE_PHASE_PROGRAM, one FLASH page - and advances to the next.
+ * @see Storage_Instance_t.movePhase
+ */
+typedef enum MOVE_PHASE {
+    MOVE_PHASE_IDLE, /**< No move is ongoing. */
+    MOVE_PHASE_PERSIST, /**< The samples to move, and the marker and hint pointing past them, are to be programmed. */
+    MOVE_PHASE_COMPRESS, /**< The (compressed) data block is to be prepared in #STORAGE_WORKAREA. */
+    MOVE_PHASE_PROGRAM, /**< The prepared pages are being written to FLASH, one page at a time. */
+    MOVE_PHASE_VERIFY, /**< All prepared pages are written; their contents in FLASH are to be checked. */
+    MOVE_PHASE_COMMIT, /**< The FLASH contents are correct; EEPROM and #sInstance are to be updated. */
+#if STORAGE_FLASH_CIRCULAR
+    MOVE_PHASE_ERASE, /**< The pages where the next block can be written are to be erased, one page at a time. */
+#endif
+    MOVE_PHASE_FAILED /**< The move failed. It is not retried until the next call to #Storage_Init or #Storage_Reset. */
+} MOVE_PHASE_T;
+
 /** The size of the first bits of the cache, in the same general purpose register where #RecoverInfo_t is stored. */
 #define FIRST_BITS_OF_CACHE_SIZE 13
 
@@ -501,6 +574,65 @@ typedef struct Marker_s {
     const int footer; /**< Must equal #MARKER_FOOTER, or @c flashByteCursor is not valid. */
 } Marker_t;
 
+#if STORAGE_CHECKPOINT
+/** Byte size of #Checkpoint_t. Checked at compile time using #checkSizeOfCheckpoint. */
+#define SIZE_OF_CHECKPOINT 8
+
+/** The absolute offset to the first of the two #Checkpoint_t slots, in the row just before the recovery rows. */
+#define CHECKPOINT_ABSOLUTE_BYTE_OFFSET (DUPLICATE_DATA_ABSOLUTE_BYTE_OFFSET - EEPROM_ROW_SIZE)
+
+/**
+ * An instance of this structure is stored in one of two slots at the fixed location #CHECKPOINT_ABSOLUTE_BYTE_OFFSET,
+ * and points to where to find #Marker_t. Each time the hint is written, the slot holding the oldest checkpoint is
+ * overwritten.
+ */
+typedef struct Checkpoint_s {
+    /** Incremented on each update, wrapping around. The valid slot with the highest sequence number is the newest. */
+    uint16_t sequence;
+
+    /** @see Storage_Instance_t.eepromBitCursor */
+    uint16_t eepromBitCursor;
+
+    /** @see Storage_Instance_t.flashByteCursor */
+    uint16_t flashByteCursor;
+
+    /** CRC-16 (CCITT) over all preceding fields. Used to validate this structure. */
+    uint16_t crc;
+} Checkpoint_t;
+#endif
+
+#if STORAGE_FLASH_FIRST_PAGE <= STORAGE_FLASH_LAST_PAGE
+/** Byte size of #Journal_t. Checked at compile time using #checkSizeOfJournal. */
+#define SIZE_OF_JOURNAL 12
+
+/** The value of #Journal_t.header while the commit of a move is ongoing. */
+#define JOURNAL_HEADER ((int)0x4A4E524C)
+
+/**
+ * An instance of this structure is stored at #DUPLICATE_DATA_ABSOLUTE_BYTE_OFFSET while the commit of a move is
+ * ongoing. The samples that were not part of the moved block are then moved to the start of the assigned EEPROM region,
+ * overwriting samples that are already in FLASH: neither the old nor the new marker describes the EEPROM contents
+ * until the commit is finished. #Storage_Init finishes it instead, using this structure - see #FinishCommit.
+ * The duplicate data is not needed while the old marker is still valid. The final #WriteHint of the commit overwrites
+ * this structure.
+ */
+typedef struct Journal_s {
+    int header; /**< Must equal #JOURNAL_HEADER, or this structure is not valid. */
+
+    /** The value of #Storage_Instance_t.eepromBitCursor before the commit, the moved block included. */
+    uint16_t eepromBitCursor;
+
+    /** The value of #Storage_Instance_t.flashByteCursor after the commit, the moved block included. */
+    uint16_t flashByteCursor;
+
+    /** The number of bits already moved to the start of the assigned EEPROM region. */
+    uint16_t shiftedBitCount;
+
+    /** CRC-16 (CCITT) over all preceding fields. Used to validate this structure. */
+    uint16_t crc;
+} Journal_t;
+#endif
+
 /**
  * The total number of bytes in EEPROM consumed by meta-data, to be able to keep track of what is stored in FLASH and
  * EEPROM, even after a power-off.
@@ -509,6 +641,68 @@ typedef struct Marker_s {
  */
 #define SIZE_OF_MARKER 12
 
+#if STORAGE_FLASH_CIRCULAR
+/**
+ * An instance of this structure is stored in FLASH, in the last bytes of each (compressed) data block. The one in the
+ * newest block - just before #Storage_Instance_t.flashByteCursor - tells which blocks are still valid: only the
+ * marker and the hint are updated in EEPROM, and those only keep track of where the next block will be written.
+ */
+typedef struct Trailer_s {
+    /** @see Storage_Instance_t.flashTailCursor */
+    uint16_t tailCursor;
+
+    /** The bitwise inverse of @c tailCursor. Used to validate this structure. */
+    uint16_t inverseTailCursor;
+
+    /** @see Storage_Instance_t.flashBaseSequence */
+    int baseSequence;
+} Trailer_t;
+#endif
+
+/** Byte size of #IndexEntry_t. Checked at compile time using #checkSizeOfIndexEntry. */
+#define SIZE_OF_INDEX_ENTRY 4
+
+/** The absolute offset to the first #IndexEntry_t, in the rows just before the checkpoint - if any - and the hint. */
+#define INDEX_ABSOLUTE_BYTE_OFFSET \
+    (DUPLICATE_DATA_ABSOLUTE_BYTE_OFFSET - ((STORAGE_CHECKPOINT + STORAGE_BLOCK_INDEX_ROW_COUNT) * EEPROM_ROW_SIZE))
+
+/** The number of bytes of the assigned FLASH region covered by each #IndexEntry_t: one FLASH sector. */
+#define INDEX_SPAN_SIZE (FLASH_PAGES_PER_SECTOR * FLASH_PAGE_SIZE)
+
+/**
+ * The number of #IndexEntry_t instances in use. Less than #STORAGE_BLOCK_INDEX_COUNT when #STORAGE_FLASH_FIRST_PAGE is
+ * only known at link time.
+ */
+#define INDEX_ENTRY_COUNT STORAGE_IDIVUP(FLASH_REGION_SIZE, INDEX_SPAN_SIZE)
+
+/** The value of #IndexEntry_t.flashByteCursor when no block header starts in the span of the entry. */
+#define INDEX_NONE 0xFFFF
+
+/**
+ * #STORAGE_BLOCK_INDEX_COUNT instances of this structure are stored at the fixed location #INDEX_ABSOLUTE_BYTE_OFFSET.
+ * Entry @c i covers the bytes @c i * #INDEX_SPAN_SIZE up to @c (i + 1) * #INDEX_SPAN_SIZE of the assigned FLASH
+ * region, and tells where the last (compressed) data block with a header in that span is stored - if any.
+ * - The entries are only written in #MOVE_PHASE_COMMIT, before the journal is written: for the span holding the header
+ *  of the new block, and for the other spans the new block extends into. An entry never describes a block that is not
+ *  yet - or no longer - stored in FLASH, unless it lies outside the part of the region where blocks are stored.
+ * - An entry is only trusted when it lies before #Storage_Instance_t.flashByteCursor and - when #STORAGE_FLASH_CIRCULAR
+ *  is set - at or after #Storage_Instance_t.flashTailCursor. To extend this part, a new block must pass the spans first,
+ *  which overwrites their entries. The entries left behind by a power loss, by a call to #Storage_Reset or by a
+ *  previous lap are thus never trusted, and the index is never cleared.
+ * .
+ * @see FindIndexedBlock
+ */
+typedef struct IndexEntry_s {
+    /** @see Storage_Instance_t.flashByteCursor. #INDEX_NONE if no block header is known to start in the span. */
+    uint16_t flashByteCursor;
+
+    /**
+     * The number of the block, counting from the very first block written since the last call to #Storage_Reset,
+     * modulo @c 0x10000: the sequence number of its first sample, divided by #STORAGE_BLOCK_SIZE_IN_SAMPLES.
+     */
+    uint16_t block;
+} IndexEntry_t;
+
 /**
  * Stores all meta data to perform the requested reads and writes in FLASH and EEPROM. Upon de-initialization, an
  * updated instance of #Marker_t is updated and stored in EEPROM, and an updated instance of #RecoverInfo_t is stored
@@ -531,9 +725,25 @@ typedef struct Storage_Instance_s {
      *  can be used for storage, thus a FLASH byte cursor always has values less than 2**15; and due to the boundary
      *  requirement, the 2 LSBits must be 0 as well: 13 bits are thus required to store this information.
      *  Masking with #MARKER_CURSOR_ZERO_MASK must thus always yield a @c 0 value.
+     * @note When #STORAGE_FLASH_CIRCULAR is set, the blocks wrap around: the next block is written at the start of the
+     *  assigned FLASH region when it does not fit any more at this position.
      */
     int flashByteCursor;
 
+    /**
+     * The position of the header of the oldest (compressed) data block in FLASH, relative to #STORAGE_FLASH_FIRST_PAGE.
+     * Always @c 0, unless #STORAGE_FLASH_CIRCULAR is set: the blocks in FLASH are then found by stepping through
+     * the block headers starting from this position - wrapping around at the end of the assigned FLASH region - up to
+     * @c flashByteCursor.
+     */
+    int flashTailCursor;
+
+    /**
+     * The sequence number of the first sample in the oldest (compressed) data block in FLASH. Always @c 0, unless
+     * #STORAGE_FLASH_CIRCULAR is set: older samples have been erased.
+     */
+    int flashBaseSequence;
+
     /* ------------------------------------------------------------------------- */
 
     /**
@@ -577,27 +787,128 @@ typedef struct Storage_Instance_s {
     /* ------------------------------------------------------------------------- */
 
     /**
-     * Determines what contents are available in #STORAGE_WORKAREA.
+     * Determines what contents are available in #STORAGE_WORKAREA. Entry @c i describes the decompressed block that
+     * starts at @code i * STORAGE_DECOMPRESSED_BLOCK_SIZE_IN_BYTES @endcode bytes from the start of #STORAGE_WORKAREA:
      * - The flash byte offset relative to #FLASH_FIRST_BYTE_ADDRESS where the header preceding the (compressed) data
      *  block can be found; these contents are decompressed and the samples, packed without padding bits, are available
-     *  from the start of #STORAGE_WORKAREA.
-     * - @c -1 if #STORAGE_WORKAREA does not contain samples after decompressing a data block stored in FLASH, or
+     *  at that location.
+     * - @c -1 if that location does not contain samples after decompressing a data block stored in FLASH, or
      *  if #STORAGE_WORKAREA is used to compress data.
      * .
      */
-    int cachedBlockOffset;
+    int cachedBlockOffset[STORAGE_DECOMPRESSED_CACHE_BLOCKS];
+
+#if STORAGE_BLOCK_CRC
+    /**
+     * The flash byte offset relative to #FLASH_FIRST_BYTE_ADDRESS of the last block stored uncompressed of which the
+     * CRC was found to be correct, or @c -1. Avoids recalculating the CRC each time samples are read in place.
+     */
+    int crcCheckedCursor;
+#endif
+
+    /**
+     * For each entry in @c cachedBlockOffset, the value of @c cacheUseCount when that decompressed block was last
+     * used. The entry with the lowest value is the least recently used, and is replaced first.
+     */
+    unsigned int cachedBlockLastUse[STORAGE_DECOMPRESSED_CACHE_BLOCKS];
+
+    /** Incremented each time a decompressed block is looked up. */
+    unsigned int cacheUseCount;
+
+    /**
+     * The number of times a decompressed block was found in #STORAGE_WORKAREA since the last call to #Storage_Init.
+     * @see Storage_GetCacheStatistics
+     */
+    int cacheHits;
+
+    /**
+     * The number of times #STORAGE_DECOMPRESS_CB had to be called since the last call to #Storage_Init.
+     * @see Storage_GetCacheStatistics
+     */
+    int cacheMisses;
+
+    /**
+     * The number of (compressed) data blocks stored in FLASH, or @c -1 if not yet determined since the last call to
+     * #Storage_Init or #Storage_Reset.
+     * @see IndexFlashBlocks
+     */
+    int blockCount;
+
+    /* ------------------------------------------------------------------------- */
+
+    /**
+     * How far the move of the oldest #STORAGE_BLOCK_SIZE_IN_SAMPLES samples from EEPROM to FLASH has progressed.
+     * Apart from the marker and hint written in #MOVE_PHASE_PERSIST, nothing has changed in EEPROM until
+     * #MOVE_PHASE_COMMIT has started: a power loss or a call to #Storage_Init restarts the move from the beginning.
+     * Once started, #Storage_Init finishes the commit instead.
+     */
+    MOVE_PHASE_T movePhase;
+
+    /** The absolute page number of the first page prepared in #STORAGE_WORKAREA. Valid from #MOVE_PHASE_PROGRAM on. */
+    int moveFirstPage;
+
+    /** The number of pages prepared in #STORAGE_WORKAREA. Valid from #MOVE_PHASE_PROGRAM on. */
+    int movePageCount;
+
+    /** The number of pages already written to FLASH. Valid from #MOVE_PHASE_PROGRAM on. */
+    int movePagesDone;
+
+    /**
+     * The value #Storage_Instance_t.flashByteCursor will have once the move is committed. Valid from
+     * #MOVE_PHASE_PROGRAM on.
+     */
+    int moveFlashByteCursor;
+
+    /** The position where the header of the new block is written. Valid from #MOVE_PHASE_PROGRAM on. */
+    int moveBlockCursor;
+
+#if STORAGE_BLOCK_CRC
+    /** The CRC of the new block, as stored in its header. Valid from #MOVE_PHASE_PROGRAM on. */
+    uint16_t moveCrc;
+
+    /** The CRC calculated so far over the new block in FLASH. Valid during #MOVE_PHASE_VERIFY. */
+    uint16_t verifyCrc;
+
+    /**
+     * The number of bytes of the (compressed) data of the new block in FLASH the CRC has been calculated over. @c -1
+     * when the header has not been taken into account yet. Valid during #MOVE_PHASE_VERIFY.
+     */
+    int verifyCursor;
+#endif
+
+#if STORAGE_FLASH_CIRCULAR
+    /**
+     * The values #Storage_Instance_t.flashTailCursor and #Storage_Instance_t.flashBaseSequence will have once the move
+     * is committed: the blocks overlapping with the pages to erase after the new block are dropped. Valid from
+     * #MOVE_PHASE_PROGRAM on.
+     */
+    int moveTailCursor;
+    int moveBaseSequence; /**< @see moveTailCursor */
+#endif
+
+#if STORAGE_DEFER_ERASE
+    /**
+     * The page number, relative to #STORAGE_FLASH_FIRST_PAGE, of the first page after the newest data in FLASH that is
+     * not yet known to be erased. All pages from the one following #Storage_Instance_t.flashByteCursor up to this one
+     * are erased.
+     * @see StepErase
+     */
+    int eraseCursor;
+#endif
 } Storage_Instance_t;
 
 /**
  * The assigned EEPROM region cannot be used fully: there must be always room for #Marker_t and the last couple of
  * bytes are used to #Hint_t. To avoid corruption in both the marker and the hint, the hint is placed in a separate
- * row.
+ * row. The checkpoint - if any - and the block index, see #IndexEntry_t, each take up rows of their own.
  * The total overhead is summed up here.
  */
 #if STORAGE_REDUCE_RECOVERY_WRITES
-    #define EEPROM_OVERHEAD_IN_BITS ((SIZE_OF_MARKER + EEPROM_ROW_SIZE) * 8)
+    #define EEPROM_OVERHEAD_IN_BITS \
+        ((SIZE_OF_MARKER + (1 + STORAGE_CHECKPOINT + STORAGE_BLOCK_INDEX_ROW_COUNT) * EEPROM_ROW_SIZE) * 8)
 #else
-    #define EEPROM_OVERHEAD_IN_BITS ((SIZE_OF_MARKER + 2 * EEPROM_ROW_SIZE) * 8)
+    #define EEPROM_OVERHEAD_IN_BITS \
+        ((SIZE_OF_MARKER + (2 + STORAGE_CHECKPOINT + STORAGE_BLOCK_INDEX_ROW_COUNT) * EEPROM_ROW_SIZE) * 8)
 #endif
 
 #if STORAGE_MAX_BLOCK_SIZE_IN_SAMPLES != (((STORAGE_EEPROM_ROW_COUNT * EEPROM_ROW_SIZE * 8) - EEPROM_OVERHEAD_IN_BITS) / STORAGE_BITSIZE)
@@ -610,11 +921,52 @@ typedef struct Storage_Instance_s {
 /** If this construct doesn't compile, #STORAGE_TYPE can not hold #STORAGE_BITSIZE bits. */
 int checkSizeOfSampleType[(sizeof(STORAGE_TYPE) * 8 < STORAGE_BITSIZE) ? -1 : 1]; /* Dummy variable since we can't use sizeof during precompilation. */
 
+/**
+ * The size in bytes of the element of #STORAGE_TYPE holding the value of one channel. This is the size of
+ * #STORAGE_TYPE itself when #STORAGE_CHANNEL_COUNT equals @c 1.
+ */
+#define CHANNEL_SIZE (sizeof(STORAGE_TYPE) / STORAGE_CHANNEL_COUNT)
+
+#if STORAGE_CHANNEL_COUNT > 1
+/**
+ * If this construct doesn't compile, #STORAGE_TYPE can not be split in #STORAGE_CHANNEL_COUNT elements of equal size,
+ * or one of these elements can not hold the number of bits of its channel.
+ */
+int checkSizeOfChannelType[((sizeof(STORAGE_TYPE) % STORAGE_CHANNEL_COUNT) != 0)
+        || (CHANNEL_SIZE * 8 < STORAGE_CHANNEL_0_BITSIZE) || (CHANNEL_SIZE * 8 < STORAGE_CHANNEL_1_BITSIZE)
+        || (CHANNEL_SIZE * 8 < STORAGE_CHANNEL_2_BITSIZE) || (CHANNEL_SIZE * 8 < STORAGE_CHANNEL_3_BITSIZE)
+        || (CHANNEL_SIZE * 8 < STORAGE_CHANNEL_4_BITSIZE) || (CHANNEL_SIZE * 8 < STORAGE_CHANNEL_5_BITSIZE)
+        || (CHANNEL_SIZE * 8 < STORAGE_CHANNEL_6_BITSIZE) || (CHANNEL_SIZE * 8 < STORAGE_CHANNEL_7_BITSIZE) ? -1 : 1]; /* Dummy variable since we can't use sizeof during precompilation. */
+#endif
+
 /** If this construct doesn't compile, the define #SIZE_OF_MARKER is no longer equal to @c sizeof(#Hint_t) */
 int checkSizeOfHint[(SIZE_OF_HINT == sizeof(Hint_t)) ? 1 : -1]; /* Dummy variable since we can't use sizeof during precompilation. */
 
+/** If this construct doesn't compile, the define #SIZE_OF_INDEX_ENTRY is no longer equal to @c sizeof(#IndexEntry_t) */
+int checkSizeOfIndexEntry[(SIZE_OF_INDEX_ENTRY == sizeof(IndexEntry_t)) ? 1 : -1]; /* Dummy variable since we can't use sizeof during precompilation. */
+
 /** If this construct doesn't compile, the define #SIZE_OF_MARKER is no longer equal to @c sizeof(#Marker_t) */
 int checkSizeOfMarker[(SIZE_OF_MARKER == sizeof(Marker_t)) ? 1 : -1]; /* Dummy variable since we can't use sizeof during precompilation. */
+#if STORAGE_BLOCK_SUMMARY
+/** If this construct doesn't compile, the define #STORAGE_BLOCK_SUMMARY_SIZE must be adapted. */
+int checkSizeOfBlockSummary[(STORAGE_BLOCK_SUMMARY_SIZE == STORAGE_CHANNEL_COUNT * sizeof(BlockSummary_t)) ? 1 : -1]; /* Dummy variable since we can't use sizeof during precompilation. */
+
+/** If this construct doesn't compile, a channel - or #STORAGE_TYPE - is too large to be summarized. */
+int checkSizeOfSummarizedValue[(CHANNEL_SIZE <= sizeof(int32_t)) ? 1 : -1]; /* Dummy variable since we can't use sizeof during precompilation. */
+#endif
+#if STORAGE_CHECKPOINT
+/** If this construct doesn't compile, the define #SIZE_OF_CHECKPOINT must be adapted. */
+int checkSizeOfCheckpoint[(SIZE_OF_CHECKPOINT == sizeof(Checkpoint_t)) ? 1 : -1]; /* Dummy variable since we can't use sizeof during precompilation. */
+#endif
+#if STORAGE_FLASH_FIRST_PAGE <= STORAGE_FLASH_LAST_PAGE
+/** If this construct doesn't compile, the define #SIZE_OF_JOURNAL must be adapted. */
+int checkSizeOfJournal[(SIZE_OF_JOURNAL == sizeof(Journal_t)) ? 1 : -1]; /* Dummy variable since we can't use sizeof during precompilation. */
+#endif
+
+#if STORAGE_FLASH_CIRCULAR
+/** If this construct doesn't compile, #FLASH_DATA_TRAILER_SIZE is no longer equal to @c sizeof(#Trailer_t) */
+int checkSizeOfTrailer[(FLASH_DATA_TRAILER_SIZE == sizeof(Trailer_t)) ? 1 : -1]; /* Dummy variable since we can't use sizeof during precompilation. */
+#endif
 
 /** If this construct doesn't compile, adjust #FIRST_BITS_OF_CACHE_SIZE. RecoverInfo_t must be exactly 32 bits in size */
 int checkSizeOfRecoverInfo[sizeof(RecoverInfo_t) == 4 ? 1 : -1]; /* Dummy variable since we can't use sizeof during precompilation. */
@@ -652,8 +1004,8 @@ static RecoverInfo_t * spRecoverInfo;
 /* ------------------------------------------------------------------------- */
 
 /**
- * Set to @c true after writing a new sample in EEPROM, used in #Storage_DeInit to know when to write the marker.
- * Not set when resetting the module; as there is no need for a marker in that case.
+ * Set to @c true after writing a new sample in EEPROM, or after resetting the module, used in #Storage_DeInit to know
+ * when to write the marker.
  */
 static bool sEepromBitCursorChanged = false;
 
@@ -704,26 +1056,85 @@ int Storage_DummyDecompressCb(const uint8_t * pData, int bitCount, void * pOut)
 static void ResetInstance(void);
 static void ShiftAlignedData(uint8_t * pTo, const uint8_t * pFrom, const int bitAlignment, const int bitCount);
 static void ShiftUnalignedData(uint8_t * pTo, const uint8_t * pFrom, const int bitAlignment, const int bitCount);
+#if (STORAGE_CHANNEL_COUNT > 1) || (STORAGE_BITSIZE <= 25)
+static void ShiftAlignedSample(uint8_t * pTo, const uint8_t * pFrom, const int bitAlignment);
+static void ShiftUnalignedSample(uint8_t * pTo, const uint8_t * pFrom, const int bitAlignment);
+#else
+    #define ShiftAlignedSample(pTo, pFrom, bitAlignment) ShiftAlignedData((pTo), (pFrom), (bitAlignment), STORAGE_BITSIZE)
+    #define ShiftUnalignedSample(pTo, pFrom, bitAlignment) \
+        ShiftUnalignedData((pTo), (pFrom), (bitAlignment), STORAGE_BITSIZE)
+#endif
 #if STORAGE_SAMPLE_ALON_CACHE_COUNT > 0
 static bool CacheSample(const STORAGE_TYPE * pSample);
 static bool GetCachedSample(const int n, void * pData);
 #endif
 static void WriteToEeprom(const int bitCursor, const void * pData, const int bitCount);
+static void WriteSamplesToEeprom(int bitCursor, const STORAGE_TYPE * pSamples, int n);
 static void ReadFromEeprom(const unsigned int bitCursor, void * pData, const int bitCount);
+static void ReadSampleFromEeprom(const int bitCursor, STORAGE_TYPE * pSample);
+#if STORAGE_BLOCK_SUMMARY
+static int32_t GetChannelValue(const STORAGE_TYPE * pSample, int channel);
+static void SummarizeValue(Storage_Summary_t * pSummary, int32_t value);
+static void SummarizeEepromBlock(uint8_t * pOut);
+#endif
 static unsigned int FindMarker(Marker_t * pMarker);
 static int GetEepromCount(void);
+static int NextFlashBlockCursor(int flashByteCursor, int blockSize);
+static bool IsIndexEntryTrusted(const IndexEntry_t * pEntry, int span);
+static int FindIndexedBlock(int block, int * pCursor);
+static void SetIndexEntry(int span, int flashByteCursor, int sequence);
+static void IndexFlashBlock(int flashByteCursor, int blockSize, int sequence);
+static void IndexFlashBlocks(void);
+static int GetFlashBlockCursor(int block);
 static int GetFlashCount(void);
 #if STORAGE_FLASH_FIRST_PAGE <= STORAGE_FLASH_LAST_PAGE
 static bool WriteToFlash(const int pageCursor, const uint8_t * pData, const int pageCount);
 #endif
 static int StoreSamplesInEeprom(const STORAGE_TYPE * pSamples, int n);
+#if STORAGE_FLASH_FIRST_PAGE <= STORAGE_FLASH_LAST_PAGE
+static void ShiftEepromSamples(int firstBit, int bitCount);
+static void FinishCommit(Journal_t * pJournal);
+#endif
+#if STORAGE_FLASH_CIRCULAR || (STORAGE_DEFER_ERASE && (STORAGE_FLASH_FIRST_PAGE <= STORAGE_FLASH_LAST_PAGE))
+static bool IsPageErased(int page);
+#endif
+#if STORAGE_FLASH_CIRCULAR
+static bool IsInEraseZone(int head, int firstByte, int size);
+static int GetNextPageToErase(void);
+#endif
+#if STORAGE_DEFER_ERASE && (STORAGE_FLASH_FIRST_PAGE <= STORAGE_FLASH_LAST_PAGE)
+static int GetEraseLimit(void);
+static bool StepErase(void);
+#endif
+#if STORAGE_FLASH_FIRST_PAGE <= STORAGE_FLASH_LAST_PAGE
+static bool IsMovePending(void);
+#endif
+static bool StepMoveSamplesFromEepromToFlash(void);
 static bool MoveSamplesFromEepromToFlash(void);
-static int ReadAndCacheSamplesFromFlash(int readCursor);
+static void InvalidateDecompressedBlocks(void);
+static int ReadAndCacheSamplesFromFlash(int readCursor, const uint8_t ** ppSamples);
+static int GetFlashRun(const STORAGE_TYPE ** ppRun, int max);
 static bool ValidateRecoverInfo(void);
 static bool ValidateMarker(const Marker_t * pMarker, int expectedFlashByteCursor);
 static bool ValidateHint(const Hint_t * pHint);
+static bool SearchMarker(int eepromBitCursor, int flashByteCursor, int count, Marker_t * pMarker);
 static void WriteHint(void);
 static void WriteMarker(void);
+#if STORAGE_CHECKPOINT || STORAGE_BLOCK_CRC || (STORAGE_FLASH_FIRST_PAGE <= STORAGE_FLASH_LAST_PAGE)
+static uint16_t CalculateCrc(uint16_t crc, const uint8_t * pData, int length);
+#endif
+#if STORAGE_BLOCK_CRC
+static uint16_t CalculateBlockCrc(const uint8_t * pHeader, int bitCount);
+static uint16_t GetBlockCrc(const uint8_t * pHeader);
+#endif
+#if STORAGE_CHECKPOINT
+static bool ReadCheckpoint(Checkpoint_t * pCheckpoint);
+static void WriteCheckpoint(void);
+#endif
+#if STORAGE_FLASH_FIRST_PAGE <= STORAGE_FLASH_LAST_PAGE
+static bool ReadJournal(Journal_t * pJournal);
+static void WriteJournal(Journal_t * pJournal);
+#endif
 
 /* ------------------------------------------------------------------------- */
 
@@ -736,11 +1147,19 @@ static void ResetInstance(void)
 {
     sInstance.eepromBitCursor = 0;
     sInstance.flashByteCursor = 0;
+    sInstance.flashTailCursor = 0;
+    sInstance.flashBaseSequence = 0;
     sInstance.readLocation = LOCATION_UNKNOWN;
     sInstance.readSequence = -1;
     sInstance.readCursor = -1;
     sInstance.targetSequence = -1;
-    sInstance.cachedBlockOffset = -1;
+    InvalidateDecompressedBlocks();
+    sInstance.cacheUseCount = 0;
+    sInstance.blockCount = -1;
+    sInstance.movePhase = MOVE_PHASE_IDLE;
+#if STORAGE_DEFER_ERASE
+    sInstance.eraseCursor = 0;
+#endif
 }
 
 /**
@@ -761,40 +1180,47 @@ static void ResetInstance(void)
  */
 static void ShiftAlignedData(uint8_t * pTo, const uint8_t * pFrom, const int bitAlignment, const int bitCount)
 {
-    const uint8_t mask = (uint8_t)(0xFF & ((1 << bitAlignment) - 1)); /* Covering the existing bits in the last byte. */
-
     ASSERT((bitAlignment >= 0) && (bitAlignment < 8));
     ASSERT(bitCount > 0);
 
-    /* 8 bits at a time, data is moved from @c from to @c to.
+    /* Data is gathered in a 32-bit accumulator. Three bytes from @c from are added to it and three bytes are emitted
+     * to @c to per iteration, leaving @c bitAlignment pending bits in the accumulator. Only byte accesses are used, as
+     * @c from and @c to need not be word aligned.
      *
-     * 8 bits from @c from are copied to two consecutive bytes in @c to: 321- ----   ---8 7654 (-: don't care)
-     * - Step 1: write the lsbits of 87654321 such that the ongoing byte is filled
-     *   ... xxxxxxxx 321xxxxx -------- ...
-     * - Step 2: write the msbits of 87654321 in the lsbit positions of the next byte
-     *   ... xxxxxxxx 321xxxxx ---87654 ...
-     * (in the above example, @c bitAlignment equals 5)
+     * The pending bits at the start are the existing bits in the first byte of @c to that are not to be touched:
+     * 321- ----   cba8 7654   0000 0fed (-: pending bits)
      */
-    int n = 0;
-    do {
-        /* Step 1: copy x lsbits of the current byte, with x = 8-bitAlignment so left shift bitAlignment places */
-        *pTo = (uint8_t)((pFrom[n] << bitAlignment) | ((*pTo) & mask));
-
-        if ((n * 8) + 8 - bitAlignment < bitCount) {
-            /* Advance to the next location to copy bits to. */
-            pTo++;
-
-            /* Step 2: copy x msbits of the new byte, with x = bitAlignment so right shift 8-bitAlignment places */
-            *pTo = (uint8_t)(pFrom[n] >> (8 - bitAlignment));
-        }
-
-        n++;
-    } while (n * 8 < bitCount);
+    uint32_t acc = (uint32_t)(*pTo) & ((1U << bitAlignment) - 1);
+    int remaining = bitCount;
+    while (remaining >= 24) {
+        acc |= ((uint32_t)pFrom[0] | ((uint32_t)pFrom[1] << 8) | ((uint32_t)pFrom[2] << 16)) << bitAlignment;
+        pTo[0] = (uint8_t)acc;
+        pTo[1] = (uint8_t)(acc >> 8);
+        pTo[2] = (uint8_t)(acc >> 16);
+        acc >>= 24;
+        pFrom += 3;
+        pTo += 3;
+        remaining -= 24;
+    }
 
-    /* Clear the bits that were copied in excess. */
-    uint8_t finalMask = (uint8_t)~(0xFF << ((bitCount + bitAlignment) % 8));
-    if (finalMask != 0) { /* finalMask equals zero when the last bit to retain is the MSBit of the last byte written. */
-        *pTo = *pTo & finalMask;
+    /* Tail: less than 24 bits are left, which together with the pending bits fit in the accumulator. */
+    if (remaining > 0) {
+        acc |= (uint32_t)pFrom[0] << bitAlignment;
+    }
+    if (remaining > 8) {
+        acc |= (uint32_t)pFrom[1] << (bitAlignment + 8);
+    }
+    if (remaining > 16) {
+        acc |= (uint32_t)pFrom[2] << (bitAlignment + 16);
+    }
+    remaining += bitAlignment;
+    if (remaining > 0) {
+        acc &= (1U << remaining) - 1; /* Clear the bits that were copied in excess. */
+        do {
+            *pTo++ = (uint8_t)acc;
+            acc >>= 8;
+            remaining -= 8;
+        } while (remaining > 0);
     }
 }
 
@@ -816,46 +1242,171 @@ static void ShiftAlignedData(uint8_t * pTo, const uint8_t * pFrom, const int bit
  */
 static void ShiftUnalignedData(uint8_t * pTo, const uint8_t * pFrom, const int bitAlignment, const int bitCount)
 {
-    const uint8_t mask = 0xFF & (uint8_t)((1 << (8 - bitAlignment)) - 1); /* Covering the lsbits to retain in the copied byte. */
-
     ASSERT((bitAlignment >= 0) && (bitAlignment < 8));
     ASSERT(bitCount > 0);
 
-    /* 8 bits at a time, data is moved from @c from to @c to.
-     *
-     * 8 bits from two consecutive bytes in @c from: 321- ----   ---8 7654 (-: don't care) are copied to one byte in
-     * @c to:
-     * - Step 1: read the msbits of 321- ----
-     *   byte = 0b00000321
-     * - Step 2: read the lsbits of ---8 7654
-     *   byte = 0b87654321
-     * (in the above example, @c bitAlignment equals 5)
+    /* Data is gathered in a 32-bit accumulator. The first byte of @c from is loaded shifted, after which three bytes
+     * from @c from are added and three bytes are emitted to @c to per iteration, leaving @code 8 - bitAlignment
+     * @endcode pending bits in the accumulator. Only byte accesses are used, as @c from and @c to need not be word
+     * aligned.
      */
-    int n = 0;
-    do {
-        /* Step 1: copy x msbits of the current byte, with x = 8-bitAlignment so right shift bitAlignment places. */
-        *pTo = (uint8_t)((pFrom[n]) >> bitAlignment);
+    const int pending = 8 - bitAlignment;
+    uint32_t acc = (uint32_t)(*pFrom++) >> bitAlignment;
+    int remaining = bitCount;
+    while (remaining - pending >= 24) {
+        acc |= ((uint32_t)pFrom[0] | ((uint32_t)pFrom[1] << 8) | ((uint32_t)pFrom[2] << 16)) << pending;
+        pTo[0] = (uint8_t)acc;
+        pTo[1] = (uint8_t)(acc >> 8);
+        pTo[2] = (uint8_t)(acc >> 16);
+        acc >>= 24;
+        pFrom += 3;
+        pTo += 3;
+        remaining -= 24;
+    }
 
-        /* Advance to the next location to copy bits from. */
-        n++;
+    /* Tail: less than 24 bits are left to load, which together with the pending bits fit in the accumulator. */
+    if (remaining > pending) {
+        acc |= (uint32_t)pFrom[0] << pending;
+    }
+    if (remaining > pending + 8) {
+        acc |= (uint32_t)pFrom[1] << (pending + 8);
+    }
+    if (remaining > pending + 16) {
+        acc |= (uint32_t)pFrom[2] << (pending + 16);
+    }
+    acc &= (1U << remaining) - 1; /* Clear the bits that were copied in excess. */
+    do {
+        *pTo++ = (uint8_t)acc;
+        acc >>= 8;
+        remaining -= 8;
+    } while (remaining > 0);
+}
 
-        if (((n - 1) * 8) + 8 - bitAlignment < bitCount) {
+#if (STORAGE_CHANNEL_COUNT > 1) || STORAGE_BLOCK_SUMMARY
+/** The number of bits stored per channel. */
+static const uint8_t sChannelBitSize[8] = STORAGE_CHANNEL_BITSIZES;
+#endif
 
-            /* Step 2: copy x lsbits of the next byte, with x = bitAlignment so left shift 8-bitAlignment places. */
-            *pTo = (uint8_t)((pFrom[n] << (8 - bitAlignment)) | ((*pTo) & mask));
+#if STORAGE_CHANNEL_COUNT > 1
+/**
+ * Copies a single sample to a buffer, non-byte aligned: the #STORAGE_CHANNEL_COUNT elements of the sample are packed
+ * back to back, keeping only the bits of each channel - see #STORAGE_CHANNEL_0_BITSIZE and on.
+ * @param pTo The location to copy to. A number of LSBits of the first byte are not touched.
+ * @param pFrom The location to copy from: a complete #STORAGE_TYPE.
+ * @param bitAlignment The number of bits to disregard in @c to. Must be less than @c 8.
+ */
+static void ShiftAlignedSample(uint8_t * pTo, const uint8_t * pFrom, const int bitAlignment)
+{
+    int bitPosition = bitAlignment;
+    for (int c = 0; c < STORAGE_CHANNEL_COUNT; c++) {
+        ShiftAlignedData(pTo + bitPosition / 8, pFrom + c * CHANNEL_SIZE, bitPosition % 8, sChannelBitSize[c]);
+        bitPosition += sChannelBitSize[c];
+    }
+}
 
-            if (n * 8 < bitCount) {
-                pTo++; /* Do not increment @c to unconditionally: @c finalmask still may have to be applied. */
-            }
+/**
+ * Copies a single sample of packed, non-byte aligned data to a buffer: the inverse of #ShiftAlignedSample.
+ * @param pTo The location to copy to: all bytes of a #STORAGE_TYPE are written. Per channel, the MSBits are set to
+ *  @c 0 or - when #STORAGE_SIGNED is set - to the value of the sign bit of the channel.
+ * @param pFrom The location to copy from. A number of LSBits are disregarded.
+ * @param bitAlignment The number of bits to disregard in @c from. Must be less than @c 8.
+ */
+static void ShiftUnalignedSample(uint8_t * pTo, const uint8_t * pFrom, const int bitAlignment)
+{
+    int bitPosition = bitAlignment;
+    for (int c = 0; c < STORAGE_CHANNEL_COUNT; c++) {
+        const int bitSize = sChannelBitSize[c];
+        const int byteCount = STORAGE_IDIVUP(bitSize, 8);
+        uint8_t fill = 0;
+        ShiftUnalignedData(pTo, pFrom + bitPosition / 8, bitPosition % 8, bitSize);
+#if STORAGE_SIGNED
+        if ((pTo[(bitSize - 1) / 8] >> ((bitSize - 1) % 8)) & 1) {
+            fill = 0xFF;
+            pTo[byteCount - 1] = (uint8_t)(pTo[byteCount - 1] | (0xFF << (((bitSize - 1) % 8) + 1)));
         }
-    } while (n * 8 < bitCount);
+#endif
+        memset(pTo + byteCount, fill, CHANNEL_SIZE - (size_t)byteCount);
+        pTo += CHANNEL_SIZE;
+        bitPosition += bitSize;
+    }
+}
+#elif STORAGE_BITSIZE <= 25
+/**
+ * Copies a single sample of byte aligned data to a buffer, non-byte aligned.
+ * Specialization of #ShiftAlignedData for @c bitCount equal to #STORAGE_BITSIZE: as a sample spans at most 4 bytes
+ * of @c to, it is moved in a single 32-bit word, the loop being fully unrolled at compile time.
+ * @param pTo The location to copy to. A number of LSBits of the first byte are not touched.
+ * @param pFrom The location to copy from.
+ * @param bitAlignment The number of bits to disregard in @c to. Must be less than @c 8.
+ */
+static void ShiftAlignedSample(uint8_t * pTo, const uint8_t * pFrom, const int bitAlignment)
+{
+    const int end = STORAGE_BITSIZE + bitAlignment;
+
+    ASSERT((bitAlignment >= 0) && (bitAlignment < 8));
+
+    uint32_t value = pFrom[0];
+#if STORAGE_BITSIZE > 8
+    value |= (uint32_t)pFrom[1] << 8;
+#endif
+#if STORAGE_BITSIZE > 16
+    value |= (uint32_t)pFrom[2] << 16;
+#endif
+#if STORAGE_BITSIZE > 24
+    value |= (uint32_t)pFrom[3] << 24;
+#endif
+    value = ((value & ((1UL << STORAGE_BITSIZE) - 1)) << bitAlignment) | (pTo[0] & ((1U << bitAlignment) - 1));
+
+    pTo[0] = (uint8_t)value;
+    if (end > 8) {
+        pTo[1] = (uint8_t)(value >> 8);
+    }
+    if (end > 16) {
+        pTo[2] = (uint8_t)(value >> 16);
+    }
+    if (end > 24) {
+        pTo[3] = (uint8_t)(value >> 24);
+    }
+}
+
+/**
+ * Copies a single sample of non-byte aligned data to a buffer, byte aligned.
+ * Specialization of #ShiftUnalignedData for @c bitCount equal to #STORAGE_BITSIZE: as a sample spans at most 4 bytes
+ * of @c from, it is moved in a single 32-bit word, the loop being fully unrolled at compile time.
+ * @param pTo The location to copy to.
+ * @param pFrom The location to copy from. A number of LSBits are disregarded.
+ * @param bitAlignment The number of bits to disregard in @c from. Must be less than @c 8.
+ */
+static void ShiftUnalignedSample(uint8_t * pTo, const uint8_t * pFrom, const int bitAlignment)
+{
+    const int end = STORAGE_BITSIZE + bitAlignment;
+
+    ASSERT((bitAlignment >= 0) && (bitAlignment < 8));
 
-    /* Clear the bits that were copied in excess. */
-    uint8_t finalMask = (uint8_t)~(0xFF << (bitCount % 8));
-    if (finalMask != 0) { /* finalMask equals zero when the last bit to retain is the MSBit of the last byte written. */
-        *pTo = *pTo & finalMask;
+    uint32_t value = pFrom[0];
+    if (end > 8) {
+        value |= (uint32_t)pFrom[1] << 8;
     }
+    if (end > 16) {
+        value |= (uint32_t)pFrom[2] << 16;
+    }
+    if (end > 24) {
+        value |= (uint32_t)pFrom[3] << 24;
+    }
+    value = (value >> bitAlignment) & ((1UL << STORAGE_BITSIZE) - 1);
+
+    pTo[0] = (uint8_t)value;
+#if STORAGE_BITSIZE > 8
+    pTo[1] = (uint8_t)(value >> 8);
+#endif
+#if STORAGE_BITSIZE > 16
+    pTo[2] = (uint8_t)(value >> 16);
+#endif
+#if STORAGE_BITSIZE > 24
+    pTo[3] = (uint8_t)(value >> 24);
+#endif
 }
+#endif
 
 /* ------------------------------------------------------------------------- */
 
@@ -873,7 +1424,7 @@ static bool CacheSample(const STORAGE_TYPE * pSample)
         int bitCursor = (32 - FIRST_BITS_OF_CACHE_SIZE) + (spRecoverInfo->sampleCacheCount * STORAGE_BITSIZE);
         int byteOffset = bitCursor / 8;
         int bitAlignment = bitCursor % 8;
-        ShiftAlignedData(&sCache[byteOffset], (uint8_t *)pSample, bitAlignment, STORAGE_BITSIZE);
+        ShiftAlignedSample(&sCache[byteOffset], (uint8_t *)pSample, bitAlignment);
         spRecoverInfo->sampleCacheCount++;
         success = true;
     }
@@ -893,7 +1444,7 @@ static bool GetCachedSample(const int n, void * pData)
         int bitCursor = (32 - FIRST_BITS_OF_CACHE_SIZE) + (n * STORAGE_BITSIZE);
         int byteOffset = bitCursor / 8;
         int bitAlignment = bitCursor % 8;
-        ShiftUnalignedData((uint8_t *)pData, &sCache[byteOffset], bitAlignment, STORAGE_BITSIZE);
+        ShiftUnalignedSample((uint8_t *)pData, &sCache[byteOffset], bitAlignment);
     }
     return n < spRecoverInfo->sampleCacheCount;
 }
@@ -929,6 +1480,48 @@ static void WriteToEeprom(const int bitCursor, const void * pData, const int bit
     Chip_EEPROM_Write(NSS_EEPROM, byteOffset, bytes, byteCount);
 }
 
+/**
+ * Appends samples in EEPROM. The samples are first packed back to back in SRAM, up to the end of the EEPROM row
+ * being written to, and then written in one go: a single call to @c Chip_EEPROM_Write is issued per EEPROM row
+ * spanned, instead of one per sample.
+ * @pre EEPROM is initialized
+ * @pre Enough free space must be available in EEPROM starting from @c bitCursor
+ * @param bitCursor Must be positive. The first bit where to start writing.
+ * @param pSamples May not be @c NULL. Pointer to the start of the array where to copy the samples from.
+ * @param n Must be strict positive. The number of samples to write.
+ * @post #sInstance is not touched.
+ */
+static void WriteSamplesToEeprom(int bitCursor, const STORAGE_TYPE * pSamples, int n)
+{
+    /* Enough room for the remainder of a row, and for the last sample that may cross into the next row. */
+    uint8_t bytes[EEPROM_ROW_SIZE + STORAGE_IDIVUP(STORAGE_BITSIZE, 8)];
+
+    ASSERT(bitCursor >= 0);
+    ASSERT(pSamples != NULL);
+    ASSERT(n > 0);
+
+    while (n > 0) {
+        const int bitAlignment = bitCursor % 8; /* The number of lsbits written in the first byte. */
+        const int byteOffset = EEPROM_ABSOLUTE_FIRST_BYTE_OFFSET + bitCursor / 8; /* The index to the first byte. */
+        const int rowEnd = (EEPROM_ROW_SIZE - (byteOffset % EEPROM_ROW_SIZE)) * 8; /* Relative to @c bytes, in bits. */
+
+        /* Read the first byte we will write to, to preserve a number of LSBits in that byte which were written
+         * previously.
+         */
+        Chip_EEPROM_Read(NSS_EEPROM, byteOffset, bytes, 1);
+        int bitPosition = bitAlignment;
+        do {
+            ShiftAlignedSample(bytes + bitPosition / 8, (const uint8_t *)pSamples, bitPosition % 8);
+            bitPosition += STORAGE_BITSIZE;
+            pSamples++;
+            n--;
+        } while ((n > 0) && (bitPosition < rowEnd));
+        Chip_EEPROM_Write(NSS_EEPROM, byteOffset, bytes, STORAGE_IDIVUP(bitPosition, 8));
+
+        bitCursor += bitPosition - bitAlignment;
+    }
+}
+
 /**
  * @pre EEPROM is initialized
  * @pre Enough bits to read are available in EEPROM starting from @c bitCursor
@@ -954,24 +1547,114 @@ static void ReadFromEeprom(const unsigned int bitCursor, void * pData, const int
     ShiftUnalignedData((uint8_t *)pData, bytes, bitAlignment, bitCount);
 }
 
-/* ------------------------------------------------------------------------- */
+/**
+ * Reads a single sample from EEPROM.
+ * @pre EEPROM is initialized
+ * @pre A sample is available in EEPROM starting from @c bitCursor
+ * @param bitCursor Must be positive. The bit position in EEPROM of the sample.
+ * @param pSample May not be @c NULL. The sample is unpacked in the location pointed to: see #ShiftUnalignedSample.
+ * @post #sInstance is not touched.
+ */
+static void ReadSampleFromEeprom(const int bitCursor, STORAGE_TYPE * pSample)
+{
+    const int bitAlignment = bitCursor % 8;
+    uint8_t bytes[STORAGE_IDIVUP(STORAGE_BITSIZE + 7, 8)];
+
+    ASSERT(bitCursor >= 0);
+    ASSERT(pSample != NULL);
+
+    Chip_EEPROM_Read(NSS_EEPROM, EEPROM_ABSOLUTE_FIRST_BYTE_OFFSET + bitCursor / 8, bytes,
+                     STORAGE_IDIVUP(STORAGE_BITSIZE + bitAlignment, 8));
+    ShiftUnalignedSample((uint8_t *)pSample, bytes, bitAlignment);
+}
 
+#if STORAGE_BLOCK_SUMMARY
 /**
- * Search backwards in the assigned EEPROM region, looking for a valid marker.
- * @param [out] pMarker : Where to copy the found marker data to. If @c 0 is returned, this will contain an invalid
- *  marker.
- * @return The position of the first bit of a valid stored instance of type #Marker_t in EEPROM, relative to
- *  #STORAGE_EEPROM_FIRST_ROW. @c 0 if the marker could not be found.
+ * Retrieves the value of one channel of a sample, as used in a summary.
+ * @param pSample May not be @c NULL. The sample, as given to #Storage_Write or as copied by #Storage_Read.
+ * @param channel Must be in the range [0, #STORAGE_CHANNEL_COUNT[.
+ * @return Only the bits that are stored for that channel are used: sign extended when #STORAGE_SIGNED is set.
  */
-static unsigned int FindMarker(Marker_t * pMarker)
+static int32_t GetChannelValue(const STORAGE_TYPE * pSample, int channel)
 {
-    unsigned int eepromBitCursor;
-    bool found = false;
+    const int bitSize = sChannelBitSize[channel];
+    uint32_t value = 0;
 
-    /* Start a slow search, checking the full EEPROM contents assigned to the storage module. */
-    unsigned int byteOffset = EEPROM_ABSOLUTE_LAST_BYTE_OFFSET - (EEPROM_OVERHEAD_IN_BITS / 8); /* Search backwards. */
-    do {
-        /* The marker consists of a header, a value, and a footer.
+    memcpy(&value, (const uint8_t *)pSample + (size_t)channel * CHANNEL_SIZE, CHANNEL_SIZE);
+    if (bitSize < 32) {
+        value &= (1UL << bitSize) - 1;
+#if STORAGE_SIGNED
+        if (value & (1UL << (bitSize - 1))) {
+            value |= ~((1UL << bitSize) - 1);
+        }
+#endif
+    }
+    return (int32_t)value;
+}
+
+/**
+ * Adds one value to a summary.
+ * @param pSummary May not be @c NULL. The summary to update.
+ * @param value The value to add.
+ */
+static void SummarizeValue(Storage_Summary_t * pSummary, int32_t value)
+{
+    if ((pSummary->count == 0) || (value < pSummary->min)) {
+        pSummary->min = value;
+    }
+    if ((pSummary->count == 0) || (value > pSummary->max)) {
+        pSummary->max = value;
+    }
+    pSummary->sum += value;
+    pSummary->count++;
+}
+
+/**
+ * Calculates the summary of the oldest #STORAGE_BLOCK_SIZE_IN_SAMPLES samples in EEPROM: those about to be moved to
+ * FLASH.
+ * @param pOut May not be @c NULL. Where to copy the #STORAGE_CHANNEL_COUNT #BlockSummary_t instances to. Need not be
+ *  aligned.
+ */
+static void SummarizeEepromBlock(uint8_t * pOut)
+{
+    Storage_Summary_t summaries[STORAGE_CHANNEL_COUNT];
+    memset(summaries, 0, sizeof(summaries));
+
+    for (int i = 0; i < STORAGE_BLOCK_SIZE_IN_SAMPLES; i++) {
+        STORAGE_TYPE sample;
+        ReadSampleFromEeprom(i * STORAGE_BITSIZE, &sample);
+        for (int c = 0; c < STORAGE_CHANNEL_COUNT; c++) {
+            SummarizeValue(&summaries[c], GetChannelValue(&sample, c));
+        }
+    }
+    for (int c = 0; c < STORAGE_CHANNEL_COUNT; c++) {
+        BlockSummary_t blockSummary = {.min = summaries[c].min, .max = summaries[c].max, .sum = summaries[c].sum};
+        memcpy(pOut + (size_t)c * sizeof(BlockSummary_t), &blockSummary, sizeof(BlockSummary_t));
+    }
+}
+#endif
+
+/* ------------------------------------------------------------------------- */
+
+/**
+ * Search backwards in the assigned EEPROM region, looking for a valid marker.
+ * @param [out] pMarker : Where to copy the found marker data to. If @c 0 is returned, this will contain an invalid
+ *  marker.
+ * @return The position of the first bit of a valid stored instance of type #Marker_t in EEPROM, relative to
+ *  #STORAGE_EEPROM_FIRST_ROW. @c 0 if the marker could not be found.
+ */
+static unsigned int FindMarker(Marker_t * pMarker)
+{
+    unsigned int eepromBitCursor;
+    bool found = false;
+
+    /* Start a slow search, checking the full EEPROM contents assigned to the storage module. */
+    /* Search backwards, starting from the last 16-bit word that can hold a part of the footer: when the assigned EEPROM
+     * region is completely filled with samples, the marker ends just before the recovery rows.
+     */
+    unsigned int byteOffset = EEPROM_ABSOLUTE_LAST_BYTE_OFFSET + 1 - (EEPROM_OVERHEAD_IN_BITS / 8) + SIZE_OF_MARKER - 2;
+    do {
+        /* The marker consists of a header, a value, and a footer.
          * By reading 16-bit words one at a time (step a) from high offset to low, we must find a value equal to
          * @c 0xFFFF that is part of the FOOTER: see ---------------- below.
          * If found (step b), we can read the word value @c h with relative byte offset @c -8 (step c) that is part
@@ -1030,26 +1713,187 @@ static int GetEepromCount(void)
     return sInstance.eepromBitCursor / STORAGE_BITSIZE;
 }
 
-/** @return The number of samples stored in FLASH. */
-static int GetFlashCount(void)
+/**
+ * Determines where the (compressed) data block following a given block is stored in FLASH.
+ * @param flashByteCursor The offset in bytes relative to #FLASH_FIRST_BYTE_ADDRESS to the header of a block.
+ * @param blockSize The size of that block, as given by #FLASH_BLOCK_SIZE.
+ * @return The offset in bytes relative to #FLASH_FIRST_BYTE_ADDRESS to the header of the next block; or
+ *  #Storage_Instance_t.flashByteCursor when the given block is the newest one.
+ */
+static int NextFlashBlockCursor(int flashByteCursor, int blockSize)
 {
-    int sequenceCount = 0;
-    /* Loop over all the (compressed) data blocks in FLASH - each is storing the same amount of samples. */
-    int readCursor = 0;
-    while (readCursor < sInstance.flashByteCursor) {
+    int next = flashByteCursor + blockSize;
+#if STORAGE_FLASH_CIRCULAR
+    /* A block never wraps around: when it does not fit before the end of the assigned FLASH region, it is written at
+     * the start instead, leaving the remainder erased.
+     */
+    if (next != sInstance.flashByteCursor) {
+        const uint8_t * header = FLASH_CURSOR_TO_BYTE_ADDRESS(next);
+        if ((next >= FLASH_REGION_SIZE) || ((header[0] & header[1]) == 0xFF)) {
+            next = 0;
+        }
+    }
+#endif
+    return next;
+}
+
+/**
+ * Checks whether an entry of the block index can be trusted - see #IndexEntry_t.
+ * @param pEntry The entry to check.
+ * @param span The index of the entry.
+ * @return @c true when the entry refers to a (compressed) data block stored in FLASH.
+ */
+static bool IsIndexEntryTrusted(const IndexEntry_t * pEntry, int span)
+{
+    int cursor = pEntry->flashByteCursor;
+    bool trusted = (cursor != INDEX_NONE) && (cursor / INDEX_SPAN_SIZE == span);
+#if STORAGE_FLASH_CIRCULAR
+    if (sInstance.flashTailCursor <= sInstance.flashByteCursor) {
+        trusted = trusted && (cursor >= sInstance.flashTailCursor) && (cursor < sInstance.flashByteCursor);
+    }
+    else {
+        trusted = trusted && ((cursor >= sInstance.flashTailCursor) || (cursor < sInstance.flashByteCursor));
+    }
+#else
+    trusted = trusted && (cursor < sInstance.flashByteCursor);
+#endif
+    return trusted;
+}
+
+/**
+ * Looks up in the block index the newest (compressed) data block that is not newer than the given block.
+ * @param block The index of the block to look for: @c 0 indicates the oldest block.
+ * @param [out] pCursor Receives the offset in bytes relative to #FLASH_FIRST_BYTE_ADDRESS to the header preceding the
+ *  block found.
+ * @return The index of the block found, less than or equal to @c block. When the index holds no trusted entry for an
+ *  older block, @c 0 is returned and @c pCursor receives #Storage_Instance_t.flashTailCursor.
+ * @note The cost is independent of the number of blocks stored: at most #STORAGE_BLOCK_INDEX_COUNT entries are read.
+ *  The entries are not sorted when #STORAGE_FLASH_CIRCULAR is set, so they are all checked.
+ */
+static int FindIndexedBlock(int block, int * pCursor)
+{
+    IndexEntry_t index[STORAGE_BLOCK_INDEX_COUNT];
+    Chip_EEPROM_Read(NSS_EEPROM, INDEX_ABSOLUTE_BYTE_OFFSET, index, INDEX_ENTRY_COUNT * SIZE_OF_INDEX_ENTRY);
+
+    uint16_t baseBlock = (uint16_t)(sInstance.flashBaseSequence / STORAGE_BLOCK_SIZE_IN_SAMPLES);
+    int found = 0;
+    *pCursor = sInstance.flashTailCursor;
+    for (int span = 0; span < INDEX_ENTRY_COUNT; span++) {
+        int b = (uint16_t)(index[span].block - baseBlock);
+        if ((b > found) && (b <= block) && IsIndexEntryTrusted(&index[span], span)) {
+            found = b;
+            *pCursor = index[span].flashByteCursor;
+        }
+    }
+    return found;
+}
+
+/**
+ * Updates one entry of the block index in EEPROM, if it changes.
+ * @param span The index of the entry.
+ * @param flashByteCursor The offset in bytes relative to #FLASH_FIRST_BYTE_ADDRESS to the header of the last block
+ *  starting in the span, or #INDEX_NONE.
+ * @param sequence The sequence number of the first sample in that block. Ignored for #INDEX_NONE.
+ */
+static void SetIndexEntry(int span, int flashByteCursor, int sequence)
+{
+    IndexEntry_t entry = {.flashByteCursor = (uint16_t)flashByteCursor, .block = INDEX_NONE};
+    if (flashByteCursor != INDEX_NONE) {
+        entry.block = (uint16_t)(sequence / STORAGE_BLOCK_SIZE_IN_SAMPLES);
+    }
+    IndexEntry_t stored;
+    const int offset = INDEX_ABSOLUTE_BYTE_OFFSET + span * SIZE_OF_INDEX_ENTRY;
+    Chip_EEPROM_Read(NSS_EEPROM, offset, &stored, SIZE_OF_INDEX_ENTRY);
+    if ((stored.flashByteCursor != entry.flashByteCursor) || (stored.block != entry.block)) {
+        Chip_EEPROM_Write(NSS_EEPROM, offset, &entry, SIZE_OF_INDEX_ENTRY);
+    }
+}
+
+/**
+ * Adds a new (compressed) data block to the block index: it becomes the last block with a header in its span, and the
+ * other spans it extends into no longer hold a header that can be trusted.
+ * @param flashByteCursor The offset in bytes relative to #FLASH_FIRST_BYTE_ADDRESS to the header of the new block.
+ * @param blockSize The size in bytes of the new block, as given by #FLASH_BLOCK_SIZE.
+ * @param sequence The sequence number of the first sample in the new block.
+ */
+static void IndexFlashBlock(int flashByteCursor, int blockSize, int sequence)
+{
+    int span = flashByteCursor / INDEX_SPAN_SIZE;
+    SetIndexEntry(span, flashByteCursor, sequence);
+    for (span++; span <= (flashByteCursor + blockSize - 1) / INDEX_SPAN_SIZE; span++) {
+        SetIndexEntry(span, INDEX_NONE, 0);
+    }
+}
+
+/**
+ * Determines #Storage_Instance_t.blockCount, if not yet done.
+ * Only the block headers after the newest block found in the block index are stepped through: at most those in one
+ * FLASH sector.
+ */
+static void IndexFlashBlocks(void)
+{
+    if (sInstance.blockCount < 0) {
+        int readCursor;
+        int blockCount = FindIndexedBlock(INT_MAX, &readCursor);
+#if STORAGE_FLASH_CIRCULAR
+        int walked = 0; /* Guards against looping forever over corrupt block headers. */
+        while ((readCursor != sInstance.flashByteCursor) && (walked < FLASH_REGION_SIZE)) {
+#else
+        while (readCursor < sInstance.flashByteCursor) {
+#endif
+            uint8_t * header = FLASH_CURSOR_TO_BYTE_ADDRESS(readCursor);
+            int bitCount = (int)(header[0] | (header[1] << 8));
+#if STORAGE_FLASH_CIRCULAR
+            walked += FLASH_BLOCK_SIZE(bitCount);
+#endif
+            readCursor = NextFlashBlockCursor(readCursor, FLASH_BLOCK_SIZE(bitCount));
+            blockCount++;
+        }
+        sInstance.blockCount = blockCount;
+    }
+}
+
+/**
+ * Determines where a (compressed) data block is stored in FLASH.
+ * @param block Must be positive and less than #Storage_Instance_t.blockCount. The index of the block: @c 0 indicates
+ *  the oldest block, holding the samples with sequence numbers #Storage_Instance_t.flashBaseSequence up to
+ *  @code flashBaseSequence + STORAGE_BLOCK_SIZE_IN_SAMPLES @endcode.
+ * @return The offset in bytes relative to #FLASH_FIRST_BYTE_ADDRESS to the header preceding the block.
+ * @pre #IndexFlashBlocks has been called.
+ */
+static int GetFlashBlockCursor(int block)
+{
+    ASSERT((block >= 0) && (block < sInstance.blockCount));
+
+    int readCursor;
+    int i = FindIndexedBlock(block, &readCursor);
+    /* Only the blocks after the one found in the index need to be stepped through. */
+    while (i < block) {
         uint8_t * header = FLASH_CURSOR_TO_BYTE_ADDRESS(readCursor);
         int bitCount = (int)(header[0] | (header[1] << 8));
-        sequenceCount += STORAGE_BLOCK_SIZE_IN_SAMPLES;
-        readCursor += FLASH_BLOCK_SIZE(bitCount);
+        readCursor = NextFlashBlockCursor(readCursor, FLASH_BLOCK_SIZE(bitCount));
+        i++;
     }
-    return sequenceCount;
+    return readCursor;
+}
+
+/**
+ * @return The sequence number of the first sample that is not stored in FLASH: the number of samples stored in FLASH,
+ *  plus - when #STORAGE_FLASH_CIRCULAR is set - the number of samples erased from FLASH.
+ */
+static int GetFlashCount(void)
+{
+    /* Each (compressed) data block in FLASH is storing the same amount of samples. */
+    IndexFlashBlocks();
+    return sInstance.flashBaseSequence + (sInstance.blockCount * STORAGE_BLOCK_SIZE_IN_SAMPLES);
 }
 
 /* ------------------------------------------------------------------------- */
 
 #if STORAGE_FLASH_FIRST_PAGE <= STORAGE_FLASH_LAST_PAGE
 /**
- * Writes a block of (compressed) samples to FLASH. After the operation, the complete FLASH contents are verified.
+ * Writes a block of (compressed) samples to FLASH. After the operation, the complete FLASH contents are verified -
+ * unless #STORAGE_BLOCK_CRC is set: the written data is then verified afterwards, in #MOVE_PHASE_VERIFY.
  * @param pageCursor Must be strict positive. The absolute page number: a value of @c 0 indicates the first page of
  *  sector 0. Defines the first byte of the page where to start writing.
  * @param pData May not be @c NULL. Must be word (32 bits) aligned.
@@ -1082,6 +1926,7 @@ static bool WriteToFlash(const int pageCursor, const uint8_t * pData, const int
         status = Chip_IAP_Flash_Program(pData, pDest, size, 0);
         __enable_irq();
     }
+#if !STORAGE_BLOCK_CRC
     if (status == IAP_STATUS_CMD_SUCCESS) {
         /* To compare, only compare the new data, i.e. skip the initial 0xFF values, as they overlap with the last
          * portion of the previously written data ("o" in MoveSamplesFromEepromToFlash).
@@ -1097,6 +1942,7 @@ static bool WriteToFlash(const int pageCursor, const uint8_t * pData, const int
         status = Chip_IAP_Compare(pData, pDest, size, NULL);
         __enable_irq();
     }
+#endif
     return status == IAP_STATUS_CMD_SUCCESS;
 }
 #endif
@@ -1111,7 +1957,22 @@ static int StoreSamplesInEeprom(const STORAGE_TYPE * pSamples, int n)
 {
     int count = 0;
     while (count < n) {
-        if (GetEepromCount() == STORAGE_BLOCK_SIZE_IN_SAMPLES) {
+        int eepromCount = GetEepromCount();
+#if STORAGE_DEFER_MOVE_TO_FLASH
+        if (eepromCount == STORAGE_MAX_BLOCK_SIZE_IN_SAMPLES) {
+            /* #Storage_Service was not called in time, and the EEPROM is completely filled. There is no other choice
+             * than to finish the move to FLASH right now.
+             * If it fails, the if test above only tests for equality, so we will not needlessly try again on each
+             * added sample.
+             */
+            (void)MoveSamplesFromEepromToFlash();
+            eepromCount = GetEepromCount();
+        }
+
+        /* Append as many samples as possible in one go: moving samples to FLASH is left to #Storage_Service. */
+        int chunk = STORAGE_MAX_BLOCK_SIZE_IN_SAMPLES - eepromCount;
+#else
+        if (eepromCount == STORAGE_BLOCK_SIZE_IN_SAMPLES) {
             /* There are enough samples stored in EEPROM to warrant a compression and a move to FLASH.
              * Clear the EEPROM by moving them to FLASH. When that is done, the EEPROM is fully empty again.
              * We do this just before writing a new sample in EEPROM, to ensure at least one sample is present in
@@ -1122,11 +1983,22 @@ static int StoreSamplesInEeprom(const STORAGE_TYPE * pSamples, int n)
             /* Even if it fails, we can still continue and try writing in the rest of the EEPROM.
              * The if test above only tests for equality, so we will not needlessly try again on each added sample.
              */
+            eepromCount = GetEepromCount();
         }
-        if (GetEepromCount() < STORAGE_MAX_BLOCK_SIZE_IN_SAMPLES) {
-            WriteToEeprom(sInstance.eepromBitCursor, pSamples + count, STORAGE_BITSIZE);
-            sInstance.eepromBitCursor += STORAGE_BITSIZE;
-            count++;
+
+        /* Append as many samples as possible in one go: up to the block boundary - where the next move to FLASH is
+         * due - or up to the end of the assigned EEPROM region if that move is no longer possible.
+         */
+        int chunk = ((eepromCount < STORAGE_BLOCK_SIZE_IN_SAMPLES) ? STORAGE_BLOCK_SIZE_IN_SAMPLES
+                                                                    : STORAGE_MAX_BLOCK_SIZE_IN_SAMPLES) - eepromCount;
+#endif
+        if (chunk > n - count) {
+            chunk = n - count;
+        }
+        if (chunk > 0) {
+            WriteSamplesToEeprom(sInstance.eepromBitCursor, pSamples + count, chunk);
+            sInstance.eepromBitCursor += chunk * STORAGE_BITSIZE;
+            count += chunk;
         }
         else {
             /* The EEPROM is fully filled with samples, and an earlier call to move data from EEPROM to FLASH failed
@@ -1141,23 +2013,251 @@ static int StoreSamplesInEeprom(const STORAGE_TYPE * pSamples, int n)
     return count;
 }
 
+#if STORAGE_FLASH_FIRST_PAGE <= STORAGE_FLASH_LAST_PAGE
 /**
- * Clear the assigned EEPROM region, by moving all data to assigned FLASH region. Before moving the data, the
- * application is given the opportunity to compress the data. The (compressed) data block is then appended to the
- * existing data in FLASH.
- * Steps:
- * - Prepare #STORAGE_WORKAREA for FLASH write
- * - Copy data from EEPROM to #STORAGE_WORKAREA
- * - Call #STORAGE_COMPRESS_CB
- * - Flash
- * - Update pointers
- * @return @c true when the compression was successful and the data has been moved to FLASH, @c false when the
- *  compression callback function returned @c false or when the FLASH storage is full: nothing has been changed in
- *  FLASH or EEPROM in that case.
- * @post #sInstance is fully updated when this function returns.
- * @note Uses #STORAGE_WORKAREA. Not in use anymore when this function returns.
+ * Moves samples following the oldest #STORAGE_BLOCK_SIZE_IN_SAMPLES samples in EEPROM towards the start of the
+ * assigned EEPROM region, one EEPROM row at a time.
+ * @param firstBit Must be positive. The bits @c [STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS + firstBit, ...) are moved to
+ *  @c [firstBit, ...).
+ * @param bitCount Must be strict positive. The number of bits to move.
+ * @note The bits are moved from low to high: each destination trails its source, so no bit is overwritten before it
+ *  has been read.
+ * @post #sInstance is not touched.
  */
-static bool MoveSamplesFromEepromToFlash(void)
+static void ShiftEepromSamples(int firstBit, int bitCount)
+{
+    uint8_t bytes[EEPROM_ROW_SIZE];
+    int bitCursor = firstBit;
+
+    ASSERT(firstBit >= 0);
+    ASSERT(bitCount > 0);
+
+    while (bitCount > 0) {
+        int chunk = (bitCount < EEPROM_ROW_SIZE * 8) ? bitCount : EEPROM_ROW_SIZE * 8;
+        ReadFromEeprom((unsigned int)(STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS + bitCursor), bytes, chunk);
+        WriteToEeprom(bitCursor, bytes, chunk);
+        bitCursor += chunk;
+        bitCount -= chunk;
+    }
+}
+
+/**
+ * Finishes the commit of a move as recorded in @c pJournal: moves the samples that were not part of the moved block
+ * to the start of the assigned EEPROM region, then replaces the old marker with a new one and updates the hint.
+ * The samples are moved in steps of at most #STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS bits. The destination of a step
+ * then never overlaps its own source, nor the source of any later step. The journal is updated after each step: after
+ * a power loss, at most the last step is repeated, reading a source that is still intact.
+ * @param pJournal May not be @c NULL. A valid journal: as written at the start of #MOVE_PHASE_COMMIT, or as found by
+ *  #Storage_Init. Updated while progressing.
+ * @post #Storage_Instance_t.eepromBitCursor and #Storage_Instance_t.flashByteCursor describe the situation after the
+ *  move. The moved samples, the new marker and the new hint are programmed; the journal is overwritten.
+ */
+static void FinishCommit(Journal_t * pJournal)
+{
+    int tailBitCount = pJournal->eepromBitCursor - STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS; /* Not moved to FLASH. */
+
+    while (pJournal->shiftedBitCount < tailBitCount) {
+        int chunk = tailBitCount - pJournal->shiftedBitCount;
+        chunk = (chunk < STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS) ? chunk : STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS;
+        ShiftEepromSamples(pJournal->shiftedBitCount, chunk);
+        Chip_EEPROM_Flush(NSS_EEPROM, true); /* The journal may only be updated once these bits are programmed. */
+        pJournal->shiftedBitCount = (uint16_t)(pJournal->shiftedBitCount + chunk);
+        WriteJournal(pJournal);
+    }
+
+    /* Clear the old marker - after a power-off we don't want to find this information any more - and write the new
+     * one. Program both before the hint overwrites the journal: until then, this function is repeated after a power
+     * loss instead.
+     */
+    uint8_t zeroMarker[sizeof(Marker_t)] = {0};
+    WriteToEeprom(pJournal->eepromBitCursor, zeroMarker, sizeof(Marker_t) * 8);
+    sInstance.eepromBitCursor = tailBitCount;
+    sInstance.flashByteCursor = pJournal->flashByteCursor;
+    WriteMarker();
+    Chip_EEPROM_Flush(NSS_EEPROM, true);
+    WriteHint();
+    Chip_EEPROM_Flush(NSS_EEPROM, true);
+}
+#endif
+
+#if STORAGE_FLASH_CIRCULAR || (STORAGE_DEFER_ERASE && (STORAGE_FLASH_FIRST_PAGE <= STORAGE_FLASH_LAST_PAGE))
+/**
+ * Checks whether a FLASH page is erased.
+ * @param page The page number, relative to #STORAGE_FLASH_FIRST_PAGE.
+ * @return @c true when all words of the page contain the erased value @c 0xFFFFFFFF.
+ */
+static bool IsPageErased(int page)
+{
+    const uint32_t * pWords = FLASH_PAGE_TO_ADDRESS(const uint32_t *, STORAGE_FLASH_FIRST_PAGE + page);
+    bool erased = true;
+    for (int i = 0; erased && (i < FLASH_PAGE_SIZE / 4); i++) {
+        erased = (pWords[i] == 0xFFFFFFFF);
+    }
+    return erased;
+}
+#endif
+
+#if STORAGE_FLASH_CIRCULAR
+/**
+ * Checks whether a part of the assigned FLASH region shares a page with the erase zone: the pages that must be erased
+ * after writing a (compressed) data block up to @c head, to be able to write the next block without erasing first.
+ * These are the pages following the page @c head points in, spanning #FLASH_MAX_BLOCK_SIZE bytes. When the next block
+ * may not fit any more before the end of the assigned FLASH region, the first pages of the region are included.
+ * @param head The offset in bytes relative to #FLASH_FIRST_BYTE_ADDRESS where the next block is to be written.
+ * @param firstByte The offset in bytes relative to #FLASH_FIRST_BYTE_ADDRESS of the first byte to check.
+ * @param size Must be strict positive. The number of bytes to check.
+ * @return @c true when at least one of the bytes lies in a page of the erase zone.
+ */
+static bool IsInEraseZone(int head, int firstByte, int size)
+{
+    const int firstPage = firstByte / FLASH_PAGE_SIZE;
+    const int lastPage = (firstByte + size - 1) / FLASH_PAGE_SIZE;
+    const int zoneFirstPage = STORAGE_IDIVUP(head, FLASH_PAGE_SIZE); /* The page head points in is in use already. */
+    int zoneLastPage;
+    bool inZone = false;
+
+    if (FLASH_REGION_SIZE - head >= FLASH_MAX_BLOCK_SIZE) {
+        zoneLastPage = (head + FLASH_MAX_BLOCK_SIZE - 1) / FLASH_PAGE_SIZE;
+    }
+    else {
+        zoneLastPage = (FLASH_REGION_SIZE / FLASH_PAGE_SIZE) - 1;
+        inZone = firstPage <= (FLASH_MAX_BLOCK_SIZE - 1) / FLASH_PAGE_SIZE;
+    }
+    return inZone || ((firstPage <= zoneLastPage) && (lastPage >= zoneFirstPage));
+}
+
+/**
+ * Looks for a page in the erase zone after the newest (compressed) data block which is not yet erased.
+ * @return The page number, relative to #STORAGE_FLASH_FIRST_PAGE; or @c -1 when the whole erase zone is erased.
+ * @see IsInEraseZone
+ */
+static int GetNextPageToErase(void)
+{
+    int page = -1;
+    for (int p = 0; (page < 0) && (p < FLASH_REGION_SIZE / FLASH_PAGE_SIZE); p++) {
+        if (IsInEraseZone(sInstance.flashByteCursor, p * FLASH_PAGE_SIZE, FLASH_PAGE_SIZE) && !IsPageErased(p)) {
+            page = p;
+        }
+    }
+    return page;
+}
+#endif
+
+#if STORAGE_DEFER_ERASE && (STORAGE_FLASH_FIRST_PAGE <= STORAGE_FLASH_LAST_PAGE)
+/**
+ * Determines up to where the pages after the newest data in FLASH hold no data that is still accessible.
+ * @return The page number, relative to #STORAGE_FLASH_FIRST_PAGE, of the first page #StepErase may not touch.
+ */
+static int GetEraseLimit(void)
+{
+    int limit = FLASH_REGION_SIZE / FLASH_PAGE_SIZE;
+#if STORAGE_FLASH_CIRCULAR
+    if (sInstance.flashTailCursor > sInstance.flashByteCursor) {
+        /* The oldest blocks are stored after the newest one: stop at the page holding the start of the oldest block. */
+        limit = sInstance.flashTailCursor / FLASH_PAGE_SIZE;
+    }
+#endif
+    return limit;
+}
+
+/**
+ * Checks the next pages after the newest data in FLASH, and erases them when necessary. Each call either erases once,
+ * or checks up to #FLASH_PAGES_PER_SECTOR pages which were found to be erased already.
+ * A whole sector is erased when it lies fully within the pages to check and more than one of its pages needs erasing;
+ * otherwise, a single page is erased.
+ * @return @c true when more pages are to be checked; @c false when all pages up to the limit have been checked, or when
+ *  an erase failed.
+ * @see GetEraseLimit
+ */
+static bool StepErase(void)
+{
+    const int limit = GetEraseLimit();
+    IAP_STATUS_T status = IAP_STATUS_CMD_SUCCESS;
+    int checked = 0;
+
+    while ((status == IAP_STATUS_CMD_SUCCESS) && (sInstance.eraseCursor < limit) && (checked < FLASH_PAGES_PER_SECTOR)) {
+        if (IsPageErased(sInstance.eraseCursor)) {
+            sInstance.eraseCursor++;
+            checked++;
+        }
+        else {
+            const uint32_t absolutePage = (uint32_t)(STORAGE_FLASH_FIRST_PAGE + sInstance.eraseCursor);
+            const uint32_t sector = absolutePage / FLASH_PAGES_PER_SECTOR;
+            int count = 1;
+            if (((absolutePage % FLASH_PAGES_PER_SECTOR) == 0)
+                    && (sInstance.eraseCursor + FLASH_PAGES_PER_SECTOR <= limit)) {
+                int dirtyCount = 0;
+                for (int p = 0; p < FLASH_PAGES_PER_SECTOR; p++) {
+                    dirtyCount += IsPageErased(sInstance.eraseCursor + p) ? 0 : 1;
+                }
+                if (dirtyCount > 1) {
+                    count = FLASH_PAGES_PER_SECTOR;
+                }
+            }
+            status = Chip_IAP_Flash_PrepareSector(sector, sector);
+            if (status == IAP_STATUS_CMD_SUCCESS) {
+                __disable_irq();
+                if (count == FLASH_PAGES_PER_SECTOR) {
+                    status = Chip_IAP_Flash_EraseSector(sector, sector, 0);
+                }
+                else {
+                    status = Chip_IAP_Flash_ErasePage(absolutePage, absolutePage, 0);
+                }
+                __enable_irq();
+            }
+            if (status == IAP_STATUS_CMD_SUCCESS) {
+                sInstance.eraseCursor += count;
+            }
+            checked = FLASH_PAGES_PER_SECTOR; /* At most one erase per call. */
+        }
+    }
+    return (status == IAP_STATUS_CMD_SUCCESS) && (sInstance.eraseCursor < limit);
+}
+#endif
+
+#if STORAGE_FLASH_FIRST_PAGE <= STORAGE_FLASH_LAST_PAGE
+/**
+ * @return @c true when a move of samples from EEPROM to FLASH is ongoing, or when at least
+ *  #STORAGE_BLOCK_SIZE_IN_SAMPLES samples are waiting in EEPROM to be moved.
+ */
+static bool IsMovePending(void)
+{
+    return ((sInstance.movePhase != MOVE_PHASE_IDLE) && (sInstance.movePhase != MOVE_PHASE_FAILED))
+            || ((sInstance.movePhase == MOVE_PHASE_IDLE) && (GetEepromCount() >= STORAGE_BLOCK_SIZE_IN_SAMPLES));
+}
+#endif
+
+/**
+ * Executes the next phase of a move of the oldest #STORAGE_BLOCK_SIZE_IN_SAMPLES samples in EEPROM to FLASH. Before
+ * moving the data, the application is given the opportunity to compress the data. The (compressed) data block is then
+ * appended to the existing data in FLASH.
+ * Phases:
+ * - #MOVE_PHASE_PERSIST: Write the marker and the hint, and program all pending EEPROM rows. After a power loss, all
+ *  samples of the block are then recovered, and a restarted move writes exactly the same data to FLASH. Without it, an
+ *  interrupted move may have written samples that were not yet recovered: different samples written afterwards would
+ *  then be programmed over the same FLASH words.
+ * - #MOVE_PHASE_COMPRESS: Prepare #STORAGE_WORKAREA for FLASH write; copy data from EEPROM to #STORAGE_WORKAREA; call
+ *  #STORAGE_COMPRESS_CB.
+ * - #MOVE_PHASE_PROGRAM: Flash, one page per call. Pages of which the contents are already present in FLASH - e.g. by
+ *  an earlier attempt which was interrupted - are skipped.
+ * - #MOVE_PHASE_VERIFY: Check the complete (compressed) data block in FLASH. When #STORAGE_BLOCK_CRC is set, this is
+ *  done by recalculating its CRC, #VERIFY_CHUNK_SIZE bytes per call.
+ * - #MOVE_PHASE_COMMIT: Update pointers; move the samples that are not part of the block to the start of EEPROM. A
+ *  journal written first allows #Storage_Init to finish this phase after a power loss: see #FinishCommit.
+ * - #MOVE_PHASE_ERASE: Only when #STORAGE_FLASH_CIRCULAR is set. Erase the pages where the next block can be written,
+ *  one page per call. The blocks stored there were already dropped in the commit phase.
+ * .
+ * Each phase takes a limited amount of time - the duration of at most one FLASH page write, or one compression.
+ * Apart from the persist phase, nothing has been changed in EEPROM until the commit phase, and #sInstance still
+ * describes the state before the move: after a power loss, the samples are recovered from EEPROM, and the move restarts
+ * from the beginning.
+ * @return @c true when more work is to be done: a move is ongoing, or at least #STORAGE_BLOCK_SIZE_IN_SAMPLES samples
+ *  are waiting in EEPROM. @c false when there is nothing left to do, or when the move failed: the compression callback
+ *  function returned @c false, the FLASH storage is full or a FLASH write failed.
+ * @note Uses #STORAGE_WORKAREA from the start of the compress phase until the end of the verify phase - or until the end
+ *  of the program phase when #STORAGE_BLOCK_CRC is set.
+ */
+static bool StepMoveSamplesFromEepromToFlash(void)
 {
 #if STORAGE_FLASH_FIRST_PAGE > STORAGE_FLASH_LAST_PAGE
     /* There is no flash assigned for storage. Cannot move to flash. */
@@ -1165,143 +2265,433 @@ static bool MoveSamplesFromEepromToFlash(void)
 #else
     if (STORAGE_FLASH_FIRST_PAGE > STORAGE_FLASH_LAST_PAGE) {
         /* There is no flash available for storage. Cannot move to flash. */
-        return false;
+        sInstance.movePhase = MOVE_PHASE_FAILED;
+    }
+    else if ((sInstance.movePhase == MOVE_PHASE_IDLE) && (GetEepromCount() >= STORAGE_BLOCK_SIZE_IN_SAMPLES)) {
+        sInstance.movePhase = MOVE_PHASE_PERSIST;
     }
-    else {
-        bool success;
-        uint8_t * pOut = STORAGE_WORKAREA;
-
-        sInstance.cachedBlockOffset = -1;
-
-        /* Prepare a number of pages to FLASH:
-         * Pages: |----------------|---...-------------|
-         * Data:   oooooohhcccccccccccc...ccfffffffffff
-         * with:
-         * - o: the last portion of the previously written (compressed) data block.
-         * - h: the two-byte header indicating the size in bits of the (compressed) data block that follows.
-         * - c: the (compressed) data block to write.
-         * - f: the yet-unused trailing bytes of the last page where the new (compressed) data block is written to.
-         *  By adding 1-bits, we can later write without the need for a costly FLASH page erase cycle.
-         */
 
-        /* Determine the first page to flash in this call. It is likely that during the previous call to this
-         * function the then-last page flashed was not completely filled; that last page in the previous call gets now
-         * completely filled first and becomes the first page to flash in this call.
-         */
-        int firstFlashPage = FLASH_CURSOR_TO_PAGE(sInstance.flashByteCursor);
-        int flashByteOffsetInPage = sInstance.flashByteCursor % FLASH_PAGE_SIZE;
+    switch (sInstance.movePhase) {
+        case MOVE_PHASE_PERSIST:
+            if (sEepromBitCursorChanged) {
+                WriteMarker();
+                WriteHint();
+            }
+            Chip_EEPROM_Flush(NSS_EEPROM, true);
+            sInstance.movePhase = MOVE_PHASE_COMPRESS;
+            break;
 
-        /* o: Ensure the part of the last page that was already written to in a previous move from EEPROM to FLASH
-         * remains untouched.
-         */
-        memset(pOut, 0xFF, (size_t)flashByteOffsetInPage);
-        pOut += flashByteOffsetInPage;
+        case MOVE_PHASE_COMPRESS: {
+            uint8_t * pOut = STORAGE_WORKAREA;
+
+            InvalidateDecompressedBlocks();
+
+            /* Prepare a number of pages to FLASH:
+             * Pages: |----------------|---...-------------|
+             * Data:   oooooohhcccccccccccc...ccfffffffffff
+             * with:
+             * - o: the last portion of the previously written (compressed) data block.
+             * - h: the header indicating the size in bits of the (compressed) data block that follows - and, when
+             *  #STORAGE_BLOCK_SUMMARY is set, the summary of its samples; when #STORAGE_BLOCK_CRC is set, the CRC
+             *  over the header and the (compressed) data block.
+             * - c: the (compressed) data block to write.
+             * - f: the yet-unused trailing bytes of the last page where the new (compressed) data block is written
+             *  to. By adding 1-bits, we can later write without the need for a costly FLASH page erase cycle.
+             */
 
-        /* c: The compress algorithm is to store the new (compressed) data block output just after the just copied data.
-         * Skip the meta data header for now: that is filled in when the compression completed.
-         */
-        int bitCount = STORAGE_COMPRESS_CB(EEPROM_ABSOLUTE_FIRST_BYTE_OFFSET, STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS,
-                                           pOut + FLASH_DATA_HEADER_SIZE);
-        if ((bitCount <= 0) || (bitCount >= STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS)) {
-            /* Compression failed, or resulted in a larger block size. In this case we still have a fallback:
-             * copy the data from EEPROM to FLASH unaltered.
+            /* Determine the first page to flash. It is likely that during the previous move the then-last page
+             * flashed was not completely filled; that last page in the previous move gets now completely filled
+             * first and becomes the first page to flash in this move.
              */
-            Chip_EEPROM_Read(NSS_EEPROM, EEPROM_ABSOLUTE_FIRST_BYTE_OFFSET, pOut + FLASH_DATA_HEADER_SIZE,
-                             STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BYTES);
-            bitCount = STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS;
-        }
-        int compressedDataSizeInBytes = STORAGE_IDIVUP(bitCount, 8);
+            int blockCursor = sInstance.flashByteCursor; /* Where h will be written. */
+            int flashByteOffsetInPage = blockCursor % FLASH_PAGE_SIZE;
+
+            /* o: Ensure the part of the last page that was already written to in a previous move from EEPROM to
+             * FLASH remains untouched.
+             */
+            memset(pOut, 0xFF, (size_t)flashByteOffsetInPage);
+            pOut += flashByteOffsetInPage;
+
+            /* c: The compress algorithm is to store the new (compressed) data block output just after the just copied
+             * data. Skip the meta data header for now: that is filled in when the compression completed.
+             */
+            int bitCount = STORAGE_COMPRESS_CB(EEPROM_ABSOLUTE_FIRST_BYTE_OFFSET,
+                                               STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS, pOut + FLASH_DATA_HEADER_SIZE);
+            if ((bitCount <= 0) || (bitCount >= STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS)) {
+                /* Compression failed, or resulted in a larger block size. In this case we still have a fallback:
+                 * copy the data from EEPROM to FLASH unaltered.
+                 */
+                Chip_EEPROM_Read(NSS_EEPROM, EEPROM_ABSOLUTE_FIRST_BYTE_OFFSET, pOut + FLASH_DATA_HEADER_SIZE,
+                                 STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BYTES);
+                bitCount = STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS;
+            }
+            int compressedDataSizeInBytes = STORAGE_IDIVUP(bitCount, 8);
+#if STORAGE_FLASH_CIRCULAR
+            if (blockCursor + FLASH_BLOCK_SIZE(bitCount) > FLASH_REGION_SIZE) {
+                /* The block does not fit before the end of the assigned FLASH region: write it at the start instead.
+                 * There is no o part then. The pages there were already erased: see #IsInEraseZone.
+                 */
+                memmove(STORAGE_WORKAREA + FLASH_DATA_HEADER_SIZE, pOut + FLASH_DATA_HEADER_SIZE,
+                        (size_t)compressedDataSizeInBytes);
+                pOut = STORAGE_WORKAREA;
+                blockCursor = 0;
+            }
+            uint8_t * pBlock = pOut;
+#endif
+
+            /* h: */
+            pOut[0] = (uint8_t)(bitCount & 0xFF);
+            pOut[1] = (uint8_t)((bitCount >> 8) & 0xFF);
+#if STORAGE_BLOCK_SUMMARY
+            SummarizeEepromBlock(pOut + 2);
+#endif
+#if STORAGE_BLOCK_CRC
+            sInstance.moveCrc = CalculateBlockCrc(pOut, bitCount);
+            pOut[FLASH_DATA_HEADER_SIZE - 2] = (uint8_t)(sInstance.moveCrc & 0xFF);
+            pOut[FLASH_DATA_HEADER_SIZE - 1] = (uint8_t)((sInstance.moveCrc >> 8) & 0xFF);
+#endif
+            pOut += FLASH_DATA_HEADER_SIZE;
+
+            /* c: */
+            pOut += compressedDataSizeInBytes;
 
-        /* h: */
-        pOut[0] = (uint8_t)(bitCount & 0xFF);
-        pOut[1] = (uint8_t)((bitCount >> 8) & 0xFF);
-        pOut += FLASH_DATA_HEADER_SIZE;
+#if STORAGE_FLASH_CIRCULAR
+            /* t: The trailer tells which blocks remain after erasing the pages where the next block can be written:
+             * drop the oldest blocks that share a page with them.
+             */
+            int tailCursor = sInstance.flashTailCursor;
+            int baseSequence = sInstance.flashBaseSequence;
+            while (tailCursor != sInstance.flashByteCursor) {
+                const uint8_t * pHeader = FLASH_CURSOR_TO_BYTE_ADDRESS(tailCursor);
+                const int blockSize = FLASH_BLOCK_SIZE(pHeader[0] | (pHeader[1] << 8));
+                if (!IsInEraseZone(blockCursor + FLASH_BLOCK_SIZE(bitCount), tailCursor, blockSize)) {
+                    break;
+                }
+                tailCursor = NextFlashBlockCursor(tailCursor, blockSize);
+                baseSequence += STORAGE_BLOCK_SIZE_IN_SAMPLES;
+            }
+            if (tailCursor == sInstance.flashByteCursor) {
+                tailCursor = blockCursor; /* The new block is the only one left. */
+            }
+            Trailer_t trailer = {.tailCursor = (uint16_t)tailCursor,
+                                 .inverseTailCursor = (uint16_t)~tailCursor,
+                                 .baseSequence = baseSequence};
+            while (pOut < pBlock + FLASH_BLOCK_SIZE(bitCount) - FLASH_DATA_TRAILER_SIZE) {
+                *pOut = 0xFF;
+                pOut++;
+            }
+            memcpy(pOut, &trailer, sizeof(Trailer_t));
+            pOut += FLASH_DATA_TRAILER_SIZE;
+            sInstance.moveTailCursor = tailCursor;
+            sInstance.moveBaseSequence = baseSequence;
+#endif
 
-        /* c: */
-        pOut += compressedDataSizeInBytes;
+            /* f: */
+            while (((int)(pOut - STORAGE_WORKAREA) % FLASH_PAGE_SIZE) != 0) {
+                *pOut = 0xFF;
+                pOut++;
+            }
 
-        /* f: */
-        while (((int)(pOut - STORAGE_WORKAREA) % FLASH_PAGE_SIZE) != 0) {
-            *pOut = 0xFF;
-            pOut++;
+            sInstance.moveBlockCursor = blockCursor;
+            sInstance.moveFlashByteCursor = blockCursor + FLASH_BLOCK_SIZE(bitCount);
+            ASSERT((sInstance.moveFlashByteCursor & 0x3) == 0); /* Must be 32-bit word-aligned. */
+            if (FLASH_CURSOR_TO_BYTE_ADDRESS(sInstance.moveFlashByteCursor) - 1 > FLASH_LAST_BYTE_ADDRESS) {
+                /* There is not enough space left in the assigned FLASH region to store the (compressed) data block. */
+                sInstance.movePhase = MOVE_PHASE_FAILED;
+            }
+            else {
+                /* Only now we can write the full oooooohhcccccccccccc...ccfffffffffff sequence to FLASH. */
+                sInstance.moveFirstPage = FLASH_CURSOR_TO_PAGE(blockCursor);
+                sInstance.movePageCount = (pOut - STORAGE_WORKAREA + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE;
+                ASSERT(sInstance.movePageCount > 0); /* Must be at least 1. */
+                sInstance.movePagesDone = 0;
+                sInstance.movePhase = MOVE_PHASE_PROGRAM;
+            }
+            break;
         }
 
-        int newFlashByteCursor = sInstance.flashByteCursor + FLASH_BLOCK_SIZE(bitCount);
-        ASSERT((newFlashByteCursor & 0x3) == 0); /* Must be 32-bit word-aligned. */
-        if (FLASH_CURSOR_TO_BYTE_ADDRESS(newFlashByteCursor) - 1 > FLASH_LAST_BYTE_ADDRESS) {
-            /* There is not enough space left in the assigned FLASH region to store the (compressed) data block. */
-            success = false;
+        case MOVE_PHASE_PROGRAM: {
+            const uint8_t * pData = STORAGE_WORKAREA + (sInstance.movePagesDone * FLASH_PAGE_SIZE);
+            const int page = sInstance.moveFirstPage + sInstance.movePagesDone;
+            const uint32_t * pWords = (const uint32_t *)pData;
+            const uint32_t * pFlashWords = FLASH_PAGE_TO_ADDRESS(const uint32_t *, page);
+
+            /* A page needs no writing when an earlier attempt already wrote it: each word is either a filler or
+             * already equal to the word in FLASH.
+             */
+            bool written = true;
+            for (int i = 0; written && (i < FLASH_PAGE_SIZE / 4); i++) {
+                written = (pWords[i] == 0xFFFFFFFF) || (pWords[i] == pFlashWords[i]);
+            }
+#if STORAGE_DEFER_ERASE
+            bool erased = true;
+            if (page - STORAGE_FLASH_FIRST_PAGE >= sInstance.eraseCursor) {
+                /* The page has not been checked yet by Storage_Service. It can only be left as is when it holds exactly
+                 * the data to write - written by an earlier attempt. Otherwise, check it now and erase it if needed.
+                 */
+                written = (memcmp(pData, pFlashWords, FLASH_PAGE_SIZE) == 0);
+                if (written) {
+                    sInstance.eraseCursor = page - STORAGE_FLASH_FIRST_PAGE + 1;
+                }
+                while ((!written) && erased && (page - STORAGE_FLASH_FIRST_PAGE >= sInstance.eraseCursor)
+                        && (sInstance.eraseCursor < GetEraseLimit())) {
+                    const int eraseCursor = sInstance.eraseCursor;
+                    (void)StepErase();
+                    erased = sInstance.eraseCursor > eraseCursor; /* No progress means an erase failed. */
+                }
+            }
+            if (!erased) {
+                sInstance.movePhase = MOVE_PHASE_FAILED;
+            }
+            else
+#endif
+            if ((!written) && (!WriteToFlash(page, pData, 1))) {
+                sInstance.movePhase = MOVE_PHASE_FAILED;
+            }
+            else {
+                sInstance.movePagesDone++;
+                if (sInstance.movePagesDone == sInstance.movePageCount) {
+#if STORAGE_BLOCK_CRC
+                    sInstance.verifyCursor = -1;
+#endif
+                    sInstance.movePhase = MOVE_PHASE_VERIFY;
+                }
+            }
+            break;
         }
-        else {
-            /* Only now we can write the full oooooohhcccccccccccc...ccfffffffffff sequence to FLASH. */
-            int pageCountToFlash = (pOut - STORAGE_WORKAREA + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE;
-            ASSERT(pageCountToFlash > 0); /* Must be at least 1. */
-            success = WriteToFlash(firstFlashPage, STORAGE_WORKAREA, pageCountToFlash);
+
+        case MOVE_PHASE_VERIFY: {
+#if STORAGE_BLOCK_CRC
+            /* Recalculate the CRC over the new block in FLASH, at most VERIFY_CHUNK_SIZE bytes per call. This no
+             * longer relies on STORAGE_WORKAREA.
+             */
+            const uint8_t * pHeader = FLASH_CURSOR_TO_BYTE_ADDRESS(sInstance.moveBlockCursor);
+            const int bitCount = pHeader[0] | (pHeader[1] << 8);
+            const int size = STORAGE_IDIVUP(bitCount, 8);
+            if (sInstance.moveBlockCursor + FLASH_BLOCK_SIZE(bitCount) != sInstance.moveFlashByteCursor) {
+                sInstance.movePhase = MOVE_PHASE_FAILED; /* The size in the header is corrupt. */
+            }
+            else if (sInstance.verifyCursor < 0) {
+                sInstance.verifyCrc = CalculateCrc(0xFFFF, pHeader, FLASH_DATA_HEADER_SIZE - 2);
+                sInstance.verifyCursor = 0;
+            }
+            else if (sInstance.verifyCursor < size) {
+                int n = size - sInstance.verifyCursor;
+                if (n > VERIFY_CHUNK_SIZE) {
+                    n = VERIFY_CHUNK_SIZE;
+                }
+                sInstance.verifyCrc = CalculateCrc(sInstance.verifyCrc,
+                                                   pHeader + FLASH_DATA_HEADER_SIZE + sInstance.verifyCursor, n);
+                sInstance.verifyCursor += n;
+            }
+            else {
+                bool ok = (sInstance.verifyCrc == sInstance.moveCrc) && (GetBlockCrc(pHeader) == sInstance.moveCrc);
+#if STORAGE_FLASH_CIRCULAR
+                /* The trailer is not covered by the CRC: check it separately. */
+                Trailer_t trailer;
+                memcpy(&trailer, FLASH_CURSOR_TO_BYTE_ADDRESS(sInstance.moveFlashByteCursor - FLASH_DATA_TRAILER_SIZE),
+                       sizeof(Trailer_t));
+                ok = ok && (trailer.tailCursor == (uint16_t)sInstance.moveTailCursor)
+                        && (trailer.inverseTailCursor == (uint16_t)~sInstance.moveTailCursor)
+                        && (trailer.baseSequence == sInstance.moveBaseSequence);
+#endif
+                sInstance.movePhase = ok ? MOVE_PHASE_COMMIT : MOVE_PHASE_FAILED;
+            }
+#else
+            /* Only compare the new data, i.e. skip the 0xFF values, as they overlap with the last portion of the
+             * previously written data ("o" above) or are left unused ("f" above).
+             */
+            const uint32_t * pWords = (const uint32_t *)STORAGE_WORKAREA;
+            const uint32_t * pFlashWords = FLASH_PAGE_TO_ADDRESS(const uint32_t *, sInstance.moveFirstPage);
+            bool ok = true;
+            for (int i = 0; ok && (i < sInstance.movePageCount * FLASH_PAGE_SIZE / 4); i++) {
+                ok = (pWords[i] == 0xFFFFFFFF) || (pWords[i] == pFlashWords[i]);
+            }
+            sInstance.movePhase = ok ? MOVE_PHASE_COMMIT : MOVE_PHASE_FAILED;
+#endif
+            break;
         }
-        if (success) { /* All that is left now is to do some housekeeping: in EEPROM and in sInstance. */
-            int oldEepromBitCursor = sInstance.eepromBitCursor; /* Used after updating the hint information. */
 
-            sInstance.eepromBitCursor = 0;
+        case MOVE_PHASE_COMMIT: { /* All that is left now is to do some housekeeping: in EEPROM and in sInstance. */
+            int oldEepromBitCursor = sInstance.eepromBitCursor; /* Used when writing the journal. */
+            int blockSequence = GetFlashCount(); /* The sequence number of the first sample in the new block. */
+
             /* Update variables used when reading samples. */
             if (sInstance.readLocation == LOCATION_EEPROM) {
                 if (sInstance.readCursor < STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS) {
                     sInstance.readLocation = LOCATION_FLASH;
-                    sInstance.readSequence = GetFlashCount() - STORAGE_BLOCK_SIZE_IN_SAMPLES;
-                    sInstance.readCursor = sInstance.flashByteCursor;
+                    sInstance.readSequence = blockSequence;
+                    sInstance.readCursor = sInstance.moveBlockCursor;
                 }
                 else {
-                    ASSERT(sInstance.readCursor == STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS);
+                    /* Beyond the moved block: a sample that is moved to the start of EEPROM below, the first sample
+                     * still to be written, or - when the cache is being moved to EEPROM, see #Storage_Write - a sample
+                     * written later on in the same call.
+                     */
+                    ASSERT(sInstance.readCursor >= STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS);
                     //sInstance.readLocation remains the same
-                    sInstance.readCursor = 0;
+                    sInstance.readCursor -= STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS;
                     //sInstance.readSequence remains the same
                 }
                 //sInstance.targetSequence remains the same
             }
+            /* Add the new block to the index, which is made durable before the journal: see #IndexEntry_t. */
+#if STORAGE_FLASH_CIRCULAR
+            if (sInstance.moveBlockCursor != sInstance.flashByteCursor) {
+                /* The new block wrapped around: the blocks indexed after the old head are no longer stored. */
+                for (int span = sInstance.flashByteCursor / INDEX_SPAN_SIZE; span < INDEX_ENTRY_COUNT; span++) {
+                    IndexEntry_t entry;
+                    Chip_EEPROM_Read(NSS_EEPROM, INDEX_ABSOLUTE_BYTE_OFFSET + span * SIZE_OF_INDEX_ENTRY, &entry,
+                            SIZE_OF_INDEX_ENTRY);
+                    if ((entry.flashByteCursor != INDEX_NONE) && (entry.flashByteCursor >= sInstance.flashByteCursor)) {
+                        SetIndexEntry(span, INDEX_NONE, 0);
+                    }
+                }
+            }
+#endif
+            IndexFlashBlock(sInstance.moveBlockCursor, sInstance.moveFlashByteCursor - sInstance.moveBlockCursor,
+                    blockSequence);
+            Chip_EEPROM_Flush(NSS_EEPROM, true);
+            sInstance.blockCount++;
+
             /* Only update flashByteCursor after updating readCursor & readSequence */
-            sInstance.flashByteCursor = newFlashByteCursor;
+#if STORAGE_DEFER_ERASE && STORAGE_FLASH_CIRCULAR
+            if (sInstance.moveFlashByteCursor < sInstance.flashByteCursor) {
+                /* The new block wrapped around: the pages after it are checked anew. */
+                sInstance.eraseCursor = STORAGE_IDIVUP(sInstance.moveFlashByteCursor, FLASH_PAGE_SIZE);
+            }
+#endif
+            sInstance.flashByteCursor = sInstance.moveFlashByteCursor;
+#if STORAGE_FLASH_CIRCULAR
+            if (sInstance.moveTailCursor != sInstance.flashTailCursor) {
+                /* The oldest blocks are dropped: their pages are erased next. */
+                if ((sInstance.readLocation == LOCATION_FLASH)
+                        && (sInstance.readSequence < sInstance.moveBaseSequence)) {
+                    sInstance.readLocation = LOCATION_UNKNOWN;
+                    sInstance.readSequence = -1;
+                    sInstance.readCursor = -1;
+                }
+                sInstance.blockCount -= (sInstance.moveBaseSequence - sInstance.flashBaseSequence)
+                        / STORAGE_BLOCK_SIZE_IN_SAMPLES;
+                sInstance.flashTailCursor = sInstance.moveTailCursor;
+                sInstance.flashBaseSequence = sInstance.moveBaseSequence;
+                InvalidateDecompressedBlocks(); /* Their locations in FLASH will be reused. */
+            }
+#endif
 
-            /* Now that everything has been copied from EEPROM to FLASH, the new marker is to be written at the
-             * beginning of the assigned EEPROM space.
-             * If that fails, we still want to have access to the just moved data.
-             * Thus: update the hint before changing the marker.
+            /* Now that everything has been copied from EEPROM to FLASH, the samples that were not part of the block are
+             * to be moved to the start of the assigned EEPROM region, followed by the new marker and hint. Until the
+             * journal is programmed, the old marker and hint remain valid: after a power loss, the move is restarted.
+             * From then on, #Storage_Init finishes the commit instead. No sample is lost either way.
+             * This is completed before FLASH is written or erased again: the marker written in #MOVE_PHASE_PERSIST
+             * would otherwise still be found after a power loss, describing the FLASH contents as they were before
+             * this move.
              */
-            WriteHint();
+            Journal_t journal = {.eepromBitCursor = (uint16_t)oldEepromBitCursor,
+                                 .flashByteCursor = (uint16_t)sInstance.flashByteCursor,
+                                 .shiftedBitCount = 0};
+            WriteJournal(&journal);
+            FinishCommit(&journal);
+            sEepromBitCursorChanged = false;
+#if STORAGE_FLASH_CIRCULAR
+            sInstance.movePhase = MOVE_PHASE_ERASE;
+#else
+            sInstance.movePhase = MOVE_PHASE_IDLE;
+#endif
+            break;
+        }
 
-            /* Clear the marker in EEPROM - after a power-off we don't want to find this information any more.
-             * sBitCursorChanged is set in Storage_Write() - which is the sole caller of this function - and the new
-             * correct marker on the new correct location will be written in Storage_DeInit().
-             */
-            uint8_t zeroMarker[sizeof(Marker_t)] = {0};
-            WriteToEeprom(oldEepromBitCursor, zeroMarker, sizeof(Marker_t) * 8);
+#if STORAGE_FLASH_CIRCULAR
+        case MOVE_PHASE_ERASE: {
+            const int page = GetNextPageToErase();
+            if (page < 0) {
+                sInstance.movePhase = MOVE_PHASE_IDLE;
+            }
+            else {
+                const uint32_t absolutePage = (uint32_t)(STORAGE_FLASH_FIRST_PAGE + page);
+                IAP_STATUS_T status = Chip_IAP_Flash_PrepareSector(absolutePage / FLASH_PAGES_PER_SECTOR,
+                                                                   absolutePage / FLASH_PAGES_PER_SECTOR);
+                if (status == IAP_STATUS_CMD_SUCCESS) {
+                    __disable_irq();
+                    status = Chip_IAP_Flash_ErasePage(absolutePage, absolutePage, 0);
+                    __enable_irq();
+                }
+                if (status != IAP_STATUS_CMD_SUCCESS) {
+                    sInstance.movePhase = MOVE_PHASE_FAILED;
+                }
+            }
+            break;
         }
+#endif
 
-        return success;
+        default:
+            break;
     }
+
+    return IsMovePending();
+#endif
+}
+
+/**
+ * Clear the assigned EEPROM region - up to a number of samples less than #STORAGE_BLOCK_SIZE_IN_SAMPLES - by moving
+ * all data to assigned FLASH region, in one go.
+ * @return @c true when all data has been moved to FLASH, @c false when the compression callback function returned
+ *  @c false or when the FLASH storage is full: nothing has been changed in EEPROM in that case.
+ * @post #sInstance is fully updated when this function returns.
+ * @note Uses #STORAGE_WORKAREA. Not in use anymore when this function returns.
+ * @see StepMoveSamplesFromEepromToFlash
+ */
+static bool MoveSamplesFromEepromToFlash(void)
+{
+    while (StepMoveSamplesFromEepromToFlash()) {
+        /* Keep going. */
+    }
+    return sInstance.movePhase == MOVE_PHASE_IDLE;
+}
+
+/**
+ * Discards all decompressed blocks kept in #STORAGE_WORKAREA.
+ * @post #Storage_Instance_t.cachedBlockOffset is fully updated when this function returns.
+ */
+static void InvalidateDecompressedBlocks(void)
+{
+    for (int i = 0; i < STORAGE_DECOMPRESSED_CACHE_BLOCKS; i++) {
+        sInstance.cachedBlockOffset[i] = -1;
+        sInstance.cachedBlockLastUse[i] = 0;
+    }
+#if STORAGE_BLOCK_CRC
+    sInstance.crcCheckedCursor = -1;
 #endif
 }
 
 /**
  * Reads a block of compressed data containing #STORAGE_BLOCK_SIZE_IN_SAMPLES samples, decompresses the data
  * and stores the result in the workspace given by the application.
+ * Up to #STORAGE_DECOMPRESSED_CACHE_BLOCKS decompressed blocks are kept: when the block is not yet available, the
+ * least recently used decompressed block is replaced.
  * @param readCursor The offset in bytes relative to FLASH_FIRST_BYTE_ADDRESS to the header preceding the
  *  (compressed) data block that must be read.
+ * @param [out] ppSamples : May not be @c NULL. When a non-zero value is returned, a pointer to the samples of the
+ *  block, packed without padding bits, is written here. This points either inside #STORAGE_WORKAREA, or - for a block
+ *  that was stored uncompressed - directly to the data in FLASH.
  * @return
- *  - When the samples are available in #STORAGE_WORKAREA (either when the previous decompression was still valid and
- *      the decompression callback was not called; or when decompression was successful as indicated by the returnvalue
- *      of the called decompression callback): the size of the (compressed) data block including the header. This is
- *      equal to the number of bytes to advance the read cursor to the header of the next (compressed) data block.
- *  - @c 0 when the FLASH contents were invalid, or when the decompression callback function returned @c false:
- *      nothing has been changed in that case.
+ *  - When the samples are available (either when a previous decompression was still valid and the decompression
+ *      callback was not called; or when decompression was successful as indicated by the returnvalue of the called
+ *      decompression callback; or when the block was stored uncompressed): the size of the (compressed) data block
+ *      including the header. This is equal to the number of bytes to advance the read cursor to the header of the
+ *      next (compressed) data block.
+ *  - @c 0 when the FLASH contents were invalid - including, when #STORAGE_BLOCK_CRC is set, a CRC mismatch - or when
+ *      the decompression callback function returned @c false: nothing has been changed in that case.
  *  .
  * @post Only #Storage_Instance_t.cachedBlockOffset is fully updated when this function returns.
- * @note Uses #STORAGE_WORKAREA. Only the first #STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BYTES bytes are in use
- *  when this function returns.
+ * @note Uses #STORAGE_WORKAREA. Only the first @code STORAGE_DECOMPRESSED_CACHE_BLOCKS
+ *  * STORAGE_DECOMPRESSED_BLOCK_SIZE_IN_BYTES @endcode bytes are in use when this function returns.
  */
-static int ReadAndCacheSamplesFromFlash(int readCursor)
+static int ReadAndCacheSamplesFromFlash(int readCursor, const uint8_t ** ppSamples)
 {
     uint8_t * pHeader = FLASH_CURSOR_TO_BYTE_ADDRESS(readCursor);
     int bitCount = (int)(pHeader[0] | (pHeader[1] << 8));
-    int blockSize;
+    int blockSize = 0;
     /* if header[0:1] == 0xFFFF, the flash was emptied.
      * This indicates a discrepancy between the instance information and the FLASH contents.
      * This may happen during development when re-flashing with the same image and erasing the non-used pages.
@@ -1309,26 +2699,120 @@ static int ReadAndCacheSamplesFromFlash(int readCursor)
     if (bitCount == 0x0000FFFF) {
         blockSize = 0;
     }
-    else if (sInstance.cachedBlockOffset == readCursor) {
-        /* The output from the previous call to STORAGE_DECOMPRESS_CB is still valid. */
-        blockSize = FLASH_BLOCK_SIZE(bitCount);
+#if STORAGE_BLOCK_CRC
+    else if ((bitCount == STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS) && (readCursor != sInstance.crcCheckedCursor)
+            && (CalculateBlockCrc(pHeader, bitCount) != GetBlockCrc(pHeader))) {
+        blockSize = 0; /* Corrupt. */
     }
+#endif
     else if (bitCount == STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS) {
-        memcpy(STORAGE_WORKAREA, pHeader + FLASH_DATA_HEADER_SIZE, (size_t)STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BYTES);
+        /* No need to copy: the samples can be read in place. */
+#if STORAGE_BLOCK_CRC
+        sInstance.crcCheckedCursor = readCursor;
+#endif
+        *ppSamples = pHeader + FLASH_DATA_HEADER_SIZE;
         blockSize = FLASH_BLOCK_SIZE(STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS);
-    } else {
-        int decompressedBitCount = STORAGE_DECOMPRESS_CB(pHeader + FLASH_DATA_HEADER_SIZE, bitCount, STORAGE_WORKAREA);
-        if (decompressedBitCount == STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS) {
-            sInstance.cachedBlockOffset = readCursor;
-            blockSize = FLASH_BLOCK_SIZE(bitCount);
+    }
+    else {
+        sInstance.cacheUseCount++;
+        int lru = 0;
+        for (int i = 0; i < STORAGE_DECOMPRESSED_CACHE_BLOCKS; i++) {
+            if (sInstance.cachedBlockOffset[i] == readCursor) {
+                /* The output from a previous call to STORAGE_DECOMPRESS_CB is still valid. */
+                sInstance.cachedBlockLastUse[i] = sInstance.cacheUseCount;
+                sInstance.cacheHits++;
+                *ppSamples = STORAGE_WORKAREA + (i * STORAGE_DECOMPRESSED_BLOCK_SIZE_IN_BYTES);
+                blockSize = FLASH_BLOCK_SIZE(bitCount);
+                break;
+            }
+            if (sInstance.cachedBlockLastUse[i] < sInstance.cachedBlockLastUse[lru]) {
+                lru = i;
+            }
         }
-        else {
-            blockSize = 0;
+
+        if (!blockSize) {
+            uint8_t * pOut = STORAGE_WORKAREA + (lru * STORAGE_DECOMPRESSED_BLOCK_SIZE_IN_BYTES);
+            sInstance.cacheMisses++;
+#if STORAGE_BLOCK_CRC
+            if (CalculateBlockCrc(pHeader, bitCount) != GetBlockCrc(pHeader)) {
+                return 0; /* Corrupt: don't even try to decompress. */
+            }
+            if ((lru * STORAGE_DECOMPRESSED_BLOCK_SIZE_IN_BYTES < STORAGE_COMPRESS_WORKAREA_SIZE)
+                    && (sInstance.movePhase == MOVE_PHASE_PROGRAM)) {
+#else
+            if ((lru * STORAGE_DECOMPRESSED_BLOCK_SIZE_IN_BYTES < STORAGE_COMPRESS_WORKAREA_SIZE)
+                    && ((sInstance.movePhase == MOVE_PHASE_PROGRAM) || (sInstance.movePhase == MOVE_PHASE_VERIFY))) {
+#endif
+                /* The pages prepared for an ongoing move to FLASH are overwritten: prepare them again later on. */
+                sInstance.movePhase = MOVE_PHASE_COMPRESS;
+            }
+            sInstance.cachedBlockOffset[lru] = -1; /* Overwritten, whatever the outcome. */
+            sInstance.cachedBlockLastUse[lru] = 0;
+            int decompressedBitCount = STORAGE_DECOMPRESS_CB(pHeader + FLASH_DATA_HEADER_SIZE, bitCount, pOut);
+            if (decompressedBitCount == STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS) {
+                sInstance.cachedBlockOffset[lru] = readCursor;
+                sInstance.cachedBlockLastUse[lru] = sInstance.cacheUseCount;
+                *ppSamples = pOut;
+                blockSize = FLASH_BLOCK_SIZE(bitCount);
+            }
         }
     }
     return blockSize;
 }
 
+/**
+ * Hands out samples in place, from the (decompressed) block in FLASH the read cursor points to, and advances the read
+ * cursor past them.
+ * @pre #Storage_Instance_t.readLocation equals #LOCATION_FLASH
+ * @pre #STORAGE_BITSIZE equals the number of bits in #STORAGE_TYPE: the samples need not be unpacked.
+ * @param [out] ppRun : May not be @c NULL. When a non-zero value is returned, a pointer to the first sample is written
+ *  here.
+ * @param max Must be strict positive. The maximum number of samples to hand out.
+ * @return The number of samples available at @c *ppRun. This is never more than the remainder of the block.
+ *  @c 0 when the samples can not be handed out in place: the block could not be decompressed, or the samples are not
+ *  properly aligned. Use #Storage_Read instead in that case.
+ * @post When all samples in FLASH are handed out, #Storage_Instance_t.readLocation equals #LOCATION_EEPROM
+ */
+static int GetFlashRun(const STORAGE_TYPE ** ppRun, int max)
+{
+    int n = 0;
+    int blockSize = 0;
+    const uint8_t * pBlockSamples = NULL;
+    const int flashCount = GetFlashCount();
+
+    ASSERT(sInstance.readLocation == LOCATION_FLASH);
+    ASSERT(STORAGE_BITSIZE == 8 * sizeof(STORAGE_TYPE));
+
+    if (sInstance.readSequence < flashCount) {
+        blockSize = ReadAndCacheSamplesFromFlash(sInstance.readCursor, &pBlockSamples);
+    }
+    if (blockSize) {
+        const uint8_t * p = pBlockSamples
+                + (sInstance.targetSequence - sInstance.readSequence) * (int)sizeof(STORAGE_TYPE);
+        if (((uintptr_t)p & (sizeof(STORAGE_TYPE) - 1)) == 0) {
+            n = sInstance.readSequence + STORAGE_BLOCK_SIZE_IN_SAMPLES - sInstance.targetSequence;
+            if (n > max) {
+                n = max;
+            }
+            *ppRun = (const STORAGE_TYPE *)p;
+            sInstance.targetSequence += n;
+            if (sInstance.readSequence + STORAGE_BLOCK_SIZE_IN_SAMPLES <= sInstance.targetSequence) {
+                /* A next sample is available in EEPROM or in the next (compressed) block of data in FLASH. */
+                sInstance.readCursor = NextFlashBlockCursor(sInstance.readCursor, blockSize);
+                ASSERT((sInstance.readCursor & 0x3) == 0); /* Must be 32-bit word-aligned. */
+                sInstance.readSequence += STORAGE_BLOCK_SIZE_IN_SAMPLES;
+            }
+        }
+    }
+
+    if (sInstance.readSequence >= flashCount) {
+        /* All is read from FLASH, ensure the next read will pick the samples from EEPROM. */
+        sInstance.readLocation = LOCATION_EEPROM;
+        sInstance.readCursor = 0;
+    }
+    return n;
+}
+
 /**
  * Checks whether #spRecoverInfo contains possible correct information.
  * @return @c true when the information contained in the structure #spRecoverInfo points to can be used.
@@ -1354,7 +2838,7 @@ static bool ValidateMarker(const Marker_t * pMarker, int expectedFlashByteCursor
             && (pMarker->footer == MARKER_FOOTER)
             && (((unsigned int)pMarker->flashByteCursor & MARKER_CURSOR_ZERO_MASK) == 0)
             && ((pMarker->flashByteCursor == 0) /* if no flash memory is available, FLASH_CURSOR_TO_BYTE_ADDRESS gives 0x7800 */
-                || (FLASH_CURSOR_TO_BYTE_ADDRESS(pMarker->flashByteCursor) <= FLASH_LAST_BYTE_ADDRESS));
+                || (FLASH_CURSOR_TO_BYTE_ADDRESS(pMarker->flashByteCursor) - 1 <= FLASH_LAST_BYTE_ADDRESS));
     if (ok && (expectedFlashByteCursor >= 0)) {
         ok = pMarker->flashByteCursor == expectedFlashByteCursor;
     }
@@ -1393,7 +2877,31 @@ static bool ValidateHint(const Hint_t * pHint)
     return ok;
 }
 
-/** Uses the information of sInstance to create a #Hint_t structure, and writes it to EEPROM. */
+/**
+ * Checks the locations a marker is expected at, when it was last known to be at @c eepromBitCursor.
+ * @param eepromBitCursor The location of the marker when the hint or the checkpoint was written.
+ * @param flashByteCursor The value of Marker_t.flashByteCursor the marker must have.
+ * @param count The number of locations to check: the marker may have moved that many samples since.
+ * @param [out] pMarker : May not be @c NULL. The contents of the last location checked are copied here.
+ * @return @c true when a valid marker was found. The recovery information then points to it.
+ */
+static bool SearchMarker(int eepromBitCursor, int flashByteCursor, int count, Marker_t * pMarker)
+{
+    bool markerIsValid = false;
+    for (int i = 0; (!markerIsValid) && (i < count)
+            && (eepromBitCursor <= STORAGE_MAX_UNCOMPRESSED_BLOCK_SIZE_IN_BITS); i++) {
+        spRecoverInfo->eepromBitCursor = (unsigned int)eepromBitCursor & 0x7FFF;
+        ReadFromEeprom(spRecoverInfo->eepromBitCursor, pMarker, sizeof(Marker_t) * 8);
+        markerIsValid = ValidateMarker(pMarker, flashByteCursor);
+        eepromBitCursor += STORAGE_BITSIZE;
+    }
+    return markerIsValid;
+}
+
+/**
+ * Uses the information of sInstance to create a #Hint_t structure, and writes it to EEPROM, together with the duplicate
+ * data and - when #STORAGE_CHECKPOINT is set - a new checkpoint.
+ */
 static void WriteHint(void)
 {
     Hint_t hint = {.eepromBitCursor = (uint16_t)sInstance.eepromBitCursor,
@@ -1411,6 +2919,9 @@ static void WriteHint(void)
     uint8_t duplicate[SIZE_OF_DUPLICATE_DATA];
     Chip_EEPROM_Read(NSS_EEPROM, EEPROM_ABSOLUTE_FIRST_BYTE_OFFSET + byteCursor, duplicate, SIZE_OF_DUPLICATE_DATA);
     Chip_EEPROM_Write(NSS_EEPROM, DUPLICATE_DATA_ABSOLUTE_BYTE_OFFSET, duplicate, SIZE_OF_DUPLICATE_DATA);
+#if STORAGE_CHECKPOINT
+    WriteCheckpoint();
+#endif
 }
 
 /** Uses the information of sInstance to create a #Marker_t structure, and writes it to EEPROM. */
@@ -1420,19 +2931,150 @@ static void WriteMarker(void)
     WriteToEeprom(sInstance.eepromBitCursor, &marker, sizeof(marker) * 8);
 }
 
+#if STORAGE_CHECKPOINT || STORAGE_BLOCK_CRC || (STORAGE_FLASH_FIRST_PAGE <= STORAGE_FLASH_LAST_PAGE)
+/**
+ * Calculates a CRC-16 using the CCITT polynomial @c 0x1021.
+ * @param crc The initial value: @c 0xFFFF to start a new calculation, or the value returned by a previous call to
+ *  continue it.
+ * @param pData May not be @c NULL. The bytes to calculate the CRC over.
+ * @param length The number of bytes in @c pData.
+ * @return The calculated CRC.
+ */
+static uint16_t CalculateCrc(uint16_t crc, const uint8_t * pData, int length)
+{
+    for (int i = 0; i < length; i++) {
+        crc = (uint16_t)(crc ^ (pData[i] << 8));
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (uint16_t)((crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1));
+        }
+    }
+    return crc;
+}
+#endif
+
+#if STORAGE_BLOCK_CRC
+/**
+ * Calculates the CRC of a (compressed) data block: over its header - without the CRC field itself - and its data.
+ * @param pHeader May not be @c NULL. Points to the header of the block, either in FLASH or in #STORAGE_WORKAREA.
+ * @param bitCount The size in bits of the (compressed) data block, as stored in its header.
+ * @return The calculated CRC.
+ */
+static uint16_t CalculateBlockCrc(const uint8_t * pHeader, int bitCount)
+{
+    uint16_t crc = CalculateCrc(0xFFFF, pHeader, FLASH_DATA_HEADER_SIZE - 2);
+    return CalculateCrc(crc, pHeader + FLASH_DATA_HEADER_SIZE, STORAGE_IDIVUP(bitCount, 8));
+}
+
+/**
+ * Retrieves the CRC stored in the header of a (compressed) data block.
+ * @param pHeader May not be @c NULL. Points to the header of the block, either in FLASH or in #STORAGE_WORKAREA.
+ * @return The CRC as calculated by #CalculateBlockCrc when the block was prepared.
+ */
+static uint16_t GetBlockCrc(const uint8_t * pHeader)
+{
+    return (uint16_t)(pHeader[FLASH_DATA_HEADER_SIZE - 2] | (pHeader[FLASH_DATA_HEADER_SIZE - 1] << 8));
+}
+#endif
+
+#if STORAGE_CHECKPOINT
+/**
+ * Reads both #Checkpoint_t slots, and selects the newest one that is valid.
+ * @param [out] pCheckpoint : May not be @c NULL. The newest valid checkpoint is copied here. When neither slot is
+ *  valid, the contents are undefined.
+ * @return @c true when a valid checkpoint was found.
+ */
+static bool ReadCheckpoint(Checkpoint_t * pCheckpoint)
+{
+    Checkpoint_t slots[2];
+    bool found = false;
+
+    Chip_EEPROM_Read(NSS_EEPROM, CHECKPOINT_ABSOLUTE_BYTE_OFFSET, slots, sizeof(slots));
+    for (int i = 0; i < 2; i++) {
+        Checkpoint_t * pSlot = &slots[i];
+        if ((pSlot->crc == CalculateCrc(0xFFFF, (uint8_t *)pSlot, offsetof(Checkpoint_t, crc)))
+                && ((!found) || ((int16_t)(pSlot->sequence - pCheckpoint->sequence) > 0))) {
+            *pCheckpoint = *pSlot;
+            found = true;
+        }
+    }
+    return found;
+}
+
+/** Uses the information of sInstance to create a #Checkpoint_t structure, and writes it to EEPROM in the oldest slot. */
+static void WriteCheckpoint(void)
+{
+    Checkpoint_t checkpoint;
+    if (!ReadCheckpoint(&checkpoint)) {
+        checkpoint.sequence = 0xFFFF; /* Next update lands in the first slot. */
+    }
+    checkpoint.sequence++;
+    checkpoint.eepromBitCursor = (uint16_t)sInstance.eepromBitCursor;
+    checkpoint.flashByteCursor = (uint16_t)sInstance.flashByteCursor;
+    checkpoint.crc = CalculateCrc(0xFFFF, (uint8_t *)&checkpoint, offsetof(Checkpoint_t, crc));
+    Chip_EEPROM_Write(NSS_EEPROM, CHECKPOINT_ABSOLUTE_BYTE_OFFSET + (checkpoint.sequence & 1) * SIZE_OF_CHECKPOINT,
+                      &checkpoint, sizeof(Checkpoint_t));
+}
+#endif
+
+#if STORAGE_FLASH_FIRST_PAGE <= STORAGE_FLASH_LAST_PAGE
+/**
+ * Reads and validates the #Journal_t structure.
+ * @param [out] pJournal : May not be @c NULL. The journal is copied here. When not valid, the contents are undefined.
+ * @return @c true when the commit of a move was interrupted, and is to be finished using #FinishCommit.
+ */
+static bool ReadJournal(Journal_t * pJournal)
+{
+    Chip_EEPROM_Read(NSS_EEPROM, DUPLICATE_DATA_ABSOLUTE_BYTE_OFFSET, pJournal, sizeof(Journal_t));
+    return (pJournal->header == JOURNAL_HEADER)
+            && (pJournal->crc == CalculateCrc(0xFFFF, (uint8_t *)pJournal, offsetof(Journal_t, crc)))
+            && (pJournal->eepromBitCursor >= STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS)
+            && (pJournal->eepromBitCursor <= STORAGE_MAX_UNCOMPRESSED_BLOCK_SIZE_IN_BITS)
+            && (pJournal->shiftedBitCount <= pJournal->eepromBitCursor - STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS)
+            && (pJournal->flashByteCursor <= FLASH_REGION_SIZE);
+}
+
+/**
+ * Writes @c pJournal to EEPROM and programs it immediately.
+ * @param pJournal May not be @c NULL. All fields except @c header and @c crc must be filled in; these two are set here.
+ */
+static void WriteJournal(Journal_t * pJournal)
+{
+    pJournal->header = JOURNAL_HEADER;
+    pJournal->crc = CalculateCrc(0xFFFF, (uint8_t *)pJournal, offsetof(Journal_t, crc));
+    Chip_EEPROM_Write(NSS_EEPROM, DUPLICATE_DATA_ABSOLUTE_BYTE_OFFSET, pJournal, sizeof(Journal_t));
+    Chip_EEPROM_Flush(NSS_EEPROM, true);
+}
+#endif
+
 /* ------------------------------------------------------------------------- */
 
 void Storage_Init(void)
 {
 #if !STORAGE_FLASH_FIRST_PAGE
     sStorageFlashFirstPage = ((int)&_etext + (int)&_edata - (int)&_data + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE;
+    ASSERT(sStorageFlashFirstPage <= STORAGE_FLASH_LAST_PAGE); /* The code must not overlap with the assigned region. */
+    if (sStorageFlashFirstPage > STORAGE_FLASH_LAST_PAGE) {
+        /* Also in release builds: never erase or program the code. An empty region disables storage to FLASH. */
+        sStorageFlashFirstPage = STORAGE_FLASH_LAST_PAGE + 1;
+    }
 #endif
     ResetInstance();
+    sInstance.cacheHits = 0;
+    sInstance.cacheMisses = 0;
 
     /** Be sure to check out the @ref storage_initializing_par "initialization flowchart" */
 
     Chip_PMU_GetRetainedData((uint32_t *)sCache, STORAGE_FIRST_ALON_REGISTER, 5 - STORAGE_FIRST_ALON_REGISTER);
     spRecoverInfo = (RecoverInfo_t *)sCache;
+#if STORAGE_FLASH_FIRST_PAGE <= STORAGE_FLASH_LAST_PAGE
+    Journal_t journal;
+    if (ReadJournal(&journal)) {
+        /* Power was lost during the commit of a move. Finish it first: the new marker is found below. */
+        FinishCommit(&journal);
+        spRecoverInfo->eepromBitCursor = (unsigned int)sInstance.eepromBitCursor & 0x7FFF;
+        spRecoverInfo->sampleCacheCount = 0;
+    }
+#endif
     bool recoverInfoIsValid = ValidateRecoverInfo();
 
     Hint_t hint;
@@ -1447,11 +3089,24 @@ void Storage_Init(void)
         markerIsValid = ValidateMarker(&marker, hintIsValid ? hint.flashByteCursor : -1);
     }
 
+#if STORAGE_CHECKPOINT
+    if (!markerIsValid) {
+        Checkpoint_t checkpoint;
+        if (ReadCheckpoint(&checkpoint)) {
+            /* The checkpoint is written together with the hint, and may be one update older than the hint. */
+            markerIsValid = SearchMarker(checkpoint.eepromBitCursor, checkpoint.flashByteCursor,
+                                         2 * STORAGE_WRITE_RECOVERY_EVERY_X_SAMPLES, &marker);
+        }
+    }
+#endif
+
     if (!markerIsValid) {
         if (hintIsValid) {
-            spRecoverInfo->eepromBitCursor = (unsigned int)hint.eepromBitCursor & 0x7FFF;
-            ReadFromEeprom(spRecoverInfo->eepromBitCursor, &marker, sizeof(marker) * 8);
-            markerIsValid = ValidateMarker(&marker, hint.flashByteCursor);
+            /* Storage_DeInit updates the hint when the marker has moved #STORAGE_WRITE_RECOVERY_EVERY_X_SAMPLES samples
+             * or more: only the locations up to there need to be checked.
+             */
+            markerIsValid = SearchMarker(hint.eepromBitCursor, hint.flashByteCursor,
+                                         STORAGE_WRITE_RECOVERY_EVERY_X_SAMPLES, &marker);
         }
     }
 
@@ -1489,6 +3144,31 @@ void Storage_Init(void)
         spRecoverInfo->sampleCacheCount = 0;
     }
 
+#if STORAGE_FLASH_CIRCULAR
+    ASSERT(FLASH_REGION_SIZE >= 3 * FLASH_MAX_BLOCK_SIZE);
+    if (sInstance.flashByteCursor > 0) {
+        /* The trailer of the newest block tells which blocks are still stored in FLASH. If it can not be trusted,
+         * neither can the blocks before it: they are then no longer accessible.
+         */
+        Trailer_t trailer;
+        memcpy(&trailer, FLASH_CURSOR_TO_BYTE_ADDRESS(sInstance.flashByteCursor - FLASH_DATA_TRAILER_SIZE),
+               sizeof(Trailer_t));
+        if (((trailer.tailCursor ^ trailer.inverseTailCursor) == 0xFFFF) && (trailer.tailCursor < FLASH_REGION_SIZE)
+                && ((trailer.tailCursor & 0x3) == 0) && (trailer.baseSequence >= 0)) {
+            sInstance.flashTailCursor = trailer.tailCursor;
+            sInstance.flashBaseSequence = trailer.baseSequence;
+        }
+        else {
+            sInstance.flashTailCursor = sInstance.flashByteCursor;
+        }
+    }
+    /* A power loss may have interrupted erasing the pages where the next block is to be written: finish that first. */
+    sInstance.movePhase = MOVE_PHASE_ERASE;
+#endif
+#if STORAGE_DEFER_ERASE
+    sInstance.eraseCursor = STORAGE_IDIVUP(sInstance.flashByteCursor, FLASH_PAGE_SIZE);
+#endif
+
     if (!markerIsValid) {
         WriteMarker();
     }
@@ -1532,6 +3212,33 @@ int Storage_GetCount(void)
     return spRecoverInfo->sampleCacheCount + GetEepromCount() + GetFlashCount();
 }
 
+int Storage_GetFirst(void)
+{
+    return sInstance.flashBaseSequence;
+}
+
+bool Storage_Service(void)
+{
+#if STORAGE_DEFER_ERASE && (STORAGE_FLASH_FIRST_PAGE <= STORAGE_FLASH_LAST_PAGE)
+    if (!IsMovePending()) {
+        return StepErase();
+    }
+    return StepMoveSamplesFromEepromToFlash() || (sInstance.eraseCursor < GetEraseLimit());
+#else
+    return StepMoveSamplesFromEepromToFlash();
+#endif
+}
+
+void Storage_GetCacheStatistics(int * pHits, int * pMisses)
+{
+    if (pHits != NULL) {
+        *pHits = sInstance.cacheHits;
+    }
+    if (pMisses != NULL) {
+        *pMisses = sInstance.cacheMisses;
+    }
+}
+
 void Storage_Reset(bool checkFlash)
 {
     spRecoverInfo->sampleCacheCount = 0;
@@ -1548,6 +3255,8 @@ void Storage_Reset(bool checkFlash)
 
 #if STORAGE_FLASH_FIRST_PAGE > STORAGE_FLASH_LAST_PAGE
     (void)checkFlash; /* suppress [-Wunused-parameter]: There is no flash assigned for storage, nothing to check. */
+#elif STORAGE_DEFER_ERASE
+    (void)checkFlash; /* suppress [-Wunused-parameter]: FLASH is checked and erased later on: see #StepErase. */
 #else
     if ((!checkFlash) || (STORAGE_FLASH_FIRST_PAGE > STORAGE_FLASH_LAST_PAGE)) {
         /* Caller explicitly indicates there is no need to check the flash, or,
@@ -1612,7 +3321,10 @@ void Storage_Reset(bool checkFlash)
     }
 #endif
     ResetInstance();
-    /* A new marker will be written in EEPROM in a later call to Storage_DeInit() */
+    /* A new marker will be written in EEPROM in a later call to Storage_DeInit(). Without it, samples written to the
+     * general purpose registers only are lost when recovering after a power-off.
+     */
+    sEepromBitCursorChanged = true;
 }
 
 #if STORAGE_SAMPLE_ALON_CACHE_COUNT > 0
@@ -1621,51 +3333,50 @@ int Storage_Write(STORAGE_TYPE * samples, int n)
     ASSERT(samples != NULL);
 
     int count = 0;
-    while (count < n) {
-        if (CacheSample(samples + count)) {
-            count++;
-        }
-        else {
-            STORAGE_TYPE cachedSamples[STORAGE_SAMPLE_ALON_CACHE_COUNT + 1];
-            int cachedCount = 0;
-            while (GetCachedSample(cachedCount, cachedSamples + cachedCount)) {
-                cachedCount++;
-            }
-            ASSERT(cachedCount == STORAGE_SAMPLE_ALON_CACHE_COUNT);
-            cachedSamples[cachedCount] = samples[count];
-            cachedCount++;
+    while ((count < n) && CacheSample(samples + count)) {
+        count++;
+    }
 
-            int stored = StoreSamplesInEeprom(cachedSamples, cachedCount);
-            if (stored) {
-                count++; /* At least one sample was stored in EEPROM: there is room now in cache if needs be. */
-                /* Clear cache, then place back on the cache what could not be moved to EEPROM. */
-                spRecoverInfo->sampleCacheCount = 0;
-                for (int i = stored; i < cachedCount; i++) {
-                    CacheSample(cachedSamples + i);
-                }
+    if (count < n) {
+        /* The cache is full: move the cached samples, followed by all remaining samples, to EEPROM in bulk. */
+        STORAGE_TYPE cachedSamples[STORAGE_SAMPLE_ALON_CACHE_COUNT];
+        int cachedCount = 0;
+        while (GetCachedSample(cachedCount, cachedSamples + cachedCount)) {
+            cachedCount++;
+        }
+        ASSERT(cachedCount == STORAGE_SAMPLE_ALON_CACHE_COUNT);
 
-                /* Update variables used when reading samples. */
-                if (sInstance.readLocation == LOCATION_CACHE) {
-                    if (sInstance.readCursor >= stored) { /* Possibly true if not all samples could be moved. */
-                        // sInstance.readLocation does not change
-                        sInstance.readCursor -= stored;
-                        // sInstance.readSequence does not change
-                    }
-                    else {
-                        sInstance.readLocation = LOCATION_EEPROM;
-                        sInstance.readCursor = sInstance.eepromBitCursor
-                                - ((stored - sInstance.readCursor) * STORAGE_BITSIZE);
-                        // sInstance.readSequence does not change
-                    }
-                }
+        /* Update variables used when reading samples: point to where the cached sample will be written in EEPROM.
+         * This may lie beyond sInstance.eepromBitCursor until all cached samples are stored.
+         */
+        if (sInstance.readLocation == LOCATION_CACHE) {
+            sInstance.readLocation = LOCATION_EEPROM;
+            sInstance.readCursor = sInstance.eepromBitCursor + (sInstance.readCursor * STORAGE_BITSIZE);
+            // sInstance.readSequence does not change
+        }
 
-                /* Loop again, cache has been updated. */
-            }
-            else {
-                /* Leave the cache intact. */
-                break; /* Stop the while loop: storage is full. */
+        int stored = StoreSamplesInEeprom(cachedSamples, cachedCount);
+        spRecoverInfo->sampleCacheCount = 0;
+        if (stored == cachedCount) {
+            count += StoreSamplesInEeprom(samples + count, n - count);
+        }
+        else {
+            /* Storage is full. Place back on the cache what could not be moved to EEPROM. */
+            for (int i = stored; i < cachedCount; i++) {
+                CacheSample(cachedSamples + i);
             }
         }
+        /* If storage is full, use what is left of the cache. */
+        while ((count < n) && CacheSample(samples + count)) {
+            count++;
+        }
+
+        /* Update variables used when reading samples, in case not all cached samples could be moved. */
+        if ((sInstance.readLocation == LOCATION_EEPROM) && (sInstance.readCursor >= sInstance.eepromBitCursor)) {
+            sInstance.readLocation = LOCATION_CACHE;
+            sInstance.readCursor = (sInstance.readCursor - sInstance.eepromBitCursor) / STORAGE_BITSIZE;
+            // sInstance.readSequence does not change
+        }
     }
 
     return count;
@@ -1684,35 +3395,20 @@ bool Storage_Seek(int n)
     sInstance.readSequence = -1;
     sInstance.readCursor = -1;
 
-    if (n < 0) { return false; }
+    if (n < sInstance.flashBaseSequence) { return false; } /* Negative, or already overwritten. */
 
-    int currentSequence = -1;
-    int currentCursor = -1;
-    int nextSequence = 0;
-    int nextCursor = 0;
+    int nextSequence = GetFlashCount();
+    int nextCursor;
 
-    /* Step through the (compressed) blocks in FLASH, counting the number of samples stored in there.
-     * If the count surpasses n we have found a block where the requested sample is stored in.
-     * - The cursor variables below indicate a byte offset in FLASH.
-     * - The sequence variables below indicate a sequence count.
-     */
-    while (nextCursor < sInstance.flashByteCursor) {
-        currentSequence = nextSequence;
-        currentCursor = nextCursor;
-        uint8_t * header = FLASH_CURSOR_TO_BYTE_ADDRESS(nextCursor);
-
-        int bitCount = (int)(header[0] | (header[1] << 8));
-        nextSequence += STORAGE_BLOCK_SIZE_IN_SAMPLES;
-        nextCursor += FLASH_BLOCK_SIZE(bitCount);
-        ASSERT((nextCursor & 0x3) == 0); /* Must be 32-bit word-aligned. */
-        if ((currentSequence <= n) && (n < nextSequence)) {
-            break;
-        }
-    }
-    if ((currentSequence <= n) && (n < nextSequence)) {
+    if (n < nextSequence) {
+        /* Each (compressed) block in FLASH stores the same number of samples: the block where the requested sample is
+         * stored in is found directly using the index.
+         */
+        int block = (n - sInstance.flashBaseSequence) / STORAGE_BLOCK_SIZE_IN_SAMPLES;
         sInstance.readLocation = LOCATION_FLASH;
-        sInstance.readSequence = currentSequence;
-        sInstance.readCursor = currentCursor;
+        sInstance.readSequence = sInstance.flashBaseSequence + block * STORAGE_BLOCK_SIZE_IN_SAMPLES;
+        sInstance.readCursor = GetFlashBlockCursor(block);
+        ASSERT((sInstance.readCursor & 0x3) == 0); /* Must be 32-bit word-aligned. */
     }
     else {
         /* Try to find the sequence number sought for in EEPROM.
@@ -1757,30 +3453,33 @@ int Storage_Read(STORAGE_TYPE * samples, int n)
     }
     else {
         if (sInstance.readLocation == LOCATION_FLASH) {
-            int blockSize = ReadAndCacheSamplesFromFlash(sInstance.readCursor);
-            while (blockSize && (count < n) && (sInstance.readCursor < sInstance.flashByteCursor)) {
+            const uint8_t * pBlockSamples = NULL;
+            const int flashCount = GetFlashCount();
+            int blockSize = ReadAndCacheSamplesFromFlash(sInstance.readCursor, &pBlockSamples);
+            while (blockSize && (count < n) && (sInstance.readSequence < flashCount)) {
                 while ((count < n) && (sInstance.readSequence + STORAGE_BLOCK_SIZE_IN_SAMPLES > sInstance.targetSequence)) {
                     /* Determine the offset in bytes and the initial number of LSBits to ignore. */
                     int bitOffset = (sInstance.targetSequence - sInstance.readSequence) * STORAGE_BITSIZE;
                     int byteOffset = bitOffset / 8;
                     int bitAlignment = bitOffset % 8;
 
-                    ShiftUnalignedData((uint8_t *)(samples + count), STORAGE_WORKAREA + byteOffset, bitAlignment,
-                                       STORAGE_BITSIZE);
+                    ShiftUnalignedSample((uint8_t *)(samples + count), pBlockSamples + byteOffset, bitAlignment);
                     bitOffset += STORAGE_BITSIZE;
                     count++;
                     sInstance.targetSequence++;
                 }
                 if (sInstance.readSequence + STORAGE_BLOCK_SIZE_IN_SAMPLES <= sInstance.targetSequence) {
                     /* A next sample is available in EEPROM or in the next (compressed) block of data in FLASH. */
-                    sInstance.readCursor += blockSize;
+                    sInstance.readCursor = NextFlashBlockCursor(sInstance.readCursor, blockSize);
                     ASSERT((sInstance.readCursor & 0x3) == 0); /* Must be 32-bit word-aligned. */
                     sInstance.readSequence += STORAGE_BLOCK_SIZE_IN_SAMPLES;
                 }
-                blockSize = ReadAndCacheSamplesFromFlash(sInstance.readCursor);
+                if ((count < n) && (sInstance.readSequence < flashCount)) {
+                    blockSize = ReadAndCacheSamplesFromFlash(sInstance.readCursor, &pBlockSamples);
+                }
             }
 
-            if (sInstance.readCursor >= sInstance.flashByteCursor) {
+            if (sInstance.readSequence >= flashCount) {
                 /* All is read from FLASH, ensure the next read will pick the samples from EEPROM. */
                 sInstance.readLocation = LOCATION_EEPROM;
                 sInstance.readCursor = 0;
@@ -1789,7 +3488,7 @@ int Storage_Read(STORAGE_TYPE * samples, int n)
 
         if (sInstance.readLocation == LOCATION_EEPROM) {
             while ((count < n) && (sInstance.readCursor < sInstance.eepromBitCursor)) {
-                ReadFromEeprom((unsigned int)sInstance.readCursor, samples + count, STORAGE_BITSIZE);
+                ReadSampleFromEeprom(sInstance.readCursor, samples + count);
                 count++;
                 sInstance.readSequence++;
                 sInstance.readCursor += STORAGE_BITSIZE;
@@ -1817,12 +3516,140 @@ int Storage_Read(STORAGE_TYPE * samples, int n)
 #endif
     }
 
-#if STORAGE_SIGNED
+#if STORAGE_CHANNEL_COUNT > 1
+    /* Nothing to do: all bytes of each sample, including the sign extension of each channel, were written to. */
+#elif STORAGE_SIGNED
     /* STORAGE_TYPE is signed: propagate the bit at position STORAGE_BITSIZE to the left */
     int msbits = sizeof(STORAGE_TYPE) * 8 - STORAGE_BITSIZE;
     for (int i = 0; i < count; i++) {
         samples[i] = (STORAGE_TYPE)((STORAGE_TYPE)(samples[i] << msbits) >> msbits);
     }
+#else
+    if (STORAGE_IDIVUP(STORAGE_BITSIZE, 8) < sizeof(STORAGE_TYPE)) {
+        /* Only the bytes covering STORAGE_BITSIZE bits were written to, with the remainder MSBits of the last one
+         * cleared: clear the bytes after. This is done per byte, as STORAGE_TYPE may be a structure.
+         */
+        for (int i = 0; i < count; i++) {
+            memset((uint8_t *)(samples + i) + STORAGE_IDIVUP(STORAGE_BITSIZE, 8), 0,
+                   sizeof(STORAGE_TYPE) - STORAGE_IDIVUP(STORAGE_BITSIZE, 8));
+        }
+    }
 #endif
     return count;
 }
+
+#if STORAGE_CHANNEL_COUNT > 1
+int Storage_ReadChannel(int channel, void * pValues, int n)
+{
+    STORAGE_TYPE sample;
+    int count = 0;
+
+    ASSERT((channel >= 0) && (channel < STORAGE_CHANNEL_COUNT));
+    ASSERT(pValues != NULL);
+
+    while ((count < n) && (Storage_Read(&sample, 1) == 1)) {
+        memcpy((uint8_t *)pValues + count * CHANNEL_SIZE, (uint8_t *)&sample + channel * CHANNEL_SIZE, CHANNEL_SIZE);
+        count++;
+    }
+    return count;
+}
+#endif
+
+int Storage_ForEach(int first, int count, pStorage_ForEachCb_t cb, void * pContext)
+{
+    STORAGE_TYPE run[STORAGE_FOREACH_RUN_COUNT];
+    int total = 0;
+    bool proceed = true;
+
+    ASSERT(cb != NULL);
+
+    if (Storage_Seek(first)) {
+        while (proceed && (total < count)) {
+            const STORAGE_TYPE * pRun = NULL;
+            int n = 0;
+            if ((STORAGE_BITSIZE == 8 * sizeof(STORAGE_TYPE)) && (sInstance.readLocation == LOCATION_FLASH)) {
+                n = GetFlashRun(&pRun, count - total);
+            }
+            if (n == 0) {
+                /* Unpack the samples first. */
+                pRun = run;
+                n = Storage_Read(run, (count - total < STORAGE_FOREACH_RUN_COUNT) ? count - total
+                                                                                   : STORAGE_FOREACH_RUN_COUNT);
+            }
+            if (n == 0) {
+                break;
+            }
+            proceed = cb(pRun, n, pContext);
+            total += n;
+        }
+    }
+    return total;
+}
+
+#if STORAGE_BLOCK_SUMMARY
+int Storage_GetSummary(int first, int count, Storage_Summary_t * pSummaries)
+{
+    STORAGE_TYPE run[STORAGE_FOREACH_RUN_COUNT];
+    int total = 0;
+
+    ASSERT(pSummaries != NULL);
+    memset(pSummaries, 0, STORAGE_CHANNEL_COUNT * sizeof(Storage_Summary_t));
+
+    if (Storage_Seek(first)) {
+        while (total < count) {
+            int n = 0;
+            if ((sInstance.readLocation == LOCATION_FLASH) && (sInstance.targetSequence == sInstance.readSequence)
+                    && (count - total >= STORAGE_BLOCK_SIZE_IN_SAMPLES)) {
+                /* The block is fully covered: use its summary, without decompressing it. */
+                const uint8_t * pHeader = FLASH_CURSOR_TO_BYTE_ADDRESS(sInstance.readCursor);
+                const int bitCount = (int)(pHeader[0] | (pHeader[1] << 8));
+                if (bitCount == 0x0000FFFF) {
+                    break; /* The FLASH was emptied: see ReadAndCacheSamplesFromFlash. */
+                }
+                for (int c = 0; c < STORAGE_CHANNEL_COUNT; c++) {
+                    BlockSummary_t blockSummary;
+                    memcpy(&blockSummary, pHeader + 2 + (size_t)c * sizeof(BlockSummary_t), sizeof(BlockSummary_t));
+                    if ((pSummaries[c].count == 0) || (blockSummary.min < pSummaries[c].min)) {
+                        pSummaries[c].min = blockSummary.min;
+                    }
+                    if ((pSummaries[c].count == 0) || (blockSummary.max > pSummaries[c].max)) {
+                        pSummaries[c].max = blockSummary.max;
+                    }
+                    pSummaries[c].sum += blockSummary.sum;
+                    pSummaries[c].count += STORAGE_BLOCK_SIZE_IN_SAMPLES;
+                }
+                n = STORAGE_BLOCK_SIZE_IN_SAMPLES;
+                sInstance.targetSequence += n;
+                sInstance.readSequence += n;
+                sInstance.readCursor = NextFlashBlockCursor(sInstance.readCursor, FLASH_BLOCK_SIZE(bitCount));
+                if (sInstance.readSequence >= GetFlashCount()) {
+                    /* All is read from FLASH, ensure the next read will pick the samples from EEPROM. */
+                    sInstance.readLocation = LOCATION_EEPROM;
+                    sInstance.readCursor = 0;
+                }
+            }
+            else {
+                /* Read the samples one by one, but only up to the end of a block in FLASH: the next one may be fully
+                 * covered.
+                 */
+                n = (count - total < STORAGE_FOREACH_RUN_COUNT) ? count - total : STORAGE_FOREACH_RUN_COUNT;
+                if ((sInstance.readLocation == LOCATION_FLASH)
+                        && (sInstance.readSequence + STORAGE_BLOCK_SIZE_IN_SAMPLES - sInstance.targetSequence < n)) {
+                    n = sInstance.readSequence + STORAGE_BLOCK_SIZE_IN_SAMPLES - sInstance.targetSequence;
+                }
+                n = Storage_Read(run, n);
+                if (n == 0) {
+                    break;
+                }
+                for (int i = 0; i < n; i++) {
+                    for (int c = 0; c < STORAGE_CHANNEL_COUNT; c++) {
+                        SummarizeValue(&pSummaries[c], GetChannelValue(&run[i], c));
+                    }
+                }
+            }
+            total += n;
+        }
+    }
+    return total;
+}
+#endif
@@ -69,8 +69,11 @@
  *  - When storing samples, and a move from EEPROM to FLASH is required, the assigned compress callback - see
  *      #STORAGE_COMPRESS_CB - is given a pointer inside this SRAM memory. The output is then stored in FLASH.
  *  - When reading samples from FLASH, the assigned decompress callback - see #STORAGE_DECOMPRESS_CB - is called as
- *      little as possible: its output is cached in the work area to speed up subsequent reads.
+ *      little as possible: its output is cached in the work area to speed up subsequent reads. Up to
+ *      #STORAGE_DECOMPRESSED_CACHE_BLOCKS decompressed blocks are kept, the least recently used one being replaced.
  *  .
+ *  The index to the (compressed) data blocks in FLASH - see #STORAGE_BLOCK_INDEX_COUNT - does not take up SRAM: it is
+ *  kept in the assigned EEPROM region, and updated while samples are moved to FLASH.
  *  If two operations in your code require such a big chunk of memory, you can overlap them if they don't have to
  *  operate concurrently. Diversity setting #STORAGE_WORKAREA can be used for this.
  *
@@ -144,6 +147,29 @@ typedef int (*pStorage_CompressCb_t)(int eepromByteOffset, int bitCount, void *
  */
 typedef int (*pStorage_DecompressCb_t)(const uint8_t * pData, int bitCount, void * pOut);
 
+/**
+ * Used by #Storage_ForEach to hand out a run of consecutive samples to the application.
+ * @param pSamples Points to @c n samples, unpacked: each element contains one sample, exactly as #Storage_Read would
+ *  have copied it. Depending on where the samples are stored, this points inside the workarea of this module - see
+ *  #STORAGE_WORKAREA - directly to FLASH, or to a temporary array on the stack.
+ * @param n The number of samples in the run. Always strict positive.
+ * @param pContext The value given in the call to #Storage_ForEach.
+ * @return @c true to receive the next run of samples, if any; @c false to stop.
+ * @warning The memory @c pSamples points to is only valid during the lifetime of the callback.
+ * @warning It is @b not allowed to call any function of this module during the lifetime of the callback.
+ */
+typedef bool (*pStorage_ForEachCb_t)(const STORAGE_TYPE * pSamples, int n, void * pContext);
+
+#if STORAGE_BLOCK_SUMMARY
+/** Summary statistics of the values of one channel over a range of samples. @see Storage_GetSummary */
+typedef struct Storage_Summary_s {
+    int count; /**< The number of samples summarized. When @c 0, the other fields are not valid. */
+    int32_t min; /**< The lowest value. */
+    int32_t max; /**< The highest value. */
+    int64_t sum; /**< The sum of all values. Divide by @c count to obtain the mean. */
+} Storage_Summary_t;
+#endif
+
 /* ------------------------------------------------------------------------- */
 
 /**
@@ -178,10 +204,50 @@ void Storage_Init(void);
 void Storage_DeInit(void);
 
 /**
- * @return The total number of samples currently stored, in EEPROM and FLASH combined.
+ * @return The total number of samples currently stored, in EEPROM and FLASH combined. When #STORAGE_FLASH_CIRCULAR is
+ *  set, the number of samples that were overwritten is included: this is then the sequence number of the next sample
+ *  to be written.
  */
 int Storage_GetCount(void);
 
+/**
+ * @return The sequence number of the oldest sample still stored. This is always @c 0, unless #STORAGE_FLASH_CIRCULAR
+ *  is set and the oldest samples have been overwritten. Samples with a lower sequence number can no longer be read:
+ *  #Storage_Seek will fail for them.
+ */
+int Storage_GetFirst(void);
+
+/**
+ * Performs a limited amount of pending housekeeping work: moving the oldest samples from EEPROM to FLASH and - when
+ * #STORAGE_DEFER_ERASE is set and no move is pending - checking and erasing the FLASH pages where the next samples are
+ * to be written. Call this repeatedly, at a moment of the application's choosing - e.g. while an NFC field supplies
+ * power - until @c false is returned.
+ * Each call takes at most the time of one compression, one FLASH page write or erase, or one update of the EEPROM
+ * contents.
+ * @pre EEPROM is initialized
+ * @return @c true when more work is pending; @c false when there is nothing left to do, or when moving samples to
+ *  FLASH failed - FLASH storage is full, for instance. In that case, it is not retried until the next call to
+ *  #Storage_Init or #Storage_Reset.
+ * @note The first step of a move makes the samples involved durable in EEPROM, together with a marker and hint. Until
+ *  the move has been fully completed, they remain stored there: an interruption, a power loss or a call to
+ *  #Storage_Init simply restarts the move in a later call, which writes the same data to FLASH.
+ * @note Reading samples from FLASH in between two calls may require to restart the move: avoid interleaving both.
+ * @post A later call to #Storage_DeInit is necessary to ensure the data can survive Deep power down state.
+ * @see STORAGE_DEFER_MOVE_TO_FLASH
+ */
+bool Storage_Service(void);
+
+/**
+ * Retrieves how effective the cache of decompressed blocks was since the last call to #Storage_Init. Use this to tune
+ * #STORAGE_DECOMPRESSED_CACHE_BLOCKS for the read patterns of your application.
+ * @param [out] pHits : May be @c NULL. When not @c NULL, the number of times a block to read from FLASH was found
+ *  already decompressed is written here.
+ * @param [out] pMisses : May be @c NULL. When not @c NULL, the number of times #STORAGE_DECOMPRESS_CB had to be
+ *  called is written here.
+ * @note Blocks stored uncompressed in FLASH are read in place and are not counted.
+ */
+void Storage_GetCacheStatistics(int * pHits, int * pMisses);
+
 /**
  * Resets the storage module to a pristine state.
  * @param checkFlash The contents in FLASH must have been erased before it can be written to. An erase operation is
@@ -192,6 +258,8 @@ int Storage_GetCount(void);
  *      sector boundaries can reduce this to the minimum of 1 erase cycle.
  *  - When @c false is given, FLASH memory is not checked and not erased.
  *  .
+ *  When #STORAGE_DEFER_ERASE is set, this argument is ignored: FLASH memory is never checked nor erased here, but
+ *  later on by #Storage_Service, or right before it is written to.
  * @note Provide @c true as argument for @c checkFlash when the intention is to store new samples afterwards.
  */
 void Storage_Reset(bool checkFlash);
@@ -208,6 +276,8 @@ void Storage_Reset(bool checkFlash);
  *  - Compressing of samples was necessary during the call, but that operation yielded an error.
  *  .
  * @note A prior call to #Storage_Seek is @b not required, as writing will always @b append the new samples.
+ * @note When #STORAGE_DEFER_MOVE_TO_FLASH is enabled, this call only moves samples from EEPROM to FLASH when the
+ *  assigned EEPROM region is completely filled: see #Storage_Service.
  * @post A later call to #Storage_DeInit is necessary to ensure the data can survive Deep power down state.
  * @warning Data is not guaranteed to be stored in EEPROM or FLASH: reset can lose some of the last samples written.
  */
@@ -233,7 +303,8 @@ bool Storage_Seek(int n);
  * @note Multiple reads can be issued after calling #Storage_Seek once, each time fetching samples in sequence.
  * @param [out] pSamples : Pointer to an array of @n elements, where the read samples are copied to. Upon successful
  *  completion, each element will contain one sample, where only the #STORAGE_BITSIZE LSBits are used per
- *  element; the remainder MSBits are set to 0.
+ *  element; the remainder MSBits are set to 0. When #STORAGE_CHANNEL_COUNT is greater than @c 1, this holds per
+ *  channel.
  * @param n : The size of the array @c samples points to, in number of #STORAGE_TYPE elements.
  * @return The number of samples read. This value may be @c 0 or any number of samples less than @c n.
  *  The remainder of the elements with a higher index may have been written to, but must be ignored.
@@ -244,6 +315,55 @@ bool Storage_Seek(int n);
  */
 int Storage_Read(STORAGE_TYPE * pSamples, int n);
 
+/**
+ * Hands out up to @c count samples, starting from the sample with index @c first, by calling @c cb one or more times
+ * with a run of consecutive samples. In contrast to #Storage_Read, this allows the application to serialize the
+ * samples directly in their final destination, without first copying them in an intermediate buffer.
+ * @param first The index of the first sample to hand out. A value of @c 0 indicates the oldest sample.
+ * @param count The maximum number of samples to hand out.
+ * @param cb May not be @c NULL. The function to call for each run of samples.
+ * @param pContext Passed as-is to @c cb.
+ * @return The number of samples handed out. This value may be @c 0 or any number of samples less than @c count, for
+ *  the same reasons as in #Storage_Read, or when @c cb returned @c false.
+ * @post The read position is moved past the last sample handed out: a subsequent call to #Storage_Read fetches the
+ *  samples following it, as if #Storage_Seek was called with @code first + (the returned value) @endcode.
+ * @see STORAGE_FOREACH_RUN_COUNT
+ */
+int Storage_ForEach(int first, int count, pStorage_ForEachCb_t cb, void * pContext);
+
+#if STORAGE_BLOCK_SUMMARY
+/**
+ * Calculates the minimum, maximum and sum of the values of up to @c count samples, starting from the sample with index
+ * @c first. Blocks in FLASH that are fully covered are summarized using the summary stored in their header, without
+ * decompressing them; only the samples before the first and after the last fully covered block are read.
+ * @param first The index of the first sample to summarize. A value of @c 0 indicates the oldest sample.
+ * @param count The maximum number of samples to summarize.
+ * @param [out] pSummaries : May not be @c NULL. Points to an array of #STORAGE_CHANNEL_COUNT elements, where the
+ *  summary of each channel is written to.
+ * @return The number of samples summarized. This value may be @c 0 or any number of samples less than @c count, for
+ *  the same reasons as in #Storage_Read.
+ * @post The read position is moved past the last sample summarized, as if #Storage_Seek was called with
+ *  @code first + (the returned value) @endcode.
+ * @see STORAGE_BLOCK_SUMMARY
+ */
+int Storage_GetSummary(int first, int count, Storage_Summary_t * pSummaries);
+#endif
+
+#if STORAGE_CHANNEL_COUNT > 1
+/**
+ * Reads the values of a single channel of @c n samples from persistent storage, starting from the sequence number set
+ * in #Storage_Seek. This behaves as #Storage_Read, but only copies the element of each sample that holds the value of
+ * channel @c channel.
+ * @param channel Must be in the range [0, #STORAGE_CHANNEL_COUNT[. The channel to retrieve.
+ * @param [out] pValues : Pointer to an array of @c n elements, each @code sizeof(STORAGE_TYPE) /
+ *  STORAGE_CHANNEL_COUNT @endcode bytes in size.
+ * @param n : The size of the array @c pValues points to, in number of elements.
+ * @return The number of values read. This value may be @c 0 or any number of values less than @c n, for the same
+ *  reasons as in #Storage_Read.
+ */
+int Storage_ReadChannel(int channel, void * pValues, int n);
+#endif
+
 /**
  * @cond STORAGE_DOC
  * @mainpage storage: NVM Storage module
@@ -40,13 +40,23 @@
  * - #STORAGE_EEPROM_LAST_ROW
  * - #STORAGE_FLASH_FIRST_PAGE
  * - #STORAGE_FLASH_LAST_PAGE
+ * - #STORAGE_FLASH_CIRCULAR
  * - #STORAGE_TYPE
+ * - #STORAGE_CHANNEL_COUNT
+ * - #STORAGE_CHANNEL_0_BITSIZE .. #STORAGE_CHANNEL_7_BITSIZE
  * - #STORAGE_BITSIZE
  * - #STORAGE_SIGNED
  * - #STORAGE_WORKAREA
  * - #STORAGE_WRITE_RECOVERY_EVERY_X_SAMPLES
  * - #STORAGE_BLOCK_SIZE_IN_SAMPLES
+ * - #STORAGE_DECOMPRESSED_CACHE_BLOCKS
+ * - #STORAGE_FOREACH_RUN_COUNT
+ * - #STORAGE_BLOCK_SUMMARY
+ * - #STORAGE_DEFER_MOVE_TO_FLASH
+ * - #STORAGE_DEFER_ERASE
  * - #STORAGE_REDUCE_RECOVERY_WRITES
+ * - #STORAGE_CHECKPOINT
+ * - #STORAGE_BLOCK_CRC
  * - #STORAGE_COMPRESS_CB
  * - #STORAGE_DECOMPRESS_CB
  * .
@@ -57,12 +67,18 @@
  * - #STORAGE_MAX_SAMPLE_ALON_CACHE_COUNT
  * - #STORAGE_WORKAREA_SELF_DEFINED
  * - #STORAGE_WORKAREA_SIZE
+ * - #STORAGE_BLOCK_INDEX_COUNT
+ * - #STORAGE_BLOCK_INDEX_ROW_COUNT
  * - #STORAGE_MAX_BLOCK_SIZE_IN_SAMPLES
+ * - #STORAGE_BLOCK_SUMMARY_SIZE
  * - #STORAGE_BLOCK_HEADER_SIZE
+ * - #STORAGE_BLOCK_TRAILER_SIZE
  * - #STORAGE_MAX_UNCOMPRESSED_BLOCK_SIZE_IN_BITS
  * - #STORAGE_MAX_LOSS_AFTER_CORRUPTION
  * - #STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS
  * - #STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BYTES
+ * - #STORAGE_DECOMPRESSED_BLOCK_SIZE_IN_BYTES
+ * - #STORAGE_COMPRESS_WORKAREA_SIZE
  *
  *  @par Choosing correct values
  *      The storage module has many diversity settings, and can be tweaked a lot. Storing data reliably and as
@@ -88,9 +104,11 @@
  *      basic types and structures or unions are possible. Each sample will be placed back to back, without a single
  *      padding bit; if you know that a few MSBits are always 0, you can choose to store fewer bits, resulting in a
  *      larger storage capacity.
+ *      A sample may also combine several values measured at the same time, each stored with its own number of bits.
  *      - #STORAGE_TYPE
  *      - #STORAGE_BITSIZE
  *      - #STORAGE_SIGNED
+ *      - #STORAGE_CHANNEL_COUNT
  *      .
  *
  *      Compression greatly increases the number of samples that can be stored, at the cost of the size of the
@@ -242,15 +260,35 @@
      * until the last byte in this page, the Storage module has full control: no other code will touch this FLASH
      * region.
      * @note the size of the region is not required to be a multiple of the FLASH sector size.
+     * @note When #STORAGE_FLASH_FIRST_PAGE equals @c 0, the first page is only known at link time: this page can then
+     *  only be checked at runtime, in #Storage_Init. A lower value leaves the last FLASH pages free for other use, e.g.
+     *  by the event module - see #EVENT_ARCHIVE_FLASH_FIRST_PAGE. When the code grows beyond this page, storage to
+     *  FLASH is disabled: only the EEPROM is then used to store samples. Debug builds assert.
      */
     #define STORAGE_FLASH_LAST_PAGE (FLASH_NR_OF_RW_SECTORS * FLASH_PAGES_PER_SECTOR - 1)
 #endif
 #if (STORAGE_FLASH_LAST_PAGE < STORAGE_FLASH_FIRST_PAGE) || (STORAGE_FLASH_LAST_PAGE >= FLASH_NR_OF_RW_SECTORS * FLASH_PAGES_PER_SECTOR)
     #error Invalid value for STORAGE_FLASH_LAST_PAGE
 #endif
-#if (STORAGE_FLASH_FIRST_PAGE == 0) && (STORAGE_FLASH_LAST_PAGE != (FLASH_NR_OF_RW_SECTORS * FLASH_PAGES_PER_SECTOR - 1))
-    #error STORAGE_FLASH_FIRST_PAGE is determined at link time; STORAGE_FLASH_LAST_PAGE can thus not be checked at precompilation time.
-    #error STORAGE_FLASH_LAST_PAGE must be set to the highest possible value in this case.
+
+#ifndef STORAGE_FLASH_CIRCULAR
+    /**
+     * - If not defined, or defined to zero, no more samples can be added once the assigned FLASH region is full:
+     *  #Storage_Write then returns a value less than requested.
+     * - If defined to a non-zero value, the assigned FLASH region is used as a ring buffer: the oldest (compressed)
+     *  data blocks are erased to make room for new ones, and writing never stops. The newest samples are kept.
+     * .
+     * Samples keep their index: the sample written first has index @c 0, also after it has been erased. Use
+     * #Storage_GetFirst to know the index of the oldest sample that can still be read.
+     * @note FLASH pages are erased a full (uncompressed) data block ahead of where the next block will be written,
+     *  right after each move of samples to FLASH - one page per call to #Storage_Service when
+     *  #STORAGE_DEFER_MOVE_TO_FLASH is set. The next move then never has to wait for an erase. The samples in these
+     *  pages are no longer accessible from then on.
+     * @note Each data block in FLASH is followed by #STORAGE_BLOCK_TRAILER_SIZE bytes of meta data, to find back the
+     *  oldest block after a power loss.
+     * @note The assigned FLASH region must be able to hold at least three uncompressed data blocks.
+     */
+    #define STORAGE_FLASH_CIRCULAR 0
 #endif
 
 /* ------------------------------------------------------------------------- */
@@ -264,10 +302,111 @@
     #define STORAGE_TYPE uint8_t
 #endif
 
+#ifndef STORAGE_CHANNEL_COUNT
+    /**
+     * The number of channels in one sample. Use this when each measurement yields several correlated values - e.g.
+     * a resistance, two voltages and a current - which must be stored, sought and read together.
+     * - When @c 1, a sample is a single value of #STORAGE_TYPE, of which #STORAGE_BITSIZE LSBits are stored.
+     * - When greater than @c 1, #STORAGE_TYPE is a record consisting of #STORAGE_CHANNEL_COUNT elements of equal size,
+     *  one per channel, without padding in between: an array, or a structure with members of the same type. Of the
+     *  element of channel @c n, #STORAGE_CHANNEL_0_BITSIZE .. #STORAGE_CHANNEL_7_BITSIZE LSBits are stored, back to
+     *  back. #STORAGE_SIGNED then applies to each channel separately.
+     * .
+     * Each call to #Storage_Write, #Storage_Seek, #Storage_Read and #Storage_ForEach still counts in samples, i.e. in
+     * records. #Storage_ReadChannel can be used to retrieve the values of one channel only.
+     * @note Samples in FLASH are compressed per block of records: see #STORAGE_CHANNEL_BITSIZES to compress each
+     *  channel on its own.
+     * @note Channels are not independent streams: all channels of a sample are written in the same call and share
+     *  its sequence number. There is no stream identifier per write, no seek per stream, and FLASH blocks carry no
+     *  stream tag. Independent streams would each need their own EEPROM region, marker, hint and ALON recovery state,
+     *  where this module recovers a single sequence from one EEPROM region and at most 4 ALON registers. When a
+     *  channel is not measured each time, write a constant value for it instead: compressed per channel - see
+     *  #STORAGE_CHANNEL_BITSIZES - its column then takes up a few bits per block in FLASH, although it still takes up
+     *  its full bit size while the sample is in EEPROM.
+     */
+    #define STORAGE_CHANNEL_COUNT 1
+#endif
+#if (STORAGE_CHANNEL_COUNT < 1) || (STORAGE_CHANNEL_COUNT > 8)
+    #error STORAGE_CHANNEL_COUNT must be in the range [1, 8]
+#endif
+
+/* The number of bits stored per channel. Only the first #STORAGE_CHANNEL_COUNT are used, and only when
+ * #STORAGE_CHANNEL_COUNT is greater than @c 1. */
+#ifndef STORAGE_CHANNEL_0_BITSIZE
+    /** The number of bits that are stored for channel @c 0. See #STORAGE_CHANNEL_COUNT */
+    #define STORAGE_CHANNEL_0_BITSIZE 0
+#endif
+#ifndef STORAGE_CHANNEL_1_BITSIZE
+    /** The number of bits that are stored for channel @c 1. See #STORAGE_CHANNEL_COUNT */
+    #define STORAGE_CHANNEL_1_BITSIZE 0
+#endif
+#ifndef STORAGE_CHANNEL_2_BITSIZE
+    /** The number of bits that are stored for channel @c 2. See #STORAGE_CHANNEL_COUNT */
+    #define STORAGE_CHANNEL_2_BITSIZE 0
+#endif
+#ifndef STORAGE_CHANNEL_3_BITSIZE
+    /** The number of bits that are stored for channel @c 3. See #STORAGE_CHANNEL_COUNT */
+    #define STORAGE_CHANNEL_3_BITSIZE 0
+#endif
+#ifndef STORAGE_CHANNEL_4_BITSIZE
+    /** The number of bits that are stored for channel @c 4. See #STORAGE_CHANNEL_COUNT */
+    #define STORAGE_CHANNEL_4_BITSIZE 0
+#endif
+#ifndef STORAGE_CHANNEL_5_BITSIZE
+    /** The number of bits that are stored for channel @c 5. See #STORAGE_CHANNEL_COUNT */
+    #define STORAGE_CHANNEL_5_BITSIZE 0
+#endif
+#ifndef STORAGE_CHANNEL_6_BITSIZE
+    /** The number of bits that are stored for channel @c 6. See #STORAGE_CHANNEL_COUNT */
+    #define STORAGE_CHANNEL_6_BITSIZE 0
+#endif
+#ifndef STORAGE_CHANNEL_7_BITSIZE
+    /** The number of bits that are stored for channel @c 7. See #STORAGE_CHANNEL_COUNT */
+    #define STORAGE_CHANNEL_7_BITSIZE 0
+#endif
+
+/**
+ * Initializer for an array of #STORAGE_CHANNEL_COUNT or more @c int elements, holding the number of bits stored per
+ * channel. Use this in the compression callbacks - see #STORAGE_COMPRESS_CB - for example:
+ * @code
+ *  static const int bitSizes[] = STORAGE_CHANNEL_BITSIZES;
+ *  return Compress_DeltaEncodeChannels(data, STORAGE_BLOCK_SIZE_IN_SAMPLES, bitSizes, STORAGE_CHANNEL_COUNT, pOut,
+ *                                      STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BYTES);
+ * @endcode
+ */
+#if STORAGE_CHANNEL_COUNT > 1
+    #define STORAGE_CHANNEL_BITSIZES {STORAGE_CHANNEL_0_BITSIZE, STORAGE_CHANNEL_1_BITSIZE, STORAGE_CHANNEL_2_BITSIZE, \
+            STORAGE_CHANNEL_3_BITSIZE, STORAGE_CHANNEL_4_BITSIZE, STORAGE_CHANNEL_5_BITSIZE, STORAGE_CHANNEL_6_BITSIZE, \
+            STORAGE_CHANNEL_7_BITSIZE}
+    #if ((STORAGE_CHANNEL_0_BITSIZE <= 0) || (STORAGE_CHANNEL_1_BITSIZE <= 0) \
+            || ((STORAGE_CHANNEL_COUNT > 2) != (STORAGE_CHANNEL_2_BITSIZE > 0)) \
+            || ((STORAGE_CHANNEL_COUNT > 3) != (STORAGE_CHANNEL_3_BITSIZE > 0)) \
+            || ((STORAGE_CHANNEL_COUNT > 4) != (STORAGE_CHANNEL_4_BITSIZE > 0)) \
+            || ((STORAGE_CHANNEL_COUNT > 5) != (STORAGE_CHANNEL_5_BITSIZE > 0)) \
+            || ((STORAGE_CHANNEL_COUNT > 6) != (STORAGE_CHANNEL_6_BITSIZE > 0)) \
+            || ((STORAGE_CHANNEL_COUNT > 7) != (STORAGE_CHANNEL_7_BITSIZE > 0)))
+        #error Exactly STORAGE_CHANNEL_COUNT channel bit sizes must be set, each strict positive
+    #endif
+    #ifndef STORAGE_BITSIZE
+        #define STORAGE_BITSIZE (STORAGE_CHANNEL_0_BITSIZE + STORAGE_CHANNEL_1_BITSIZE + STORAGE_CHANNEL_2_BITSIZE \
+                + STORAGE_CHANNEL_3_BITSIZE + STORAGE_CHANNEL_4_BITSIZE + STORAGE_CHANNEL_5_BITSIZE \
+                + STORAGE_CHANNEL_6_BITSIZE + STORAGE_CHANNEL_7_BITSIZE)
+    #endif
+    #if STORAGE_BITSIZE != (STORAGE_CHANNEL_0_BITSIZE + STORAGE_CHANNEL_1_BITSIZE + STORAGE_CHANNEL_2_BITSIZE \
+            + STORAGE_CHANNEL_3_BITSIZE + STORAGE_CHANNEL_4_BITSIZE + STORAGE_CHANNEL_5_BITSIZE \
+            + STORAGE_CHANNEL_6_BITSIZE + STORAGE_CHANNEL_7_BITSIZE)
+        #error STORAGE_BITSIZE must equal the sum of all channel bit sizes: leave it undefined
+    #endif
+#else
+    #define STORAGE_CHANNEL_BITSIZES {STORAGE_BITSIZE}
+#endif
+
 #ifndef STORAGE_BITSIZE
     /**
      * The number of bits that are to be stored for each sample. For each sample given using #Storage_Write
      * this number of LSBits are written;
+     * @note When #STORAGE_CHANNEL_COUNT is greater than @c 1, this equals the sum of all channel bit sizes, and need
+     *  not be defined.
      */
     #define STORAGE_BITSIZE 8
 #endif
@@ -304,6 +443,8 @@
      * - If not defined, the MSBits at positions #STORAGE_BITSIZE and up will be set to @c 0.
      * .
      * @warning Setting this diversity flag to 1 while #STORAGE_TYPE is a structure, while raise compiler errors.
+     *  This does not apply when #STORAGE_CHANNEL_COUNT is greater than @c 1: the sign bit of each channel is then
+     *  propagated up to the MSBit of its element.
      * see #Storage_Read.
      */
     #define STORAGE_SIGNED 0
@@ -346,6 +487,51 @@
     #error Leave STORAGE_REDUCE_RECOVERY_WRITES undefined in app_sel.h, or define it to 0 (--> 2 recovery rows) or 1 (--> 1 recovery row)
 #endif
 
+#ifndef STORAGE_CHECKPOINT
+    /**
+     * - If not defined, or defined to zero, #Storage_Init finds back the stored samples after the general purpose
+     *  registers were cleared - e.g. after a battery swap or a hard reset - by checking the few locations following
+     *  the recovery information. Only when that fails, a slow search through the full assigned EEPROM region is
+     *  done, which may take more than 10 ms.
+     * - If defined to a non-zero value:
+     *  one more row of the assigned EEPROM region is reserved for a checkpoint journal: two alternating slots, each
+     *  holding a sequence number, the state to recover and a CRC. A slot is updated each time the hint is written, and
+     *  recovery then takes at most 2 * #STORAGE_WRITE_RECOVERY_EVERY_X_SAMPLES EEPROM reads, also when the hint itself
+     *  got corrupted.
+     * .
+     * @note Endurance budget: the checkpoint row is flushed as often as the hint rows - once per
+     *  #STORAGE_WRITE_RECOVERY_EVERY_X_SAMPLES samples written, and once per move to FLASH - and thus shares the
+     *  precondition documented there: the number of updates over the full lifetime of the product must stay below the
+     *  write endurance limit of 10.000.
+     */
+    #define STORAGE_CHECKPOINT 0
+#endif
+#if (STORAGE_CHECKPOINT != 0) && (STORAGE_CHECKPOINT != 1)
+    #error Leave STORAGE_CHECKPOINT undefined in app_sel.h, or define it to 0 or 1
+#endif
+
+#ifndef STORAGE_BLOCK_CRC
+    /**
+     * - If not defined, or defined to zero, each page written to FLASH is compared with the data to write right after
+     *  programming, with interrupts disabled, and the complete (compressed) data block is compared once more before
+     *  the move to FLASH is committed. #STORAGE_WORKAREA must remain untouched until then.
+     * - If defined to a non-zero value, a CRC-16 over the header and the (compressed) data of each block is calculated
+     *  while the block is prepared, and stored in its header. Instead of comparing, the block is verified by
+     *  recalculating the CRC over the data in FLASH, in chunks, with interrupts enabled. #STORAGE_WORKAREA is no
+     *  longer needed once all pages are written. The CRC is also checked each time a block is read from FLASH: a
+     *  corrupted block is then treated as unreadable, just as a block that failed to decompress.
+     * .
+     * @note This adds 2 bytes to #STORAGE_BLOCK_HEADER_SIZE.
+     */
+    #define STORAGE_BLOCK_CRC 0
+#endif
+#if (STORAGE_BLOCK_CRC != 0) && (STORAGE_BLOCK_CRC != 1)
+    #error Leave STORAGE_BLOCK_CRC undefined in app_sel.h, or define it to 0 or 1
+#endif
+#if STORAGE_CHECKPOINT && (STORAGE_EEPROM_ROW_COUNT < 4)
+    #error STORAGE_CHECKPOINT requires at least 4 EEPROM pages to be assigned for storage
+#endif
+
 /**
  * The maximum loss of samples that can occur. The storage module may not be able to return the most recently stored
  * samples after an EEPROM corruption occurs. A scenario where this can happen is when printed batteries are used,
@@ -360,26 +546,89 @@
         + STORAGE_WRITE_RECOVERY_EVERY_X_SAMPLES \
         + STORAGE_REDUCE_RECOVERY_WRITES * STORAGE_IDIVUP(8 * 8, STORAGE_BITSIZE)
 
+/**
+ * The number of entries in the index of the (compressed) data blocks in FLASH: one per FLASH sector - or part thereof -
+ * of the assigned FLASH region. Each entry tells where the last block starting in that sector is stored, and which
+ * samples it holds. This allows #Storage_Seek and #Storage_GetCount to find a block after stepping through the headers
+ * of at most one sector, instead of through all block headers stored in FLASH before it - also right after
+ * #Storage_Init, as the index is stored in the assigned EEPROM region, just before the hint.
+ * @note Each entry takes up 4 bytes, rounded up to a full row: see #STORAGE_BLOCK_INDEX_ROW_COUNT.
+ * @note When #STORAGE_FLASH_FIRST_PAGE equals @c 0, the index is sized for a region starting at the first FLASH page.
+ */
+#define STORAGE_BLOCK_INDEX_COUNT \
+    STORAGE_IDIVUP(STORAGE_FLASH_LAST_PAGE + 1 - STORAGE_FLASH_FIRST_PAGE, FLASH_PAGES_PER_SECTOR)
+
+/** The number of EEPROM rows taken up by the index of the (compressed) data blocks in FLASH. */
+#define STORAGE_BLOCK_INDEX_ROW_COUNT STORAGE_IDIVUP(4 * STORAGE_BLOCK_INDEX_COUNT, EEPROM_ROW_SIZE)
+
 /**
  * The maximum allowed value for #STORAGE_BLOCK_SIZE_IN_SAMPLES. After this many samples, the assigned EEPROM region is
  * completely filled and no new sample can be written to EEPROM before its contents are moved to FLASH first.
  * @hideinitializer
  */
 #if STORAGE_REDUCE_RECOVERY_WRITES
-    #define STORAGE_MAX_BLOCK_SIZE_IN_SAMPLES (((STORAGE_EEPROM_SIZE - 76) * 8) / STORAGE_BITSIZE)
+    #define STORAGE_MAX_BLOCK_SIZE_IN_SAMPLES \
+        (((STORAGE_EEPROM_SIZE - 76 - ((STORAGE_CHECKPOINT + STORAGE_BLOCK_INDEX_ROW_COUNT) * EEPROM_ROW_SIZE)) * 8) \
+        / STORAGE_BITSIZE)
     /* Magic value 76 is checked at compile time in storage.c */
 #else
-    #define STORAGE_MAX_BLOCK_SIZE_IN_SAMPLES (((STORAGE_EEPROM_SIZE - 140) * 8) / STORAGE_BITSIZE)
+    #define STORAGE_MAX_BLOCK_SIZE_IN_SAMPLES \
+        (((STORAGE_EEPROM_SIZE - 140 - ((STORAGE_CHECKPOINT + STORAGE_BLOCK_INDEX_ROW_COUNT) * EEPROM_ROW_SIZE)) * 8) \
+        / STORAGE_BITSIZE)
     /* Magic value 140 is checked at compile time in storage.c */
 #endif
 
 /** Defines the number of bits required to store one block of samples. */
 #define STORAGE_MAX_UNCOMPRESSED_BLOCK_SIZE_IN_BITS (STORAGE_MAX_BLOCK_SIZE_IN_SAMPLES * STORAGE_BITSIZE)
 
+#ifndef STORAGE_BLOCK_SUMMARY
+    /**
+     * - If not defined, or defined to zero, only the size of each (compressed) data block is stored in front of it in
+     *  FLASH.
+     * - If defined to a non-zero value, the minimum, maximum and sum of the values of each channel in the block are
+     *  stored as well, calculated when the samples are moved from EEPROM to FLASH. #Storage_GetSummary then only
+     *  needs to decompress the blocks that are partially covered by the requested range of samples.
+     * .
+     * @note The values are interpreted as @c int32_t, sign extended when #STORAGE_SIGNED is set. #STORAGE_TYPE must be
+     *  an integer type - or a record of integer elements when #STORAGE_CHANNEL_COUNT is greater than @c 1 - of at most
+     *  32 bits.
+     * @see STORAGE_BLOCK_SUMMARY_SIZE
+     */
+    #define STORAGE_BLOCK_SUMMARY 0
+#endif
+#if (STORAGE_BLOCK_SUMMARY != 0) && (STORAGE_BLOCK_SUMMARY != 1)
+    #error Leave STORAGE_BLOCK_SUMMARY undefined in app_sel.h, or define it to 0 or 1
+#endif
+#if STORAGE_BLOCK_SUMMARY && !STORAGE_SIGNED && (((STORAGE_CHANNEL_COUNT == 1) && (STORAGE_BITSIZE > 31)) \
+        || (STORAGE_CHANNEL_0_BITSIZE > 31) || (STORAGE_CHANNEL_1_BITSIZE > 31) || (STORAGE_CHANNEL_2_BITSIZE > 31) \
+        || (STORAGE_CHANNEL_3_BITSIZE > 31) || (STORAGE_CHANNEL_4_BITSIZE > 31) || (STORAGE_CHANNEL_5_BITSIZE > 31) \
+        || (STORAGE_CHANNEL_6_BITSIZE > 31) || (STORAGE_CHANNEL_7_BITSIZE > 31))
+    #error STORAGE_BLOCK_SUMMARY requires unsigned values to fit in 31 bits
+#endif
+
 /**
- * The size in bytes of the meta data stored just in front of the (compressed) data block in FLASH.
+ * The size in bytes of the summary stored for each (compressed) data block in FLASH, as part of its header: per
+ * channel, a 32-bit minimum, a 32-bit maximum and a 64-bit sum. The number of samples is not stored: each block holds
+ * #STORAGE_BLOCK_SIZE_IN_SAMPLES samples.
+ * @see STORAGE_BLOCK_SUMMARY
  */
-#define STORAGE_BLOCK_HEADER_SIZE 2
+#define STORAGE_BLOCK_SUMMARY_SIZE (STORAGE_BLOCK_SUMMARY * 16 * STORAGE_CHANNEL_COUNT)
+
+/**
+ * The size in bytes of the meta data stored just in front of the (compressed) data block in FLASH: the size of the
+ * block in bits, followed by the summary - see #STORAGE_BLOCK_SUMMARY - and the CRC - see #STORAGE_BLOCK_CRC.
+ */
+#define STORAGE_BLOCK_HEADER_SIZE (2 + STORAGE_BLOCK_SUMMARY_SIZE + 2 * STORAGE_BLOCK_CRC)
+
+/**
+ * The size in bytes of the meta data stored just after the (compressed) data block in FLASH.
+ * @see STORAGE_FLASH_CIRCULAR
+ */
+#if STORAGE_FLASH_CIRCULAR
+    #define STORAGE_BLOCK_TRAILER_SIZE 8
+#else
+    #define STORAGE_BLOCK_TRAILER_SIZE 0
+#endif
 
 #ifndef STORAGE_BLOCK_SIZE_IN_SAMPLES
     /**
@@ -406,8 +655,97 @@
 /** Defines the number of bytes required to store one block of samples. */
 #define STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BYTES STORAGE_IDIVUP(STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BITS, 8)
 
-/** The size in bytes of the required memory for this module */
-#define STORAGE_WORKAREA_SIZE ((FLASH_PAGE_SIZE * 2) + STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BYTES)
+#if STORAGE_FLASH_CIRCULAR && (STORAGE_FLASH_FIRST_PAGE != 0) \
+        && ((STORAGE_FLASH_LAST_PAGE + 1 - STORAGE_FLASH_FIRST_PAGE) * FLASH_PAGE_SIZE < 3 * (STORAGE_BLOCK_HEADER_SIZE \
+        + STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BYTES + 3 + STORAGE_BLOCK_TRAILER_SIZE))
+    #error The assigned FLASH region is too small to hold three uncompressed data blocks, as required by STORAGE_FLASH_CIRCULAR
+#endif
+
+#ifndef STORAGE_FOREACH_RUN_COUNT
+    /**
+     * The maximum number of samples #Storage_ForEach hands out in one call to its callback when the samples must be
+     * unpacked first. The samples are unpacked in an array of this size, allocated on the stack.
+     * @note When #STORAGE_BITSIZE equals the number of bits in #STORAGE_TYPE, samples stored in FLASH are handed out
+     *  in place, up to a full block at a time, and this array is not used for them.
+     */
+    #define STORAGE_FOREACH_RUN_COUNT 16
+#endif
+#if STORAGE_FOREACH_RUN_COUNT <= 0
+    #error STORAGE_FOREACH_RUN_COUNT must be a strict positive number
+#endif
+
+#ifndef STORAGE_DEFER_MOVE_TO_FLASH
+    /**
+     * - If not defined, or defined to zero, samples are moved from EEPROM to FLASH as part of the call to
+     *  #Storage_Write that finds #STORAGE_BLOCK_SIZE_IN_SAMPLES samples stored in EEPROM. That call then takes 100+
+     *  milliseconds to complete.
+     * - If defined to a non-zero value, #Storage_Write never moves samples to FLASH until the assigned EEPROM region is
+     *  completely filled. Instead, the application is expected to call #Storage_Service at a moment of its choosing -
+     *  e.g. while an NFC field supplies power - which moves the samples in a number of short steps.
+     * .
+     */
+    #define STORAGE_DEFER_MOVE_TO_FLASH 0
+#endif
+
+#ifndef STORAGE_DEFER_ERASE
+    /**
+     * - If not defined, or defined to zero, #Storage_Reset checks - and if necessary erases - the assigned FLASH region
+     *  in one go when asked to.
+     * - If defined to a non-zero value, #Storage_Reset does not check nor erase FLASH at all. Instead, the pages after
+     *  the newest data in FLASH are checked and - when not erased - erased by #Storage_Service, once no move of
+     *  samples to FLASH is pending. A whole sector is erased at once when more than one page of it needs erasing.
+     *  A page that must be written before #Storage_Service got to it is checked and erased right before the write.
+     * .
+     * Combine this with #STORAGE_DEFER_MOVE_TO_FLASH and call #Storage_Service at a moment of the application's choosing
+     * - e.g. while an NFC field supplies power, or when idle between two measurements - to keep FLASH erases out of the
+     * calls to #Storage_Write.
+     * @note Which pages are known to be erased is not kept between two sessions: after #Storage_Init, the pages after the
+     *  newest data in FLASH are checked again. Checking an erased page only involves reading it.
+     */
+    #define STORAGE_DEFER_ERASE 0
+#endif
+
+/**
+ * The number of bytes in #STORAGE_WORKAREA occupied by one decompressed block of samples: the size of an uncompressed
+ * block, rounded up to a word boundary.
+ */
+#define STORAGE_DECOMPRESSED_BLOCK_SIZE_IN_BYTES (4 * STORAGE_IDIVUP(STORAGE_UNCOMPRESSED_BLOCK_SIZE_IN_BYTES, 4))
+
+/**
+ * The number of bytes in #STORAGE_WORKAREA required to compress a block of samples, including the FLASH page
+ * contents surrounding it.
+ */
+#define STORAGE_COMPRESS_WORKAREA_SIZE ((FLASH_PAGE_SIZE * 2) + STORAGE_DECOMPRESSED_BLOCK_SIZE_IN_BYTES \
+        + STORAGE_BLOCK_SUMMARY_SIZE + STORAGE_BLOCK_TRAILER_SIZE)
+
+#ifndef STORAGE_DECOMPRESSED_CACHE_BLOCKS
+    /**
+     * The number of decompressed blocks of samples that are kept in #STORAGE_WORKAREA. When reading samples from
+     * FLASH, the least recently used decompressed block is replaced, so that alternating reads from a few blocks do
+     * not require to call #STORAGE_DECOMPRESS_CB each time.
+     * @note By default, as many decompressed blocks are kept as fit in the part of #STORAGE_WORKAREA that is
+     *  required anyhow for compressing samples - typically just one: no extra SRAM is used. Increase this value when
+     *  the application reads back and forth between a few blocks, see #Storage_GetCacheStatistics.
+     * @note Each additional block takes up #STORAGE_DECOMPRESSED_BLOCK_SIZE_IN_BYTES bytes of #STORAGE_WORKAREA_SIZE,
+     *  once the part required for compression is filled.
+     * @note All decompressed blocks are discarded when samples are moved from EEPROM to FLASH.
+     * @note Uncompressed blocks in FLASH are read directly and do not occupy a place in this cache.
+     */
+    #define STORAGE_DECOMPRESSED_CACHE_BLOCKS (STORAGE_COMPRESS_WORKAREA_SIZE / STORAGE_DECOMPRESSED_BLOCK_SIZE_IN_BYTES)
+#endif
+#if STORAGE_DECOMPRESSED_CACHE_BLOCKS <= 0
+    #error STORAGE_DECOMPRESSED_CACHE_BLOCKS must be a strict positive number
+#endif
+
+/**
+ * The size in bytes of the required memory for this module.
+ * - The first part is used to compress a block of samples, or to keep up to #STORAGE_DECOMPRESSED_CACHE_BLOCKS
+ *  decompressed blocks of samples, whichever is larger.
+ * .
+ */
+#define STORAGE_WORKAREA_SIZE ((STORAGE_COMPRESS_WORKAREA_SIZE > (STORAGE_DECOMPRESSED_CACHE_BLOCKS \
+        * STORAGE_DECOMPRESSED_BLOCK_SIZE_IN_BYTES)) ? STORAGE_COMPRESS_WORKAREA_SIZE : (STORAGE_DECOMPRESSED_CACHE_BLOCKS \
+        * STORAGE_DECOMPRESSED_BLOCK_SIZE_IN_BYTES))
 
 #ifdef STORAGE_WORKAREA
     #undef STORAGE_WORKAREA_SELF_DEFINED